@@ -0,0 +1,134 @@
+// interaction with the light shadowed by the shadow map atlas instead of the stencil buffer
+
+#ifdef GL_ES
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+#endif
+
+uniform sampler2D u_fragmentMap0;	// bump map
+uniform sampler2D u_fragmentMap1;	// light falloff
+uniform sampler2D u_fragmentMap2;	// light projection
+uniform sampler2D u_fragmentMap3;	// diffuse map
+uniform sampler2D u_fragmentMap4;	// specular map
+uniform sampler2D u_fragmentMap5;	// specular lookup table
+uniform sampler2D u_fragmentMap6;	// shadow map atlas
+
+uniform vec4 u_diffuseColor;
+uniform vec4 u_specularColor;
+
+uniform vec4 u_shadowLightOrigin;	// w = number of faces
+uniform vec4 u_shadowTile0;			// atlas corners of the +X and -X faces
+uniform vec4 u_shadowTile1;			// +Y and -Y
+uniform vec4 u_shadowTile2;			// +Z and -Z
+uniform vec4 u_shadowParms;			// face scale, face offset, 1 / atlas size, stored depth per unit
+uniform vec4 u_shadowBias;			// constant bias, slope bias in texels, texel size = z * depth + w
+
+varying vec2 var_TexNormal;
+varying vec2 var_TexDiffuse;
+varying vec2 var_TexSpecular;
+varying vec4 var_TexLight;
+varying vec4 var_Color;
+varying vec3 var_L;
+varying vec3 var_V;
+varying vec4 var_ShadowCoord;
+varying float var_ShadowSlope;
+
+float unpackDepth(vec4 packed)
+{
+	return dot(packed, vec4(1.0, 1.0 / 255.0, 1.0 / 65025.0, 1.0 / 16581375.0));
+}
+
+float shadowFactor(void)
+{
+	vec2 coord;
+	float depth;
+
+	if (u_shadowLightOrigin.w > 1.0) {
+		vec3 dir = var_ShadowCoord.xyz;
+		vec3 axis = abs(dir);
+		vec2 face;
+		vec2 tile;
+		float major;
+
+		// must match the face axis in tr_shadowmap.cpp
+		if (axis.x >= axis.y && axis.x >= axis.z) {
+			major = axis.x;
+
+			if (dir.x > 0.0) {
+				face = vec2(dir.y, dir.z);
+				tile = u_shadowTile0.xy;
+			} else {
+				face = vec2(-dir.y, dir.z);
+				tile = u_shadowTile0.zw;
+			}
+		} else if (axis.y >= axis.z) {
+			major = axis.y;
+
+			if (dir.y > 0.0) {
+				face = vec2(-dir.x, dir.z);
+				tile = u_shadowTile1.xy;
+			} else {
+				face = vec2(dir.x, dir.z);
+				tile = u_shadowTile1.zw;
+			}
+		} else {
+			major = axis.z;
+
+			if (dir.z > 0.0) {
+				face = vec2(dir.x, dir.y);
+				tile = u_shadowTile2.xy;
+			} else {
+				face = vec2(dir.x, -dir.y);
+				tile = u_shadowTile2.zw;
+			}
+		}
+
+		coord = tile + face / major * u_shadowParms.x + u_shadowParms.y;
+		depth = major * u_shadowParms.w;
+	} else {
+		coord = var_ShadowCoord.xy / var_ShadowCoord.w;
+		depth = var_ShadowCoord.z;
+	}
+
+	depth -= u_shadowBias.x + u_shadowBias.y * var_ShadowSlope * (depth * u_shadowBias.z + u_shadowBias.w);
+
+	// 3x3 percentage closer filter
+	float lit = 0.0;
+
+	for (int y = -1; y <= 1; y++) {
+		for (int x = -1; x <= 1; x++) {
+			vec2 offset = vec2(float(x), float(y)) * u_shadowParms.z;
+			lit += step(depth, unpackDepth(texture2D(u_fragmentMap6, coord + offset)));
+		}
+	}
+
+	return lit * (1.0 / 9.0);
+}
+
+void main(void)
+{
+	vec3 L = normalize(var_L);
+	vec3 V = normalize(var_V);
+	vec3 H = normalize(L + V);
+
+	// the normal maps have x in alpha
+	vec3 N = 2.0 * texture2D(u_fragmentMap0, var_TexNormal).agb - 1.0;
+	N = normalize(N);
+
+	float NdotL = clamp(dot(N, L), 0.0, 1.0);
+	float NdotH = clamp(dot(N, H), 0.0, 1.0);
+
+	vec3 light = texture2DProj(u_fragmentMap2, var_TexLight.xyw).rgb;
+	light *= texture2D(u_fragmentMap1, vec2(var_TexLight.z, 0.5)).rgb;
+
+	vec3 diffuse = texture2D(u_fragmentMap3, var_TexDiffuse).rgb * u_diffuseColor.rgb;
+	vec3 specular = 2.0 * texture2D(u_fragmentMap4, var_TexSpecular).rgb * u_specularColor.rgb;
+	specular *= texture2D(u_fragmentMap5, vec2(NdotH, 0.5)).rgb;
+
+	vec3 color = (diffuse + specular) * NdotL * light * shadowFactor();
+
+	gl_FragColor = vec4(color, 1.0) * var_Color;
+}
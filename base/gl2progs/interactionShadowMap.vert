@@ -0,0 +1,80 @@
+// interaction with the light shadowed by the shadow map atlas instead of the stencil buffer
+
+#ifdef GL_ES
+precision highp float;
+#endif
+
+attribute vec4 attr_TexCoord;
+attribute vec3 attr_Tangent;
+attribute vec3 attr_Bitangent;
+attribute vec3 attr_Normal;
+attribute vec4 attr_Vertex;
+attribute vec4 attr_Color;
+
+uniform vec4 u_lightProjectionS;
+uniform vec4 u_lightProjectionT;
+uniform vec4 u_lightProjectionQ;
+uniform vec4 u_lightFalloff;
+
+uniform vec4 u_bumpMatrixS;
+uniform vec4 u_bumpMatrixT;
+uniform vec4 u_diffuseMatrixS;
+uniform vec4 u_diffuseMatrixT;
+uniform vec4 u_specularMatrixS;
+uniform vec4 u_specularMatrixT;
+
+uniform vec4 u_colorModulate;
+uniform vec4 u_colorAdd;
+
+uniform vec4 u_lightOrigin;			// local space
+uniform vec4 u_viewOrigin;			// local space
+
+uniform mat4 u_modelViewProjectionMatrix;
+uniform mat4 u_modelMatrix;
+
+uniform mat4 u_shadowMatrix;		// global space to the atlas, for single face lights
+uniform vec4 u_shadowLightOrigin;	// global space, w = number of faces
+
+varying vec2 var_TexNormal;
+varying vec2 var_TexDiffuse;
+varying vec2 var_TexSpecular;
+varying vec4 var_TexLight;
+varying vec4 var_Color;
+varying vec3 var_L;
+varying vec3 var_V;
+varying vec4 var_ShadowCoord;
+varying float var_ShadowSlope;
+
+void main(void)
+{
+	vec3 L = u_lightOrigin.xyz - attr_Vertex.xyz;
+	vec3 V = u_viewOrigin.xyz - attr_Vertex.xyz;
+
+	// light and view vectors in tangent space
+	var_L = vec3(dot(attr_Tangent, L), dot(attr_Bitangent, L), dot(attr_Normal, L));
+	var_V = vec3(dot(attr_Tangent, V), dot(attr_Bitangent, V), dot(attr_Normal, V));
+
+	var_TexNormal = vec2(dot(u_bumpMatrixS, attr_TexCoord), dot(u_bumpMatrixT, attr_TexCoord));
+	var_TexDiffuse = vec2(dot(u_diffuseMatrixS, attr_TexCoord), dot(u_diffuseMatrixT, attr_TexCoord));
+	var_TexSpecular = vec2(dot(u_specularMatrixS, attr_TexCoord), dot(u_specularMatrixT, attr_TexCoord));
+
+	var_TexLight = vec4(dot(u_lightProjectionS, attr_Vertex), dot(u_lightProjectionT, attr_Vertex),
+	                    dot(u_lightFalloff, attr_Vertex), dot(u_lightProjectionQ, attr_Vertex));
+
+	var_Color = (attr_Color / 255.0) * u_colorModulate + u_colorAdd;
+
+	// point lights pick the cube face from the light vector
+	vec4 global = u_modelMatrix * attr_Vertex;
+
+	if (u_shadowLightOrigin.w > 1.0) {
+		var_ShadowCoord = vec4(global.xyz - u_shadowLightOrigin.xyz, 1.0);
+	} else {
+		var_ShadowCoord = u_shadowMatrix * global;
+	}
+
+	// surfaces at a grazing angle to the light need more bias
+	float cosine = clamp(dot(normalize(attr_Normal), normalize(L)), 0.1, 1.0);
+	var_ShadowSlope = sqrt(1.0 - cosine * cosine) / cosine;
+
+	gl_Position = u_modelViewProjectionMatrix * attr_Vertex;
+}
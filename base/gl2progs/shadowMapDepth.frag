@@ -0,0 +1,23 @@
+// the depth is packed in 8 bits per channel, OpenGL ES 2.0 has no depth textures
+
+#ifdef GL_ES
+#ifdef GL_FRAGMENT_PRECISION_HIGH
+precision highp float;
+#else
+precision mediump float;
+#endif
+#endif
+
+varying float var_Depth;
+
+vec4 packDepth(float depth)
+{
+	vec4 packed = fract(depth * vec4(1.0, 255.0, 65025.0, 16581375.0));
+	return packed - packed.yzww * vec4(1.0 / 255.0, 1.0 / 255.0, 1.0 / 255.0, 0.0);
+}
+
+void main(void)
+{
+	// 1.0 would wrap around to 0.0, the cleared texels are the farthest depth
+	gl_FragColor = packDepth(clamp(var_Depth, 0.0, 0.99999));
+}
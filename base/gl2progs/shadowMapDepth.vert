@@ -0,0 +1,19 @@
+// renders the shadow casters of a light into its faces of the shadow map atlas
+
+#ifdef GL_ES
+precision highp float;
+#endif
+
+attribute vec4 attr_Vertex;
+
+uniform mat4 u_modelViewProjectionMatrix;
+uniform vec4 u_shadowDepthPlane;	// clip space to the stored linear depth
+
+varying float var_Depth;
+
+void main(void)
+{
+	gl_Position = u_modelViewProjectionMatrix * attr_Vertex;
+
+	var_Depth = dot(u_shadowDepthPlane, gl_Position);
+}
@@ -256,6 +256,17 @@ void			Sys_LeaveCriticalSection(int index) {}
 void			Sys_WaitForEvent(int index) {}
 void			Sys_TriggerEvent(int index) {}
 
+void			Sys_RunJobs(xjob_t function, void *parms, int parmSize, int numJobs)
+{
+	for (int i = 0; i < numJobs; i++) {
+		function((byte *)parms + i * parmSize);
+	}
+}
+int				Sys_NumJobThreads(void)
+{
+	return 0;
+}
+
 /*
 ==============
 idSysLocal stub
@@ -361,7 +361,7 @@ void idCollisionModelManagerLocal::ParseVertices(idLexer *src, cm_model_t *model
 	src->ExpectTokenString("{");
 	model->numVertices = src->ParseInt();
 	model->maxVertices = model->numVertices;
-	model->vertices = (cm_vertex_t *) Mem_Alloc(model->maxVertices * sizeof(cm_vertex_t));
+	model->vertices = (cm_vertex_t *) Mem_Alloc(model->maxVertices * sizeof(cm_vertex_t), TAG_COLLISION);
 
 	for (i = 0; i < model->numVertices; i++) {
 		src->Parse1DMatrix(3, model->vertices[i].p.ToFloatPtr());
@@ -385,7 +385,7 @@ void idCollisionModelManagerLocal::ParseEdges(idLexer *src, cm_model_t *model)
 	src->ExpectTokenString("{");
 	model->numEdges = src->ParseInt();
 	model->maxEdges = model->numEdges;
-	model->edges = (cm_edge_t *) Mem_Alloc(model->maxEdges * sizeof(cm_edge_t));
+	model->edges = (cm_edge_t *) Mem_Alloc(model->maxEdges * sizeof(cm_edge_t), TAG_COLLISION);
 
 	for (i = 0; i < model->numEdges; i++) {
 		src->ExpectTokenString("(");
@@ -444,7 +444,7 @@ void idCollisionModelManagerLocal::ParsePolygons(idLexer *src, cm_model_t *model
 	idToken token;
 
 	if (src->CheckTokenType(TT_NUMBER, 0, &token)) {
-		model->polygonBlock = (cm_polygonBlock_t *) Mem_Alloc(sizeof(cm_polygonBlock_t) + token.GetIntValue());
+		model->polygonBlock = (cm_polygonBlock_t *) Mem_Alloc(sizeof(cm_polygonBlock_t) + token.GetIntValue(), TAG_COLLISION);
 		model->polygonBlock->bytesRemaining = token.GetIntValue();
 		model->polygonBlock->next = ((byte *) model->polygonBlock) + sizeof(cm_polygonBlock_t);
 	}
@@ -491,7 +491,7 @@ void idCollisionModelManagerLocal::ParseBrushes(idLexer *src, cm_model_t *model)
 	idToken token;
 
 	if (src->CheckTokenType(TT_NUMBER, 0, &token)) {
-		model->brushBlock = (cm_brushBlock_t *) Mem_Alloc(sizeof(cm_brushBlock_t) + token.GetIntValue());
+		model->brushBlock = (cm_brushBlock_t *) Mem_Alloc(sizeof(cm_brushBlock_t) + token.GetIntValue(), TAG_COLLISION);
 		model->brushBlock->bytesRemaining = token.GetIntValue();
 		model->brushBlock->next = ((byte *) model->brushBlock) + sizeof(cm_brushBlock_t);
 	}
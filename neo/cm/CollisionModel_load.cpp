@@ -90,7 +90,7 @@ void idCollisionModelManagerLocal::ParseProcNodes(idLexer *src)
 		src->Error("ParseProcNodes: bad numProcNodes");
 	}
 
-	procNodes = (cm_procNode_t *)Mem_ClearedAlloc(numProcNodes * sizeof(cm_procNode_t));
+	procNodes = (cm_procNode_t *)Mem_ClearedAlloc(numProcNodes * sizeof(cm_procNode_t), TAG_COLLISION);
 
 	for (i = 0; i < numProcNodes; i++) {
 		cm_procNode_t *node;
@@ -616,7 +616,7 @@ cm_node_t *idCollisionModelManagerLocal::AllocNode(cm_model_t *model, int blockS
 	cm_nodeBlock_t *nodeBlock;
 
 	if (!model->nodeBlocks || !model->nodeBlocks->nextNode) {
-		nodeBlock = (cm_nodeBlock_t *) Mem_ClearedAlloc(sizeof(cm_nodeBlock_t) + blockSize * sizeof(cm_node_t));
+		nodeBlock = (cm_nodeBlock_t *) Mem_ClearedAlloc(sizeof(cm_nodeBlock_t) + blockSize * sizeof(cm_node_t), TAG_COLLISION);
 		nodeBlock->nextNode = (cm_node_t *)(((byte *) nodeBlock) + sizeof(cm_nodeBlock_t));
 		nodeBlock->next = model->nodeBlocks;
 		model->nodeBlocks = nodeBlock;
@@ -649,7 +649,7 @@ cm_polygonRef_t *idCollisionModelManagerLocal::AllocPolygonReference(cm_model_t
 	cm_polygonRefBlock_t *prefBlock;
 
 	if (!model->polygonRefBlocks || !model->polygonRefBlocks->nextRef) {
-		prefBlock = (cm_polygonRefBlock_t *) Mem_Alloc(sizeof(cm_polygonRefBlock_t) + blockSize * sizeof(cm_polygonRef_t));
+		prefBlock = (cm_polygonRefBlock_t *) Mem_Alloc(sizeof(cm_polygonRefBlock_t) + blockSize * sizeof(cm_polygonRef_t), TAG_COLLISION);
 		prefBlock->nextRef = (cm_polygonRef_t *)(((byte *) prefBlock) + sizeof(cm_polygonRefBlock_t));
 		prefBlock->next = model->polygonRefBlocks;
 		model->polygonRefBlocks = prefBlock;
@@ -681,7 +681,7 @@ cm_brushRef_t *idCollisionModelManagerLocal::AllocBrushReference(cm_model_t *mod
 	cm_brushRefBlock_t *brefBlock;
 
 	if (!model->brushRefBlocks || !model->brushRefBlocks->nextRef) {
-		brefBlock = (cm_brushRefBlock_t *) Mem_Alloc(sizeof(cm_brushRefBlock_t) + blockSize * sizeof(cm_brushRef_t));
+		brefBlock = (cm_brushRefBlock_t *) Mem_Alloc(sizeof(cm_brushRefBlock_t) + blockSize * sizeof(cm_brushRef_t), TAG_COLLISION);
 		brefBlock->nextRef = (cm_brushRef_t *)(((byte *) brefBlock) + sizeof(cm_brushRefBlock_t));
 		brefBlock->next = model->brushRefBlocks;
 		model->brushRefBlocks = brefBlock;
@@ -720,7 +720,7 @@ cm_polygon_t *idCollisionModelManagerLocal::AllocPolygon(cm_model_t *model, int
 		model->polygonBlock->next += size;
 		model->polygonBlock->bytesRemaining -= size;
 	} else {
-		poly = (cm_polygon_t *) Mem_Alloc(size);
+		poly = (cm_polygon_t *) Mem_Alloc(size, TAG_COLLISION);
 	}
 
 	return poly;
@@ -745,7 +745,7 @@ cm_brush_t *idCollisionModelManagerLocal::AllocBrush(cm_model_t *model, int numP
 		model->brushBlock->next += size;
 		model->brushBlock->bytesRemaining -= size;
 	} else {
-		brush = (cm_brush_t *) Mem_Alloc(size);
+		brush = (cm_brush_t *) Mem_Alloc(size, TAG_COLLISION);
 	}
 
 	return brush;
@@ -806,10 +806,10 @@ void idCollisionModelManagerLocal::SetupTrmModelStructure(void)
 	// allocate vertex and edge arrays
 	model->numVertices = 0;
 	model->maxVertices = MAX_TRACEMODEL_VERTS;
-	model->vertices = (cm_vertex_t *) Mem_ClearedAlloc(model->maxVertices * sizeof(cm_vertex_t));
+	model->vertices = (cm_vertex_t *) Mem_ClearedAlloc(model->maxVertices * sizeof(cm_vertex_t), TAG_COLLISION);
 	model->numEdges = 0;
 	model->maxEdges = MAX_TRACEMODEL_EDGES+1;
-	model->edges = (cm_edge_t *) Mem_ClearedAlloc(model->maxEdges * sizeof(cm_edge_t));
+	model->edges = (cm_edge_t *) Mem_ClearedAlloc(model->maxEdges * sizeof(cm_edge_t), TAG_COLLISION);
 	// create a material for the trace model polygons
 	trmMaterial = declManager->FindMaterial("_tracemodel", false);
 
@@ -2546,7 +2546,7 @@ int idCollisionModelManagerLocal::GetVertex(cm_model_t *model, const idVec3 &v,
 		// resize vertex array
 		model->maxVertices = (float) model->maxVertices * 1.5f + 1;
 		oldVertices = model->vertices;
-		model->vertices = (cm_vertex_t *) Mem_ClearedAlloc(model->maxVertices * sizeof(cm_vertex_t));
+		model->vertices = (cm_vertex_t *) Mem_ClearedAlloc(model->maxVertices * sizeof(cm_vertex_t), TAG_COLLISION);
 		memcpy(model->vertices, oldVertices, model->numVertices * sizeof(cm_vertex_t));
 		Mem_Free(oldVertices);
 
@@ -2635,7 +2635,7 @@ int idCollisionModelManagerLocal::GetEdge(cm_model_t *model, const idVec3 &v1, c
 		// resize edge array
 		model->maxEdges = (float) model->maxEdges * 1.5f + 1;
 		oldEdges = model->edges;
-		model->edges = (cm_edge_t *) Mem_ClearedAlloc(model->maxEdges * sizeof(cm_edge_t));
+		model->edges = (cm_edge_t *) Mem_ClearedAlloc(model->maxEdges * sizeof(cm_edge_t), TAG_COLLISION);
 		memcpy(model->edges, oldEdges, model->numEdges * sizeof(cm_edge_t));
 		Mem_Free(oldEdges);
 
@@ -3172,7 +3172,7 @@ void idCollisionModelManagerLocal::OptimizeArrays(cm_model_t *model)
 	cm_edge_t *oldEdges;
 	cm_vertex_t *oldVertices;
 
-	remap = (int *) Mem_ClearedAlloc(Max(model->numVertices, model->numEdges) * sizeof(int));
+	remap = (int *) Mem_ClearedAlloc(Max(model->numVertices, model->numEdges) * sizeof(int), TAG_COLLISION);
 
 	// get all used vertices
 	for (i = 0; i < model->numEdges; i++) {
@@ -3223,7 +3223,7 @@ void idCollisionModelManagerLocal::OptimizeArrays(cm_model_t *model)
 	oldVertices = model->vertices;
 
 	if (oldVertices) {
-		model->vertices = (cm_vertex_t *) Mem_ClearedAlloc(model->numVertices * sizeof(cm_vertex_t));
+		model->vertices = (cm_vertex_t *) Mem_ClearedAlloc(model->numVertices * sizeof(cm_vertex_t), TAG_COLLISION);
 		memcpy(model->vertices, oldVertices, model->numVertices * sizeof(cm_vertex_t));
 		Mem_Free(oldVertices);
 	}
@@ -3232,7 +3232,7 @@ void idCollisionModelManagerLocal::OptimizeArrays(cm_model_t *model)
 	oldEdges = model->edges;
 
 	if (oldEdges) {
-		model->edges = (cm_edge_t *) Mem_ClearedAlloc(model->numEdges * sizeof(cm_edge_t));
+		model->edges = (cm_edge_t *) Mem_ClearedAlloc(model->numEdges * sizeof(cm_edge_t), TAG_COLLISION);
 		memcpy(model->edges, oldEdges, model->numEdges * sizeof(cm_edge_t));
 		Mem_Free(oldEdges);
 	}
@@ -3346,8 +3346,8 @@ cm_model_t *idCollisionModelManagerLocal::LoadRenderModel(const char *fileName)
 		model->maxEdges += surf->geometry->numIndexes;
 	}
 
-	model->vertices = (cm_vertex_t *) Mem_ClearedAlloc(model->maxVertices * sizeof(cm_vertex_t));
-	model->edges = (cm_edge_t *) Mem_ClearedAlloc(model->maxEdges * sizeof(cm_edge_t));
+	model->vertices = (cm_vertex_t *) Mem_ClearedAlloc(model->maxVertices * sizeof(cm_vertex_t), TAG_COLLISION);
+	model->edges = (cm_edge_t *) Mem_ClearedAlloc(model->maxEdges * sizeof(cm_edge_t), TAG_COLLISION);
 
 	// setup hash to speed up finding shared vertices and edges
 	SetupHash();
@@ -3435,8 +3435,8 @@ cm_model_t *idCollisionModelManagerLocal::CollisionModelForMapEntity(const idMap
 	CM_EstimateVertsAndEdges(mapEnt, &model->maxVertices, &model->maxEdges);
 	model->numVertices = 0;
 	model->numEdges = 0;
-	model->vertices = (cm_vertex_t *) Mem_ClearedAlloc(model->maxVertices * sizeof(cm_vertex_t));
-	model->edges = (cm_edge_t *) Mem_ClearedAlloc(model->maxEdges * sizeof(cm_edge_t));
+	model->vertices = (cm_vertex_t *) Mem_ClearedAlloc(model->maxVertices * sizeof(cm_vertex_t), TAG_COLLISION);
+	model->edges = (cm_edge_t *) Mem_ClearedAlloc(model->maxEdges * sizeof(cm_edge_t), TAG_COLLISION);
 
 	cm_vertexHash->ResizeIndex(model->maxVertices);
 	cm_edgeHash->ResizeIndex(model->maxEdges);
@@ -3710,7 +3710,7 @@ void idCollisionModelManagerLocal::LoadMap(const idMapFile *mapFile)
 	// models
 	maxModels = MAX_SUBMODELS;
 	numModels = 0;
-	models = (cm_model_t **) Mem_ClearedAlloc((maxModels+1) * sizeof(cm_model_t *));
+	models = (cm_model_t **) Mem_ClearedAlloc((maxModels+1) * sizeof(cm_model_t *), TAG_COLLISION);
 
 	// setup hash to speed up finding shared vertices and edges
 	SetupHash();
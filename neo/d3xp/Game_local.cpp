@@ -5398,3 +5398,18 @@ idGameLocal::GetMapLoadingGUI
 */
 void idGameLocal::GetMapLoadingGUI(char gui[ MAX_STRING_CHARS ]) { }
 
+/*
+===============
+idGameLocal::GetMemoryTagStats
+===============
+*/
+void idGameLocal::GetMemoryTagStats(const memTag_t tag, memTagStats_t &stats)
+{
+#ifdef GAME_DLL
+	Mem_GetTagStats(tag, stats);
+#else
+	// the engine heap is shared and already counts it
+	memset(&stats, 0, sizeof(stats));
+#endif
+}
+
@@ -122,6 +122,20 @@ typedef struct entityState_s {
 	struct entityState_s 	*next;
 } entityState_t;
 
+// entity delta written for one client, shared with the other clients that have the same base state
+typedef struct snapshotCache_s {
+	struct snapshotCache_s 	*next;
+	const entityState_t 	*base;				// base state the delta was written against
+	unsigned long			baseHash;
+	bool					changed;			// false if the entity did not change compared to the base
+	int						stateSize;			// write state of the new base
+	int						stateWriteBit;
+	int						numDeltaBits;
+	// followed by the new base state and the delta bits
+} snapshotCache_t;
+
+const int SNAPSHOT_CACHE_SIZE		= 1 << 20;
+
 typedef struct snapshot_s {
 	int						sequence;
 	entityState_t 			*firstEntityState;
@@ -438,6 +452,8 @@ class idGameLocal : public idGame
 		virtual void			ServerClientDisconnect(int clientNum);
 		virtual void			ServerWriteInitialReliableMessages(int clientNum);
 		virtual void			ServerWriteSnapshot(int clientNum, int sequence, idBitMsg &msg, byte *clientInPVS, int numPVSClients);
+		virtual void			ServerBeginSnapshots(const int *clientNums, int numClients);
+		virtual void			ServerEndSnapshots(void);
 		virtual bool			ServerApplySnapshot(int clientNum, int sequence);
 		virtual void			ServerProcessReliableMessage(int clientNum, const idBitMsg &msg);
 		virtual void			ClientReadSnapshot(int clientNum, int sequence, const int gameFrame, const int gameTime, const int dupeUsercmds, const int aheadOfServer, const idBitMsg &msg);
@@ -452,6 +468,8 @@ class idGameLocal : public idGame
 
 		virtual void				GetMapLoadingGUI(char gui[ MAX_STRING_CHARS ]);
 
+		virtual void				GetMemoryTagStats(const memTag_t tag, memTagStats_t &stats);
+
 		// ---------------------- Public idGameLocal Interface -------------------
 
 		void					Printf(const char *fmt, ...) const id_attribute((format(printf,2,3)));
@@ -613,8 +631,15 @@ class idGameLocal : public idGame
 		entityState_t 			*clientEntityStates[MAX_CLIENTS][MAX_GENTITIES];
 		int						clientPVS[MAX_CLIENTS][ENTITY_PVS_SIZE];
 		snapshot_t 			*clientSnapshots[MAX_CLIENTS];
-		idBlockAlloc<entityState_t,256>entityStateAllocator;
-		idBlockAlloc<snapshot_t,64>snapshotAllocator;
+		idBlockAlloc<entityState_t,256>entityStateAllocator[MAX_CLIENTS];	// per client so snapshots can be written in parallel
+		idBlockAlloc<snapshot_t,64>snapshotAllocator[MAX_CLIENTS];
+		pvsHandle_t				snapshotPVS[MAX_CLIENTS];				// set up by ServerBeginSnapshots
+		snapshotCache_t 		*snapshotCache[MAX_GENTITIES];			// entity deltas written between ServerBeginSnapshots and ServerEndSnapshots
+		idList<byte>			snapshotCacheData;
+		int						snapshotCacheUsed;
+		bool					snapshotCacheActive;
+		int						snapshotCacheHits[MAX_CLIENTS];
+		int						snapshotCacheMisses[MAX_CLIENTS];
 
 		idEventQueue			eventQueue;
 		idEventQueue			savedEventQueue;
@@ -662,6 +687,11 @@ class idGameLocal : public idGame
 		void					InitLocalClient(int clientNum);
 		void					InitClientDeclRemap(int clientNum);
 		void					ServerSendDeclRemapToClient(int clientNum, declType_t type, int index);
+		int						GetSnapshotSourceAreas(int clientNum, int *sourceAreas) const;
+		pvsHandle_t				SetupSnapshotPVS(int clientNum, int *sourceAreas, int &numSourceAreas) const;
+		void					ReserveSnapshotStates(int clientNum, int numStates);
+		bool					WriteEntityDelta(idEntity *ent, const entityState_t *base, entityState_t *newBase, idBitMsg &msg);
+		bool					WriteSnapshotEntity(int clientNum, idEntity *ent, const entityState_t *base, entityState_t *newBase, idBitMsg &msg);
 		void					FreeSnapshotsOlderThanSequence(int clientNum, int sequence);
 		bool					ApplySnapshot(int clientNum, int sequence);
 		void					WriteGameStateToSnapshot(idBitMsgDelta &msg) const;
@@ -53,6 +53,8 @@ idCVar net_clientSmoothing("net_clientSmoothing", "0.8", CVAR_GAME | CVAR_FLOAT,
 idCVar net_clientSelfSmoothing("net_clientSelfSmoothing", "0.6", CVAR_GAME | CVAR_FLOAT, "smooth self position if network causes prediction error.", 0.0f, 0.95f);
 idCVar net_clientMaxPrediction("net_clientMaxPrediction", "1000", CVAR_SYSTEM | CVAR_INTEGER | CVAR_NOCHEAT, "maximum number of milliseconds a client can predict ahead of server.");
 idCVar net_clientLagOMeter("net_clientLagOMeter", "1", CVAR_GAME | CVAR_BOOL | CVAR_NOCHEAT | CVAR_ARCHIVE, "draw prediction graph");
+idCVar net_serverSnapshotCache("net_serverSnapshotCache", "1", CVAR_GAME | CVAR_BOOL | CVAR_NOCHEAT, "share entity deltas between clients with the same base state");
+idCVar net_serverShowSnapshotCache("net_serverShowSnapshotCache", "0", CVAR_GAME | CVAR_BOOL | CVAR_NOCHEAT, "print the snapshot cache hit rate every server frame");
 
 /*
 ================
@@ -73,6 +75,15 @@ void idGameLocal::InitAsyncNetwork(void)
 	memset(clientPVS, 0, sizeof(clientPVS));
 	memset(clientSnapshots, 0, sizeof(clientSnapshots));
 
+	for (i = 0; i < MAX_CLIENTS; i++) {
+		snapshotPVS[i].i = -1;
+		snapshotPVS[i].h = 0;
+	}
+
+	memset(snapshotCache, 0, sizeof(snapshotCache));
+	snapshotCacheUsed = 0;
+	snapshotCacheActive = false;
+
 	eventQueue.Init();
 	savedEventQueue.Init();
 
@@ -90,8 +101,12 @@ idGameLocal::ShutdownAsyncNetwork
 */
 void idGameLocal::ShutdownAsyncNetwork(void)
 {
-	entityStateAllocator.Shutdown();
-	snapshotAllocator.Shutdown();
+	for (int i = 0; i < MAX_CLIENTS; i++) {
+		entityStateAllocator[i].Shutdown();
+		snapshotAllocator[i].Shutdown();
+	}
+
+	snapshotCacheData.Clear();
 	eventQueue.Shutdown();
 	savedEventQueue.Shutdown();
 	memset(clientEntityStates, 0, sizeof(clientEntityStates));
@@ -376,7 +391,7 @@ void idGameLocal::ServerClientDisconnect(int clientNum)
 	// free entity states stored for this client
 	for (i = 0; i < MAX_GENTITIES; i++) {
 		if (clientEntityStates[ clientNum ][ i ]) {
-			entityStateAllocator.Free(clientEntityStates[ clientNum ][ i ]);
+			entityStateAllocator[clientNum].Free(clientEntityStates[ clientNum ][ i ]);
 			clientEntityStates[ clientNum ][ i ] = NULL;
 		}
 	}
@@ -492,7 +507,7 @@ void idGameLocal::FreeSnapshotsOlderThanSequence(int clientNum, int sequence)
 		if (snapshot->sequence < sequence) {
 			for (state = snapshot->firstEntityState; state; state = snapshot->firstEntityState) {
 				snapshot->firstEntityState = snapshot->firstEntityState->next;
-				entityStateAllocator.Free(state);
+				entityStateAllocator[clientNum].Free(state);
 			}
 
 			if (lastSnapshot) {
@@ -501,7 +516,7 @@ void idGameLocal::FreeSnapshotsOlderThanSequence(int clientNum, int sequence)
 				clientSnapshots[clientNum] = snapshot->next;
 			}
 
-			snapshotAllocator.Free(snapshot);
+			snapshotAllocator[clientNum].Free(snapshot);
 		} else {
 			lastSnapshot = snapshot;
 		}
@@ -526,7 +541,7 @@ bool idGameLocal::ApplySnapshot(int clientNum, int sequence)
 		if (snapshot->sequence == sequence) {
 			for (state = snapshot->firstEntityState; state; state = state->next) {
 				if (clientEntityStates[clientNum][state->entityNumber]) {
-					entityStateAllocator.Free(clientEntityStates[clientNum][state->entityNumber]);
+					entityStateAllocator[clientNum].Free(clientEntityStates[clientNum][state->entityNumber]);
 				}
 
 				clientEntityStates[clientNum][state->entityNumber] = state;
@@ -540,7 +555,7 @@ bool idGameLocal::ApplySnapshot(int clientNum, int sequence)
 				clientSnapshots[clientNum] = nextSnapshot;
 			}
 
-			snapshotAllocator.Free(snapshot);
+			snapshotAllocator[clientNum].Free(snapshot);
 			return true;
 		} else {
 			lastSnapshot = snapshot;
@@ -582,6 +597,150 @@ void idGameLocal::ReadGameStateFromSnapshot(const idBitMsgDelta &msg)
 	mpGame.ReadFromSnapshot(msg);
 }
 
+/*
+================
+WriteBitsFromMsg
+================
+*/
+static void WriteBitsFromMsg(idBitMsg &msg, const idBitMsg &bits, int numBits)
+{
+	int n;
+
+	bits.BeginReading();
+
+	while (numBits > 0) {
+		n = Min(numBits, 32);
+		msg.WriteBits(bits.ReadBits(n), n);
+		numBits -= n;
+	}
+}
+
+/*
+================
+idGameLocal::WriteEntityDelta
+
+  Writes the entity to the new base state and the delta from the base to msg.
+  Returns false if the entity did not change compared to the base.
+================
+*/
+bool idGameLocal::WriteEntityDelta(idEntity *ent, const entityState_t *base, entityState_t *newBase, idBitMsg &msg)
+{
+	idBitMsgDelta deltaMsg;
+
+	deltaMsg.Init(base ? &base->state : NULL, &newBase->state, &msg);
+
+	deltaMsg.WriteBits(spawnIds[ ent->entityNumber ], 32 - GENTITYNUM_BITS);
+	deltaMsg.WriteBits(ent->GetType()->typeNum, idClass::GetTypeNumBits());
+	deltaMsg.WriteBits(ServerRemapDecl(-1, DECL_ENTITYDEF, ent->entityDefNumber), entityDefBits);
+
+	// write the class specific data to the snapshot
+	ent->WriteToSnapshot(deltaMsg);
+
+	return deltaMsg.HasChanged();
+}
+
+/*
+================
+idGameLocal::WriteSnapshotEntity
+
+  Same as WriteEntityDelta but while snapshots for several clients are written the delta is
+  stored in the snapshot cache, clients with the same base state reuse it instead of writing it again.
+  The cache is shared by the snapshot threads, entries are never changed once they are linked in.
+================
+*/
+bool idGameLocal::WriteSnapshotEntity(int clientNum, idEntity *ent, const entityState_t *base, entityState_t *newBase, idBitMsg &msg)
+{
+	snapshotCache_t *cache, *head;
+	idBitMsg deltaBits;
+	byte deltaBuf[MAX_ENTITY_STATE_SIZE * 3];
+	unsigned long baseHash;
+	int baseSize, size, offset;
+	byte *data;
+	bool changed;
+
+	if (!snapshotCacheActive) {
+		return WriteEntityDelta(ent, base, newBase, msg);
+	}
+
+	baseSize = base ? base->state.GetSize() : 0;
+	baseHash = base ? CRC32_BlockChecksum(base->stateBuf, baseSize) : 0;
+
+	for (cache = snapshotCache[ ent->entityNumber ]; cache; cache = cache->next) {
+		if (cache->baseHash != baseHash) {
+			continue;
+		}
+
+		if (cache->base == base) {
+			break;
+		}
+
+		if (cache->base && base && cache->base->state.GetSize() == baseSize && memcmp(cache->base->stateBuf, base->stateBuf, baseSize) == 0) {
+			break;
+		}
+	}
+
+	if (cache) {
+		snapshotCacheHits[clientNum]++;
+
+		data = (byte *)(cache + 1);
+		memcpy(newBase->stateBuf, data, cache->stateSize);
+		newBase->state.RestoreWriteState(cache->stateSize, cache->stateWriteBit);
+
+		deltaBits.Init((const byte *)data + cache->stateSize, (cache->numDeltaBits + 7) >> 3);
+		deltaBits.SetSize((cache->numDeltaBits + 7) >> 3);
+		WriteBitsFromMsg(msg, deltaBits, cache->numDeltaBits);
+
+		return cache->changed;
+	}
+
+	snapshotCacheMisses[clientNum]++;
+
+	// write the delta to a separate message so it can be stored
+	deltaBits.Init(deltaBuf, sizeof(deltaBuf));
+	deltaBits.SetAllowOverflow(true);
+	deltaBits.BeginWriting();
+
+	changed = WriteEntityDelta(ent, base, newBase, deltaBits);
+
+	if (deltaBits.IsOverflowed()) {
+		if (base) {
+			base->state.BeginReading();
+		}
+
+		newBase->state.BeginWriting();
+		return WriteEntityDelta(ent, base, newBase, msg);
+	}
+
+	WriteBitsFromMsg(msg, deltaBits, deltaBits.GetNumBitsWritten());
+
+	// allocate the entry, if the cache is full the delta just isn't shared
+	size = (sizeof(snapshotCache_t) + newBase->state.GetSize() + deltaBits.GetSize() + 15) & ~15;
+	offset = __sync_fetch_and_add(&snapshotCacheUsed, size);
+
+	if (offset + size > snapshotCacheData.Num()) {
+		return changed;
+	}
+
+	cache = (snapshotCache_t *)(snapshotCacheData.Ptr() + offset);
+	cache->base = base;
+	cache->baseHash = baseHash;
+	cache->changed = changed;
+	newBase->state.SaveWriteState(cache->stateSize, cache->stateWriteBit);
+	cache->numDeltaBits = deltaBits.GetNumBitsWritten();
+
+	data = (byte *)(cache + 1);
+	memcpy(data, newBase->stateBuf, cache->stateSize);
+	memcpy(data + cache->stateSize, deltaBuf, deltaBits.GetSize());
+
+	// link it in, other snapshot threads may be adding deltas for the same entity
+	do {
+		head = snapshotCache[ ent->entityNumber ];
+		cache->next = head;
+	} while (!__sync_bool_compare_and_swap(&snapshotCache[ ent->entityNumber ], head, cache));
+
+	return changed;
+}
+
 /*
 ================
 idGameLocal::ServerWriteSnapshot
@@ -592,13 +751,13 @@ idGameLocal::ServerWriteSnapshot
 void idGameLocal::ServerWriteSnapshot(int clientNum, int sequence, idBitMsg &msg, byte *clientInPVS, int numPVSClients)
 {
 	int i, msgSize, msgWriteBit;
-	idPlayer *player, *spectated = NULL;
+	idPlayer *player;
 	idEntity *ent;
 	pvsHandle_t pvsHandle;
 	idBitMsgDelta deltaMsg;
 	snapshot_t *snapshot;
 	entityState_t *base, *newBase;
-	int numSourceAreas, sourceAreas[ idEntity::MAX_PVS_AREAS ];
+	int numSourceAreas = 0, sourceAreas[ idEntity::MAX_PVS_AREAS ];
 
 	player = static_cast<idPlayer *>(entities[ clientNum ]);
 
@@ -606,43 +765,26 @@ void idGameLocal::ServerWriteSnapshot(int clientNum, int sequence, idBitMsg &msg
 		return;
 	}
 
-	if (player->spectating && player->spectator != clientNum && entities[ player->spectator ]) {
-		spectated = static_cast< idPlayer * >(entities[ player->spectator ]);
-	} else {
-		spectated = player;
-	}
-
 	// free too old snapshots
 	FreeSnapshotsOlderThanSequence(clientNum, sequence - 64);
 
 	// allocate new snapshot
-	snapshot = snapshotAllocator.Alloc();
+	snapshot = snapshotAllocator[clientNum].Alloc();
 	snapshot->sequence = sequence;
 	snapshot->firstEntityState = NULL;
 	snapshot->next = clientSnapshots[clientNum];
 	clientSnapshots[clientNum] = snapshot;
 	memset(snapshot->pvs, 0, sizeof(snapshot->pvs));
 
-	// get PVS for this player
-	// don't use PVSAreas for networking - PVSAreas depends on animations (and md5 bounds), which are not synchronized
-	numSourceAreas = gameRenderWorld->BoundsInAreas(spectated->GetPlayerPhysics()->GetAbsBounds(), sourceAreas, idEntity::MAX_PVS_AREAS);
-	pvsHandle = gameLocal.pvs.SetupCurrentPVS(sourceAreas, numSourceAreas, PVS_NORMAL);
-
-#ifdef _D3XP
-
-	// Add portalSky areas to PVS
-	if (portalSkyEnt.GetEntity()) {
-		pvsHandle_t	otherPVS, newPVS;
-		idEntity *skyEnt = portalSkyEnt.GetEntity();
-
-		otherPVS = gameLocal.pvs.SetupCurrentPVS(skyEnt->GetPVSAreas(), skyEnt->GetNumPVSAreas());
-		newPVS = gameLocal.pvs.MergeCurrentPVS(pvsHandle, otherPVS);
-		pvs.FreeCurrentPVS(pvsHandle);
-		pvs.FreeCurrentPVS(otherPVS);
-		pvsHandle = newPVS;
-	}
-
+	// use the PVS from ServerBeginSnapshots if available, setting up a PVS is not thread safe
+	if (snapshotPVS[clientNum].i >= 0) {
+		pvsHandle = snapshotPVS[clientNum];
+#if ASYNC_WRITE_PVS
+		numSourceAreas = GetSnapshotSourceAreas(clientNum, sourceAreas);
 #endif
+	} else {
+		pvsHandle = SetupSnapshotPVS(clientNum, sourceAreas, numSourceAreas);
+	}
 
 #if ASYNC_WRITE_TAGS
 	idRandom tagRandom;
@@ -678,23 +820,14 @@ void idGameLocal::ServerWriteSnapshot(int clientNum, int sequence, idBitMsg &msg
 			base->state.BeginReading();
 		}
 
-		newBase = entityStateAllocator.Alloc();
+		newBase = entityStateAllocator[clientNum].Alloc();
 		newBase->entityNumber = ent->entityNumber;
 		newBase->state.Init(newBase->stateBuf, sizeof(newBase->stateBuf));
 		newBase->state.BeginWriting();
 
-		deltaMsg.Init(base ? &base->state : NULL, &newBase->state, &msg);
-
-		deltaMsg.WriteBits(spawnIds[ ent->entityNumber ], 32 - GENTITYNUM_BITS);
-		deltaMsg.WriteBits(ent->GetType()->typeNum, idClass::GetTypeNumBits());
-		deltaMsg.WriteBits(ServerRemapDecl(-1, DECL_ENTITYDEF, ent->entityDefNumber), entityDefBits);
-
-		// write the class specific data to the snapshot
-		ent->WriteToSnapshot(deltaMsg);
-
-		if (!deltaMsg.HasChanged()) {
+		if (!WriteSnapshotEntity(clientNum, ent, base, newBase, msg)) {
 			msg.RestoreWriteState(msgSize, msgWriteBit);
-			entityStateAllocator.Free(newBase);
+			entityStateAllocator[clientNum].Free(newBase);
 		} else {
 			newBase->next = snapshot->firstEntityState;
 			snapshot->firstEntityState = newBase;
@@ -726,7 +859,9 @@ void idGameLocal::ServerWriteSnapshot(int clientNum, int sequence, idBitMsg &msg
 	}
 
 	// free the PVS
-	pvs.FreeCurrentPVS(pvsHandle);
+	if (snapshotPVS[clientNum].i < 0) {
+		pvs.FreeCurrentPVS(pvsHandle);
+	}
 
 	// write the game and player state to the snapshot
 	base = clientEntityStates[clientNum][ENTITYNUM_NONE];	// ENTITYNUM_NONE is used for the game and player state
@@ -735,7 +870,7 @@ void idGameLocal::ServerWriteSnapshot(int clientNum, int sequence, idBitMsg &msg
 		base->state.BeginReading();
 	}
 
-	newBase = entityStateAllocator.Alloc();
+	newBase = entityStateAllocator[clientNum].Alloc();
 	newBase->entityNumber = ENTITYNUM_NONE;
 	newBase->next = snapshot->firstEntityState;
 	snapshot->firstEntityState = newBase;
@@ -756,6 +891,178 @@ void idGameLocal::ServerWriteSnapshot(int clientNum, int sequence, idBitMsg &msg
 	LittleRevBytes(clientInPVS, sizeof(int), sizeof(clientInPVS) / sizeof(int));
 }
 
+/*
+================
+idGameLocal::GetSnapshotSourceAreas
+================
+*/
+int idGameLocal::GetSnapshotSourceAreas(int clientNum, int *sourceAreas) const
+{
+	idPlayer *player, *spectated;
+
+	player = static_cast<idPlayer *>(entities[ clientNum ]);
+
+	if (player->spectating && player->spectator != clientNum && entities[ player->spectator ]) {
+		spectated = static_cast< idPlayer * >(entities[ player->spectator ]);
+	} else {
+		spectated = player;
+	}
+
+	// don't use PVSAreas for networking - PVSAreas depends on animations (and md5 bounds), which are not synchronized
+	return gameRenderWorld->BoundsInAreas(spectated->GetPlayerPhysics()->GetAbsBounds(), sourceAreas, idEntity::MAX_PVS_AREAS);
+}
+
+/*
+================
+idGameLocal::SetupSnapshotPVS
+
+  Sets up the PVS used to select the entities sent to the given client.
+================
+*/
+pvsHandle_t idGameLocal::SetupSnapshotPVS(int clientNum, int *sourceAreas, int &numSourceAreas) const
+{
+	pvsHandle_t pvsHandle;
+
+	// get PVS for this player
+	numSourceAreas = GetSnapshotSourceAreas(clientNum, sourceAreas);
+	pvsHandle = pvs.SetupCurrentPVS(sourceAreas, numSourceAreas, PVS_NORMAL);
+
+#ifdef _D3XP
+
+	// Add portalSky areas to PVS
+	if (portalSkyEnt.GetEntity()) {
+		pvsHandle_t	otherPVS, newPVS;
+		idEntity *skyEnt = portalSkyEnt.GetEntity();
+
+		otherPVS = gameLocal.pvs.SetupCurrentPVS(skyEnt->GetPVSAreas(), skyEnt->GetNumPVSAreas());
+		newPVS = gameLocal.pvs.MergeCurrentPVS(pvsHandle, otherPVS);
+		pvs.FreeCurrentPVS(pvsHandle);
+		pvs.FreeCurrentPVS(otherPVS);
+		pvsHandle = newPVS;
+	}
+
+#endif
+
+	return pvsHandle;
+}
+
+/*
+================
+idGameLocal::ReserveSnapshotStates
+
+  Makes sure the client allocators can hand out a complete snapshot without growing.
+================
+*/
+void idGameLocal::ReserveSnapshotStates(int clientNum, int numStates)
+{
+	entityState_t *state, *reserved;
+
+	if (snapshotAllocator[clientNum].GetFreeCount() < 1) {
+		snapshotAllocator[clientNum].Free(snapshotAllocator[clientNum].Alloc());
+	}
+
+	if (entityStateAllocator[clientNum].GetFreeCount() >= numStates) {
+		return;
+	}
+
+	reserved = NULL;
+
+	while (numStates-- > 0) {
+		state = entityStateAllocator[clientNum].Alloc();
+		state->next = reserved;
+		reserved = state;
+	}
+
+	while (reserved) {
+		state = reserved;
+		reserved = reserved->next;
+		entityStateAllocator[clientNum].Free(state);
+	}
+}
+
+/*
+================
+idGameLocal::ServerBeginSnapshots
+
+  Does the work of ServerWriteSnapshot that touches shared state up front,
+  so the snapshots for the given clients can be written concurrently.
+================
+*/
+void idGameLocal::ServerBeginSnapshots(const int *clientNums, int numClients)
+{
+	int i, clientNum, numStates, numSourceAreas, sourceAreas[ idEntity::MAX_PVS_AREAS ];
+	idEntity *ent;
+
+	// every synchronized entity and the game state may end up in a snapshot
+	numStates = 1;
+
+	for (ent = spawnedEntities.Next(); ent != NULL; ent = ent->spawnNode.Next()) {
+		if (ent->fl.networkSync) {
+			numStates++;
+		}
+	}
+
+	for (i = 0; i < numClients; i++) {
+		clientNum = clientNums[i];
+
+		if (!entities[ clientNum ]) {
+			continue;
+		}
+
+		assert(snapshotPVS[clientNum].i < 0);
+
+		// the heap is not thread safe so the workers must never grow the allocators
+		ReserveSnapshotStates(clientNum, numStates);
+
+		snapshotPVS[clientNum] = SetupSnapshotPVS(clientNum, sourceAreas, numSourceAreas);
+
+		snapshotCacheHits[clientNum] = 0;
+		snapshotCacheMisses[clientNum] = 0;
+	}
+
+	// deltas can only be shared if there is more than one snapshot
+	snapshotCacheActive = net_serverSnapshotCache.GetBool() && numClients > 1;
+
+	if (snapshotCacheActive) {
+		if (snapshotCacheData.Num() != SNAPSHOT_CACHE_SIZE) {
+			snapshotCacheData.SetGranularity(1);
+			snapshotCacheData.SetNum(SNAPSHOT_CACHE_SIZE);
+		}
+
+		memset(snapshotCache, 0, sizeof(snapshotCache));
+		snapshotCacheUsed = 0;
+	}
+}
+
+/*
+================
+idGameLocal::ServerEndSnapshots
+================
+*/
+void idGameLocal::ServerEndSnapshots(void)
+{
+	int i, hits, misses;
+
+	hits = misses = 0;
+
+	for (i = 0; i < MAX_CLIENTS; i++) {
+		if (snapshotPVS[i].i >= 0) {
+			pvs.FreeCurrentPVS(snapshotPVS[i]);
+			snapshotPVS[i].i = -1;
+
+			hits += snapshotCacheHits[i];
+			misses += snapshotCacheMisses[i];
+		}
+	}
+
+	if (snapshotCacheActive && net_serverShowSnapshotCache.GetBool() && hits + misses > 0) {
+		Printf("frame %d: snapshot cache %d hits, %d misses (%d%%), %d KB used\n", framenum, hits, misses,
+		       hits * 100 / (hits + misses), Min(snapshotCacheUsed, snapshotCacheData.Num()) >> 10);
+	}
+
+	snapshotCacheActive = false;
+}
+
 /*
 ================
 idGameLocal::ServerApplySnapshot
@@ -1091,7 +1398,7 @@ void idGameLocal::ClientReadSnapshot(int clientNum, int sequence, const int game
 	snapshotEntities.Clear();
 
 	// allocate new snapshot
-	snapshot = snapshotAllocator.Alloc();
+	snapshot = snapshotAllocator[clientNum].Alloc();
 	snapshot->sequence = sequence;
 	snapshot->firstEntityState = NULL;
 	snapshot->next = clientSnapshots[clientNum];
@@ -1111,7 +1418,7 @@ void idGameLocal::ClientReadSnapshot(int clientNum, int sequence, const int game
 			base->state.BeginReading();
 		}
 
-		newBase = entityStateAllocator.Alloc();
+		newBase = entityStateAllocator[clientNum].Alloc();
 		newBase->entityNumber = i;
 		newBase->next = snapshot->firstEntityState;
 		snapshot->firstEntityState = newBase;
@@ -1345,7 +1652,7 @@ void idGameLocal::ClientReadSnapshot(int clientNum, int sequence, const int game
 		base->state.BeginReading();
 	}
 
-	newBase = entityStateAllocator.Alloc();
+	newBase = entityStateAllocator[clientNum].Alloc();
 	newBase->entityNumber = ENTITYNUM_NONE;
 	newBase->next = snapshot->firstEntityState;
 	snapshot->firstEntityState = newBase;
@@ -477,7 +477,7 @@ void *idClass::operator new(size_t s)
 	int *p;
 
 	s += sizeof(int);
-	p = (int *)Mem_Alloc(s);
+	p = (int *)Mem_Alloc(s, TAG_ENTITY);
 	*p = s;
 	memused += s;
 	numobjects++;
@@ -502,7 +502,7 @@ void *idClass::operator new(size_t s, int, int, char *, int)
 	int *p;
 
 	s += sizeof(int);
-	p = (int *)Mem_Alloc(s);
+	p = (int *)Mem_Alloc(s, TAG_ENTITY);
 	*p = s;
 	memused += s;
 	numobjects++;
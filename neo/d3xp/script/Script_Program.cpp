@@ -1038,7 +1038,7 @@ bool idScriptObject::SetType(const char *typeName)
 
 		// allocate the memory
 		size = type->Size();
-		data = (byte *)Mem_Alloc(size);
+		data = (byte *)Mem_Alloc(size, TAG_SCRIPT);
 	}
 
 	// init object memory
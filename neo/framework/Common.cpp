@@ -74,7 +74,7 @@ idCVar com_developer("developer", "0", CVAR_BOOL|CVAR_SYSTEM|CVAR_NOCHEAT, "deve
 idCVar com_allowConsole("com_allowConsole", "0", CVAR_BOOL | CVAR_SYSTEM | CVAR_NOCHEAT, "allow toggling console with the tilde key");
 idCVar com_speeds("com_speeds", "0", CVAR_BOOL|CVAR_SYSTEM|CVAR_NOCHEAT, "show engine timings");
 idCVar com_showFPS("com_showFPS", "0", CVAR_BOOL|CVAR_SYSTEM|CVAR_ARCHIVE|CVAR_NOCHEAT, "show frames rendered per second");
-idCVar com_showMemoryUsage("com_showMemoryUsage", "0", CVAR_BOOL|CVAR_SYSTEM|CVAR_NOCHEAT, "show total and per frame memory usage");
+idCVar com_showMemoryUsage("com_showMemoryUsage", "0", CVAR_INTEGER|CVAR_SYSTEM|CVAR_NOCHEAT, "show total and per frame memory usage, 2 = also per memory tag", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2>);
 idCVar com_showAsyncStats("com_showAsyncStats", "0", CVAR_BOOL|CVAR_SYSTEM|CVAR_NOCHEAT, "show async network stats");
 idCVar com_showSoundDecoders("com_showSoundDecoders", "0", CVAR_BOOL|CVAR_SYSTEM|CVAR_NOCHEAT, "show sound decoders");
 idCVar com_timestampPrints("com_timestampPrints", "0", CVAR_SYSTEM, "print time with each console print, 1 = msec, 2 = sec", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2>);
@@ -87,6 +87,31 @@ idCVar com_videoRam("com_videoRam", "64", CVAR_INTEGER | CVAR_SYSTEM | CVAR_NOCH
 
 idCVar com_product_lang_ext("com_product_lang_ext", "1", CVAR_INTEGER | CVAR_SYSTEM | CVAR_ARCHIVE, "Extension to use when creating language files.");
 
+// memory budgets in MB, a warning is printed when the peak of a tag goes over its budget
+idCVar com_budgetMisc("com_budgetMisc", "0", CVAR_INTEGER | CVAR_SYSTEM | CVAR_ARCHIVE | CVAR_NOCHEAT, "memory budget for untagged allocations in MB, 0 = none");
+idCVar com_budgetGeometry("com_budgetGeometry", "0", CVAR_INTEGER | CVAR_SYSTEM | CVAR_ARCHIVE | CVAR_NOCHEAT, "memory budget for renderer geometry in MB, 0 = none");
+idCVar com_budgetImages("com_budgetImages", "0", CVAR_INTEGER | CVAR_SYSTEM | CVAR_ARCHIVE | CVAR_NOCHEAT, "memory budget for images in MB, 0 = none");
+idCVar com_budgetSound("com_budgetSound", "0", CVAR_INTEGER | CVAR_SYSTEM | CVAR_ARCHIVE | CVAR_NOCHEAT, "memory budget for sound in MB, 0 = none");
+idCVar com_budgetDecls("com_budgetDecls", "0", CVAR_INTEGER | CVAR_SYSTEM | CVAR_ARCHIVE | CVAR_NOCHEAT, "memory budget for decls in MB, 0 = none");
+idCVar com_budgetEntities("com_budgetEntities", "0", CVAR_INTEGER | CVAR_SYSTEM | CVAR_ARCHIVE | CVAR_NOCHEAT, "memory budget for game entities in MB, 0 = none");
+idCVar com_budgetScript("com_budgetScript", "0", CVAR_INTEGER | CVAR_SYSTEM | CVAR_ARCHIVE | CVAR_NOCHEAT, "memory budget for scripts in MB, 0 = none");
+idCVar com_budgetCollision("com_budgetCollision", "0", CVAR_INTEGER | CVAR_SYSTEM | CVAR_ARCHIVE | CVAR_NOCHEAT, "memory budget for collision models in MB, 0 = none");
+idCVar com_budgetAAS("com_budgetAAS", "0", CVAR_INTEGER | CVAR_SYSTEM | CVAR_ARCHIVE | CVAR_NOCHEAT, "memory budget for AAS in MB, 0 = none");
+idCVar com_budgetFrameTemp("com_budgetFrameTemp", "0", CVAR_INTEGER | CVAR_SYSTEM | CVAR_ARCHIVE | CVAR_NOCHEAT, "memory budget for renderer frame temporary memory in MB, 0 = none");
+
+static idCVar *com_memoryBudgets[TAG_NUM_TAGS] = {
+	&com_budgetMisc,
+	&com_budgetGeometry,
+	&com_budgetImages,
+	&com_budgetSound,
+	&com_budgetDecls,
+	&com_budgetEntities,
+	&com_budgetScript,
+	&com_budgetCollision,
+	&com_budgetAAS,
+	&com_budgetFrameTemp
+};
+
 // com_speeds times
 int				time_gameFrame;
 int				time_gameDraw;
@@ -1303,6 +1328,88 @@ static void PrintMemInfo_f(const idCmdArgs &args)
 	fileSystem->CloseFile(f);
 }
 
+/*
+==================
+Com_GetMemoryTagStats
+
+  the game has a heap of its own when it is a separate module,
+  the sum of the two peaks may be higher than the real peak
+==================
+*/
+void Com_GetMemoryTagStats(const memTag_t tag, memTagStats_t &stats)
+{
+	memTagStats_t gameStats;
+
+	Mem_GetTagStats(tag, stats);
+
+	if (game) {
+		game->GetMemoryTagStats(tag, gameStats);
+		stats.num += gameStats.num;
+		stats.current += gameStats.current;
+		stats.peak += gameStats.peak;
+	}
+}
+
+/*
+==================
+Com_CheckMemoryBudgets
+
+  warns once when the peak of a tag goes over its budget
+==================
+*/
+static void Com_CheckMemoryBudgets(void)
+{
+	static int		warnedBudget[TAG_NUM_TAGS];
+	memTagStats_t	stats;
+	int				i, budget;
+
+	for (i = 0; i < TAG_NUM_TAGS; i++) {
+		budget = com_memoryBudgets[i]->GetInteger();
+
+		if (budget <= 0 || budget == warnedBudget[i]) {
+			continue;
+		}
+
+		Com_GetMemoryTagStats((memTag_t)i, stats);
+
+		if ((stats.peak >> 10) > (budget << 10)) {
+			common->Warning("memory tag '%s' peaked at %d kB, over its budget of %d MB", Mem_GetTagName((memTag_t)i), stats.peak >> 10, budget);
+			warnedBudget[i] = budget;
+		}
+	}
+}
+
+/*
+==================
+Com_MemoryTags_f
+==================
+*/
+static void Com_MemoryTags_f(const idCmdArgs &args)
+{
+	memTagStats_t	stats, total;
+	int				i, budget;
+
+	memset(&total, 0, sizeof(total));
+
+	common->Printf("tag          blocks current kB    peak kB  budget kB\n");
+	common->Printf("----------- ------- ---------- ---------- ----------\n");
+
+	for (i = 0; i < TAG_NUM_TAGS; i++) {
+		Com_GetMemoryTagStats((memTag_t)i, stats);
+		budget = com_memoryBudgets[i]->GetInteger();
+
+		common->Printf("%-11s %7d %10d %10d %10s%s\n", Mem_GetTagName((memTag_t)i), stats.num, stats.current >> 10, stats.peak >> 10,
+		               budget > 0 ? va("%d", budget << 10) : "-", (budget > 0 && (stats.peak >> 10) > (budget << 10)) ? " over budget" : "");
+
+		total.num += stats.num;
+		total.current += stats.current;
+		total.peak += stats.peak;
+	}
+
+	common->Printf("----------- ------- ---------- ---------- ----------\n");
+	common->Printf("%-11s %7d %10d %10d\n", "total", total.num, total.current >> 10, total.peak >> 10);
+}
+
 #ifdef ID_ALLOW_TOOLS
 /*
 ==================
@@ -2542,6 +2649,7 @@ void idCommonLocal::InitCommands(void)
 #endif
 
 	cmdSystem->AddCommand("printMemInfo", PrintMemInfo_f, CMD_FL_SYSTEM, "prints memory debugging data");
+	cmdSystem->AddCommand("memoryTags", Com_MemoryTags_f, CMD_FL_SYSTEM, "prints the current and peak memory of each memory tag");
 
 	// idLib commands
 	cmdSystem->AddCommand("memoryDump", Mem_Dump_f, CMD_FL_SYSTEM|CMD_FL_CHEAT, "creates a memory dump");
@@ -2652,6 +2760,8 @@ void idCommonLocal::Frame(void)
 			session->UpdateScreen(false);
 		}
 
+		Com_CheckMemoryBudgets();
+
 		// report timing information
 		if (com_speeds.GetBool()) {
 			static int	lastTime;
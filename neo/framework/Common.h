@@ -78,6 +78,9 @@ extern int			time_gameDraw;			// game present time
 extern int			time_frontend;			// renderer frontend time
 extern int			time_backend;			// renderer backend time
 
+// memory allocated with the tag by the engine and the game
+void				Com_GetMemoryTagStats(const memTag_t tag, memTagStats_t &stats);
+
 extern int			com_frameTime;			// time for the current frame in milliseconds
 extern volatile int	com_ticNumber;			// 60 hz tics, incremented by async function
 extern int			com_editors;			// current active editor(s)
@@ -2703,6 +2703,523 @@ void idCompressor_LZW::DecompressBlock()
 	blockSize = Min(writeByte, LZW_BLOCK_SIZE);
 }
 
+/*
+=================================================================================
+
+	idCompressor_RangeCoder
+
+	Adaptive binary range coder intended for small network messages. Every byte
+	is coded as eight binary decisions down a bit tree with an order-1 context
+	derived from the previous byte. The models adapt while coding but start each
+	message from one of a few primed models which are tuned for the different
+	kinds of messages sent over a channel. Because unreliable messages can be
+	dropped the models never carry over from one message to the next.
+
+	The encoder buffers the complete input, picks the primed model which codes
+	the start of the message best and stores the model number in the first byte
+	of the output. Incompressible input is stored uncompressed.
+
+=================================================================================
+*/
+
+const int RC_PROB_BITS		= 11;
+const int RC_PROB_ONE		= 1 << RC_PROB_BITS;
+const int RC_PROB_MIN		= 31;
+const int RC_MOVE_BITS		= 4;
+const unsigned int RC_TOP	= 1 << 24;
+const int RC_NUM_CONTEXTS	= 3;
+const int RC_NUM_MODELS		= 3;
+const int RC_MODEL_STORED	= 255;
+const int RC_TRIAL_BYTES	= 128;
+
+class idCompressor_RangeCoder : public idCompressor_None
+{
+	public:
+		idCompressor_RangeCoder(void);
+
+		void			Init(idFile *f, bool compress, int wordLength);
+		void			FinishCompress(void);
+		float			GetCompressionRatio(void) const;
+
+		int				Write(const void *inData, int inLength);
+		int				Read(void *outData, int outLength);
+
+	private:
+		byte			inBuffer[65536];
+		byte			outBuffer[65536];
+		int				inLength;
+		int				inPos;
+		int				outLength;
+		int				totalBytes;
+
+		unsigned short	probs[RC_NUM_CONTEXTS][256];
+		int				prevByte;
+
+		// encoder state
+		uint64_t		low;
+		unsigned int	range;
+		byte			cache;
+		int				cacheSize;
+
+		// decoder state
+		unsigned int	code;
+		bool			decoding;
+
+		static unsigned short	primedProbs[RC_NUM_MODELS][RC_NUM_CONTEXTS][256];
+		static bool		primed;
+
+	private:
+		static void		PrimeModels(void);
+		static int		ByteContext(int b);
+
+		int				Encode(const byte *data, int length, int model, byte *out, int maxOut);
+		bool			ShiftLow(byte *out, int &outPos, int maxOut);
+		int				DecodeByte(void);
+		int				ReadInputByte(void);
+};
+
+unsigned short	idCompressor_RangeCoder::primedProbs[RC_NUM_MODELS][RC_NUM_CONTEXTS][256];
+bool			idCompressor_RangeCoder::primed = false;
+
+/*
+================
+idCompressor_RangeCoder::idCompressor_RangeCoder
+================
+*/
+idCompressor_RangeCoder::idCompressor_RangeCoder(void)
+{
+	if (!primed) {
+		PrimeModels();
+	}
+
+	inLength = 0;
+	inPos = 0;
+	outLength = 0;
+	totalBytes = 0;
+	decoding = false;
+}
+
+/*
+================
+idCompressor_RangeCoder::PrimeModels
+
+  Builds the initial bit tree probabilities from byte frequency estimates.
+  Model 0 is tuned for bit packed snapshot deltas which are dominated by zero
+  bytes, model 1 for small signed values as found in user commands and model 2
+  for text as sent with reliable messages.
+================
+*/
+void idCompressor_RangeCoder::PrimeModels(void)
+{
+	int model, context, node, depth, first, half, i;
+	float freq[256], left, right;
+
+	for (model = 0; model < RC_NUM_MODELS; model++) {
+		for (context = 0; context < RC_NUM_CONTEXTS; context++) {
+
+			for (i = 0; i < 256; i++) {
+				switch (model) {
+					case 0:
+						freq[i] = (i == 0) ? 48.0f : 1.0f;
+						break;
+					case 1:
+						if (i == 0) {
+							freq[i] = 24.0f;
+						} else if (i < 16 || i >= 240) {
+							freq[i] = 4.0f;
+						} else {
+							freq[i] = 1.0f;
+						}
+						break;
+					default:
+						if (i == 0) {
+							freq[i] = 8.0f;
+						} else if (i >= 'a' && i <= 'z') {
+							freq[i] = 12.0f;
+						} else if (i >= ' ' && i < 127) {
+							freq[i] = 6.0f;
+						} else {
+							freq[i] = 0.5f;
+						}
+						break;
+				}
+			}
+
+			// zero bytes tend to come in runs
+			if (context == 0) {
+				freq[0] *= 2.5f;
+			}
+
+			primedProbs[model][context][0] = RC_PROB_ONE >> 1;
+
+			for (node = 1; node < 256; node++) {
+				for (depth = 0; (2 << depth) <= node; depth++) {
+				}
+
+				half = 1 << (7 - depth);
+				first = (node - (1 << depth)) << (8 - depth);
+				left = right = 0.0f;
+
+				for (i = 0; i < half; i++) {
+					left += freq[first + i];
+					right += freq[first + half + i];
+				}
+
+				primedProbs[model][context][node] = idMath::ClampInt(RC_PROB_MIN, RC_PROB_ONE - RC_PROB_MIN, idMath::FtoiFast(left * RC_PROB_ONE / (left + right)));
+			}
+		}
+	}
+
+	primed = true;
+}
+
+/*
+================
+idCompressor_RangeCoder::ByteContext
+================
+*/
+ID_INLINE int idCompressor_RangeCoder::ByteContext(int b)
+{
+	if (b == 0) {
+		return 0;
+	}
+
+	return (b < 0x80) ? 1 : 2;
+}
+
+/*
+================
+idCompressor_RangeCoder::Init
+================
+*/
+void idCompressor_RangeCoder::Init(idFile *f, bool compress, int wordLength)
+{
+	this->file = f;
+	this->compress = compress;
+
+	inLength = 0;
+	inPos = 0;
+	outLength = 0;
+	totalBytes = 0;
+	decoding = false;
+}
+
+/*
+================
+idCompressor_RangeCoder::Write
+================
+*/
+int idCompressor_RangeCoder::Write(const void *inData, int inLength)
+{
+	if (compress == false || inLength <= 0) {
+		return 0;
+	}
+
+	if (inLength > (int)sizeof(inBuffer) - this->inLength) {
+		inLength = sizeof(inBuffer) - this->inLength;
+	}
+
+	memcpy(inBuffer + this->inLength, inData, inLength);
+	this->inLength += inLength;
+
+	return inLength;
+}
+
+/*
+================
+idCompressor_RangeCoder::ShiftLow
+================
+*/
+ID_INLINE bool idCompressor_RangeCoder::ShiftLow(byte *out, int &outPos, int maxOut)
+{
+	if ((unsigned int)low < 0xFF000000u || (low >> 32) != 0) {
+		byte temp = cache;
+
+		do {
+			if (outPos >= maxOut) {
+				return false;
+			}
+
+			// the first byte is always zero and is not written
+			if (outPos >= 0) {
+				out[outPos] = (byte)(temp + (byte)(low >> 32));
+			}
+
+			outPos++;
+			temp = 0xFF;
+		} while (--cacheSize != 0);
+
+		cache = (byte)(low >> 24);
+	}
+
+	cacheSize++;
+	low = (low & 0x00FFFFFF) << 8;
+	return true;
+}
+
+/*
+================
+idCompressor_RangeCoder::Encode
+
+  Returns the number of bytes written to out or -1 if the output did not fit.
+================
+*/
+int idCompressor_RangeCoder::Encode(const byte *data, int length, int model, byte *out, int maxOut)
+{
+	int i, j, node, bit, outPos, bits;
+	unsigned int bound;
+	unsigned short *p;
+	uint64_t mask, value;
+
+	memcpy(probs, primedProbs[model], sizeof(probs));
+	prevByte = 0;
+
+	low = 0;
+	range = 0xFFFFFFFF;
+	cache = 0;
+	cacheSize = 1;
+	outPos = -1;
+
+	for (i = 0; i < length; i++) {
+		p = probs[ByteContext(prevByte)];
+		node = 1;
+
+		for (j = 7; j >= 0; j--) {
+			bit = (data[i] >> j) & 1;
+			bound = (range >> RC_PROB_BITS) * p[node];
+
+			if (bit == 0) {
+				range = bound;
+				p[node] += (RC_PROB_ONE - p[node]) >> RC_MOVE_BITS;
+			} else {
+				low += bound;
+				range -= bound;
+				p[node] -= p[node] >> RC_MOVE_BITS;
+			}
+
+			node = (node << 1) | bit;
+
+			while (range < RC_TOP) {
+				range <<= 8;
+
+				if (!ShiftLow(out, outPos, maxOut)) {
+					return -1;
+				}
+			}
+		}
+
+		prevByte = data[i];
+	}
+
+	// use the value within the final range with the most trailing zero bits
+	// so the trailing zero bytes can be left out, the decoder pads with zeros
+	for (bits = 32; bits > 0; bits--) {
+		mask = ((uint64_t)1 << bits) - 1;
+		value = (low + mask) & ~mask;
+
+		if (value < low + range) {
+			low = value;
+			break;
+		}
+	}
+
+	for (i = 0; i < 5; i++) {
+		if (!ShiftLow(out, outPos, maxOut)) {
+			return -1;
+		}
+	}
+
+	while (outPos > 0 && out[outPos - 1] == 0) {
+		outPos--;
+	}
+
+	return outPos;
+}
+
+/*
+================
+idCompressor_RangeCoder::FinishCompress
+================
+*/
+void idCompressor_RangeCoder::FinishCompress(void)
+{
+	int model, bestModel, trialLength, length, bestLength;
+	byte header;
+
+	if (compress == false) {
+		return;
+	}
+
+	// pick the primed model which codes the start of the message best
+	trialLength = Min(inLength, RC_TRIAL_BYTES);
+	bestModel = 0;
+	bestLength = sizeof(outBuffer) + 1;
+
+	for (model = 0; model < RC_NUM_MODELS; model++) {
+		length = Encode(inBuffer, trialLength, model, outBuffer, sizeof(outBuffer));
+
+		if (length >= 0 && length < bestLength) {
+			bestLength = length;
+			bestModel = model;
+		}
+	}
+
+	length = Encode(inBuffer, inLength, bestModel, outBuffer, inLength);
+
+	if (length < 0 || length >= inLength) {
+		header = RC_MODEL_STORED;
+		file->Write(&header, 1);
+		file->Write(inBuffer, inLength);
+		outLength = 1 + inLength;
+	} else {
+		header = bestModel;
+		file->Write(&header, 1);
+		file->Write(outBuffer, length);
+		outLength = 1 + length;
+	}
+
+	totalBytes = inLength;
+	inLength = 0;
+}
+
+/*
+================
+idCompressor_RangeCoder::ReadInputByte
+================
+*/
+ID_INLINE int idCompressor_RangeCoder::ReadInputByte(void)
+{
+	if (inPos >= inLength) {
+		return 0;
+	}
+
+	return inBuffer[inPos++];
+}
+
+/*
+================
+idCompressor_RangeCoder::DecodeByte
+================
+*/
+ID_INLINE int idCompressor_RangeCoder::DecodeByte(void)
+{
+	int j, node;
+	unsigned int bound;
+	unsigned short *p;
+
+	p = probs[ByteContext(prevByte)];
+	node = 1;
+
+	for (j = 0; j < 8; j++) {
+		bound = (range >> RC_PROB_BITS) * p[node];
+
+		if (code < bound) {
+			range = bound;
+			p[node] += (RC_PROB_ONE - p[node]) >> RC_MOVE_BITS;
+			node <<= 1;
+		} else {
+			code -= bound;
+			range -= bound;
+			p[node] -= p[node] >> RC_MOVE_BITS;
+			node = (node << 1) | 1;
+		}
+
+		while (range < RC_TOP) {
+			range <<= 8;
+			code = (code << 8) | ReadInputByte();
+		}
+	}
+
+	prevByte = node & 255;
+	return prevByte;
+}
+
+/*
+================
+idCompressor_RangeCoder::Read
+================
+*/
+int idCompressor_RangeCoder::Read(void *outData, int outLength)
+{
+	int i, model;
+	byte *out;
+
+	if (compress == true || outLength <= 0) {
+		return 0;
+	}
+
+	out = (byte *) outData;
+
+	if (!decoding) {
+		inLength = file->Read(inBuffer, sizeof(inBuffer));
+		inPos = 0;
+		this->outLength = 0;
+		decoding = true;
+
+		if (inLength <= 0) {
+			return 0;
+		}
+
+		model = inBuffer[inPos++];
+
+		if (model == RC_MODEL_STORED) {
+			prevByte = -1;
+		} else if (model < RC_NUM_MODELS) {
+			memcpy(probs, primedProbs[model], sizeof(probs));
+			prevByte = 0;
+			range = 0xFFFFFFFF;
+			code = 0;
+
+			for (i = 0; i < 4; i++) {
+				code = (code << 8) | ReadInputByte();
+			}
+		} else {
+			// corrupt message
+			inLength = 0;
+			return 0;
+		}
+	}
+
+	if (prevByte < 0) {
+		i = Min(outLength, inLength - inPos);
+		memcpy(out, inBuffer + inPos, i);
+		inPos += i;
+	} else if (inLength > 0) {
+		for (i = 0; i < outLength; i++) {
+			out[i] = DecodeByte();
+		}
+	} else {
+		i = 0;
+	}
+
+	this->outLength += i;
+	totalBytes = inPos;
+
+	return i;
+}
+
+/*
+================
+idCompressor_RangeCoder::GetCompressionRatio
+================
+*/
+float idCompressor_RangeCoder::GetCompressionRatio(void) const
+{
+	if (compress) {
+		if (totalBytes <= 0) {
+			return 0.0f;
+		}
+
+		return (totalBytes - outLength) * 100.0f / totalBytes;
+	} else {
+		if (outLength <= 0) {
+			return 0.0f;
+		}
+
+		return (outLength - totalBytes) * 100.0f / outLength;
+	}
+}
+
 /*
 =================================================================================
 
@@ -2800,3 +3317,13 @@ idCompressor *idCompressor::AllocLZW(void)
 {
 	return new idCompressor_LZW();
 }
+
+/*
+================
+idCompressor::AllocRangeCoder
+================
+*/
+idCompressor *idCompressor::AllocRangeCoder(void)
+{
+	return new idCompressor_RangeCoder();
+}
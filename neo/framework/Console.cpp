@@ -233,6 +233,8 @@ SCR_DrawMemoryUsage
 float SCR_DrawMemoryUsage(float y)
 {
 	memoryStats_t allocs, frees;
+	memTagStats_t tagStats;
+	int i;
 
 	Mem_GetStats(allocs);
 	SCR_DrawTextRightAlign(y, "total allocated memory: %4d, %4dkB", allocs.num, allocs.totalSize>>10);
@@ -242,6 +244,13 @@ float SCR_DrawMemoryUsage(float y)
 
 	Mem_ClearFrameStats();
 
+	if (com_showMemoryUsage.GetInteger() > 1) {
+		for (i = 0; i < TAG_NUM_TAGS; i++) {
+			Com_GetMemoryTagStats((memTag_t)i, tagStats);
+			SCR_DrawTextRightAlign(y, "%s: %6dkB  peak: %6dkB", Mem_GetTagName((memTag_t)i), tagStats.current>>10, tagStats.peak>>10);
+		}
+	}
+
 	return y;
 }
 
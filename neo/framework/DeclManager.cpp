@@ -64,6 +64,49 @@ missing reload over a previously explicit definition
 #define USE_COMPRESSED_DECLS
 //#define GET_HUFFMAN_FREQUENCIES
 
+// decl definitions of the decl files cached in the save path, so unchanged files
+// don't need to be read and lexed at startup
+// stored in native byte order, the cache is never shared between machines
+#define DECL_CACHE_FILE			"declcache.dat"
+#define DECL_CACHE_IDENT		(('C'<<24)+('L'<<16)+('C'<<8)+'D')
+#define DECL_CACHE_VERSION		1
+
+// set if the decl text is stored huffman compressed
+#define DECL_CACHE_COMPRESSED	BIT(0)
+
+typedef struct {
+	int						ident;
+	int						version;
+	int						flags;
+	int						numFiles;
+} declCacheHeader_t;
+
+// each file record is followed by the file name and the decl records,
+// each decl record by the decl name and the stored decl text, all padded to 4 bytes
+typedef struct {
+	int						recordLength;			// including this header
+	int						nameLength;
+	int						fileSize;				// size and time of the file when it was lexed
+	int						timestamp;
+	int						checksum;
+	int						numLines;
+	int						defaultType;
+	int						numDeclTypes;			// decl types registered when it was lexed
+	int						numDecls;
+} declCacheFile_t;
+
+typedef struct {
+	int						recordLength;
+	int						type;
+	int						nameLength;
+	int						sourceTextOffset;
+	int						sourceTextLength;
+	int						sourceLine;
+	int						checksum;
+	int						textLength;
+	int						compressedLength;		// length of the stored text
+} declCacheDecl_t;
+
 class idDeclType
 {
 	public:
@@ -82,6 +125,43 @@ class idDeclFolder
 
 class idDeclFile;
 
+// the decl files of a folder are read on the main thread and scanned for their decls
+// by the job threads, the decls are then defined on the main thread in file order.
+// the scanner can't use idLexer because idStr's string allocator isn't thread safe,
+// decl_verifyScan checks it against the lexer.
+// only the scanning is threaded.  parsing the decls referenced by a map on worker
+// threads is left to a separate change: a parse looks up and parses the decls it
+// references, and materials and sound shaders load images and samples, so it needs
+// thread safe decl hash tables, implicit decl creation and media managers first.
+// until then FindType, CreateNewDecl and Parse() are main thread only.
+typedef struct {
+	int						type;
+	int						nameOffset;				// name token in the file, without quotes
+	int						nameLength;
+	int						sourceTextOffset;
+	int						sourceTextLength;
+	int						sourceLine;
+	int						checksum;				// checksum of the decl text
+	int						storedOffset;			// the decl text as it will be stored
+	int						storedLength;
+} declSpan_t;
+
+typedef struct {
+	idDeclFile 				*file;
+	const declCacheFile_t	*cacheRecord;			// set if the decls come from the decl cache instead
+	ID_TIME_T				timestamp;
+	char 					*buffer;
+	int						length;
+	declSpan_t 				*spans;
+	int						maxSpans;
+	int						numSpans;
+	byte 					*stored;
+	int						maxStored;
+	int						checksum;
+	int						numLines;
+	bool					scanned;				// false if the file has to go through the lexer
+} declScan_t;
+
 class idDeclLocal : public idDeclBase
 {
 		friend class idDeclFile;
@@ -132,6 +212,9 @@ class idDeclLocal : public idDeclBase
 		// Set textSource possible with compression.
 		void						SetTextLocal(const char *text, const int length);
 
+		// Set textSource from a copy stored in the decl cache.
+		void						SetStoredTextLocal(const char *stored, const int storedLength, const int length, const int textChecksum);
+
 	private:
 		idDecl 					*self;
 
@@ -165,6 +248,21 @@ class idDeclFile
 		void						Reload(bool force);
 		int							LoadAndParse();
 
+		// LoadAndParse split up, so the files of a folder can be scanned by the job threads
+		void						StartLoad(declScan_t &scan);
+		static void					ScanJob(void *parms);
+		void						FinishLoad(declScan_t &scan);
+
+	private:
+		void						ParseFromCache(const declCacheFile_t *record, ID_TIME_T fileTimestamp);
+		void						ParseScan(const declScan_t &scan);
+		void						ParseText(const declScan_t &scan);
+		bool						VerifyScan(const declScan_t &scan);
+		void						BeginText(const declScan_t &scan);
+		idDeclLocal 				*DefineDecl(declType_t type, const char *name, int sourceTextOffset, int sourceTextLength,
+		        int sourceLine, bool &reparse);
+		void						AddCacheDecl(const idDeclLocal *decl);
+
 	public:
 		idStr						fileName;
 		declType_t					defaultType;
@@ -175,6 +273,13 @@ class idDeclFile
 		int							numLines;
 
 		idDeclLocal 				*decls;
+
+		// kept for the decl cache until it is written
+		const declCacheFile_t		*cacheRecord;			// the record the decls were loaded from
+		idFile_Memory				*cacheDecls;			// or the decl records made while lexing
+		int							numCacheDecls;
+		int							cacheDeclTypes;			// decl types registered when it was lexed
+		bool						cacheable;				// false if some decls were skipped as redefinitions
 };
 
 class idDeclManagerLocal : public idDeclManager
@@ -223,6 +328,17 @@ class idDeclManagerLocal : public idDeclManager
 		static void					MakeNameCanonical(const char *name, char *result, int maxLength);
 		idDeclLocal 				*FindTypeWithoutParsing(declType_t type, const char *name, bool makeDefault = true);
 
+		bool						DeclCacheActive(void) const {
+			return declCacheActive;
+		}
+		bool						VerifyDeclScans(void) const {
+			return decl_verifyScan.GetBool();
+		}
+		const declCacheFile_t		*FindDeclCacheFile(const char *fileName, int fileSize, ID_TIME_T timestamp, declType_t defaultType) const;
+		void						SetDeclCacheDirty(void) {
+			declCacheDirty = true;
+		}
+
 		idDeclType 				*GetDeclType(int type) const {
 			return declTypes[type];
 		}
@@ -244,14 +360,31 @@ class idDeclManagerLocal : public idDeclManager
 		int							indent;			// for MediaPrint
 		bool						insideLevelLoad;
 
+		byte 						*declCache;		// the whole cache file, until WriteDeclCache
+		int							declCacheLength;
+		idHashIndex					declCacheHash;
+		idList<int>					declCacheOffsets;
+		bool						declCacheActive;
+		bool						declCacheDirty;
+
 		static idCVar				decl_show;
+		static idCVar				decl_cache;
+		static idCVar				decl_parallelScan;
+		static idCVar				decl_verifyScan;
 
 	private:
 		static void					ListDecls_f(const idCmdArgs &args);
 		static void					ReloadDecls_f(const idCmdArgs &args);
 		static void					TouchDecl_f(const idCmdArgs &args);
+
+		void						LoadDeclCache(void);
+		void						WriteDeclCache(void);
+		void						FreeDeclCache(void);
 };
 
+idCVar idDeclManagerLocal::decl_cache("decl_cache", "1", CVAR_SYSTEM | CVAR_INIT | CVAR_BOOL, "cache the decl definitions of unchanged files in " DECL_CACHE_FILE " to speed up startup");
+idCVar idDeclManagerLocal::decl_parallelScan("decl_parallelScan", "1", CVAR_SYSTEM | CVAR_BOOL, "scan the decl files of a folder for their decls on the job threads");
+idCVar idDeclManagerLocal::decl_verifyScan("decl_verifyScan", "0", CVAR_SYSTEM | CVAR_BOOL, "lex the decl files again after scanning them and warn if the decls found differ");
 idCVar idDeclManagerLocal::decl_show("decl_show", "0", CVAR_SYSTEM, "set to 1 to print parses, 2 to also print references", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2>);
 
 idDeclManagerLocal	declManagerLocal;
@@ -485,16 +618,16 @@ void ShutdownHuffman(void)
 
 /*
 ================
-HuffmanCompressText
+HuffmanEncodeText
+
+Doesn't touch the compression statistics, so the job threads can use it.
 ================
 */
-int HuffmanCompressText(const char *text, int textLength, byte *compressed, int maxCompressedSize)
+static int HuffmanEncodeText(const char *text, int textLength, byte *compressed, int maxCompressedSize)
 {
 	int i, j;
 	idBitMsg msg;
 
-	totalUncompressedLength += textLength;
-
 	msg.Init(compressed, maxCompressedSize);
 	msg.BeginWriting();
 
@@ -510,11 +643,26 @@ int HuffmanCompressText(const char *text, int textLength, byte *compressed, int
 		}
 	}
 
-	totalCompressedLength += msg.GetSize();
-
 	return msg.GetSize();
 }
 
+/*
+================
+HuffmanCompressText
+================
+*/
+int HuffmanCompressText(const char *text, int textLength, byte *compressed, int maxCompressedSize)
+{
+	int compressedSize;
+
+	compressedSize = HuffmanEncodeText(text, textLength, compressed, maxCompressedSize);
+
+	totalUncompressedLength += textLength;
+	totalCompressedLength += compressedSize;
+
+	return compressedSize;
+}
+
 /*
 ================
 HuffmanDecompressText
@@ -591,6 +739,11 @@ idDeclFile::idDeclFile(const char *fileName, declType_t defaultType)
 	this->fileSize = 0;
 	this->numLines = 0;
 	this->decls = NULL;
+	this->cacheRecord = NULL;
+	this->cacheDecls = NULL;
+	this->numCacheDecls = 0;
+	this->cacheDeclTypes = 0;
+	this->cacheable = false;
 }
 
 /*
@@ -607,6 +760,11 @@ idDeclFile::idDeclFile()
 	this->fileSize = 0;
 	this->numLines = 0;
 	this->decls = NULL;
+	this->cacheRecord = NULL;
+	this->cacheDecls = NULL;
+	this->numCacheDecls = 0;
+	this->cacheDeclTypes = 0;
+	this->cacheable = false;
 }
 
 /*
@@ -643,42 +801,633 @@ int c_savedMemory = 0;
 
 int idDeclFile::LoadAndParse()
 {
-	int			i, numTypes;
-	idLexer		src;
-	idToken		token;
-	int			startMarker;
-	char 		*buffer;
-	int			length, size;
-	int			sourceLine;
-	idStr		name;
-	idDeclLocal *newDecl;
-	bool		reparse;
+	declScan_t	scan;
+
+	StartLoad(scan);
+	ScanJob(&scan);
+	FinishLoad(scan);
+
+	return checksum;
+}
+
+/*
+================
+idDeclFile::StartLoad
+
+Reads the file for ScanJob, unless its decls can come from the decl cache.
+================
+*/
+void idDeclFile::StartLoad(declScan_t &scan)
+{
+	int i;
+
+	memset(&scan, 0, sizeof(scan));
+	scan.file = this;
+
+	// an unchanged file gets its decls from the decl cache, without being read
+	if (declManagerLocal.DeclCacheActive()) {
+		scan.length = fileSystem->ReadFile(fileName, NULL, &scan.timestamp);
+		scan.cacheRecord = declManagerLocal.FindDeclCacheFile(fileName, scan.length, scan.timestamp, defaultType);
+
+		if (scan.cacheRecord) {
+			common->DPrintf("...loading '%s' from the decl cache\n", fileName.c_str());
+			return;
+		}
+	}
 
 	// load the text
 	common->DPrintf("...loading '%s'\n", fileName.c_str());
-	length = fileSystem->ReadFile(fileName, (void **)&buffer, &timestamp);
+	scan.length = fileSystem->ReadFile(fileName, (void **)&scan.buffer, &scan.timestamp);
 
-	if (length == -1) {
+	if (scan.length == -1) {
 		common->FatalError("couldn't load %s", fileName.c_str());
-		return 0;
+		return;
 	}
 
-	if (!src.LoadMemory(buffer, length, fileName)) {
-		common->Error("Couldn't parse %s", fileName.c_str());
-		Mem_Free(buffer);
-		return 0;
+	// every decl has an opening brace
+	for (i = 0; i < scan.length; i++) {
+		if (scan.buffer[i] == '{') {
+			scan.maxSpans++;
+		}
+	}
+
+	scan.spans = (declSpan_t *)Mem_Alloc(scan.maxSpans * sizeof(declSpan_t), TAG_DECL);
+
+#ifdef USE_COMPRESSED_DECLS
+	int maxBytesPerCode = (maxHuffmanBits + 7) >> 3;
+	scan.maxStored = scan.length * maxBytesPerCode;
+	scan.stored = (byte *)Mem_Alloc(scan.maxStored, TAG_DECL);
+#endif
+}
+
+/*
+================
+DeclScanWhiteSpace
+
+Skips white space and comments like idLexer::ReadWhiteSpace, the same quirks
+included.  Returns 0 at the end of the text, and -1 if the lexer would warn.
+================
+*/
+static int DeclScanWhiteSpace(const char *&p, int &line)
+{
+	while (1) {
+		while (*p <= ' ') {
+			if (!*p) {
+				return 0;
+			}
+
+			if (*p == '\n') {
+				line++;
+			}
+
+			p++;
+		}
+
+		if (p[0] != '/') {
+			break;
+		}
+
+		// comments //
+		if (p[1] == '/') {
+			p += 2;
+
+			while (*p != '\n') {
+				if (!*p) {
+					return 0;
+				}
+
+				p++;
+			}
+
+			line++;
+			p++;
+			continue;
+		}
+
+		// comments /* */
+		if (p[1] == '*') {
+			p++;
+
+			while (1) {
+				p++;
+
+				if (!*p) {
+					return 0;
+				}
+
+				if (*p == '\n') {
+					line++;
+				} else if (*p == '/') {
+					if (p[-1] == '*') {
+						break;
+					}
+
+					if (p[1] == '*') {
+						// nested comment
+						return -1;
+					}
+				}
+			}
+
+			// the lexer steps over one more character after the comment
+			p++;
+
+			if (!*p) {
+				return 0;
+			}
+
+			p++;
+			continue;
+		}
+
+		break;
 	}
 
+	return 1;
+}
+
+/*
+================
+DeclScanNumber
+
+Steps over a number like idLexer::ReadNumber, returns false if the lexer would
+error out on it.
+================
+*/
+static bool DeclScanNumber(const char *&p)
+{
+	int		i, dots;
+	bool	isFloat;
+
+	isFloat = false;
+
+	if (p[0] == '0' && p[1] != '.') {
+		if (p[1] == 'x' || p[1] == 'X') {
+			for (p += 2; (*p >= '0' && *p <= '9') || (*p >= 'a' && *p <= 'f') || (*p >= 'A' && *p <= 'F'); p++) {
+			}
+		} else if (p[1] == 'b' || p[1] == 'B') {
+			for (p += 2; *p == '0' || *p == '1'; p++) {
+			}
+		} else {
+			for (p++; *p >= '0' && *p <= '7'; p++) {
+			}
+		}
+	} else {
+		dots = 0;
+
+		for (; (*p >= '0' && *p <= '9') || *p == '.'; p++) {
+			if (*p == '.') {
+				dots++;
+			}
+		}
+
+		if (*p == 'e' && dots == 0) {
+			dots++;
+		}
+
+		if (dots > 1) {
+			return false;
+		}
+
+		if (dots == 1) {
+			isFloat = true;
+
+			if (*p == 'e') {
+				p++;
+
+				if (*p == '-' || *p == '+') {
+					p++;
+				}
+
+				for (; *p >= '0' && *p <= '9'; p++) {
+				}
+			} else if (*p == '#') {
+				return false;
+			}
+		}
+	}
+
+	// precision and sign suffixes aren't part of the token, but are skipped
+	if (isFloat) {
+		if (*p == 'f' || *p == 'F' || *p == 'l' || *p == 'L') {
+			p++;
+		}
+	} else {
+		for (i = 0; i < 2 && (*p == 'l' || *p == 'L' || *p == 'u' || *p == 'U'); i++) {
+			p++;
+		}
+	}
+
+	return true;
+}
+
+/*
+================
+DeclScanToken
+
+Finds the next token the way idLexer::ReadToken does with DECL_LEXER_FLAGS,
+without copying it out.  Returns false at the end of the text, the type is
+0 if the lexer would warn or error out.
+================
+*/
+static bool DeclScanToken(const char *&p, int &line, const char *&start, const char *&end, int &type)
+{
+	const char	*next;
+	int			nextLine, result;
+	char		c;
+
+	type = 0;
+
+	result = DeclScanWhiteSpace(p, line);
+
+	if (result <= 0) {
+		return (result < 0);
+	}
+
+	start = p;
+	c = *p;
+
+	if ((c >= '0' && c <= '9') || (c == '.' && p[1] >= '0' && p[1] <= '9')) {
+		if (!DeclScanNumber(p)) {
+			return true;
+		}
+
+		end = p;
+		type = TT_NUMBER;
+	} else if (c == '\"' || c == '\'') {
+		for (p++; *p != c; p++) {
+			if (!*p || *p == '\n') {
+				return true;
+			}
+		}
+
+		start++;
+		end = p;
+		p++;
+
+		// a string followed by a '\' is concatenated with the next one
+		if (c == '\"') {
+			next = p;
+			nextLine = line;
+			result = DeclScanWhiteSpace(next, nextLine);
+
+			if (result < 0 || (result > 0 && *next == '\\')) {
+				return true;
+			}
+		}
+
+		type = (c == '\"') ? TT_STRING : TT_LITERAL;
+	} else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == '/' || c == '\\' || c == '.') {
+		do {
+			c = *(++p);
+		} while ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+		         c == '_' || c == '/' || c == '\\' || c == ':' || c == '.');
+
+		end = p;
+		type = TT_NAME;
+	} else if (strchr("!#$%&()*+,-:;<=>?[]^|~{}", c)) {
+		// none of the multi character punctuations matter for finding the decls
+		end = ++p;
+		type = TT_PUNCTUATION;
+	}
+
+	return true;
+}
+
+/*
+================
+idDeclFile::ScanJob
+
+Finds the decls in a file read by StartLoad, and checksums and compresses
+their text.  This runs on the job threads, so it only reads the decl types
+and writes to the buffers allocated for it.  A file with anything the
+lexer would warn about is left to the lexer in FinishLoad.
+================
+*/
+void idDeclFile::ScanJob(void *parms)
+{
+	declScan_t	*scan = (declScan_t *)parms;
+	const char	*p, *start, *end, *nameStart, *nameEnd;
+	declSpan_t	*span;
+	declType_t	type;
+	int			i, numTypes, tokenType, line, startMarker, sourceLine, depth, storedLength;
+
+	if (!scan->buffer) {
+		return;
+	}
+
+	scan->checksum = MD5_BlockChecksum(scan->buffer, scan->length);
+
+#ifdef GET_HUFFMAN_FREQUENCIES
+	// the frequencies are counted as the lexer sets the decl text
+	return;
+#endif
+
+	numTypes = declManagerLocal.GetNumDeclTypes();
+
+	p = scan->buffer;
+	line = 1;
+	storedLength = 0;
+
+	while (1) {
+
+		startMarker = p - scan->buffer;
+		sourceLine = line;
+
+		// the decl type name
+		if (!DeclScanToken(p, line, start, end, tokenType)) {
+			break;
+		}
+
+		if (!tokenType || tokenType == TT_PUNCTUATION) {
+			return;
+		}
+
+		type = DECL_MAX_TYPES;
+
+		for (i = 0; i < numTypes; i++) {
+			idDeclType *typeInfo = declManagerLocal.GetDeclType(i);
+
+			if (typeInfo && typeInfo->typeName.Length() == end - start && idStr::Icmpn(typeInfo->typeName, start, end - start) == 0) {
+				type = typeInfo->type;
+				break;
+			}
+		}
+
+		// without a type name it's the name of a decl of the default type
+		if (type == DECL_MAX_TYPES) {
+			if (scan->file->defaultType == DECL_MAX_TYPES) {
+				return;
+			}
+
+			type = scan->file->defaultType;
+		} else if (!DeclScanToken(p, line, start, end, tokenType)) {
+			return;
+		}
+
+		// the lexer skips export decls, and takes numbers as names with their suffixes stripped
+		if (type == DECL_MODELEXPORT || (tokenType != TT_NAME && tokenType != TT_STRING && tokenType != TT_LITERAL)) {
+			return;
+		}
+
+		nameStart = start;
+		nameEnd = end;
+
+		// make sure there's a '{'
+		if (!DeclScanToken(p, line, start, end, tokenType) || tokenType != TT_PUNCTUATION || *start != '{') {
+			return;
+		}
+
+		// now take everything until a matched closing brace
+		for (depth = 1; depth > 0;) {
+			if (!DeclScanToken(p, line, start, end, tokenType) || !tokenType) {
+				return;
+			}
+
+			if (tokenType == TT_PUNCTUATION) {
+				if (*start == '{') {
+					depth++;
+				} else if (*start == '}') {
+					depth--;
+				}
+			}
+		}
+
+		if (scan->numSpans >= scan->maxSpans) {
+			return;
+		}
+
+		span = &scan->spans[scan->numSpans++];
+		span->type = type;
+		span->nameOffset = nameStart - scan->buffer;
+		span->nameLength = nameEnd - nameStart;
+		span->sourceTextOffset = startMarker;
+		span->sourceTextLength = (p - scan->buffer) - startMarker;
+		span->sourceLine = sourceLine;
+		span->checksum = MD5_BlockChecksum(scan->buffer + startMarker, span->sourceTextLength);
+
+#ifdef USE_COMPRESSED_DECLS
+		span->storedOffset = storedLength;
+		span->storedLength = HuffmanEncodeText(scan->buffer + startMarker, span->sourceTextLength,
+		                                       scan->stored + storedLength, scan->maxStored - storedLength);
+		storedLength += span->storedLength;
+#else
+		span->storedOffset = startMarker;
+		span->storedLength = span->sourceTextLength;
+#endif
+	}
+
+	scan->numLines = line;
+	scan->scanned = true;
+}
+
+/*
+================
+idDeclFile::FinishLoad
+
+Defines the decls found by ScanJob, or lexes the file if the scan gave up.
+================
+*/
+void idDeclFile::FinishLoad(declScan_t &scan)
+{
 	// mark all the defs that were from the last reload of this file
 	for (idDeclLocal *decl = decls; decl; decl = decl->nextInFile) {
 		decl->redefinedInReload = false;
 	}
 
-	src.SetFlags(DECL_LEXER_FLAGS);
+	if (scan.cacheRecord) {
+		ParseFromCache(scan.cacheRecord, scan.timestamp);
+	} else {
+		timestamp = scan.timestamp;
+
+		// a scan that doesn't match the lexer is thrown away
+		if (scan.scanned && declManagerLocal.VerifyDeclScans() && !VerifyScan(scan)) {
+			scan.scanned = false;
+		}
+
+		if (scan.scanned) {
+			ParseScan(scan);
+		} else {
+			ParseText(scan);
+		}
+
+		Mem_Free(scan.buffer);
+		Mem_Free(scan.spans);
+		Mem_Free(scan.stored);
+		scan.buffer = NULL;
+		scan.spans = NULL;
+		scan.stored = NULL;
+	}
+
+	// any defs that weren't redefinedInReload should now be defaulted
+	for (idDeclLocal *decl = decls ; decl ; decl = decl->nextInFile) {
+		if (decl->redefinedInReload == false) {
+			decl->MakeDefault();
+			decl->sourceTextOffset = decl->sourceFile->fileSize;
+			decl->sourceTextLength = 0;
+			decl->sourceLine = decl->sourceFile->numLines;
+		}
+	}
+}
+
+/*
+================
+idDeclFile::ParseFromCache
+
+Defines the decls saved in the decl cache for a file that hasn't changed
+since it was lexed.
+================
+*/
+void idDeclFile::ParseFromCache(const declCacheFile_t *record, ID_TIME_T fileTimestamp)
+{
+	const declCacheDecl_t	*cacheDecl;
+	const char				*name;
+	int						i, offset;
+	idDeclLocal				*newDecl;
+	bool					reparse;
+
+	timestamp = fileTimestamp;
+	fileSize = record->fileSize;
+	checksum = record->checksum;
+	numLines = record->numLines;
+
+	delete cacheDecls;
+	cacheDecls = NULL;
+	cacheRecord = record;
+
+	offset = sizeof(declCacheFile_t) + ((record->nameLength + 1 + 3) & ~3);
+
+	for (i = 0; i < record->numDecls; i++) {
+		cacheDecl = (const declCacheDecl_t *)((const byte *)record + offset);
+		name = (const char *)(cacheDecl + 1);
+		offset += cacheDecl->recordLength;
+
+		newDecl = DefineDecl((declType_t)cacheDecl->type, name, cacheDecl->sourceTextOffset, cacheDecl->sourceTextLength,
+		                     cacheDecl->sourceLine, reparse);
+
+		if (!newDecl) {
+			continue;
+		}
+
+		newDecl->SetStoredTextLocal(name + ((cacheDecl->nameLength + 1 + 3) & ~3), cacheDecl->compressedLength,
+		                            cacheDecl->textLength, cacheDecl->checksum);
+
+		// if it is currently in use, reparse it immedaitely
+		if (reparse) {
+			newDecl->ParseLocal();
+		}
+	}
+}
+
+/*
+================
+idDeclFile::BeginText
+================
+*/
+void idDeclFile::BeginText(const declScan_t &scan)
+{
+	// the decls are recorded for the decl cache as they are defined
+	cacheRecord = NULL;
+	delete cacheDecls;
+	cacheDecls = NULL;
+	numCacheDecls = 0;
+	cacheDeclTypes = declManagerLocal.GetNumDeclTypes();
+	cacheable = true;
+
+	if (declManagerLocal.DeclCacheActive()) {
+		cacheDecls = new idFile_Memory(fileName);
+		declManagerLocal.SetDeclCacheDirty();
+	}
+
+	checksum = scan.checksum;
+
+	fileSize = scan.length;
+}
+
+/*
+================
+idDeclFile::ParseScan
+
+Defines the decls found by ScanJob, in the order they appear in the file.
+================
+*/
+void idDeclFile::ParseScan(const declScan_t &scan)
+{
+	const declSpan_t	*span;
+	const char			*stored;
+	idStr				name;
+	idDeclLocal			*newDecl;
+	bool				reparse;
+	int					i;
+
+	BeginText(scan);
+
+#ifdef USE_COMPRESSED_DECLS
+	stored = (const char *)scan.stored;
+#else
+	stored = scan.buffer;
+#endif
+
+	for (i = 0; i < scan.numSpans; i++) {
+		span = &scan.spans[i];
+
+		name.Empty();
+		name.Append(scan.buffer + span->nameOffset, span->nameLength);
+
+		newDecl = DefineDecl((declType_t)span->type, name, span->sourceTextOffset, span->sourceTextLength,
+		                     span->sourceLine, reparse);
+
+		if (!newDecl) {
+			// which decl wins depends on the other files, so this file can't be cached
+			cacheable = false;
+			continue;
+		}
+
+		newDecl->SetStoredTextLocal(stored + span->storedOffset, span->storedLength, span->sourceTextLength, span->checksum);
+
+#ifdef USE_COMPRESSED_DECLS
+		totalUncompressedLength += span->sourceTextLength;
+		totalCompressedLength += span->storedLength;
+#endif
+
+		AddCacheDecl(newDecl);
+
+		// if it is currently in use, reparse it immedaitely
+		if (reparse) {
+			newDecl->ParseLocal();
+		}
+	}
+
+	numLines = scan.numLines;
+}
+
+/*
+================
+idDeclFile::ParseText
+
+Lexes the file, identifying each individual declaration
+================
+*/
+void idDeclFile::ParseText(const declScan_t &scan)
+{
+	int			i, numTypes;
+	idLexer		src;
+	idToken		token;
+	int			startMarker;
+	int			size;
+	int			sourceLine;
+	idStr		name;
+	idDeclLocal *newDecl;
+	bool		reparse;
+
+	if (!src.LoadMemory(scan.buffer, scan.length, fileName)) {
+		common->Error("Couldn't parse %s", fileName.c_str());
+		return;
+	}
 
-	checksum = MD5_BlockChecksum(buffer, length);
+	BeginText(scan);
 
-	fileSize = length;
+	src.SetFlags(DECL_LEXER_FLAGS);
 
 	// scan through, identifying each individual declaration
 	while (1) {
@@ -693,8 +1442,135 @@ int idDeclFile::LoadAndParse()
 
 		declType_t identifiedType = DECL_MAX_TYPES;
 
-		// get the decl type from the type name
-		numTypes = declManagerLocal.GetNumDeclTypes();
+		// get the decl type from the type name
+		numTypes = declManagerLocal.GetNumDeclTypes();
+
+		for (i = 0; i < numTypes; i++) {
+			idDeclType *typeInfo = declManagerLocal.GetDeclType(i);
+
+			if (typeInfo && typeInfo->typeName.Icmp(token) == 0) {
+				identifiedType = (declType_t) typeInfo->type;
+				break;
+			}
+		}
+
+		if (i >= numTypes) {
+
+			if (token.Icmp("{") == 0) {
+
+				// if we ever see an open brace, we somehow missed the [type] <name> prefix
+				src.Warning("Missing decl name");
+				src.SkipBracedSection(false);
+				continue;
+
+			} else {
+
+				if (defaultType == DECL_MAX_TYPES) {
+					src.Warning("No type");
+					continue;
+				}
+
+				src.UnreadToken(&token);
+				// use the default type
+				identifiedType = defaultType;
+			}
+		}
+
+		// now parse the name
+		if (!src.ReadToken(&token)) {
+			src.Warning("Type without definition at end of file");
+			break;
+		}
+
+		if (!token.Icmp("{")) {
+			// if we ever see an open brace, we somehow missed the [type] <name> prefix
+			src.Warning("Missing decl name");
+			src.SkipBracedSection(false);
+			continue;
+		}
+
+		// FIXME: export decls are only used by the model exporter, they are skipped here for now
+		if (identifiedType == DECL_MODELEXPORT) {
+			src.SkipBracedSection();
+			continue;
+		}
+
+		name = token;
+
+		// make sure there's a '{'
+		if (!src.ReadToken(&token)) {
+			src.Warning("Type without definition at end of file");
+			break;
+		}
+
+		if (token != "{") {
+			src.Warning("Expecting '{' but found '%s'", token.c_str());
+			continue;
+		}
+
+		src.UnreadToken(&token);
+
+		// now take everything until a matched closing brace
+		src.SkipBracedSection();
+		size = src.GetFileOffset() - startMarker;
+
+		newDecl = DefineDecl(identifiedType, name, startMarker, size, sourceLine, reparse);
+
+		if (!newDecl) {
+			// which decl wins depends on the other files, so this file can't be cached
+			cacheable = false;
+			continue;
+		}
+
+		newDecl->SetTextLocal(scan.buffer + startMarker, size);
+
+		AddCacheDecl(newDecl);
+
+		// if it is currently in use, reparse it immedaitely
+		if (reparse) {
+			newDecl->ParseLocal();
+		}
+	}
+
+	numLines = src.GetLineNum();
+}
+
+/*
+================
+idDeclFile::VerifyScan
+
+Finds the decls with idLexer the way ParseText does, and compares them with
+the spans ScanJob found.  Only a file the lexer doesn't warn about is
+scanned, so any warning is a difference as well.
+================
+*/
+bool idDeclFile::VerifyScan(const declScan_t &scan)
+{
+	int					i, numTypes, numSpans, startMarker, sourceLine, size;
+	idLexer				src;
+	idToken				token, name;
+	declType_t			identifiedType;
+	const declSpan_t	*span;
+
+	if (!src.LoadMemory(scan.buffer, scan.length, fileName)) {
+		return false;
+	}
+
+	src.SetFlags(DECL_LEXER_FLAGS | LEXFL_NOWARNINGS | LEXFL_NOERRORS | LEXFL_NOFATALERRORS);
+
+	numTypes = declManagerLocal.GetNumDeclTypes();
+	numSpans = 0;
+
+	while (1) {
+
+		startMarker = src.GetFileOffset();
+		sourceLine = src.GetLineNum();
+
+		if (!src.ReadToken(&token)) {
+			break;
+		}
+
+		identifiedType = DECL_MAX_TYPES;
 
 		for (i = 0; i < numTypes; i++) {
 			idDeclType *typeInfo = declManagerLocal.GetDeclType(i);
@@ -706,122 +1582,140 @@ int idDeclFile::LoadAndParse()
 		}
 
 		if (i >= numTypes) {
-
-			if (token.Icmp("{") == 0) {
-
-				// if we ever see an open brace, we somehow missed the [type] <name> prefix
-				src.Warning("Missing decl name");
-				src.SkipBracedSection(false);
-				continue;
-
-			} else {
-
-				if (defaultType == DECL_MAX_TYPES) {
-					src.Warning("No type");
-					continue;
-				}
-
-				src.UnreadToken(&token);
-				// use the default type
-				identifiedType = defaultType;
+			if (token == "{" || defaultType == DECL_MAX_TYPES) {
+				common->Warning("decl_verifyScan: %s, line %d: scan missed a lexer warning", fileName.c_str(), sourceLine);
+				return false;
 			}
-		}
 
-		// now parse the name
-		if (!src.ReadToken(&token)) {
-			src.Warning("Type without definition at end of file");
-			break;
+			src.UnreadToken(&token);
+			identifiedType = defaultType;
 		}
 
-		if (!token.Icmp("{")) {
-			// if we ever see an open brace, we somehow missed the [type] <name> prefix
-			src.Warning("Missing decl name");
-			src.SkipBracedSection(false);
-			continue;
+		if (!src.ReadToken(&name) || name == "{" || identifiedType == DECL_MODELEXPORT ||
+		    !src.ReadToken(&token) || token != "{") {
+			common->Warning("decl_verifyScan: %s, line %d: scan missed a lexer warning", fileName.c_str(), sourceLine);
+			return false;
 		}
 
-		// FIXME: export decls are only used by the model exporter, they are skipped here for now
-		if (identifiedType == DECL_MODELEXPORT) {
-			src.SkipBracedSection();
-			continue;
+		src.UnreadToken(&token);
+
+		if (!src.SkipBracedSection() || src.HadError()) {
+			common->Warning("decl_verifyScan: %s, line %d: scan missed a lexer warning", fileName.c_str(), sourceLine);
+			return false;
 		}
 
-		name = token;
+		size = src.GetFileOffset() - startMarker;
 
-		// make sure there's a '{'
-		if (!src.ReadToken(&token)) {
-			src.Warning("Type without definition at end of file");
-			break;
+		if (numSpans >= scan.numSpans) {
+			common->Warning("decl_verifyScan: %s, line %d: scan missed decl '%s'", fileName.c_str(), sourceLine, name.c_str());
+			return false;
 		}
 
-		if (token != "{") {
-			src.Warning("Expecting '{' but found '%s'", token.c_str());
-			continue;
+		span = &scan.spans[numSpans++];
+
+		if (span->type != identifiedType || span->sourceTextOffset != startMarker || span->sourceTextLength != size ||
+		    span->sourceLine != sourceLine || name.Length() != span->nameLength ||
+		    idStr::Cmpn(name, scan.buffer + span->nameOffset, span->nameLength) != 0) {
+			common->Warning("decl_verifyScan: %s, line %d: scan found a different decl than '%s'", fileName.c_str(), sourceLine, name.c_str());
+			return false;
 		}
+	}
 
-		src.UnreadToken(&token);
+	if (numSpans != scan.numSpans || src.GetLineNum() != scan.numLines) {
+		common->Warning("decl_verifyScan: %s: scan found %d decls and %d lines, the lexer %d decls and %d lines",
+		                fileName.c_str(), scan.numSpans, scan.numLines, numSpans, src.GetLineNum());
+		return false;
+	}
 
-		// now take everything until a matched closing brace
-		src.SkipBracedSection();
-		size = src.GetFileOffset() - startMarker;
+	return true;
+}
 
-		// look it up, possibly getting a newly created default decl
-		reparse = false;
-		newDecl = declManagerLocal.FindTypeWithoutParsing(identifiedType, name, false);
+/*
+================
+idDeclFile::DefineDecl
 
-		if (newDecl) {
-			// update the existing copy
-			if (newDecl->sourceFile != this || newDecl->redefinedInReload) {
-				src.Warning("%s '%s' previously defined at %s:%i", declManagerLocal.GetDeclNameFromType(identifiedType),
-				            name.c_str(), newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine);
-				continue;
-			}
+Looks up the decl, possibly getting a newly created default decl, and sets
+its source in this file.  Returns NULL if it was already defined in another
+file or earlier in this one.
+================
+*/
+idDeclLocal *idDeclFile::DefineDecl(declType_t type, const char *name, int sourceTextOffset, int sourceTextLength,
+                                    int sourceLine, bool &reparse)
+{
+	idDeclLocal *newDecl;
 
-			if (newDecl->declState != DS_UNPARSED) {
-				reparse = true;
-			}
-		} else {
-			// allow it to be created as a default, then add it to the per-file list
-			newDecl = declManagerLocal.FindTypeWithoutParsing(identifiedType, name, true);
-			newDecl->nextInFile = this->decls;
-			this->decls = newDecl;
-		}
+	reparse = false;
+	newDecl = declManagerLocal.FindTypeWithoutParsing(type, name, false);
 
-		newDecl->redefinedInReload = true;
+	if (newDecl) {
+		// update the existing copy
+		if (newDecl->sourceFile != this || newDecl->redefinedInReload) {
+			common->Warning("file %s, line %d: %s '%s' previously defined at %s:%i", fileName.c_str(), sourceLine,
+			                declManagerLocal.GetDeclNameFromType(type), name, newDecl->sourceFile->fileName.c_str(), newDecl->sourceLine);
+			return NULL;
+		}
 
-		if (newDecl->textSource) {
-			Mem_Free(newDecl->textSource);
-			newDecl->textSource = NULL;
+		if (newDecl->declState != DS_UNPARSED) {
+			reparse = true;
 		}
+	} else {
+		// allow it to be created as a default, then add it to the per-file list
+		newDecl = declManagerLocal.FindTypeWithoutParsing(type, name, true);
+		newDecl->nextInFile = this->decls;
+		this->decls = newDecl;
+	}
 
-		newDecl->SetTextLocal(buffer + startMarker, size);
-		newDecl->sourceFile = this;
-		newDecl->sourceTextOffset = startMarker;
-		newDecl->sourceTextLength = size;
-		newDecl->sourceLine = sourceLine;
-		newDecl->declState = DS_UNPARSED;
+	newDecl->redefinedInReload = true;
 
-		// if it is currently in use, reparse it immedaitely
-		if (reparse) {
-			newDecl->ParseLocal();
-		}
+	if (newDecl->textSource) {
+		Mem_Free(newDecl->textSource);
+		newDecl->textSource = NULL;
 	}
 
-	numLines = src.GetLineNum();
+	newDecl->sourceFile = this;
+	newDecl->sourceTextOffset = sourceTextOffset;
+	newDecl->sourceTextLength = sourceTextLength;
+	newDecl->sourceLine = sourceLine;
+	newDecl->declState = DS_UNPARSED;
 
-	Mem_Free(buffer);
+	return newDecl;
+}
 
-	// any defs that weren't redefinedInReload should now be defaulted
-	for (idDeclLocal *decl = decls ; decl ; decl = decl->nextInFile) {
-		if (decl->redefinedInReload == false) {
-			decl->MakeDefault();
-			decl->sourceTextOffset = decl->sourceFile->fileSize;
-			decl->sourceTextLength = 0;
-			decl->sourceLine = decl->sourceFile->numLines;
-		}
+/*
+================
+idDeclFile::AddCacheDecl
+================
+*/
+void idDeclFile::AddCacheDecl(const idDeclLocal *decl)
+{
+	static const byte	pad[4] = { 0, 0, 0, 0 };
+	declCacheDecl_t		record;
+	int					namePad, textPad;
+
+	if (!cacheDecls) {
+		return;
 	}
 
-	return checksum;
+	namePad = ((decl->name.Length() + 1 + 3) & ~3) - decl->name.Length();
+	textPad = ((decl->compressedLength + 3) & ~3) - decl->compressedLength;
+
+	record.recordLength = sizeof(record) + decl->name.Length() + namePad + decl->compressedLength + textPad;
+	record.type = decl->type;
+	record.nameLength = decl->name.Length();
+	record.sourceTextOffset = decl->sourceTextOffset;
+	record.sourceTextLength = decl->sourceTextLength;
+	record.sourceLine = decl->sourceLine;
+	record.checksum = decl->checksum;
+	record.textLength = decl->textLength;
+	record.compressedLength = decl->compressedLength;
+
+	cacheDecls->Write(&record, sizeof(record));
+	cacheDecls->Write(decl->name.c_str(), decl->name.Length());
+	cacheDecls->Write(pad, namePad);
+	cacheDecls->Write(decl->textSource, decl->compressedLength);
+	cacheDecls->Write(pad, textPad);
+
+	numCacheDecls++;
 }
 
 /*
@@ -854,6 +1748,8 @@ void idDeclManagerLocal::Init(void)
 	ClearHuffmanFrequencies();
 #endif
 
+	LoadDeclCache();
+
 	// decls used throughout the engine
 	RegisterDeclType("table",				DECL_TABLE,			idDeclAllocator<idDeclTable>);
 	RegisterDeclType("material",			DECL_MATERIAL,		idDeclAllocator<idMaterial>);
@@ -925,6 +1821,9 @@ void idDeclManagerLocal::Shutdown(void)
 	int			i, j;
 	idDeclLocal *decl;
 
+	// if no level was loaded, the cache hasn't been written yet
+	WriteDeclCache();
+
 	// free decls
 	for (i = 0; i < DECL_MAX_TYPES; i++) {
 		for (j = 0; j < linearLists[i].Num(); j++) {
@@ -980,6 +1879,9 @@ void idDeclManagerLocal::BeginLevelLoad()
 {
 	insideLevelLoad = true;
 
+	// all the decl folders have been registered by now
+	WriteDeclCache();
+
 	// clear all the referencedThisLevel flags and purge all the data
 	// so the next reference will cause a reparse
 	for (int i = 0; i < DECL_MAX_TYPES; i++) {
@@ -1038,11 +1940,14 @@ idDeclManagerLocal::RegisterDeclFolder
 */
 void idDeclManagerLocal::RegisterDeclFolder(const char *folder, const char *extension, declType_t defaultType)
 {
-	int i, j;
+	const int DECL_SCAN_BATCH_FILES = 64;
+	const int DECL_SCAN_BATCH_LENGTH = 4 * 1024 * 1024;
+	int i, j, numScans, batchLength;
 	idStr fileName;
 	idDeclFolder *declFolder;
 	idFileList *fileList;
 	idDeclFile *df;
+	declScan_t *scans;
 
 	// check whether this folder / extension combination already exists
 	for (i = 0; i < declFolders.Num(); i++) {
@@ -1064,30 +1969,312 @@ void idDeclManagerLocal::RegisterDeclFolder(const char *folder, const char *exte
 	// scan for decl files
 	fileList = fileSystem->ListFiles(declFolder->folder, declFolder->extension, true);
 
-	// load and parse decl files
-	for (i = 0; i < fileList->GetNumFiles(); i++) {
-		fileName = declFolder->folder + "/" + fileList->GetFile(i);
+	// load and parse decl files, a batch at a time to bound the memory held by the
+	// file text, the files of a batch are scanned for their decls by the job threads
+	// and the decls are then defined in file order, so redefinitions resolve the same
+	scans = new declScan_t[ DECL_SCAN_BATCH_FILES ];
 
-		// check whether this file has already been loaded
-		for (j = 0; j < loadedFiles.Num(); j++) {
-			if (fileName.Icmp(loadedFiles[j]->fileName) == 0) {
-				break;
+	for (i = 0; i < fileList->GetNumFiles();) {
+		numScans = 0;
+		batchLength = 0;
+
+		for (; i < fileList->GetNumFiles() && numScans < DECL_SCAN_BATCH_FILES && batchLength < DECL_SCAN_BATCH_LENGTH; i++) {
+			fileName = declFolder->folder + "/" + fileList->GetFile(i);
+
+			// check whether this file has already been loaded
+			for (j = 0; j < loadedFiles.Num(); j++) {
+				if (fileName.Icmp(loadedFiles[j]->fileName) == 0) {
+					break;
+				}
+			}
+
+			if (j < loadedFiles.Num()) {
+				df = loadedFiles[j];
+			} else {
+				df = new idDeclFile(fileName, defaultType);
+				loadedFiles.Append(df);
+			}
+
+			df->StartLoad(scans[numScans]);
+
+			if (scans[numScans].buffer) {
+				batchLength += scans[numScans].length;
 			}
+
+			numScans++;
 		}
 
-		if (j < loadedFiles.Num()) {
-			df = loadedFiles[j];
+		if (decl_parallelScan.GetBool()) {
+			Sys_RunJobs(idDeclFile::ScanJob, scans, sizeof(scans[0]), numScans);
 		} else {
-			df = new idDeclFile(fileName, defaultType);
-			loadedFiles.Append(df);
+			for (j = 0; j < numScans; j++) {
+				idDeclFile::ScanJob(&scans[j]);
+			}
 		}
 
-		df->LoadAndParse();
+		for (j = 0; j < numScans; j++) {
+			scans[j].file->FinishLoad(scans[j]);
+		}
 	}
 
+	delete[] scans;
+
 	fileSystem->FreeFileList(fileList);
 }
 
+/*
+===================
+idDeclManagerLocal::LoadDeclCache
+
+Reads the decl cache, the records are checked as they are walked
+===================
+*/
+void idDeclManagerLocal::LoadDeclCache(void)
+{
+	const declCacheHeader_t	*header;
+	const declCacheFile_t	*record;
+	const declCacheDecl_t	*cacheDecl;
+	idFile					*f;
+	int						i, j, offset, declOffset, flags;
+
+	FreeDeclCache();
+	declCacheActive = false;
+	declCacheDirty = false;
+
+#ifdef GET_HUFFMAN_FREQUENCIES
+	// the frequencies are counted from the text of all the decls
+	return;
+#endif
+
+	if (!decl_cache.GetBool()) {
+		return;
+	}
+
+	declCacheActive = true;
+
+	f = fileSystem->OpenExplicitFileRead(fileSystem->RelativePathToOSPath(DECL_CACHE_FILE, "fs_savepath"));
+
+	if (!f) {
+		return;
+	}
+
+	declCacheLength = f->Length();
+
+	if (declCacheLength >= (int)sizeof(declCacheHeader_t)) {
+		declCache = (byte *)Mem_Alloc(declCacheLength, TAG_DECL);
+
+		if (f->Read(declCache, declCacheLength) != declCacheLength) {
+			FreeDeclCache();
+		}
+	}
+
+	fileSystem->CloseFile(f);
+
+	if (!declCache) {
+		return;
+	}
+
+#ifdef USE_COMPRESSED_DECLS
+	flags = DECL_CACHE_COMPRESSED;
+#else
+	flags = 0;
+#endif
+
+	header = (const declCacheHeader_t *)declCache;
+
+	if (header->ident != DECL_CACHE_IDENT || header->version != DECL_CACHE_VERSION || header->flags != flags) {
+		common->DPrintf("%s is out of date\n", DECL_CACHE_FILE);
+		FreeDeclCache();
+		return;
+	}
+
+	offset = sizeof(declCacheHeader_t);
+
+	for (i = 0; i < header->numFiles; i++) {
+		record = (const declCacheFile_t *)(declCache + offset);
+
+		if (offset + (int)sizeof(declCacheFile_t) > declCacheLength ||
+		    record->recordLength < (int)sizeof(declCacheFile_t) || record->recordLength > declCacheLength - offset ||
+		    record->nameLength < 0 || record->numDecls < 0 ||
+		    (int)sizeof(declCacheFile_t) + ((record->nameLength + 1 + 3) & ~3) > record->recordLength ||
+		    ((const char *)(record + 1))[record->nameLength] != '\0') {
+			break;
+		}
+
+		declOffset = sizeof(declCacheFile_t) + ((record->nameLength + 1 + 3) & ~3);
+
+		for (j = 0; j < record->numDecls; j++) {
+			cacheDecl = (const declCacheDecl_t *)((const byte *)record + declOffset);
+
+			if (declOffset + (int)sizeof(declCacheDecl_t) > record->recordLength ||
+			    cacheDecl->recordLength > record->recordLength - declOffset ||
+			    cacheDecl->type < 0 || cacheDecl->type >= record->numDeclTypes || cacheDecl->nameLength <= 0 || cacheDecl->compressedLength < 0 ||
+			    (int)sizeof(declCacheDecl_t) + ((cacheDecl->nameLength + 1 + 3) & ~3) + ((cacheDecl->compressedLength + 3) & ~3) != cacheDecl->recordLength ||
+			    ((const char *)(cacheDecl + 1))[cacheDecl->nameLength] != '\0') {
+				break;
+			}
+
+			declOffset += cacheDecl->recordLength;
+		}
+
+		if (j < record->numDecls) {
+			break;
+		}
+
+		declCacheHash.Add(idStr::IHash((const char *)(record + 1)), declCacheOffsets.Append(offset));
+		offset += record->recordLength;
+	}
+
+	if (i < header->numFiles) {
+		common->Warning("%s is corrupted", DECL_CACHE_FILE);
+		FreeDeclCache();
+		return;
+	}
+}
+
+/*
+===================
+idDeclManagerLocal::FindDeclCacheFile
+
+Returns the cache record of a decl file if it hasn't changed since it was lexed
+===================
+*/
+const declCacheFile_t *idDeclManagerLocal::FindDeclCacheFile(const char *fileName, int fileSize, ID_TIME_T timestamp, declType_t defaultType) const
+{
+	const declCacheFile_t	*record;
+	int						i;
+
+	if (!declCache || fileSize < 0) {
+		return NULL;
+	}
+
+	for (i = declCacheHash.First(idStr::IHash(fileName)); i != -1; i = declCacheHash.Next(i)) {
+		record = (const declCacheFile_t *)(declCache + declCacheOffsets[i]);
+
+		if (idStr::Icmp((const char *)(record + 1), fileName) != 0) {
+			continue;
+		}
+
+		// the registered types decide which tokens are decl type names
+		if (record->fileSize != fileSize || record->timestamp != (int)timestamp ||
+		    record->defaultType != defaultType || record->numDeclTypes != declTypes.Num()) {
+			return NULL;
+		}
+
+		return record;
+	}
+
+	return NULL;
+}
+
+/*
+===================
+idDeclManagerLocal::WriteDeclCache
+
+Rewrites the decl cache if any decl file was lexed, then drops the cache
+for the rest of the session, later reloads aren't recorded.
+===================
+*/
+void idDeclManagerLocal::WriteDeclCache(void)
+{
+	static const byte	pad[4] = { 0, 0, 0, 0 };
+	declCacheHeader_t	header;
+	declCacheFile_t		record;
+	idDeclFile			*df;
+	idFile				*f;
+	int					i, namePad;
+
+	if (!declCacheActive) {
+		return;
+	}
+
+	if (declCacheDirty) {
+		f = fileSystem->OpenFileWrite(DECL_CACHE_FILE);
+
+		if (!f) {
+			common->Warning("couldn't write %s", DECL_CACHE_FILE);
+		} else {
+			header.ident = DECL_CACHE_IDENT;
+			header.version = DECL_CACHE_VERSION;
+#ifdef USE_COMPRESSED_DECLS
+			header.flags = DECL_CACHE_COMPRESSED;
+#else
+			header.flags = 0;
+#endif
+			header.numFiles = 0;
+
+			for (i = 0; i < loadedFiles.Num(); i++) {
+				if (loadedFiles[i]->cacheRecord || (loadedFiles[i]->cacheDecls && loadedFiles[i]->cacheable)) {
+					header.numFiles++;
+				}
+			}
+
+			f->Write(&header, sizeof(header));
+
+			for (i = 0; i < loadedFiles.Num(); i++) {
+				df = loadedFiles[i];
+
+				// unchanged files keep their old record
+				if (df->cacheRecord) {
+					f->Write(df->cacheRecord, df->cacheRecord->recordLength);
+					continue;
+				}
+
+				if (!df->cacheDecls || !df->cacheable) {
+					continue;
+				}
+
+				namePad = ((df->fileName.Length() + 1 + 3) & ~3) - df->fileName.Length();
+
+				record.recordLength = sizeof(record) + df->fileName.Length() + namePad + df->cacheDecls->Length();
+				record.nameLength = df->fileName.Length();
+				record.fileSize = df->fileSize;
+				record.timestamp = df->timestamp;
+				record.checksum = df->checksum;
+				record.numLines = df->numLines;
+				record.defaultType = df->defaultType;
+				record.numDeclTypes = df->cacheDeclTypes;
+				record.numDecls = df->numCacheDecls;
+
+				f->Write(&record, sizeof(record));
+				f->Write(df->fileName.c_str(), df->fileName.Length());
+				f->Write(pad, namePad);
+				f->Write(df->cacheDecls->GetDataPtr(), df->cacheDecls->Length());
+			}
+
+			fileSystem->CloseFile(f);
+
+			common->DPrintf("wrote %s with %d files\n", DECL_CACHE_FILE, header.numFiles);
+		}
+	}
+
+	for (i = 0; i < loadedFiles.Num(); i++) {
+		loadedFiles[i]->cacheRecord = NULL;
+		delete loadedFiles[i]->cacheDecls;
+		loadedFiles[i]->cacheDecls = NULL;
+	}
+
+	FreeDeclCache();
+	declCacheActive = false;
+}
+
+/*
+===================
+idDeclManagerLocal::FreeDeclCache
+===================
+*/
+void idDeclManagerLocal::FreeDeclCache(void)
+{
+	if (declCache) {
+		Mem_Free(declCache);
+		declCache = NULL;
+	}
+
+	declCacheLength = 0;
+	declCacheHash.Free();
+	declCacheOffsets.Clear();
+}
+
 /*
 ===================
 idDeclManagerLocal::GetChecksum
@@ -2073,17 +3260,40 @@ void idDeclLocal::SetTextLocal(const char *text, const int length)
 	int maxBytesPerCode = (maxHuffmanBits + 7) >> 3;
 	byte *compressed = (byte *)_alloca(length * maxBytesPerCode);
 	compressedLength = HuffmanCompressText(text, length, compressed, length * maxBytesPerCode);
-	textSource = (char *)Mem_Alloc(compressedLength);
+	textSource = (char *)Mem_Alloc(compressedLength, TAG_DECL);
 	memcpy(textSource, compressed, compressedLength);
 #else
 	compressedLength = length;
-	textSource = (char *) Mem_Alloc(length + 1);
+	textSource = (char *) Mem_Alloc(length + 1, TAG_DECL);
 	memcpy(textSource, text, length);
 	textSource[length] = '\0';
 #endif
 	textLength = length;
 }
 
+/*
+=================
+idDeclLocal::SetStoredTextLocal
+=================
+*/
+void idDeclLocal::SetStoredTextLocal(const char *stored, const int storedLength, const int length, const int textChecksum)
+{
+	Mem_Free(textSource);
+
+	checksum = textChecksum;
+	compressedLength = storedLength;
+
+#ifdef USE_COMPRESSED_DECLS
+	textSource = (char *)Mem_Alloc(storedLength, TAG_DECL);
+	memcpy(textSource, stored, storedLength);
+#else
+	textSource = (char *) Mem_Alloc(storedLength + 1, TAG_DECL);
+	memcpy(textSource, stored, storedLength);
+	textSource[storedLength] = '\0';
+#endif
+	textLength = length;
+}
+
 /*
 =================
 idDeclLocal::ReplaceSourceFileText
@@ -2105,7 +3315,7 @@ bool idDeclLocal::ReplaceSourceFileText(void)
 	// get length and allocate buffer to hold the file
 	oldFileLength = sourceFile->fileSize;
 	newFileLength = oldFileLength - sourceTextLength + textLength;
-	buffer = (char *) Mem_Alloc(Max(newFileLength, oldFileLength));
+	buffer = (char *) Mem_Alloc(Max(newFileLength, oldFileLength), TAG_DECL);
 
 	// read original file
 	if (sourceFile->fileSize) {
@@ -1336,6 +1336,9 @@ idFile_InZip
 =================================================================================
 */
 
+#define ZIP_SEEK_BUF_SIZE			(1<<15)
+#define ZIP_CHECKPOINT_INTERVAL		(1<<20)		// about 45k of decompression state per checkpoint
+
 /*
 =================
 idFile_InZip::idFile_InZip
@@ -1356,6 +1359,12 @@ idFile_InZip::~idFile_InZip
 */
 idFile_InZip::~idFile_InZip(void)
 {
+	int i;
+
+	for (i = 0; i < checkpoints.Num(); i++) {
+		unzFreeCheckpoint(checkpoints[i]);
+	}
+
 	unzCloseCurrentFile(z);
 	unzClose(z);
 }
@@ -1369,11 +1378,84 @@ Properly handles partial reads
 */
 int idFile_InZip::Read(void *buffer, int len)
 {
-	int l = unzReadCurrentFile(z, buffer, len);
+	int l, r, pos;
+
+	if (fileSize < ZIP_CHECKPOINT_INTERVAL * 2) {
+		l = unzReadCurrentFile(z, buffer, len);
+		fileSystem->AddToReadCount(l);
+		return l;
+	}
+
+	// stop at every checkpoint interval so seeks can resume from there
+	for (l = 0; l < len; l += r) {
+		pos = unztell(z);
+		r = unzReadCurrentFile(z, (byte *)buffer + l, Min(len - l, ZIP_CHECKPOINT_INTERVAL - pos % ZIP_CHECKPOINT_INTERVAL));
+
+		if (r <= 0) {
+			break;
+		}
+
+		AddCheckpoint();
+	}
+
 	fileSystem->AddToReadCount(l);
 	return l;
 }
 
+/*
+=================
+idFile_InZip::AddCheckpoint
+
+Saves the decompression state the first time the read position passes
+the next checkpoint interval.
+=================
+*/
+void idFile_InZip::AddCheckpoint(void)
+{
+	void *checkpoint;
+
+	if (fileSize < ZIP_CHECKPOINT_INTERVAL * 2) {
+		return;
+	}
+
+	if (unztell(z) < (checkpoints.Num() + 1) * ZIP_CHECKPOINT_INTERVAL) {
+		return;
+	}
+
+	checkpoint = unzSaveCheckpoint(z);
+
+	if (checkpoint) {
+		checkpoints.Append(checkpoint);
+	}
+}
+
+/*
+=================
+idFile_InZip::Skip
+
+Decompresses and discards len bytes, returns the number of bytes skipped
+=================
+*/
+int idFile_InZip::Skip(int len)
+{
+	int res, skipped;
+	char *buf;
+
+	buf = (char *) _alloca16(ZIP_SEEK_BUF_SIZE);
+
+	for (skipped = 0; skipped < len; skipped += res) {
+		res = unzReadCurrentFile(z, buf, Min(len - skipped, ZIP_SEEK_BUF_SIZE));
+
+		if (res <= 0) {
+			break;
+		}
+
+		AddCheckpoint();
+	}
+
+	return skipped;
+}
+
 /*
 =================
 idFile_InZip::Write
@@ -1440,47 +1522,204 @@ ID_TIME_T idFile_InZip::Timestamp(void)
 idFile_InZip::Seek
 
   returns zero on success and -1 on failure
+  resumes decompression from the closest checkpoint before the new position
 =================
 */
-#define ZIP_SEEK_BUF_SIZE	(1<<15)
-
 int idFile_InZip::Seek(long offset, fsOrigin_t origin)
 {
-	int res, i;
-	char *buf;
+	int i, pos, checkpointPos;
+
+	pos = unztell(z);
 
 	switch (origin) {
 		case FS_SEEK_END: {
 			offset = fileSize - offset;
+			break;
 		}
 		case FS_SEEK_SET: {
+			break;
+		}
+		case FS_SEEK_CUR: {
+			offset += pos;
+			break;
+		}
+		default: {
+			common->FatalError("idFile_InZip::Seek: bad origin for %s\n", name.c_str());
+			return -1;
+		}
+	}
+
+	if (offset < 0) {
+		offset = 0;
+	}
+
+	if (offset > fileSize) {
+		return -1;
+	}
+
+	// find the last checkpoint before the new position
+	for (i = checkpoints.Num() - 1; i >= 0; i--) {
+		if (unzCheckpointTell(checkpoints[i]) <= offset) {
+			break;
+		}
+	}
+
+	checkpointPos = (i >= 0) ? unzCheckpointTell(checkpoints[i]) : 0;
+
+	if (offset < pos || checkpointPos > pos) {
+		if (i >= 0 && unzRestoreCheckpoint(z, checkpoints[i]) == UNZ_OK) {
+			pos = checkpointPos;
+		} else {
 			// set the file position in the zip file (also sets the current file info)
 			unzSetCurrentFileInfoPosition(z, zipFilePos);
 			unzOpenCurrentFile(z);
-
-			if (offset <= 0) {
-				return 0;
-			}
+			pos = 0;
 		}
-		case FS_SEEK_CUR: {
-			buf = (char *) _alloca16(ZIP_SEEK_BUF_SIZE);
+	}
 
-			for (i = 0; i < (offset - ZIP_SEEK_BUF_SIZE); i += ZIP_SEEK_BUF_SIZE) {
-				res = unzReadCurrentFile(z, buf, ZIP_SEEK_BUF_SIZE);
+	return (Skip(offset - pos) == offset - pos) ? 0 : -1;
+}
 
-				if (res < ZIP_SEEK_BUF_SIZE) {
-					return -1;
-				}
-			}
 
-			res = i + unzReadCurrentFile(z, buf, offset - i);
-			return (res == offset) ? 0 : -1;
+/*
+=================================================================================
+
+idFile_InZipView
+
+=================================================================================
+*/
+
+/*
+=================
+idFile_InZipView::idFile_InZipView
+=================
+*/
+idFile_InZipView::idFile_InZipView(void)
+{
+	name = "invalid";
+	data = NULL;
+	fileSize = 0;
+	curPos = 0;
+}
+
+/*
+=================
+idFile_InZipView::~idFile_InZipView
+=================
+*/
+idFile_InZipView::~idFile_InZipView(void)
+{
+}
+
+/*
+=================
+idFile_InZipView::Read
+=================
+*/
+int idFile_InZipView::Read(void *buffer, int len)
+{
+	if (len > fileSize - curPos) {
+		len = fileSize - curPos;
+	}
+
+	memcpy(buffer, data + curPos, len);
+	curPos += len;
+	fileSystem->AddToReadCount(len);
+	return len;
+}
+
+/*
+=================
+idFile_InZipView::Write
+=================
+*/
+int idFile_InZipView::Write(const void *buffer, int len)
+{
+	common->FatalError("idFile_InZipView::Write: cannot write to the zipped file %s", name.c_str());
+	return 0;
+}
+
+/*
+=================
+idFile_InZipView::ForceFlush
+=================
+*/
+void idFile_InZipView::ForceFlush(void)
+{
+	common->FatalError("idFile_InZipView::ForceFlush: cannot flush the zipped file %s", name.c_str());
+}
+
+/*
+=================
+idFile_InZipView::Flush
+=================
+*/
+void idFile_InZipView::Flush(void)
+{
+	common->FatalError("idFile_InZipView::Flush: cannot flush the zipped file %s", name.c_str());
+}
+
+/*
+=================
+idFile_InZipView::Tell
+=================
+*/
+int idFile_InZipView::Tell(void)
+{
+	return curPos;
+}
+
+/*
+================
+idFile_InZipView::Length
+================
+*/
+int idFile_InZipView::Length(void)
+{
+	return fileSize;
+}
+
+/*
+================
+idFile_InZipView::Timestamp
+================
+*/
+ID_TIME_T idFile_InZipView::Timestamp(void)
+{
+	return 0;
+}
+
+/*
+=================
+idFile_InZipView::Seek
+
+  returns zero on success and -1 on failure
+=================
+*/
+int idFile_InZipView::Seek(long offset, fsOrigin_t origin)
+{
+	switch (origin) {
+		case FS_SEEK_CUR: {
+			offset += curPos;
+			break;
 		}
-		default: {
-			common->FatalError("idFile_InZip::Seek: bad origin for %s\n", name.c_str());
+		case FS_SEEK_END: {
+			offset = fileSize - offset;
 			break;
 		}
+		case FS_SEEK_SET: {
+			break;
+		}
+		default: {
+			common->FatalError("idFile_InZipView::Seek: bad origin for %s\n", name.c_str());
+			return -1;
+		}
 	}
 
-	return -1;
+	if (offset < 0 || offset > fileSize) {
+		return -1;
+	}
+
+	curPos = offset;
+	return 0;
 }
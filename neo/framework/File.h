@@ -266,6 +266,46 @@ class idFile_InZip : public idFile
 		int						zipFilePos;		// zip file info position in pak
 		int						fileSize;		// size of the file
 		void 					*z;				// unzip info
+		idList<void *>			checkpoints;	// decompression state saved every ZIP_CHECKPOINT_INTERVAL bytes
+
+		void					AddCheckpoint(void);
+		int						Skip(int len);
+};
+
+class idFile_InZipView : public idFile
+{
+		friend class			idFileSystemLocal;
+
+	public:
+		idFile_InZipView(void);
+		virtual					~idFile_InZipView(void);
+
+		virtual const char 	*GetName(void) {
+			return name.c_str();
+		}
+		virtual const char 	*GetFullPath(void) {
+			return fullPath.c_str();
+		}
+		virtual int				Read(void *buffer, int len);
+		virtual int				Write(const void *buffer, int len);
+		virtual int				Length(void);
+		virtual ID_TIME_T			Timestamp(void);
+		virtual int				Tell(void);
+		virtual void			ForceFlush(void);
+		virtual void			Flush(void);
+		virtual int				Seek(long offset, fsOrigin_t origin);
+
+		// returns const pointer to the file data inside the memory mapped pak
+		const byte 			*GetDataPtr(void) const {
+			return data;
+		}
+
+	private:
+		idStr					name;			// name of the file in the pak
+		idStr					fullPath;		// full file path including pak file name
+		const byte 			*data;			// stored file data in the mapped pak
+		int						fileSize;		// size of the file
+		int						curPos;			// current read position
 };
 
 #endif /* !__FILE_H__ */
@@ -173,7 +173,7 @@ for instance to base a mod of D3 + D3XP assets, fs_game mymod, fs_game_base d3xp
 // the wrong place for Doom 3 don't break pure servers.
 #define DOOM3_PURE_SPECIAL_CASES
 
-typedef bool (*pureExclusionFunc_t)(const struct pureExclusion_s &excl, int l, const idStr &name);
+typedef bool (*pureExclusionFunc_t)(const struct pureExclusion_s &excl, int l, const char *name);
 
 typedef struct pureExclusion_s {
 	int					nameLen;
@@ -183,27 +183,27 @@ typedef struct pureExclusion_s {
 	pureExclusionFunc_t	func;
 } pureExclusion_t;
 
-bool excludeExtension(const pureExclusion_t &excl, int l, const idStr &name)
+bool excludeExtension(const pureExclusion_t &excl, int l, const char *name)
 {
-	if (l > excl.extLen && !idStr::Icmp(name.c_str() + l - excl.extLen, excl.ext)) {
+	if (l > excl.extLen && !idStr::Icmp(name + l - excl.extLen, excl.ext)) {
 		return true;
 	}
 
 	return false;
 }
 
-bool excludePathPrefixAndExtension(const pureExclusion_t &excl, int l, const idStr &name)
+bool excludePathPrefixAndExtension(const pureExclusion_t &excl, int l, const char *name)
 {
-	if (l > excl.nameLen && !idStr::Icmp(name.c_str() + l - excl.extLen, excl.ext) && !name.IcmpPrefixPath(excl.name)) {
+	if (l > excl.nameLen && !idStr::Icmp(name + l - excl.extLen, excl.ext) && !idStr::IcmpnPath(name, excl.name, excl.nameLen)) {
 		return true;
 	}
 
 	return false;
 }
 
-bool excludeFullName(const pureExclusion_t &excl, int l, const idStr &name)
+bool excludeFullName(const pureExclusion_t &excl, int l, const char *name)
 {
-	if (l == excl.nameLen && !name.Icmp(excl.name)) {
+	if (l == excl.nameLen && !idStr::Icmp(name, excl.name)) {
 		return true;
 	}
 
@@ -264,7 +264,8 @@ static idInitExclusions	initExclusions;
 #define FILE_HASH_SIZE			1024
 
 typedef struct fileInPack_s {
-	idStr				name;						// name of the file
+	const char 			*name;						// name of the file, in the nameBuffer of the pak
+	int					nameLength;
 	unsigned long		pos;						// file info position in zip
 	struct fileInPack_s *next;						// next file in the hash
 } fileInPack_t;
@@ -300,8 +301,13 @@ typedef struct {
 	addonInfo_t			*addon_info;
 	pureStatus_t		pureStatus;
 	bool				isNew;						// for downloaded paks
+	ID_TIME_T			timestamp;
 	fileInPack_t		*hashTable[FILE_HASH_SIZE];
 	fileInPack_t		*buildBuffer;
+	char 				*nameBuffer;				// all file names, nul terminated
+	int					nameBufferLength;
+	const byte			*mappedData;				// whole pak mapped into memory for stored files, or NULL
+	int					mappedLength;
 } pack_t;
 
 typedef struct {
@@ -309,6 +315,18 @@ typedef struct {
 	idStr				gamedir;					// base
 } directory_t;
 
+// file shared by the async reads of the same path or idFile, only the main thread opens and closes it
+typedef struct asyncReadFile_s {
+	idStr				relativePath;				// empty when the caller opened the file
+	idFile 				*f;
+	bool				ownsFile;
+	FILE 				*fp;						// plain file read with stdio on the I/O thread
+	const byte 			*data;						// or file stored in a mapped pak, anything else is read through f
+	int					length;
+	int					numReads;					// queued and in progress reads
+	struct asyncReadFile_s *next;
+} asyncReadFile_t;
+
 typedef struct searchpath_s {
 	pack_t 			*pack;						// only one of pack / dir will be non NULL
 	directory_t 		*dir;
@@ -328,6 +346,44 @@ typedef struct searchpath_s {
 
 // how many OSes to handle game paks for ( we don't have to know them precisely )
 #define MAX_GAME_OS	6
+
+// size of the local file header in front of every file in a zip
+#define ZIP_LOCAL_HEADER_SIZE	30
+
+// maximum number of reads of the same file serviced together
+#define MAX_ASYNC_READ_BATCH	32
+
+// pak directories cached in the save path, so the paks don't need to be scanned at startup
+// stored in native byte order, the cache is never shared between machines
+#define PAK_INDEX_FILE			"pakindex.dat"
+#define PAK_INDEX_IDENT			(('X'<<24)+('I'<<16)+('K'<<8)+'P')
+#define PAK_INDEX_VERSION		1
+
+typedef struct {
+	int					ident;
+	int					version;
+	int					hashSize;					// FILE_HASH_SIZE
+	int					numPaks;
+} pakIndexHeader_t;
+
+// each record is followed by the pak path, the file entries and the file names,
+// all padded to 4 bytes
+typedef struct {
+	int					recordLength;				// including this header
+	int					pathLength;
+	int					length;						// size and time of the pak when it was scanned
+	int					timestamp;
+	int					checksum;
+	int					numFiles;
+	int					namesLength;
+} pakIndexRecord_t;
+
+typedef struct {
+	int					pos;
+	int					hash;
+	int					nameOffset;
+	int					nameLength;
+} pakIndexFile_t;
 #define BINARY_CONFIG "binary.conf"
 #define ADDON_CONFIG "addon.conf"
 
@@ -391,7 +447,7 @@ class idFileSystemLocal : public idFileSystem
 			readCount = 0;
 		}
 		virtual void			AddToReadCount(int c) {
-			readCount += c;
+			__sync_fetch_and_add(&readCount, c);
 		}
 		virtual int				GetReadCount(void) {
 			return readCount;
@@ -409,6 +465,11 @@ class idFileSystemLocal : public idFileSystem
 		virtual const idDict 	*GetMapDecl(int i);
 		virtual void			FindMapScreenshot(const char *path, char *buf, int len);
 		virtual bool			FilenameCompare(const char *s1, const char *s2) const;
+		virtual int				ReadFileView(const char *relativePath, const void **buffer, ID_TIME_T *timestamp);
+		virtual void			FreeFileView(const void *buffer);
+		virtual void			AsyncRead(asyncRead_t *read);
+		virtual bool			CancelAsyncRead(asyncRead_t *read);
+		virtual void			WaitAsyncRead(asyncRead_t *read);
 
 		static void				Dir_f(const idCmdArgs &args);
 		static void				DirTree_f(const idCmdArgs &args);
@@ -418,6 +479,7 @@ class idFileSystemLocal : public idFileSystem
 
 	private:
 		friend void			*BackgroundDownloadThread(void *parms);
+		friend void			*AsyncReadThread(void *parms);
 
 		searchpath_t 			*searchPaths;
 		int						readCount;			// total bytes read
@@ -440,11 +502,21 @@ class idFileSystemLocal : public idFileSystem
 		static idCVar			fs_game_base;
 		static idCVar			fs_caseSensitiveOS;
 		static idCVar			fs_searchAddons;
+		static idCVar			fs_mapPaks;
+		static idCVar			fs_pakIndex;
 
 		backgroundDownload_t 	*backgroundDownloads;
 		backgroundDownload_t	defaultBackgroundDownload;
 		xthreadInfo				backgroundThread;
 
+		byte 					*pakIndex;			// pak directory cache, only loaded during startup
+		int						pakIndexLength;
+		bool					pakIndexDirty;
+
+		asyncRead_t 			*asyncReads;		// queued reads, oldest first
+		asyncReadFile_t 		*asyncReadFiles;
+		xthreadInfo				asyncReadThread;
+
 		idList<pack_t *>		serverPaks;
 		bool					loadedFileFromDir;		// set to true once a file was loaded from a directory - can't switch to pure anymore
 		idList<int>				restartChecksums;		// used during a restart to set things in right order
@@ -486,6 +558,21 @@ class idFileSystemLocal : public idFileSystem
 		// searches all the paks, no pure check
 		pack_t 				*FindPakForFileChecksum(const char *relativePath, int fileChecksum, bool bReference);
 		idFile_InZip 			*ReadFileFromZip(pack_t *pak, fileInPack_t *pakFile, const char *relativePath);
+		idFile_InZipView 		*ViewFileFromZip(pack_t *pak, fileInPack_t *pakFile, const char *relativePath);
+		idFile 				*OpenFileFromZip(pack_t *pak, fileInPack_t *pakFile, const char *relativePath);
+		bool					IsMappedData(const void *buffer) const;
+		void					LoadPakIndex(void);
+		void					WritePakIndex(void);
+		void					FreePakIndex(void);
+		const pakIndexRecord_t	*FindPakIndexRecord(const char *path, int length, ID_TIME_T timestamp) const;
+		bool					LoadZipFileFromIndex(pack_t *pack, const pakIndexRecord_t *record);
+		bool					ScanZipFile(pack_t *pack);
+		void					StartAsyncReadThread(void);
+		void					ShutdownAsyncReads(void);
+		asyncReadFile_t 		*GetAsyncReadFile(const asyncRead_t *read);
+		void					CloseAsyncReadFiles(void);
+		int						DequeueAsyncReads(asyncRead_t *batch[MAX_ASYNC_READ_BATCH]);
+		static void				ServiceAsyncRead(asyncRead_t *read);
 		int						GetFileChecksum(idFile *file);
 		pureStatus_t			GetPackStatus(pack_t *pak);
 		addonInfo_t 			*ParseAddonDef(const char *buf, const int len);
@@ -511,6 +598,8 @@ idCVar	idFileSystemLocal::fs_caseSensitiveOS("fs_caseSensitiveOS", "0", CVAR_SYS
 idCVar	idFileSystemLocal::fs_caseSensitiveOS("fs_caseSensitiveOS", "1", CVAR_SYSTEM | CVAR_BOOL, "");
 #endif
 idCVar	idFileSystemLocal::fs_searchAddons("fs_searchAddons", "0", CVAR_SYSTEM | CVAR_BOOL, "search all addon pk4s ( disables addon functionality )");
+idCVar	idFileSystemLocal::fs_mapPaks("fs_mapPaks", "1", CVAR_SYSTEM | CVAR_INIT | CVAR_BOOL, "memory map pk4s so files stored without compression are read without copies");
+idCVar	idFileSystemLocal::fs_pakIndex("fs_pakIndex", "1", CVAR_SYSTEM | CVAR_INIT | CVAR_BOOL, "cache the pk4 directories in " PAK_INDEX_FILE " to speed up startup");
 
 idFileSystemLocal	fileSystemLocal;
 idFileSystem 		*fileSystem = &fileSystemLocal;
@@ -532,6 +621,12 @@ idFileSystemLocal::idFileSystemLocal(void)
 	loadedFileFromDir = false;
 	restartGamePakChecksum = 0;
 	memset(&backgroundThread, 0, sizeof(backgroundThread));
+	pakIndex = NULL;
+	pakIndexLength = 0;
+	pakIndexDirty = false;
+	asyncReads = NULL;
+	asyncReadFiles = NULL;
+	memset(&asyncReadThread, 0, sizeof(asyncReadThread));
 	addonPaks = NULL;
 }
 
@@ -1232,6 +1327,108 @@ int idFileSystemLocal::ReadFile(const char *relativePath, void **buffer, ID_TIME
 	return len;
 }
 
+/*
+============
+idFileSystemLocal::ReadFileView
+
+Like ReadFile but files stored without compression in a mapped pak are
+returned as a pointer into the pak, without allocating or copying.
+The data is read-only and not 0 terminated.
+============
+*/
+int idFileSystemLocal::ReadFileView(const char *relativePath, const void **buffer, ID_TIME_T *timestamp)
+{
+	idFile 				*f;
+	idFile_InZipView	*view;
+	byte				*buf;
+	int					len;
+
+	if (!searchPaths) {
+		common->FatalError("Filesystem call made without initialization\n");
+	}
+
+	// journalled files and plain files always go through the buffered path
+	if (!buffer || (eventLoop && eventLoop->JournalLevel() != 0)) {
+		return ReadFile(relativePath, (void **)buffer, timestamp);
+	}
+
+	*buffer = NULL;
+
+	if (timestamp) {
+		*timestamp = FILE_NOT_FOUND_TIMESTAMP;
+	}
+
+	f = OpenFileRead(relativePath);
+
+	if (f == NULL) {
+		return -1;
+	}
+
+	len = f->Length();
+
+	if (timestamp) {
+		*timestamp = f->Timestamp();
+	}
+
+	loadCount++;
+	view = dynamic_cast<idFile_InZipView *>(f);
+
+	if (view) {
+		*buffer = view->GetDataPtr();
+		AddToReadCount(len);
+	} else {
+		// same as ReadFile so FreeFileView can hand it to FreeFile
+		loadStack++;
+		buf = (byte *)Mem_ClearedAlloc(len + 1);
+		f->Read(buf, len);
+		buf[len] = 0;
+		*buffer = buf;
+	}
+
+	CloseFile(f);
+
+	return len;
+}
+
+/*
+============
+idFileSystemLocal::IsMappedData
+============
+*/
+bool idFileSystemLocal::IsMappedData(const void *buffer) const
+{
+	searchpath_t *sp, *loop;
+
+	for (loop = searchPaths; loop; loop == searchPaths ? loop = addonPaks : loop = NULL) {
+		for (sp = loop; sp; sp = sp->next) {
+			if (sp->pack && sp->pack->mappedData && (const byte *)buffer >= sp->pack->mappedData && (const byte *)buffer < sp->pack->mappedData + sp->pack->mappedLength) {
+				return true;
+			}
+		}
+	}
+
+	return false;
+}
+
+/*
+=============
+idFileSystemLocal::FreeFileView
+=============
+*/
+void idFileSystemLocal::FreeFileView(const void *buffer)
+{
+	if (!buffer) {
+		common->FatalError("idFileSystemLocal::FreeFileView( NULL )");
+	}
+
+	// views are released with the pak
+	if (IsMappedData(buffer)) {
+		return;
+	}
+
+	FreeFile(const_cast<void *>(buffer));
+}
+
 /*
 =============
 idFileSystemLocal::FreeFile
@@ -1402,6 +1599,144 @@ addonInfo_t *idFileSystemLocal::ParseAddonDef(const char *buf, const int len)
 	return NULL;
 }
 
+/*
+=================
+idFileSystemLocal::ScanZipFile
+
+Builds the file table of the pak from the central directory of the zip.
+=================
+*/
+bool idFileSystemLocal::ScanZipFile(pack_t *pack)
+{
+	fileInPack_t 	*buildBuffer;
+	unz_file_info	file_info;
+	char			filename_inzip[MAX_ZIPPED_FILE_NAME];
+	char 			*nameBuffer, *newBuffer, *c;
+	int				nameBufferSize, nameLength;
+	int				i, err;
+	int				fs_numHeaderLongs;
+	int 			*fs_headerLongs;
+	long			hash;
+
+	buildBuffer = pack->buildBuffer;
+
+	nameBufferSize = pack->numfiles * 64;
+	nameBuffer = new char[ nameBufferSize ];
+	pack->nameBufferLength = 0;
+
+	fs_numHeaderLongs = 0;
+	fs_headerLongs = (int *)Mem_ClearedAlloc(pack->numfiles * sizeof(int));
+
+	unzGoToFirstFile(pack->handle);
+
+	for (i = 0; i < pack->numfiles; i++) {
+		err = unzGetCurrentFileInfo(pack->handle, &file_info, filename_inzip, sizeof(filename_inzip), NULL, 0, NULL, 0);
+
+		if (err != UNZ_OK) {
+			break;
+		}
+
+		if (file_info.uncompressed_size > 0) {
+			fs_headerLongs[fs_numHeaderLongs++] = LittleLong(file_info.crc);
+		}
+
+		nameLength = idStr::Length(filename_inzip);
+
+		if (pack->nameBufferLength + nameLength + 1 > nameBufferSize) {
+			nameBufferSize = (pack->nameBufferLength + nameLength + 1) * 2;
+			newBuffer = new char[ nameBufferSize ];
+			memcpy(newBuffer, nameBuffer, pack->nameBufferLength);
+			delete [] nameBuffer;
+			nameBuffer = newBuffer;
+		}
+
+		// the names are pointed at once the buffer stops growing
+		buildBuffer[i].nameLength = nameLength;
+
+		for (c = filename_inzip; *c; c++) {
+			*c = (*c == '\\') ? '/' : idStr::ToLower(*c);
+		}
+
+		memcpy(nameBuffer + pack->nameBufferLength, filename_inzip, nameLength + 1);
+		pack->nameBufferLength += nameLength + 1;
+		// store the file position in the zip
+		unzGetCurrentFileInfoPosition(pack->handle, &buildBuffer[i].pos);
+		// go to the next file in the zip
+		unzGoToNextFile(pack->handle);
+	}
+
+	pack->numfiles = i;
+	pack->nameBuffer = nameBuffer;
+
+	for (i = 0; i < pack->numfiles; i++) {
+		buildBuffer[i].name = nameBuffer;
+		nameBuffer += buildBuffer[i].nameLength + 1;
+		// add the file to the hash
+		hash = HashFileName(buildBuffer[i].name);
+		buildBuffer[i].next = pack->hashTable[hash];
+		pack->hashTable[hash] = &buildBuffer[i];
+	}
+
+	pack->checksum = MD4_BlockChecksum(fs_headerLongs, 4 * fs_numHeaderLongs);
+	pack->checksum = LittleLong(pack->checksum);
+
+	Mem_Free(fs_headerLongs);
+
+	return true;
+}
+
+/*
+=================
+idFileSystemLocal::LoadZipFileFromIndex
+
+Builds the file table of the pak from its record in the pak index.
+Returns false if the record doesn't match the zip, the pak is scanned then.
+=================
+*/
+bool idFileSystemLocal::LoadZipFileFromIndex(pack_t *pack, const pakIndexRecord_t *record)
+{
+	const pakIndexFile_t	*indexFiles;
+	const char 				*names;
+	fileInPack_t 			*buildBuffer;
+	int						i;
+
+	if (record->numFiles != pack->numfiles) {
+		return false;
+	}
+
+	indexFiles = (const pakIndexFile_t *)((const byte *)(record + 1) + ((record->pathLength + 1 + 3) & ~3));
+	names = (const char *)(indexFiles + record->numFiles);
+
+	// validate everything first, the index is just a cache
+	for (i = 0; i < record->numFiles; i++) {
+		if (indexFiles[i].hash < 0 || indexFiles[i].hash >= FILE_HASH_SIZE ||
+		    indexFiles[i].nameOffset < 0 || indexFiles[i].nameLength < 0 ||
+		    indexFiles[i].nameOffset + indexFiles[i].nameLength >= record->namesLength ||
+		    names[indexFiles[i].nameOffset + indexFiles[i].nameLength] != '\0') {
+			return false;
+		}
+	}
+
+	pack->nameBuffer = new char[ record->namesLength ];
+	pack->nameBufferLength = record->namesLength;
+	memcpy(pack->nameBuffer, names, record->namesLength);
+
+	buildBuffer = pack->buildBuffer;
+
+	for (i = 0; i < record->numFiles; i++) {
+		buildBuffer[i].name = pack->nameBuffer + indexFiles[i].nameOffset;
+		buildBuffer[i].nameLength = indexFiles[i].nameLength;
+		buildBuffer[i].pos = indexFiles[i].pos;
+		// add the file to the hash
+		buildBuffer[i].next = pack->hashTable[indexFiles[i].hash];
+		pack->hashTable[indexFiles[i].hash] = &buildBuffer[i];
+	}
+
+	pack->checksum = record->checksum;
+
+	return true;
+}
+
 /*
 =================
 idFileSystemLocal::LoadZipFile
@@ -1409,21 +1744,17 @@ idFileSystemLocal::LoadZipFile
 */
 pack_t *idFileSystemLocal::LoadZipFile(const char *zipfile)
 {
-	fileInPack_t 	*buildBuffer;
 	pack_t 		*pack;
 	unzFile			uf;
 	int				err;
 	unz_global_info gi;
-	char			filename_inzip[MAX_ZIPPED_FILE_NAME];
-	unz_file_info	file_info;
 	int				i;
-	long			hash;
-	int				fs_numHeaderLongs;
-	int 			*fs_headerLongs;
 	FILE			*f;
 	int				len;
+	ID_TIME_T		timestamp;
 	int				confHash;
 	fileInPack_t	*pakFile;
+	const pakIndexRecord_t	*record;
 
 	f = OpenOSFile(zipfile, "rb");
 
@@ -1433,10 +1764,9 @@ pack_t *idFileSystemLocal::LoadZipFile(const char *zipfile)
 
 	fseek(f, 0, SEEK_END);
 	len = ftell(f);
+	timestamp = Sys_FileTimeStamp(f);
 	fclose(f);
 
-	fs_numHeaderLongs = 0;
-
 	uf = unzOpen(zipfile);
 	err = unzGetGlobalInfo(uf, &gi);
 
@@ -1444,7 +1774,6 @@ pack_t *idFileSystemLocal::LoadZipFile(const char *zipfile)
 		return NULL;
 	}
 
-	buildBuffer = new fileInPack_t[gi.number_entry];
 	pack = new pack_t;
 
 	for (i = 0; i < FILE_HASH_SIZE; i++) {
@@ -1454,7 +1783,9 @@ pack_t *idFileSystemLocal::LoadZipFile(const char *zipfile)
 	pack->pakFilename = zipfile;
 	pack->handle = uf;
 	pack->numfiles = gi.number_entry;
-	pack->buildBuffer = buildBuffer;
+	pack->buildBuffer = new fileInPack_t[gi.number_entry];
+	pack->nameBuffer = NULL;
+	pack->nameBufferLength = 0;
 	pack->referenced = false;
 	pack->binary = BINARY_UNKNOWN;
 	pack->addon = false;
@@ -1464,32 +1795,20 @@ pack_t *idFileSystemLocal::LoadZipFile(const char *zipfile)
 	pack->isNew = false;
 
 	pack->length = len;
+	pack->timestamp = timestamp;
 
-	unzGoToFirstFile(uf);
-	fs_headerLongs = (int *)Mem_ClearedAlloc(gi.number_entry * sizeof(int));
-
-	for (i = 0; i < (int)gi.number_entry; i++) {
-		err = unzGetCurrentFileInfo(uf, &file_info, filename_inzip, sizeof(filename_inzip), NULL, 0, NULL, 0);
-
-		if (err != UNZ_OK) {
-			break;
-		}
+	if (fs_mapPaks.GetBool()) {
+		pack->mappedData = (const byte *)Sys_MapFile(zipfile, &pack->mappedLength);
+	} else {
+		pack->mappedData = NULL;
+		pack->mappedLength = 0;
+	}
 
-		if (file_info.uncompressed_size > 0) {
-			fs_headerLongs[fs_numHeaderLongs++] = LittleLong(file_info.crc);
-		}
+	record = FindPakIndexRecord(zipfile, len, timestamp);
 
-		hash = HashFileName(filename_inzip);
-		buildBuffer[i].name = filename_inzip;
-		buildBuffer[i].name.ToLower();
-		buildBuffer[i].name.BackSlashesToSlashes();
-		// store the file position in the zip
-		unzGetCurrentFileInfoPosition(uf, &buildBuffer[i].pos);
-		// add the file to the hash
-		buildBuffer[i].next = pack->hashTable[hash];
-		pack->hashTable[hash] = &buildBuffer[i];
-		// go to the next file in the zip
-		unzGoToNextFile(uf);
+	if (!record || !LoadZipFileFromIndex(pack, record)) {
+		ScanZipFile(pack);
+		pakIndexDirty = true;
 	}
 
 	// check if this is an addon pak
@@ -1519,72 +1838,282 @@ pack_t *idFileSystemLocal::LoadZipFile(const char *zipfile)
 		}
 	}
 
-	pack->checksum = MD4_BlockChecksum(fs_headerLongs, 4 * fs_numHeaderLongs);
-	pack->checksum = LittleLong(pack->checksum);
-
-	Mem_Free(fs_headerLongs);
-
 	return pack;
 }
 
 /*
-===============
-idFileSystemLocal::AddZipFile
-adds a downloaded pak file to the list so we can work out what we have and what we still need
-the isNew flag is set to true, indicating that we cannot add this pak to the search lists without a restart
-===============
+=================
+idFileSystemLocal::LoadPakIndex
+=================
 */
-int idFileSystemLocal::AddZipFile(const char *path)
+void idFileSystemLocal::LoadPakIndex(void)
 {
-	idStr			fullpath = fs_savepath.GetString();
-	pack_t			*pak;
-	searchpath_t	*search, *last;
+	const pakIndexHeader_t	*header;
+	const pakIndexRecord_t	*record;
+	idStr					path;
+	FILE 					*f;
+	int						i, offset;
 
-	fullpath.AppendPath(path);
-	pak = LoadZipFile(fullpath);
+	FreePakIndex();
+	pakIndexDirty = !fs_pakIndex.GetBool();
 
-	if (!pak) {
-		common->Warning("AddZipFile %s failed\n", path);
-		return 0;
+	if (!fs_pakIndex.GetBool() || !fs_savepath.GetString()[0]) {
+		return;
 	}
 
-	// insert the pak at the end of the search list - temporary until we restart
-	pak->isNew = true;
-	search = new searchpath_t;
-	search->dir = NULL;
-	search->pack = pak;
-	search->next = NULL;
-	last = searchPaths;
+	path = fs_savepath.GetString();
+	path.AppendPath(PAK_INDEX_FILE);
 
-	while (last->next) {
-		last = last->next;
+	// the whole index is read at once, the records are checked as they are walked
+	f = OpenOSFile(path, "rb");
+
+	if (!f) {
+		pakIndexDirty = true;
+		return;
 	}
 
-	last->next = search;
-	common->Printf("Appended pk4 %s with checksum 0x%x\n", pak->pakFilename.c_str(), pak->checksum);
-	return pak->checksum;
+	fseek(f, 0, SEEK_END);
+	pakIndexLength = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	if (pakIndexLength >= (int)sizeof(pakIndexHeader_t)) {
+		pakIndex = (byte *)Mem_Alloc(pakIndexLength);
+
+		if ((int)fread(pakIndex, 1, pakIndexLength, f) != pakIndexLength) {
+			FreePakIndex();
+		}
+	}
+
+	fclose(f);
+
+	if (!pakIndex) {
+		pakIndexDirty = true;
+		return;
+	}
+
+	header = (const pakIndexHeader_t *)pakIndex;
+
+	if (header->ident != PAK_INDEX_IDENT || header->version != PAK_INDEX_VERSION || header->hashSize != FILE_HASH_SIZE) {
+		common->DPrintf("%s is out of date\n", PAK_INDEX_FILE);
+		FreePakIndex();
+		pakIndexDirty = true;
+		return;
+	}
+
+	offset = sizeof(pakIndexHeader_t);
+
+	for (i = 0; i < header->numPaks; i++) {
+		record = (const pakIndexRecord_t *)(pakIndex + offset);
+
+		if (offset + (int)sizeof(pakIndexRecord_t) > pakIndexLength ||
+		    record->recordLength < (int)sizeof(pakIndexRecord_t) || record->recordLength > pakIndexLength - offset ||
+		    record->pathLength < 0 || record->numFiles < 0 || record->namesLength < 0 ||
+		    (int)sizeof(pakIndexRecord_t) + ((record->pathLength + 1 + 3) & ~3) + record->numFiles * (int)sizeof(pakIndexFile_t) + record->namesLength > record->recordLength) {
+			common->Warning("%s is corrupted", PAK_INDEX_FILE);
+			FreePakIndex();
+			pakIndexDirty = true;
+			return;
+		}
+
+		offset += record->recordLength;
+	}
 }
 
 /*
-===============
-idFileSystemLocal::AddUnique
-===============
+=================
+idFileSystemLocal::FindPakIndexRecord
+=================
 */
-int idFileSystemLocal::AddUnique(const char *name, idStrList &list, idHashIndex &hashIndex) const
+const pakIndexRecord_t *idFileSystemLocal::FindPakIndexRecord(const char *path, int length, ID_TIME_T timestamp) const
 {
-	int i, hashKey;
+	const pakIndexHeader_t	*header;
+	const pakIndexRecord_t	*record;
+	int						i, offset;
 
-	hashKey = hashIndex.GenerateKey(name);
+	if (!pakIndex) {
+		return NULL;
+	}
 
-	for (i = hashIndex.First(hashKey); i >= 0; i = hashIndex.Next(i)) {
-		if (list[i].Icmp(name) == 0) {
-			return i;
+	header = (const pakIndexHeader_t *)pakIndex;
+	offset = sizeof(pakIndexHeader_t);
+
+	for (i = 0; i < header->numPaks; i++) {
+		record = (const pakIndexRecord_t *)(pakIndex + offset);
+
+		if (record->length == length && record->timestamp == (int)timestamp && !FilenameCompare((const char *)(record + 1), path)) {
+			return record;
 		}
+
+		offset += record->recordLength;
 	}
 
-	i = list.Append(name);
-	hashIndex.Add(hashKey, i);
-	return i;
+	return NULL;
+}
+
+/*
+=================
+idFileSystemLocal::FreePakIndex
+=================
+*/
+void idFileSystemLocal::FreePakIndex(void)
+{
+	if (pakIndex) {
+		Mem_Free(pakIndex);
+		pakIndex = NULL;
+	}
+
+	pakIndexLength = 0;
+}
+
+/*
+=================
+idFileSystemLocal::WritePakIndex
+
+Rewrites the pak index with the directories of all the loaded paks.
+=================
+*/
+void idFileSystemLocal::WritePakIndex(void)
+{
+	static const byte	pad[4] = { 0, 0, 0, 0 };
+	searchpath_t		*sp, *loop;
+	pakIndexHeader_t	header;
+	pakIndexRecord_t	record;
+	pakIndexFile_t		indexFile;
+	pack_t 				*pak;
+	idStr				path;
+	FILE 				*f;
+	int					i, pathPad, namesPad;
+
+	if (!fs_pakIndex.GetBool() || !fs_savepath.GetString()[0]) {
+		return;
+	}
+
+	path = fs_savepath.GetString();
+	path.AppendPath(PAK_INDEX_FILE);
+
+	CreateOSPath(path);
+	f = OpenOSFile(path, "wb");
+
+	if (!f) {
+		common->Warning("couldn't write %s", path.c_str());
+		return;
+	}
+
+	header.ident = PAK_INDEX_IDENT;
+	header.version = PAK_INDEX_VERSION;
+	header.hashSize = FILE_HASH_SIZE;
+	header.numPaks = 0;
+
+	for (loop = searchPaths; loop; loop == searchPaths ? loop = addonPaks : loop = NULL) {
+		for (sp = loop; sp; sp = sp->next) {
+			if (sp->pack && !sp->pack->isNew) {
+				header.numPaks++;
+			}
+		}
+	}
+
+	fwrite(&header, sizeof(header), 1, f);
+
+	for (loop = searchPaths; loop; loop == searchPaths ? loop = addonPaks : loop = NULL) {
+		for (sp = loop; sp; sp = sp->next) {
+			pak = sp->pack;
+
+			if (!pak || pak->isNew) {
+				continue;
+			}
+
+			pathPad = ((pak->pakFilename.Length() + 1 + 3) & ~3) - pak->pakFilename.Length() - 1;
+			namesPad = ((pak->nameBufferLength + 3) & ~3) - pak->nameBufferLength;
+
+			record.pathLength = pak->pakFilename.Length();
+			record.length = pak->length;
+			record.timestamp = (int)pak->timestamp;
+			record.checksum = pak->checksum;
+			record.numFiles = pak->numfiles;
+			record.namesLength = pak->nameBufferLength;
+			record.recordLength = sizeof(record) + record.pathLength + 1 + pathPad +
+			                      record.numFiles * sizeof(indexFile) + record.namesLength + namesPad;
+
+			fwrite(&record, sizeof(record), 1, f);
+			fwrite(pak->pakFilename.c_str(), pak->pakFilename.Length() + 1, 1, f);
+			fwrite(pad, pathPad, 1, f);
+
+			for (i = 0; i < pak->numfiles; i++) {
+				indexFile.pos = pak->buildBuffer[i].pos;
+				indexFile.hash = HashFileName(pak->buildBuffer[i].name);
+				indexFile.nameOffset = pak->buildBuffer[i].name - pak->nameBuffer;
+				indexFile.nameLength = pak->buildBuffer[i].nameLength;
+				fwrite(&indexFile, sizeof(indexFile), 1, f);
+			}
+
+			fwrite(pak->nameBuffer, pak->nameBufferLength, 1, f);
+			fwrite(pad, namesPad, 1, f);
+		}
+	}
+
+	fclose(f);
+
+	common->DPrintf("wrote %s with %d paks\n", PAK_INDEX_FILE, header.numPaks);
+}
+
+/*
+===============
+idFileSystemLocal::AddZipFile
+adds a downloaded pak file to the list so we can work out what we have and what we still need
+the isNew flag is set to true, indicating that we cannot add this pak to the search lists without a restart
+===============
+*/
+int idFileSystemLocal::AddZipFile(const char *path)
+{
+	idStr			fullpath = fs_savepath.GetString();
+	pack_t			*pak;
+	searchpath_t	*search, *last;
+
+	fullpath.AppendPath(path);
+	pak = LoadZipFile(fullpath);
+
+	if (!pak) {
+		common->Warning("AddZipFile %s failed\n", path);
+		return 0;
+	}
+
+	// insert the pak at the end of the search list - temporary until we restart
+	pak->isNew = true;
+	search = new searchpath_t;
+	search->dir = NULL;
+	search->pack = pak;
+	search->next = NULL;
+	last = searchPaths;
+
+	while (last->next) {
+		last = last->next;
+	}
+
+	last->next = search;
+	common->Printf("Appended pk4 %s with checksum 0x%x\n", pak->pakFilename.c_str(), pak->checksum);
+	return pak->checksum;
+}
+
+/*
+===============
+idFileSystemLocal::AddUnique
+===============
+*/
+int idFileSystemLocal::AddUnique(const char *name, idStrList &list, idHashIndex &hashIndex) const
+{
+	int i, hashKey;
+
+	hashKey = hashIndex.GenerateKey(name);
+
+	for (i = hashIndex.First(hashKey); i >= 0; i = hashIndex.Next(i)) {
+		if (list[i].Icmp(name) == 0) {
+			return i;
+		}
+	}
+
+	i = list.Append(name);
+	hashIndex.Add(hashKey, i);
+	return i;
 }
 
 /*
@@ -1703,7 +2232,7 @@ int idFileSystemLocal::GetFileList(const char *relativePath, const idStrList &ex
 
 			for (i = 0; i < pak->numfiles; i++) {
 
-				length = buildBuffer[i].name.Length();
+				length = buildBuffer[i].nameLength;
 
 				// if the name is not long anough to at least contain the path
 				if (length <= pathLength) {
@@ -2456,6 +2985,9 @@ void idFileSystemLocal::Startup(void)
 		common->Printf("restarting filesystem with %d addon pak file(s) to include\n", addonChecksums.Num());
 	}
 
+	// the pak directories are taken from the index when the paks didn't change
+	LoadPakIndex();
+
 	SetupGameDirectories(BASE_GAMEDIR);
 
 	// fs_game_base override
@@ -2534,6 +3066,13 @@ void idFileSystemLocal::Startup(void)
 	assert(!addonChecksums.Num());
 	addonChecksums.Clear();	// just in case
 
+	if (pakIndexDirty) {
+		WritePakIndex();
+		pakIndexDirty = false;
+	}
+
+	FreePakIndex();
+
 	if (restartChecksums.Num()) {
 		search = &searchPaths;
 
@@ -3207,6 +3746,9 @@ void idFileSystemLocal::Init(void)
 	// spawn a thread to handle background file reads
 	StartBackgroundDownloadThread();
 
+	// and one for the async read queue
+	StartAsyncReadThread();
+
 	// if we can't find default.cfg, assume that the paths are
 	// busted and error out now, rather than getting an unreadable
 	// graphics screen when the font fails to load
@@ -3250,6 +3792,9 @@ void idFileSystemLocal::Shutdown(bool reloading)
 {
 	searchpath_t *sp, *next, *loop;
 
+	// finish the reads before the files and paks go away
+	ShutdownAsyncReads();
+
 	gameFolder.Clear();
 
 	serverPaks.Clear();
@@ -3272,7 +3817,9 @@ void idFileSystemLocal::Shutdown(bool reloading)
 
 			if (sp->pack) {
 				unzClose(sp->pack->handle);
+				Sys_UnmapFile(sp->pack->mappedData, sp->pack->mappedLength);
 				delete [] sp->pack->buildBuffer;
+				delete [] sp->pack->nameBuffer;
 
 				if (sp->pack->addon_info) {
 					sp->pack->addon_info->mapDecls.DeleteContents(true);
@@ -3398,7 +3945,7 @@ pureStatus_t idFileSystemLocal::GetPackStatus(pack_t *pak)
 
 		while (file) {
 			abrt = true;
-			l = file->name.Length();
+			l = file->nameLength;
 
 			for (int j = 0; pureExclusions[j].func != NULL; j++) {
 				if (pureExclusions[j].func(pureExclusions[j], l, file->name)) {
@@ -3408,7 +3955,7 @@ pureStatus_t idFileSystemLocal::GetPackStatus(pack_t *pak)
 			}
 
 			if (abrt) {
-				common->DPrintf("pak '%s' candidate for pure: '%s'\n", pak->pakFilename.c_str(), file->name.c_str());
+				common->DPrintf("pak '%s' candidate for pure: '%s'\n", pak->pakFilename.c_str(), file->name);
 				break;
 			}
 
@@ -3474,6 +4021,78 @@ idFile_InZip *idFileSystemLocal::ReadFileFromZip(pack_t *pak, fileInPack_t *pakF
 	return file;
 }
 
+/*
+===========
+idFileSystemLocal::ViewFileFromZip
+
+Returns a read-only view on the mapped pak for files that are stored
+without compression, NULL if the file has to be decompressed.
+===========
+*/
+idFile_InZipView *idFileSystemLocal::ViewFileFromZip(pack_t *pak, fileInPack_t *pakFile, const char *relativePath)
+{
+	unz_s 			*zi;
+	const byte		*localHeader;
+	unsigned long	offset;
+	int				size;
+
+	if (!pak->mappedData) {
+		return NULL;
+	}
+
+	// set the file position in the zip file (also sets the current file info)
+	unzSetCurrentFileInfoPosition(pak->handle, pakFile->pos);
+	zi = (unz_s *)pak->handle;
+
+	// encrypted files have bit 0 set
+	if (zi->cur_file_info.compression_method != 0 || (zi->cur_file_info.flag & 1)) {
+		return NULL;
+	}
+
+	size = zi->cur_file_info.uncompressed_size;
+	offset = zi->byte_before_the_zipfile + zi->cur_file_info_internal.offset_curfile;
+
+	if (offset + ZIP_LOCAL_HEADER_SIZE > (unsigned long)pak->mappedLength) {
+		return NULL;
+	}
+
+	// the local header has its own file name and extra field lengths
+	localHeader = pak->mappedData + offset;
+
+	if (localHeader[0] != 0x50 || localHeader[1] != 0x4b || localHeader[2] != 0x03 || localHeader[3] != 0x04) {
+		return NULL;
+	}
+
+	offset += ZIP_LOCAL_HEADER_SIZE + (localHeader[26] | (localHeader[27] << 8)) + (localHeader[28] | (localHeader[29] << 8));
+
+	if (offset + size > (unsigned long)pak->mappedLength) {
+		return NULL;
+	}
+
+	idFile_InZipView *file = new idFile_InZipView();
+	file->name = relativePath;
+	file->fullPath = pak->pakFilename + "/" + relativePath;
+	file->data = pak->mappedData + offset;
+	file->fileSize = size;
+	return file;
+}
+
+/*
+===========
+idFileSystemLocal::OpenFileFromZip
+===========
+*/
+idFile *idFileSystemLocal::OpenFileFromZip(pack_t *pak, fileInPack_t *pakFile, const char *relativePath)
+{
+	idFile_InZipView *view = ViewFileFromZip(pak, pakFile, relativePath);
+
+	if (view) {
+		return view;
+	}
+
+	return ReadFileFromZip(pak, pakFile, relativePath);
+}
+
 /*
 ===========
 idFileSystemLocal::OpenFileReadFlags
@@ -3693,7 +4312,7 @@ idFile *idFileSystemLocal::OpenFileReadFlags(const char *relativePath, int searc
 			for (pakFile = pak->hashTable[hash]; pakFile; pakFile = pakFile->next) {
 				// case and separator insensitive comparisons
 				if (!FilenameCompare(pakFile->name, relativePath)) {
-					idFile_InZip *file = ReadFileFromZip(pak, pakFile, relativePath);
+					idFile *file = OpenFileFromZip(pak, pakFile, relativePath);
 
 					if (foundInPak) {
 						*foundInPak = pak;
@@ -3726,7 +4345,7 @@ idFile *idFileSystemLocal::OpenFileReadFlags(const char *relativePath, int searc
 
 			for (pakFile = pak->hashTable[hash]; pakFile; pakFile = pakFile->next) {
 				if (!FilenameCompare(pakFile->name, relativePath)) {
-					idFile_InZip *file = ReadFileFromZip(pak, pakFile, relativePath);
+					idFile *file = OpenFileFromZip(pak, pakFile, relativePath);
 
 					if (foundInPak) {
 						*foundInPak = pak;
@@ -4208,6 +4827,409 @@ void idFileSystemLocal::BackgroundDownload(backgroundDownload_t *bgl)
 	}
 }
 
+/*
+===================
+AsyncReadThread
+
+Services the async read queue, one file at a time.
+===================
+*/
+void *AsyncReadThread(void *parms)
+{
+	asyncRead_t	*batch[MAX_ASYNC_READ_BATCH];
+	int			i, numReads;
+
+	while (1) {
+		Sys_EnterCriticalSection(CRITICAL_SECTION_TWO);
+		numReads = fileSystemLocal.DequeueAsyncReads(batch);
+		Sys_LeaveCriticalSection(CRITICAL_SECTION_TWO);
+
+		if (!numReads) {
+			Sys_WaitForEvent(TRIGGER_EVENT_TWO);
+			continue;
+		}
+
+		for (i = 0; i < numReads; i++) {
+			idFileSystemLocal::ServiceAsyncRead(batch[i]);
+		}
+
+		// release the file before the reads are flagged done, the caller may close it right after
+		Sys_EnterCriticalSection(CRITICAL_SECTION_TWO);
+
+		for (i = 0; i < numReads; i++) {
+			batch[i]->file->numReads--;
+		}
+
+		Sys_LeaveCriticalSection(CRITICAL_SECTION_TWO);
+
+		for (i = 0; i < numReads; i++) {
+			batch[i]->status = (batch[i]->bytesRead == batch[i]->length) ? ASYNC_READ_DONE : ASYNC_READ_FAILED;
+
+			if (batch[i]->callback) {
+				batch[i]->callback(batch[i]);
+			}
+		}
+
+		Sys_TriggerEvent(TRIGGER_EVENT_THREE);
+	}
+
+	return NULL;
+}
+
+/*
+=================
+idFileSystemLocal::StartAsyncReadThread
+=================
+*/
+void idFileSystemLocal::StartAsyncReadThread(void)
+{
+	if (!asyncReadThread.threadHandle) {
+		Sys_CreateThread(AsyncReadThread, NULL, THREAD_NORMAL, asyncReadThread, "asyncRead", g_threads, &g_thread_count);
+
+		if (!asyncReadThread.threadHandle) {
+			common->Warning("idFileSystemLocal::StartAsyncReadThread: failed");
+		}
+	}
+}
+
+/*
+=================
+idFileSystemLocal::DequeueAsyncReads
+
+Takes the oldest read with the highest priority off the queue, along with
+the other queued reads of the same file sorted by offset, so the file is
+read in a single forward pass. Called with the async read lock held.
+=================
+*/
+int idFileSystemLocal::DequeueAsyncReads(asyncRead_t *batch[MAX_ASYNC_READ_BATCH])
+{
+	asyncRead_t	*read, *best, **prev;
+	int			i, j, numReads;
+
+	best = NULL;
+
+	for (read = asyncReads; read; read = read->next) {
+		if (!best || read->priority > best->priority) {
+			best = read;
+		}
+	}
+
+	if (!best) {
+		return 0;
+	}
+
+	numReads = 0;
+
+	for (prev = &asyncReads; *prev;) {
+		read = *prev;
+
+		if (read->file == best->file && (read == best || numReads < MAX_ASYNC_READ_BATCH - 1)) {
+			*prev = read->next;
+			read->next = NULL;
+			read->status = ASYNC_READ_INPROGRESS;
+			batch[numReads++] = read;
+		} else {
+			prev = &read->next;
+		}
+	}
+
+	// insertion sort on the offset, batches are small
+	for (i = 1; i < numReads; i++) {
+		read = batch[i];
+
+		for (j = i; j > 0 && batch[j - 1]->offset > read->offset; j--) {
+			batch[j] = batch[j - 1];
+		}
+
+		batch[j] = read;
+	}
+
+	return numReads;
+}
+
+/*
+=================
+idFileSystemLocal::ServiceAsyncRead
+
+Runs on the I/O thread. Compressed pak files have their own zip handle per
+idFile, so inflating them here doesn't race the main thread.
+=================
+*/
+void idFileSystemLocal::ServiceAsyncRead(asyncRead_t *read)
+{
+	asyncReadFile_t	*file = read->file;
+	int				length;
+
+	read->bytesRead = 0;
+
+	if (read->offset < 0 || read->offset > file->length) {
+		return;
+	}
+
+	length = Min(read->length, file->length - read->offset);
+
+	if (file->data) {
+		memcpy(read->buffer, file->data + read->offset, length);
+		read->bytesRead = length;
+		return;
+	}
+
+	if (!file->fp) {
+		// compressed pak files, seeks forward within the batch only inflate the gap
+		if (file->f->Seek(read->offset, FS_SEEK_SET) == 0) {
+			read->bytesRead = file->f->Read(read->buffer, length);
+		}
+
+		return;
+	}
+
+	// reads following each other in the batch don't need a seek
+	if (ftell(file->fp) != read->offset && fseek(file->fp, read->offset, SEEK_SET) != 0) {
+		return;
+	}
+
+	read->bytesRead = fread(read->buffer, 1, length, file->fp);
+}
+
+/*
+=================
+idFileSystemLocal::GetAsyncReadFile
+
+Finds the file for the read, opens it if needed.
+=================
+*/
+asyncReadFile_t *idFileSystemLocal::GetAsyncReadFile(const asyncRead_t *read)
+{
+	asyncReadFile_t		*file;
+	idFile_InZipView	*view;
+	idFile_Permanent	*permanent;
+	idFile 				*f;
+
+	Sys_EnterCriticalSection(CRITICAL_SECTION_TWO);
+
+	for (file = asyncReadFiles; file; file = file->next) {
+		if (read->f) {
+			// files of the caller are only known while they have reads, the pointer may be reused afterwards
+			if (file->f == read->f && file->numReads > 0) {
+				break;
+			}
+		} else if (file->ownsFile && !FilenameCompare(file->relativePath, read->relativePath)) {
+			break;
+		}
+	}
+
+	Sys_LeaveCriticalSection(CRITICAL_SECTION_TWO);
+
+	if (file) {
+		return file;
+	}
+
+	f = read->f ? read->f : OpenFileRead(read->relativePath);
+
+	if (!f) {
+		return NULL;
+	}
+
+	file = new asyncReadFile_t;
+	file->relativePath = read->f ? "" : read->relativePath;
+	file->f = f;
+	file->ownsFile = (read->f == NULL);
+	file->fp = NULL;
+	file->data = NULL;
+	file->length = f->Length();
+	file->numReads = 0;
+
+	if ((view = dynamic_cast<idFile_InZipView *>(f)) != NULL) {
+		file->data = view->GetDataPtr();
+	} else if ((permanent = dynamic_cast<idFile_Permanent *>(f)) != NULL) {
+		file->fp = permanent->GetFilePtr();
+	}
+
+	Sys_EnterCriticalSection(CRITICAL_SECTION_TWO);
+	file->next = asyncReadFiles;
+	asyncReadFiles = file;
+	Sys_LeaveCriticalSection(CRITICAL_SECTION_TWO);
+
+	return file;
+}
+
+/*
+=================
+idFileSystemLocal::CloseAsyncReadFiles
+
+Closes the files that have no reads left, called from the main thread.
+=================
+*/
+void idFileSystemLocal::CloseAsyncReadFiles(void)
+{
+	asyncReadFile_t	*file, **prev, *closed;
+
+	closed = NULL;
+
+	Sys_EnterCriticalSection(CRITICAL_SECTION_TWO);
+
+	for (prev = &asyncReadFiles; *prev;) {
+		file = *prev;
+
+		if (file->numReads == 0) {
+			*prev = file->next;
+			file->next = closed;
+			closed = file;
+		} else {
+			prev = &file->next;
+		}
+	}
+
+	Sys_LeaveCriticalSection(CRITICAL_SECTION_TWO);
+
+	while (closed) {
+		file = closed;
+		closed = closed->next;
+
+		if (file->ownsFile) {
+			CloseFile(file->f);
+		}
+
+		delete file;
+	}
+}
+
+/*
+=================
+idFileSystemLocal::AsyncRead
+=================
+*/
+void idFileSystemLocal::AsyncRead(asyncRead_t *read)
+{
+	asyncReadFile_t *file;
+	asyncRead_t		**last;
+
+	read->status = ASYNC_READ_QUEUED;
+	read->bytesRead = 0;
+	read->next = NULL;
+
+	file = GetAsyncReadFile(read);
+
+	if (!file) {
+		read->status = ASYNC_READ_FAILED;
+
+		if (read->callback) {
+			read->callback(read);
+		}
+
+		return;
+	}
+
+	read->file = file;
+
+	Sys_EnterCriticalSection(CRITICAL_SECTION_TWO);
+
+	file->numReads++;
+
+	for (last = &asyncReads; *last; last = &(*last)->next) {
+	}
+
+	*last = read;
+
+	Sys_LeaveCriticalSection(CRITICAL_SECTION_TWO);
+
+	Sys_TriggerEvent(TRIGGER_EVENT_TWO);
+
+	CloseAsyncReadFiles();
+}
+
+/*
+=================
+idFileSystemLocal::CancelAsyncRead
+=================
+*/
+bool idFileSystemLocal::CancelAsyncRead(asyncRead_t *read)
+{
+	asyncRead_t **prev;
+	bool		cancelled;
+
+	cancelled = false;
+
+	Sys_EnterCriticalSection(CRITICAL_SECTION_TWO);
+
+	for (prev = &asyncReads; *prev; prev = &(*prev)->next) {
+		if (*prev == read) {
+			*prev = read->next;
+			read->next = NULL;
+			read->file->numReads--;
+			read->status = ASYNC_READ_CANCELLED;
+			cancelled = true;
+			break;
+		}
+	}
+
+	Sys_LeaveCriticalSection(CRITICAL_SECTION_TWO);
+
+	CloseAsyncReadFiles();
+
+	return cancelled;
+}
+
+/*
+=================
+idFileSystemLocal::WaitAsyncRead
+=================
+*/
+void idFileSystemLocal::WaitAsyncRead(asyncRead_t *read)
+{
+	while (read->status == ASYNC_READ_QUEUED || read->status == ASYNC_READ_INPROGRESS) {
+		Sys_WaitForEvent(TRIGGER_EVENT_THREE);
+	}
+
+	CloseAsyncReadFiles();
+}
+
+/*
+=================
+idFileSystemLocal::ShutdownAsyncReads
+
+Cancels the queued reads and waits for the ones in progress.
+=================
+*/
+void idFileSystemLocal::ShutdownAsyncReads(void)
+{
+	asyncRead_t		*read;
+	asyncReadFile_t	*file;
+	bool			busy;
+
+	Sys_EnterCriticalSection(CRITICAL_SECTION_TWO);
+
+	for (read = asyncReads; read; read = read->next) {
+		read->file->numReads--;
+		read->status = ASYNC_READ_CANCELLED;
+	}
+
+	asyncReads = NULL;
+
+	Sys_LeaveCriticalSection(CRITICAL_SECTION_TWO);
+
+	do {
+		busy = false;
+
+		Sys_EnterCriticalSection(CRITICAL_SECTION_TWO);
+
+		for (file = asyncReadFiles; file; file = file->next) {
+			if (file->numReads > 0) {
+				busy = true;
+				break;
+			}
+		}
+
+		Sys_LeaveCriticalSection(CRITICAL_SECTION_TWO);
+
+		if (busy) {
+			Sys_WaitForEvent(TRIGGER_EVENT_THREE);
+		}
+	} while (busy);
+
+	CloseAsyncReadFiles();
+}
+
 /*
 =================
 idFileSystemLocal::PerformingCopyFiles
@@ -118,6 +118,40 @@ typedef struct backgroundDownload_s {
 	volatile bool		completed;
 } backgroundDownload_t;
 
+typedef enum {
+	ASYNC_READ_PRIORITY_LOW,		// precaching that can wait
+	ASYNC_READ_PRIORITY_NORMAL,
+	ASYNC_READ_PRIORITY_HIGH		// data that is needed right away
+} asyncReadPriority_t;
+
+typedef enum {
+	ASYNC_READ_QUEUED,
+	ASYNC_READ_INPROGRESS,
+	ASYNC_READ_DONE,
+	ASYNC_READ_FAILED,
+	ASYNC_READ_CANCELLED
+} asyncReadStatus_t;
+
+// called from the file system I/O thread once the read is done or failed
+// it must not allocate memory or use any of the engine systems
+typedef void (*asyncReadCallback_t)(struct asyncRead_s *read);
+
+typedef struct asyncRead_s {
+	const char 			*relativePath;	// file opened by the file system, only used when f is NULL
+	idFile 				*f;				// already opened file, not to be used by the caller until the read is done
+	int					offset;
+	int					length;
+	void 				*buffer;		// caller buffer for length bytes
+	asyncReadPriority_t	priority;
+	asyncReadCallback_t	callback;		// may be NULL
+	void 				*userData;
+
+	volatile asyncReadStatus_t	status;	// set by the fileSystem
+	volatile int		bytesRead;		// set by the fileSystem
+	struct asyncReadFile_s	*file;		// set by the fileSystem
+	struct asyncRead_s	*next;			// set by the fileSystem
+} asyncRead_t;
+
 // file list for directory listings
 class idFileList
 {
@@ -299,6 +333,22 @@ class idFileSystem
 
 		// ignore case and seperator char distinctions
 		virtual bool			FilenameCompare(const char *s1, const char *s2) const = 0;
+
+		// Like ReadFile, but files stored uncompressed in a pak are returned as a pointer into the
+		// memory mapped pak without any copy. The data is read-only and NOT 0 terminated.
+		// Other files are loaded into a buffer, so FreeFileView has to be called in all cases.
+		virtual int				ReadFileView(const char *relativePath, const void **buffer, ID_TIME_T *timestamp = NULL) = 0;
+		// Releases the data returned by ReadFileView.
+		virtual void			FreeFileView(const void *buffer) = 0;
+
+		// Queues a read that is serviced by the file system I/O thread in priority order. Queued reads
+		// of the same file are serviced together in offset order, compressed pak files are inflated
+		// on the I/O thread as well.
+		virtual void			AsyncRead(asyncRead_t *read) = 0;
+		// Returns true if the read was still queued and is cancelled, false if it already started.
+		virtual bool			CancelAsyncRead(asyncRead_t *read) = 0;
+		// Blocks until the read is done, failed or cancelled. Only the main thread can wait.
+		virtual void			WaitAsyncRead(asyncRead_t *read) = 0;
 };
 
 extern idFileSystem 		*fileSystem;
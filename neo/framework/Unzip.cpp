@@ -652,6 +652,17 @@ int inflateSync OF((z_streamp strm));
   until success or end of the input data.
 */
 
+int inflateCopy OF((z_streamp dest, z_streamp source));
+/*
+     Sets the destination stream as a complete copy of the source stream,
+   including the sliding window and any partially decoded block. The copy
+   can be used to resume decompression from the same point later on. The
+   input and output pointers are copied as is.
+
+     inflateCopy returns Z_OK if success, Z_MEM_ERROR if there was not
+   enough memory, Z_STREAM_ERROR if the source stream state was inconsistent.
+*/
+
 int inflateReset OF((z_streamp strm));
 /*
      This function is equivalent to inflateEnd followed by inflateInit,
@@ -2251,6 +2262,126 @@ extern int unzCloseCurrentFile(unzFile file)
 }
 
 
+/*
+  Checkpoints of the current file read state.
+  The compressed input that was read ahead is not kept, the zip file is read
+  again from the position of the first unused byte on restore.
+*/
+typedef struct {
+	file_in_zip_read_info_s info;   /* copy of the read state, read_buffer and file are not used */
+} unz_checkpoint_s;
+
+extern unzCheckpoint unzSaveCheckpoint(unzFile file)
+{
+	unz_s *s;
+	file_in_zip_read_info_s *pfile_in_zip_read_info;
+	unz_checkpoint_s *checkpoint;
+
+	if (file==NULL)
+		return NULL;
+
+	s=(unz_s *)file;
+	pfile_in_zip_read_info=s->pfile_in_zip_read;
+
+	if (pfile_in_zip_read_info==NULL)
+		return NULL;
+
+	checkpoint = (unz_checkpoint_s *)ALLOC(sizeof(unz_checkpoint_s));
+
+	if (checkpoint==NULL)
+		return NULL;
+
+	checkpoint->info = *pfile_in_zip_read_info;
+	checkpoint->info.read_buffer = NULL;
+	checkpoint->info.file = NULL;
+
+	if (pfile_in_zip_read_info->stream_initialised) {
+		if (inflateCopy(&checkpoint->info.stream, &pfile_in_zip_read_info->stream) != Z_OK) {
+			TRYFREE(checkpoint);
+			return NULL;
+		}
+	}
+
+	/* give back the input that was read ahead, it is read again on restore */
+	checkpoint->info.pos_in_zipfile -= pfile_in_zip_read_info->stream.avail_in;
+	checkpoint->info.rest_read_compressed += pfile_in_zip_read_info->stream.avail_in;
+	checkpoint->info.stream.next_in = NULL;
+	checkpoint->info.stream.avail_in = 0;
+
+	return checkpoint;
+}
+
+extern int unzRestoreCheckpoint(unzFile file, unzCheckpoint checkpoint)
+{
+	unz_s *s;
+	file_in_zip_read_info_s *pfile_in_zip_read_info;
+	unz_checkpoint_s *cp;
+	char *read_buffer;
+	FILE *fin;
+
+	if (file==NULL || checkpoint==NULL)
+		return UNZ_PARAMERROR;
+
+	s=(unz_s *)file;
+	cp=(unz_checkpoint_s *)checkpoint;
+	pfile_in_zip_read_info=s->pfile_in_zip_read;
+
+	if (pfile_in_zip_read_info==NULL)
+		return UNZ_PARAMERROR;
+
+	if (pfile_in_zip_read_info->stream_initialised)
+		inflateEnd(&pfile_in_zip_read_info->stream);
+
+	read_buffer = pfile_in_zip_read_info->read_buffer;
+	fin = pfile_in_zip_read_info->file;
+
+	*pfile_in_zip_read_info = cp->info;
+	pfile_in_zip_read_info->read_buffer = read_buffer;
+	pfile_in_zip_read_info->file = fin;
+	pfile_in_zip_read_info->stream_initialised = 0;
+
+	if (cp->info.stream_initialised) {
+		if (inflateCopy(&pfile_in_zip_read_info->stream, &cp->info.stream) != Z_OK)
+			return UNZ_INTERNALERROR;
+
+		pfile_in_zip_read_info->stream_initialised = 1;
+	}
+
+	pfile_in_zip_read_info->stream.next_in = (Byte *)read_buffer;
+	pfile_in_zip_read_info->stream.avail_in = 0;
+
+	/* the read loop only seeks before the first read of the file */
+	if (fseek(fin, pfile_in_zip_read_info->pos_in_zipfile +
+	          pfile_in_zip_read_info->byte_before_the_zipfile, SEEK_SET)!=0)
+		return UNZ_ERRNO;
+
+	return UNZ_OK;
+}
+
+extern long unzCheckpointTell(unzCheckpoint checkpoint)
+{
+	if (checkpoint==NULL)
+		return UNZ_PARAMERROR;
+
+	return (long)((unz_checkpoint_s *)checkpoint)->info.stream.total_out;
+}
+
+extern void unzFreeCheckpoint(unzCheckpoint checkpoint)
+{
+	unz_checkpoint_s *cp;
+
+	if (checkpoint==NULL)
+		return;
+
+	cp=(unz_checkpoint_s *)checkpoint;
+
+	if (cp->info.stream_initialised)
+		inflateEnd(&cp->info.stream);
+
+	TRYFREE(cp);
+}
+
+
 /*
   Get the global comment string of the ZipFile, in the szComment buffer.
   uSizeBuf is the size of the szComment buffer.
@@ -4625,6 +4756,87 @@ int inflateSyncPoint(z_streamp z)
 	return inflate_blocks_sync_point(z->state->blocks);
 }
 
+/* relocates a pointer into the source hufts to the copied hufts, static fixed trees are kept */
+#define HUFT_RELOCATE(p) ((p) >= s->hufts && (p) < s->hufts + MANY ? c->hufts + ((p) - s->hufts) : (p))
+
+int inflateCopy(z_streamp dest, z_streamp source)
+{
+	struct internal_state *copy;
+	inflate_blocks_statef *s, *c;
+	inflate_codes_statef *codes;
+	uInt t;
+
+	if (dest == Z_NULL || source == Z_NULL || source->state == Z_NULL || source->state->blocks == Z_NULL)
+		return Z_STREAM_ERROR;
+
+	s = source->state->blocks;
+	*dest = *source;
+	dest->state = Z_NULL;
+
+	if ((copy = (struct internal_state *)ZALLOC(source, 1, sizeof(struct internal_state))) == Z_NULL)
+		return Z_MEM_ERROR;
+
+	*copy = *source->state;
+	copy->blocks = Z_NULL;
+	dest->state = copy;
+
+	if ((c = (inflate_blocks_statef *)ZALLOC(source, 1, sizeof(struct inflate_blocks_state))) == Z_NULL) {
+		inflateEnd(dest);
+		return Z_MEM_ERROR;
+	}
+
+	*c = *s;
+	c->mode = TYPE;     /* nothing to free in the copy until it is complete */
+	c->hufts = (inflate_huft *)ZALLOC(source, sizeof(inflate_huft), MANY);
+	c->window = (Byte *)ZALLOC(source, 1, (uInt)(s->end - s->window));
+
+	if (c->hufts == Z_NULL || c->window == Z_NULL) {
+		TRY_FREE(source, c->hufts);
+		TRY_FREE(source, c->window);
+		ZFREE(source, c);
+		inflateEnd(dest);
+		return Z_MEM_ERROR;
+	}
+
+	copy->blocks = c;
+	zmemcpy(c->hufts, s->hufts, sizeof(inflate_huft) * MANY);
+	zmemcpy(c->window, s->window, (uInt)(s->end - s->window));
+	c->end = c->window + (s->end - s->window);
+	c->read = c->window + (s->read - s->window);
+	c->write = c->window + (s->write - s->window);
+
+	if (s->mode == BTREE || s->mode == DTREE) {
+		t = 258 + (s->sub.trees.table & 0x1f) + ((s->sub.trees.table >> 5) & 0x1f);
+
+		if ((c->sub.trees.blens = (uInt *)ZALLOC(source, t, sizeof(uInt))) == Z_NULL) {
+			inflateEnd(dest);
+			return Z_MEM_ERROR;
+		}
+
+		zmemcpy(c->sub.trees.blens, s->sub.trees.blens, t * sizeof(uInt));
+		c->sub.trees.tb = HUFT_RELOCATE(s->sub.trees.tb);
+	} else if (s->mode == CODES) {
+		if ((codes = (inflate_codes_statef *)ZALLOC(source, 1, sizeof(struct inflate_codes_state))) == Z_NULL) {
+			inflateEnd(dest);
+			return Z_MEM_ERROR;
+		}
+
+		*codes = *s->sub.decode.codes;
+		codes->ltree = HUFT_RELOCATE(codes->ltree);
+		codes->dtree = HUFT_RELOCATE(codes->dtree);
+
+		if (codes->mode == LEN || codes->mode == DIST)
+			codes->sub.code.tree = HUFT_RELOCATE(codes->sub.code.tree);
+
+		c->sub.decode.codes = codes;
+	}
+
+	c->mode = s->mode;
+	return Z_OK;
+}
+
+#undef HUFT_RELOCATE
+
 voidp zcalloc(voidp opaque, unsigned items, unsigned size)
 {
 	if (opaque) items += size - size; /* make compiler happy */
@@ -339,4 +339,35 @@ extern int unzGetLocalExtrafield(unzFile file, void *buf, unsigned len);
 	the error code
 */
 
+typedef void *unzCheckpoint;
+
+extern unzCheckpoint unzSaveCheckpoint(unzFile file);
+
+/*
+  Save the complete read and decompression state of the current file.
+  Reading can later continue from this point with unzRestoreCheckpoint,
+  which is a lot faster than decompressing from the start of the file.
+  return NULL if there is no current file or not enough memory
+*/
+
+extern int unzRestoreCheckpoint(unzFile file, unzCheckpoint checkpoint);
+
+/*
+  Continue reading the current file from a checkpoint saved for the same
+  file in the zip. The file must be open with unzOpenCurrentFile.
+  return UNZ_OK if there is no problem
+*/
+
+extern long unzCheckpointTell(unzCheckpoint checkpoint);
+
+/*
+  Give the position in uncompressed data of the checkpoint
+*/
+
+extern void unzFreeCheckpoint(unzCheckpoint checkpoint);
+
+/*
+  Free a checkpoint returned by unzSaveCheckpoint
+*/
+
 #endif /* __UNZIP_H__ */
@@ -657,10 +657,7 @@ void idAsyncClient::SendEmptyToServer(bool force, bool mapLoad)
 	}
 
 	msg.Init(msgBuf, sizeof(msgBuf));
-	msg.WriteLong(serverMessageSequence);
-	msg.WriteLong(mapLoad ? GAME_INIT_ID_MAP_LOAD : gameInitId);
-	msg.WriteLong(snapshotSequence);
-	msg.WriteByte(CLIENT_UNRELIABLE_MESSAGE_EMPTY);
+	idAsyncNetwork::WriteUnreliableHeader(msg, serverMessageSequence, mapLoad ? GAME_INIT_ID_MAP_LOAD : gameInitId, snapshotSequence, CLIENT_UNRELIABLE_MESSAGE_EMPTY);
 
 	channel.SendMessage(clientPort, clientTime, msg);
 
@@ -686,10 +683,7 @@ void idAsyncClient::SendPingResponseToServer(int time)
 	}
 
 	msg.Init(msgBuf, sizeof(msgBuf));
-	msg.WriteLong(serverMessageSequence);
-	msg.WriteLong(gameInitId);
-	msg.WriteLong(snapshotSequence);
-	msg.WriteByte(CLIENT_UNRELIABLE_MESSAGE_PINGRESPONSE);
+	idAsyncNetwork::WriteUnreliableHeader(msg, serverMessageSequence, gameInitId, snapshotSequence, CLIENT_UNRELIABLE_MESSAGE_PINGRESPONSE);
 	msg.WriteLong(time);
 
 	channel.SendMessage(clientPort, clientTime, msg);
@@ -706,10 +700,9 @@ idAsyncClient::SendUsercmdsToServer
 */
 void idAsyncClient::SendUsercmdsToServer(void)
 {
-	int			i, numUsercmds, index;
+	int			numUsercmds, index;
 	idBitMsg	msg;
 	byte		msgBuf[MAX_MESSAGE_SIZE];
-	usercmd_t 	*last;
 
 	if (idAsyncNetwork::verbose.GetInteger() == 2) {
 		common->Printf("sending usercmd to server: gameInitId = %d, gameFrame = %d, gameTime = %d\n", gameInitId, gameFrame, gameTime);
@@ -723,23 +716,13 @@ void idAsyncClient::SendUsercmdsToServer(void)
 
 	// send the user commands to the server
 	msg.Init(msgBuf, sizeof(msgBuf));
-	msg.WriteLong(serverMessageSequence);
-	msg.WriteLong(gameInitId);
-	msg.WriteLong(snapshotSequence);
-	msg.WriteByte(CLIENT_UNRELIABLE_MESSAGE_USERCMD);
+	idAsyncNetwork::WriteUnreliableHeader(msg, serverMessageSequence, gameInitId, snapshotSequence, CLIENT_UNRELIABLE_MESSAGE_USERCMD);
 	msg.WriteShort(clientPrediction);
 
 	numUsercmds = idMath::ClampInt(0, 10, idAsyncNetwork::clientUsercmdBackup.GetInteger()) + 1;
 
 	// write the user commands
-	msg.WriteLong(gameFrame);
-	msg.WriteByte(numUsercmds);
-
-	for (last = NULL, i = gameFrame - numUsercmds + 1; i <= gameFrame; i++) {
-		index = i & (MAX_USERCMD_BACKUP - 1);
-		idAsyncNetwork::WriteUserCmdDelta(msg, userCmds[index][clientNum], last);
-		last = &userCmds[index][clientNum];
-	}
+	idAsyncNetwork::WriteUserCmds(msg, gameFrame, numUsercmds, &userCmds[0][clientNum], MAX_ASYNC_CLIENTS);
 
 	channel.SendMessage(clientPort, clientTime, msg);
 
@@ -930,9 +913,6 @@ void idAsyncClient::ProcessReliableMessagePure(const idBitMsg &msg)
 {
 	idBitMsg	outMsg;
 	byte		msgBuf[ MAX_MESSAGE_SIZE ];
-	int			inChecksums[ MAX_PURE_PAKS ];
-	int			i;
-	int			gamePakChecksum;
 	int			serverGameInitId;
 
 	session->SetGUI(NULL, NULL);
@@ -957,20 +937,10 @@ void idAsyncClient::ProcessReliableMessagePure(const idBitMsg &msg)
 	sessLocal.ExecuteMapChange(true);
 
 	// upon receiving our pure list, the server will send us SCS_INGAME and we'll start getting snapshots
-	fileSystem->GetPureServerChecksums(inChecksums, -1, &gamePakChecksum);
 	outMsg.Init(msgBuf, sizeof(msgBuf));
 	outMsg.WriteByte(CLIENT_RELIABLE_MESSAGE_PURE);
-
 	outMsg.WriteLong(gameInitId);
-
-	i = 0;
-
-	while (inChecksums[ i ]) {
-		outMsg.WriteLong(inChecksums[ i++ ]);
-	}
-
-	outMsg.WriteLong(0);
-	outMsg.WriteLong(gamePakChecksum);
+	idAsyncNetwork::WritePureChecksums(outMsg);
 
 	if (!channel.SendReliableMessage(outMsg)) {
 		common->Error("client->server reliable messages overflow\n");
@@ -1205,6 +1175,11 @@ void idAsyncClient::ProcessConnectResponseMessage(const netadr_t from, const idB
 	serverGameTime = msg.ReadLong();
 	msg.ReadDeltaDict(serverSI, NULL);
 
+	// servers which do not send a channel compression only support run length compression
+	if (msg.GetRemainingReadBits() >= 8) {
+		channel.SetCompression((channelCompression_t) idMath::ClampInt(0, CHANNEL_COMPRESSION_MAX, msg.ReadByte()));
+	}
+
 	InitGame(serverGameInitId, serverGameFrame, serverGameTime, serverSI);
 
 	// load map
@@ -1605,9 +1580,6 @@ void idAsyncClient::ProcessPureMessage(const netadr_t from, const idBitMsg &msg)
 {
 	idBitMsg	outMsg;
 	byte		msgBuf[ MAX_MESSAGE_SIZE ];
-	int			i;
-	int			inChecksums[ MAX_PURE_PAKS ];
-	int			gamePakChecksum;
 
 	if (clientState != CS_CONNECTING) {
 		common->Printf("clientState != CS_CONNECTING, pure msg ignored\n");
@@ -1618,20 +1590,12 @@ void idAsyncClient::ProcessPureMessage(const netadr_t from, const idBitMsg &msg)
 		return;
 	}
 
-	fileSystem->GetPureServerChecksums(inChecksums, -1, &gamePakChecksum);
 	outMsg.Init(msgBuf, sizeof(msgBuf));
 	outMsg.WriteShort(CONNECTIONLESS_MESSAGE_ID);
 	outMsg.WriteString("pureClient");
 	outMsg.WriteLong(serverChallenge);
 	outMsg.WriteShort(clientId);
-	i = 0;
-
-	while (inChecksums[ i ]) {
-		outMsg.WriteLong(inChecksums[ i++ ]);
-	}
-
-	outMsg.WriteLong(0);
-	outMsg.WriteLong(gamePakChecksum);
+	idAsyncNetwork::WritePureChecksums(outMsg);
 	clientPort.SendPacket(from, outMsg.GetData(), outMsg.GetSize());
 }
 
@@ -1781,30 +1745,13 @@ void idAsyncClient::SetupConnection(void)
 	if (clientState == CS_CHALLENGING) {
 		common->Printf("sending challenge to %s\n", Sys_NetAdrToString(serverAddress));
 		msg.Init(msgBuf, sizeof(msgBuf));
-		msg.WriteShort(CONNECTIONLESS_MESSAGE_ID);
-		msg.WriteString("challenge");
-		msg.WriteLong(clientId);
+		idAsyncNetwork::WriteChallengeMessage(msg, clientId);
 		clientPort.SendPacket(serverAddress, msg.GetData(), msg.GetSize());
 	} else if (clientState == CS_CONNECTING) {
 		common->Printf("sending connect to %s with challenge 0x%x\n", Sys_NetAdrToString(serverAddress), serverChallenge);
 		msg.Init(msgBuf, sizeof(msgBuf));
-		msg.WriteShort(CONNECTIONLESS_MESSAGE_ID);
-		msg.WriteString("connect");
-		msg.WriteLong(ASYNC_PROTOCOL_VERSION);
-#if ID_FAKE_PURE
-		// fake win32 OS - might need to adapt depending on the case
-		msg.WriteShort(0);
-#else
-		msg.WriteShort(BUILD_OS_ID);
-#endif
-		msg.WriteLong(clientDataChecksum);
-		msg.WriteLong(serverChallenge);
-		msg.WriteShort(clientId);
-		msg.WriteLong(cvarSystem->GetCVarInteger("net_clientMaxRate"));
-		msg.WriteString(cvarSystem->GetCVarString("com_guid"));
-		msg.WriteString(cvarSystem->GetCVarString("password"), -1, false);
-		// do not make the protocol depend on PB
-		msg.WriteShort(0);
+		idAsyncNetwork::WriteConnectMessage(msg, clientDataChecksum, serverChallenge, clientId,
+		                                    cvarSystem->GetCVarInteger("net_clientMaxRate"), cvarSystem->GetCVarString("com_guid"));
 		clientPort.SendPacket(serverAddress, msg.GetData(), msg.GetSize());
 
 		if (idAsyncNetwork::LANServer.GetBool()) {
@@ -33,6 +33,7 @@ If you have questions concerning this license or the applicable additional terms
 
 idAsyncServer		idAsyncNetwork::server;
 idAsyncClient		idAsyncNetwork::client;
+idLoadTest			idAsyncNetwork::loadTest;
 
 idCVar				idAsyncNetwork::verbose("net_verbose", "0", CVAR_SYSTEM | CVAR_INTEGER | CVAR_NOCHEAT, "1 = verbose output, 2 = even more verbose output", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2>);
 idCVar				idAsyncNetwork::allowCheats("net_allowCheats", "0", CVAR_SYSTEM | CVAR_BOOL | CVAR_NETWORKSYNC, "Allow cheats in network game");
@@ -46,6 +47,8 @@ idCVar				idAsyncNetwork::serverSnapshotDelay("net_serverSnapshotDelay", "50", C
 idCVar				idAsyncNetwork::serverMaxClientRate("net_serverMaxClientRate", "16000", CVAR_SYSTEM | CVAR_INTEGER | CVAR_ARCHIVE | CVAR_NOCHEAT, "maximum rate to a client in bytes/sec");
 idCVar				idAsyncNetwork::clientMaxRate("net_clientMaxRate", "16000", CVAR_SYSTEM | CVAR_INTEGER | CVAR_ARCHIVE | CVAR_NOCHEAT, "maximum rate requested by client from server in bytes/sec");
 idCVar				idAsyncNetwork::serverMaxUsercmdRelay("net_serverMaxUsercmdRelay", "5", CVAR_SYSTEM | CVAR_INTEGER | CVAR_NOCHEAT, "maximum number of usercmds from other clients the server relays to a client", 1, MAX_USERCMD_RELAY, idCmdSystem::ArgCompletion_Integer<1,MAX_USERCMD_RELAY>);
+idCVar				idAsyncNetwork::serverParallelSnapshots("net_serverParallelSnapshots", "1", CVAR_SYSTEM | CVAR_BOOL | CVAR_NOCHEAT, "write the snapshots for all clients in parallel on the job threads");
+idCVar				idAsyncNetwork::channelCompression("net_channelCompression", "1", CVAR_SYSTEM | CVAR_INTEGER | CVAR_NOCHEAT, "best channel compression to negotiate at connect time, 0 = zero based run length, 1 = adaptive range coding", 0, CHANNEL_COMPRESSION_MAX);
 idCVar				idAsyncNetwork::serverZombieTimeout("net_serverZombieTimeout", "5", CVAR_SYSTEM | CVAR_INTEGER | CVAR_NOCHEAT, "disconnected client timeout in seconds");
 idCVar				idAsyncNetwork::serverClientTimeout("net_serverClientTimeout", "40", CVAR_SYSTEM | CVAR_INTEGER | CVAR_NOCHEAT, "client time out in seconds");
 idCVar				idAsyncNetwork::clientServerTimeout("net_clientServerTimeout", "40", CVAR_SYSTEM | CVAR_INTEGER | CVAR_NOCHEAT, "server time out in seconds");
@@ -109,6 +112,9 @@ void idAsyncNetwork::Init(void)
 	cmdSystem->AddCommand("kick", Kick_f, CMD_FL_SYSTEM, "kick a client by connection number");
 	cmdSystem->AddCommand("checkNewVersion", CheckNewVersion_f, CMD_FL_SYSTEM, "check if a new version of the game is available");
 	cmdSystem->AddCommand("updateUI", UpdateUI_f, CMD_FL_SYSTEM, "internal - cause a sync down of game-modified userinfo");
+	cmdSystem->AddCommand("loadTest", LoadTest_f, CMD_FL_SYSTEM, "connects headless clients to a server for load testing");
+	cmdSystem->AddCommand("loadTestStop", LoadTestStop_f, CMD_FL_SYSTEM, "disconnects the load test clients");
+	cmdSystem->AddCommand("testChannelCompression", idMsgChannel::TestCompression_f, CMD_FL_SYSTEM, "compresses and decompresses test buffers and the captured messages with every channel compression, \"capture\" captures the next messages sent");
 #endif
 }
 
@@ -167,6 +173,7 @@ idAsyncNetwork::Shutdown
 */
 void idAsyncNetwork::Shutdown(void)
 {
+	loadTest.Stop();
 	client.serverList.Shutdown();
 	client.DisconnectFromServer();
 	client.ClearServers();
@@ -192,6 +199,7 @@ void idAsyncNetwork::RunFrame(void)
 
 	client.RunFrame();
 	server.RunFrame();
+	loadTest.RunFrame();
 }
 
 /*
@@ -262,6 +270,103 @@ void idAsyncNetwork::ReadUserCmdDelta(const idBitMsg &msg, usercmd_t &cmd, const
 	cmd.angles[2] = msg.ReadShort();
 }
 
+/*
+==================
+idAsyncNetwork::WriteChallengeMessage
+==================
+*/
+void idAsyncNetwork::WriteChallengeMessage(idBitMsg &msg, int clientId)
+{
+	msg.WriteShort(CONNECTIONLESS_MESSAGE_ID);
+	msg.WriteString("challenge");
+	msg.WriteLong(clientId);
+}
+
+/*
+==================
+idAsyncNetwork::WriteConnectMessage
+==================
+*/
+void idAsyncNetwork::WriteConnectMessage(idBitMsg &msg, int dataChecksum, int serverChallenge, int clientId, int maxRate, const char *guid)
+{
+	msg.WriteShort(CONNECTIONLESS_MESSAGE_ID);
+	msg.WriteString("connect");
+	msg.WriteLong(ASYNC_PROTOCOL_VERSION);
+#if ID_FAKE_PURE
+	// fake win32 OS - might need to adapt depending on the case
+	msg.WriteShort(0);
+#else
+	msg.WriteShort(BUILD_OS_ID);
+#endif
+	msg.WriteLong(dataChecksum);
+	msg.WriteLong(serverChallenge);
+	msg.WriteShort(clientId);
+	msg.WriteLong(maxRate);
+	msg.WriteString(guid);
+	msg.WriteString(cvarSystem->GetCVarString("password"), -1, false);
+	// do not make the protocol depend on PB
+	msg.WriteShort(0);
+	// best channel compression we support, the server picks the one to use
+	msg.WriteByte(channelCompression.GetInteger());
+}
+
+/*
+==================
+idAsyncNetwork::WritePureChecksums
+
+  Writes the checksums of the local pure list, zero terminated, followed by the game pak checksum.
+==================
+*/
+void idAsyncNetwork::WritePureChecksums(idBitMsg &msg)
+{
+	int i, gamePakChecksum;
+	int checksums[ MAX_PURE_PAKS ];
+
+	fileSystem->GetPureServerChecksums(checksums, -1, &gamePakChecksum);
+
+	for (i = 0; checksums[ i ]; i++) {
+		msg.WriteLong(checksums[ i ]);
+	}
+
+	msg.WriteLong(0);
+	msg.WriteLong(gamePakChecksum);
+}
+
+/*
+==================
+idAsyncNetwork::WriteUnreliableHeader
+==================
+*/
+void idAsyncNetwork::WriteUnreliableHeader(idBitMsg &msg, int serverMessageSequence, int gameInitId, int snapshotSequence, int type)
+{
+	msg.WriteLong(serverMessageSequence);
+	msg.WriteLong(gameInitId);
+	msg.WriteLong(snapshotSequence);
+	msg.WriteByte(type);
+}
+
+/*
+==================
+idAsyncNetwork::WriteUserCmds
+
+  Writes the user commands of the last numUsercmds frames up to gameFrame, delta compressed.
+==================
+*/
+void idAsyncNetwork::WriteUserCmds(idBitMsg &msg, int gameFrame, int numUsercmds, const usercmd_t *cmds, int cmdStride)
+{
+	int				i;
+	const usercmd_t	*cmd, *last;
+
+	msg.WriteLong(gameFrame);
+	msg.WriteByte(numUsercmds);
+
+	for (last = NULL, i = gameFrame - numUsercmds + 1; i <= gameFrame; i++) {
+		cmd = &cmds[(i & (MAX_USERCMD_BACKUP - 1)) * cmdStride];
+		WriteUserCmdDelta(msg, *cmd, last);
+		last = cmd;
+	}
+}
+
 /*
 ==================
 idAsyncNetwork::DuplicateUsercmd
@@ -541,6 +646,45 @@ void idAsyncNetwork::UpdateUI_f(const idCmdArgs &args)
 	server.UpdateUI(clientNum);
 }
 
+/*
+==================
+idAsyncNetwork::LoadTest_f
+==================
+*/
+void idAsyncNetwork::LoadTest_f(const idCmdArgs &args)
+{
+	netadr_t	adr;
+	const char	*address;
+
+	if (args.Argc() < 2) {
+		common->Printf("USAGE: loadTest <numClients> [serverAddress] [msec between clients]\n");
+		return;
+	}
+
+	address = (args.Argc() > 2) ? args.Argv(2) : "localhost";
+
+	if (!Sys_StringToNetAdr(address, &adr, true)) {
+		common->Printf("loadTest: couldn't resolve %s\n", address);
+		return;
+	}
+
+	if (!adr.port) {
+		adr.port = server.IsActive() ? server.GetPort() : PORT_SERVER;
+	}
+
+	loadTest.Start(adr, atoi(args.Argv(1)), (args.Argc() > 3) ? atoi(args.Argv(3)) : 500);
+}
+
+/*
+==================
+idAsyncNetwork::LoadTestStop_f
+==================
+*/
+void idAsyncNetwork::LoadTestStop_f(const idCmdArgs &args)
+{
+	loadTest.Stop();
+}
+
 /*
 ===============
 idAsyncNetwork::BuildInvalidKeyMsg
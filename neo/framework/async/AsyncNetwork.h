@@ -65,6 +65,7 @@ const int GAME_INIT_ID_MAP_LOAD		= -2;
 #include "AsyncServer.h"
 #include "ServerScan.h"
 #include "AsyncClient.h"
+#include "LoadTest.h"
 
 /*
 ===============================================================================
@@ -155,6 +156,14 @@ class idAsyncNetwork
 		static void				WriteUserCmdDelta(idBitMsg &msg, const usercmd_t &cmd, const usercmd_t *base);
 		static void				ReadUserCmdDelta(const idBitMsg &msg, usercmd_t &cmd, const usercmd_t *base);
 
+		// client to server messages, shared by idAsyncClient and the load test clients
+		static void				WriteChallengeMessage(idBitMsg &msg, int clientId);
+		static void				WriteConnectMessage(idBitMsg &msg, int dataChecksum, int serverChallenge, int clientId, int maxRate, const char *guid);
+		static void				WritePureChecksums(idBitMsg &msg);
+		static void				WriteUnreliableHeader(idBitMsg &msg, int serverMessageSequence, int gameInitId, int snapshotSequence, int type);
+		// the command for frame i is cmds[ ( i & ( MAX_USERCMD_BACKUP - 1 ) ) * cmdStride ]
+		static void				WriteUserCmds(idBitMsg &msg, int gameFrame, int numUsercmds, const usercmd_t *cmds, int cmdStride);
+
 		static bool				DuplicateUsercmd(const usercmd_t &previousUserCmd, usercmd_t &currentUserCmd, int frame, int time);
 		static bool				UsercmdInputChanged(const usercmd_t &previousUserCmd, const usercmd_t &currentUserCmd);
 
@@ -169,6 +178,7 @@ class idAsyncNetwork
 
 		static idAsyncServer	server;
 		static idAsyncClient	client;
+		static idLoadTest		loadTest;
 
 		static idCVar			verbose;						// verbose output
 		static idCVar			allowCheats;					// allow cheats
@@ -177,6 +187,8 @@ class idAsyncNetwork
 		static idCVar			serverMaxClientRate;			// maximum outgoing rate to clients
 		static idCVar			clientMaxRate;					// maximum rate from server requested by client
 		static idCVar			serverMaxUsercmdRelay;			// maximum number of usercmds relayed to other clients
+		static idCVar			serverParallelSnapshots;		// write the client snapshots on the job threads
+		static idCVar			channelCompression;				// best channel compression to negotiate at connect time
 		static idCVar			serverZombieTimeout;			// time out in seconds for zombie clients
 		static idCVar			serverClientTimeout;			// time out in seconds for connected clients
 		static idCVar			clientServerTimeout;			// time out in seconds for server
@@ -217,6 +229,8 @@ class idAsyncNetwork
 		static void				Kick_f(const idCmdArgs &args);
 		static void				CheckNewVersion_f(const idCmdArgs &args);
 		static void				UpdateUI_f(const idCmdArgs &args);
+		static void				LoadTest_f(const idCmdArgs &args);
+		static void				LoadTestStop_f(const idCmdArgs &args);
 };
 
 #endif /* !__ASYNCNETWORK_H__ */
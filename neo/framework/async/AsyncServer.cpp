@@ -40,6 +40,15 @@ const int NOINPUT_IDLE_TIME				= 30000;
 
 const int HEARTBEAT_MSEC				= 5*60*1000;
 
+// what RunFrame sends to a client
+typedef enum {
+	CLIENT_SEND_NOTHING,
+	CLIENT_SEND_FRAGMENT,
+	CLIENT_SEND_PING,
+	CLIENT_SEND_SNAPSHOT,
+	CLIENT_SEND_EMPTY
+} clientSend_t;
+
 // must be kept in sync with authReplyMsg_t
 const char *authReplyMsg[] = {
 	//	"Waiting for authorization",
@@ -98,6 +107,10 @@ idAsyncServer::idAsyncServer(void)
 	stats_average_sum = 0;
 	stats_max = 0;
 	stats_max_index = 0;
+
+	frameTimeTotal = 0.0;
+	frameTimeMax = 0.0;
+	numFrameTimes = 0;
 }
 
 /*
@@ -1213,32 +1226,23 @@ void idAsyncServer::SendGameInitToClient(int clientNum)
 
 /*
 ==================
-idAsyncServer::SendSnapshotToClient
+idAsyncServer::WriteSnapshotToClient
+
+  Only touches the state of the given client, snapshots for several clients can be written at once.
 ==================
 */
-bool idAsyncServer::SendSnapshotToClient(int clientNum)
+void idAsyncServer::WriteSnapshotToClient(int clientNum, idBitMsg &msg)
 {
 	int			i, j, index, numUsercmds;
-	idBitMsg	msg;
-	byte		msgBuf[MAX_MESSAGE_SIZE];
 	usercmd_t 	*last;
 	byte		clientInPVS[MAX_ASYNC_CLIENTS >> 3];
 
 	serverClient_t &client = clients[clientNum];
 
-	if (serverTime - client.lastSnapshotTime < idAsyncNetwork::serverSnapshotDelay.GetInteger()) {
-		return false;
-	}
-
-	if (idAsyncNetwork::verbose.GetInteger() == 2) {
-		common->Printf("sending snapshot to client %d: gameInitId = %d, gameFrame = %d, gameTime = %d\n", clientNum, gameInitId, gameFrame, gameTime);
-	}
-
 	// how far is the client ahead of the server minus the packet delay
 	client.clientAheadTime = client.gameTime - (gameTime + gameTimeResidual);
 
 	// write the snapshot
-	msg.Init(msgBuf, sizeof(msgBuf));
 	msg.WriteLong(gameInitId);
 	msg.WriteByte(SERVER_UNRELIABLE_MESSAGE_SNAPSHOT);
 	msg.WriteLong(client.snapshotSequence);
@@ -1278,14 +1282,75 @@ bool idAsyncServer::SendSnapshotToClient(int clientNum)
 	}
 
 	msg.WriteByte(MAX_ASYNC_CLIENTS);
+}
 
-	client.channel.SendMessage(serverPort, serverTime, msg);
+/*
+==================
+idAsyncServer::WriteSnapshotJob
+==================
+*/
+void idAsyncServer::WriteSnapshotJob(void *parms)
+{
+	serverSnapshot_t *snapshot = (serverSnapshot_t *)parms;
+
+	snapshot->msg.Init(snapshot->msgBuf, sizeof(snapshot->msgBuf));
+	snapshot->server->WriteSnapshotToClient(snapshot->clientNum, snapshot->msg);
+}
+
+/*
+==================
+idAsyncServer::WriteSnapshotsToClients
+
+  Writes the snapshots into snapshots[], in the order of clientNums.
+==================
+*/
+void idAsyncServer::WriteSnapshotsToClients(const int *clientNums, int numClients)
+{
+	int i;
+
+	if (numClients <= 0) {
+		return;
+	}
+
+	for (i = 0; i < numClients; i++) {
+		snapshots[i].server = this;
+		snapshots[i].clientNum = clientNums[i];
+	}
+
+	// the game state stays frozen while the snapshots are written
+	game->ServerBeginSnapshots(clientNums, numClients);
+
+	if (idAsyncNetwork::serverParallelSnapshots.GetBool()) {
+		Sys_RunJobs(WriteSnapshotJob, snapshots, sizeof(snapshots[0]), numClients);
+	} else {
+		for (i = 0; i < numClients; i++) {
+			WriteSnapshotJob(&snapshots[i]);
+		}
+	}
+
+	game->ServerEndSnapshots();
+}
+
+/*
+==================
+idAsyncServer::SendSnapshotToClient
+
+  The channels share the server port, so the snapshots are sent from the server thread only.
+==================
+*/
+void idAsyncServer::SendSnapshotToClient(const serverSnapshot_t &snapshot)
+{
+	serverClient_t &client = clients[snapshot.clientNum];
+
+	if (idAsyncNetwork::verbose.GetInteger() == 2) {
+		common->Printf("sending snapshot to client %d: gameInitId = %d, gameFrame = %d, gameTime = %d\n", snapshot.clientNum, gameInitId, gameFrame, gameTime);
+	}
+
+	client.channel.SendMessage(serverPort, serverTime, snapshot.msg);
 
 	client.lastSnapshotTime = serverTime;
 	client.snapshotSequence++;
 	client.numDuplicatedUsercmds = 0;
-
-	return true;
 }
 
 /*
@@ -1793,6 +1858,7 @@ void idAsyncServer::ProcessConnectMessage(const netadr_t from, const idBitMsg &m
 	char		guid[ 12 ];
 	char		password[ 17 ];
 	int			i, ichallenge, islot, OS, numClients;
+	channelCompression_t compression;
 
 	protocol = msg.ReadLong();
 	OS = msg.ReadShort();
@@ -1900,6 +1966,17 @@ void idAsyncServer::ProcessConnectMessage(const netadr_t from, const idBitMsg &m
 	// if authState == CDK_PUREOK, the check was already performed once before entering pure checks
 	// but meanwhile, the max players may have been reached
 	msg.ReadString(password, sizeof(password));
+
+	// skip the PB placeholder and pick the channel compression, clients which do not
+	// send their best channel compression only support run length compression
+	msg.ReadShort();
+
+	if (msg.GetRemainingReadBits() >= 8) {
+		compression = (channelCompression_t) idMath::ClampInt(0, idAsyncNetwork::channelCompression.GetInteger(), msg.ReadByte());
+	} else {
+		compression = CHANNEL_COMPRESSION_RUNLENGTH;
+	}
+
 	char reason[MAX_STRING_CHARS];
 	allowReply_t reply = game->ServerAllowClient(numClients, Sys_NetAdrToString(from), guid, password, reason);
 
@@ -1967,6 +2044,7 @@ void idAsyncServer::ProcessConnectMessage(const netadr_t from, const idBitMsg &m
 		if (clientNum < MAX_ASYNC_CLIENTS) {
 			// initialize
 			clients[ clientNum ].channel.Init(from, serverId);
+			clients[ clientNum ].channel.SetCompression(compression);
 			clients[ clientNum ].OS = OS;
 			strncpy(clients[ clientNum ].guid, guid, 12);
 			clients[ clientNum ].guid[11] = 0;
@@ -1991,6 +2069,7 @@ void idAsyncServer::ProcessConnectMessage(const netadr_t from, const idBitMsg &m
 	outMsg.WriteLong(gameFrame);
 	outMsg.WriteLong(gameTime);
 	outMsg.WriteDeltaDict(sessLocal.mapSpawnData.serverInfo, NULL);
+	outMsg.WriteByte(compression);
 
 	serverPort.SendPacket(from, outMsg.GetData(), outMsg.GetSize());
 
@@ -2239,6 +2318,21 @@ void idAsyncServer::ProcessGetInfoMessage(const netadr_t from, const idBitMsg &m
 	serverPort.SendPacket(from, outMsg.GetData(), outMsg.GetSize());
 }
 
+/*
+===============
+idAsyncServer::GetFrameTimes
+===============
+*/
+void idAsyncServer::GetFrameTimes(float &averageTime, float &maxTime)
+{
+	averageTime = numFrameTimes ? frameTimeTotal / numFrameTimes : 0.0f;
+	maxTime = frameTimeMax;
+
+	frameTimeTotal = 0.0;
+	frameTimeMax = 0.0;
+	numFrameTimes = 0;
+}
+
 /*
 ===============
 idAsyncServer::PrintLocalServerInfo
@@ -2540,6 +2634,9 @@ void idAsyncServer::RunFrame(void)
 	netadr_t	from;
 	int			outgoingRate, incomingRate;
 	float		outgoingCompression, incomingCompression;
+	int			snapshotClients[MAX_ASYNC_CLIENTS], numSnapshotClients;
+	byte		clientSends[MAX_ASYNC_CLIENTS];
+	idTimer		frameTimer;
 
 	msec = UpdateTime(100);
 
@@ -2559,10 +2656,10 @@ void idAsyncServer::RunFrame(void)
 
 		do {
 
-			// blocking read with game time residual timeout
-			newPacket = serverPort.GetPacketBlocking(from, msgBuf, size, sizeof(msgBuf), USERCMD_MSEC - gameTimeResidual - 1);
+			// blocking read with game time residual timeout, receives all pending packets at once
+			newPacket = (serverPort.ReceivePackets(USERCMD_MSEC - gameTimeResidual - 1) > 0);
 
-			if (newPacket) {
+			while (serverPort.GetQueuedPacket(from, msgBuf, size, sizeof(msgBuf))) {
 				msg.Init(msgBuf, sizeof(msgBuf));
 				msg.SetSize(size);
 				msg.BeginReading();
@@ -2579,6 +2676,8 @@ void idAsyncServer::RunFrame(void)
 
 	} while (gameTimeResidual < USERCMD_MSEC);
 
+	frameTimer.Start();
+
 	// send heart beat to master servers
 	MasterHeartbeat();
 
@@ -2641,10 +2740,14 @@ void idAsyncServer::RunFrame(void)
 	// duplicate usercmds so there is always at least one available to send with snapshots
 	DuplicateUsercmds(gameFrame, gameTime);
 
-	// send snapshots to connected clients
+	// decide what goes to each connected client, so all the snapshots can be written at once
+	numSnapshotClients = 0;
+
 	for (i = 0; i < MAX_ASYNC_CLIENTS; i++) {
 		serverClient_t &client = clients[i];
 
+		clientSends[i] = CLIENT_SEND_NOTHING;
+
 		if (client.clientState == SCS_FREE || i == localClientNum) {
 			continue;
 		}
@@ -2661,19 +2764,52 @@ void idAsyncServer::RunFrame(void)
 
 		// send additional message fragments if the last message was too large to send at once
 		if (client.channel.UnsentFragmentsLeft()) {
-			client.channel.SendNextFragment(serverPort, serverTime);
+			clientSends[i] = CLIENT_SEND_FRAGMENT;
 			continue;
 		}
 
 		if (client.clientState == SCS_INGAME) {
-			if (!SendSnapshotToClient(i)) {
-				SendPingToClient(i);
+			if (serverTime - client.lastSnapshotTime < idAsyncNetwork::serverSnapshotDelay.GetInteger()) {
+				clientSends[i] = CLIENT_SEND_PING;
+			} else {
+				clientSends[i] = CLIENT_SEND_SNAPSHOT;
+				snapshotClients[numSnapshotClients++] = i;
 			}
 		} else {
-			SendEmptyToClient(i);
+			clientSends[i] = CLIENT_SEND_EMPTY;
+		}
+	}
+
+	WriteSnapshotsToClients(snapshotClients, numSnapshotClients);
+
+	// send in client order, the packets go out together once all are sent
+	serverPort.BeginSendBatch();
+	numSnapshotClients = 0;
+
+	for (i = 0; i < MAX_ASYNC_CLIENTS; i++) {
+		switch (clientSends[i]) {
+			case CLIENT_SEND_FRAGMENT:
+				clients[i].channel.SendNextFragment(serverPort, serverTime);
+				break;
+			case CLIENT_SEND_PING:
+				SendPingToClient(i);
+				break;
+			case CLIENT_SEND_SNAPSHOT:
+				SendSnapshotToClient(snapshots[numSnapshotClients++]);
+				break;
+			case CLIENT_SEND_EMPTY:
+				SendEmptyToClient(i);
+				break;
 		}
 	}
 
+	serverPort.EndSendBatch();
+
+	frameTimer.Stop();
+	frameTimeTotal += frameTimer.Milliseconds();
+	frameTimeMax = Max(frameTimeMax, frameTimer.Milliseconds());
+	numFrameTimes++;
+
 	if (com_showAsyncStats.GetBool()) {
 
 		UpdateAsyncStatsAvg();
@@ -2696,6 +2832,11 @@ void idAsyncServer::RunFrame(void)
 				}
 			}
 
+			common->Printf("server port: %d packets in with %d calls, %d packets out with %d calls\n",
+			               serverPort.packetsRead, serverPort.readCalls, serverPort.packetsWritten, serverPort.writeCalls);
+			serverPort.packetsRead = serverPort.readCalls = 0;
+			serverPort.packetsWritten = serverPort.writeCalls = 0;
+
 			idStr msg;
 			GetAsyncStatsAvgMsg(msg);
 			common->Printf(va("%s\n", msg.c_str()));
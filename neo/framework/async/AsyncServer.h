@@ -127,6 +127,16 @@ typedef struct serverClient_s {
 
 } serverClient_t;
 
+class idAsyncServer;
+
+// snapshots are written on the job threads, each into its own buffer
+typedef struct serverSnapshot_s {
+	idAsyncServer 		*server;
+	int					clientNum;
+	idBitMsg			msg;
+	byte				msgBuf[MAX_MESSAGE_SIZE];
+} serverSnapshot_t;
+
 
 class idAsyncServer
 {
@@ -184,6 +194,9 @@ class idAsyncServer
 
 		void				PrintLocalServerInfo(void);
 
+		// average and max time spent in RunFrame since the last call
+		void				GetFrameTimes(float &averageTime, float &maxTime);
+
 	private:
 		bool				active;						// true if server is active
 		int					realTime;					// absolute time
@@ -197,6 +210,7 @@ class idAsyncServer
 		challenge_t			challenges[MAX_CHALLENGES];	// to prevent invalid IPs from connecting
 		serverClient_t		clients[MAX_ASYNC_CLIENTS];	// clients
 		usercmd_t			userCmds[MAX_USERCMD_BACKUP][MAX_ASYNC_CLIENTS];
+		serverSnapshot_t	snapshots[MAX_ASYNC_CLIENTS];
 
 		int					gameInitId;					// game initialization identification
 		int					gameFrame;					// local game frame
@@ -223,6 +237,11 @@ class idAsyncServer
 		int					stats_max;
 		int					stats_max_index;
 
+		// time spent advancing the game and sending snapshots, see GetFrameTimes
+		double				frameTimeTotal;
+		double				frameTimeMax;
+		int					numFrameTimes;
+
 		void				PrintOOB(const netadr_t to, int opcode, const char *string);
 		void				DuplicateUsercmds(int frame, int time);
 		void				ClearClient(int clientNum);
@@ -241,7 +260,10 @@ class idAsyncServer
 		bool				SendEmptyToClient(int clientNum, bool force = false);
 		bool				SendPingToClient(int clientNum);
 		void				SendGameInitToClient(int clientNum);
-		bool				SendSnapshotToClient(int clientNum);
+		void				WriteSnapshotToClient(int clientNum, idBitMsg &msg);
+		void				WriteSnapshotsToClients(const int *clientNums, int numClients);
+		void				SendSnapshotToClient(const serverSnapshot_t &snapshot);
+		static void			WriteSnapshotJob(void *parms);
 		void				ProcessUnreliableClientMessage(int clientNum, const idBitMsg &msg);
 		void				ProcessReliableClientMessages(int clientNum);
 		void				ProcessChallengeMessage(const netadr_t from, const idBitMsg &msg);
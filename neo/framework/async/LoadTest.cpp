@@ -0,0 +1,734 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#include "../../idlib/precompiled.h"
+#pragma hdrstop
+
+#include "AsyncNetwork.h"
+
+const int LOADTEST_CONNECT_RESEND_TIME	= 1000;
+const int LOADTEST_EMPTY_RESEND_TIME	= 500;
+
+idCVar net_loadTestMovement("net_loadTestMovement", "0", CVAR_SYSTEM | CVAR_INTEGER, "user commands of the load test clients, 0 = random, 1 = scripted run in circles while firing", 0, 1);
+idCVar net_loadTestRate("net_loadTestRate", "16000", CVAR_SYSTEM | CVAR_INTEGER, "maximum rate requested by the load test clients in bytes/sec");
+
+/*
+==================
+idLoadTestClient::idLoadTestClient
+==================
+*/
+idLoadTestClient::idLoadTestClient()
+{
+	state = LTS_DISCONNECTED;
+	index = 0;
+	clientId = 0;
+	clientNum = 0;
+	clientTime = 0;
+	serverId = 0;
+	serverChallenge = 0;
+	serverMessageSequence = 0;
+	gameInitId = GAME_INIT_ID_INVALID;
+	gameFrame = 0;
+	gameTime = 0;
+	snapshotSequence = 0;
+	numSnapshots = 0;
+	lastConnectTime = 0;
+	lastPacketTime = 0;
+	lastEmptyTime = 0;
+	lastUsercmdTime = 0;
+	memset(&serverAddress, 0, sizeof(serverAddress));
+	memset(userCmds, 0, sizeof(userCmds));
+}
+
+/*
+==================
+idLoadTestClient::Connect
+==================
+*/
+void idLoadTestClient::Connect(const netadr_t adr, int index)
+{
+	if (!port.GetPort() && !port.InitForPort(PORT_ANY)) {
+		common->Printf("loadTest client %d: couldn't open a port\n", index);
+		return;
+	}
+
+	this->index = index;
+	serverAddress = adr;
+	state = LTS_CHALLENGING;
+	clientTime = Sys_Milliseconds();
+	clientId = (clientTime + index * 7919) & CONNECTIONLESS_MESSAGE_ID_MASK;
+	random.SetSeed(clientId);
+	serverMessageSequence = 0;
+	gameInitId = GAME_INIT_ID_INVALID;
+	snapshotSequence = 0;
+	numSnapshots = 0;
+	lastConnectTime = -9999;
+	lastPacketTime = clientTime;
+	lastEmptyTime = 0;
+	memset(userCmds, 0, sizeof(userCmds));
+}
+
+/*
+==================
+idLoadTestClient::Disconnect
+==================
+*/
+void idLoadTestClient::Disconnect(void)
+{
+	idBitMsg	msg;
+	byte		msgBuf[MAX_MESSAGE_SIZE];
+
+	if (state >= LTS_CONNECTED) {
+		msg.Init(msgBuf, sizeof(msgBuf));
+		msg.WriteByte(CLIENT_RELIABLE_MESSAGE_DISCONNECT);
+		msg.WriteString("disconnect");
+		SendReliable(msg);
+
+		SendEmpty(true);
+		SendEmpty(true);
+		SendEmpty(true);
+
+		channel.Shutdown();
+	}
+
+	state = LTS_DISCONNECTED;
+	port.Close();
+}
+
+/*
+==================
+idLoadTestClient::SendConnectionless
+==================
+*/
+void idLoadTestClient::SendConnectionless(const idBitMsg &msg)
+{
+	port.SendPacket(serverAddress, msg.GetData(), msg.GetSize());
+}
+
+/*
+==================
+idLoadTestClient::SetupConnection
+==================
+*/
+void idLoadTestClient::SetupConnection(void)
+{
+	idBitMsg	msg;
+	byte		msgBuf[MAX_MESSAGE_SIZE];
+
+	if (clientTime - lastConnectTime < LOADTEST_CONNECT_RESEND_TIME) {
+		return;
+	}
+
+	msg.Init(msgBuf, sizeof(msgBuf));
+
+	if (state == LTS_CHALLENGING) {
+		idAsyncNetwork::WriteChallengeMessage(msg, clientId);
+	} else {
+		// no guid, the server doesn't wait for an auth reply in LAN mode
+		idAsyncNetwork::WriteConnectMessage(msg, declManager->GetChecksum(), serverChallenge, clientId, net_loadTestRate.GetInteger(), "");
+	}
+
+	SendConnectionless(msg);
+	lastConnectTime = clientTime;
+}
+
+/*
+==================
+idLoadTestClient::SendEmpty
+==================
+*/
+void idLoadTestClient::SendEmpty(bool force)
+{
+	idBitMsg	msg;
+	byte		msgBuf[MAX_MESSAGE_SIZE];
+
+	if (!force && clientTime - lastEmptyTime < LOADTEST_EMPTY_RESEND_TIME) {
+		return;
+	}
+
+	msg.Init(msgBuf, sizeof(msgBuf));
+	idAsyncNetwork::WriteUnreliableHeader(msg, serverMessageSequence, gameInitId, snapshotSequence, CLIENT_UNRELIABLE_MESSAGE_EMPTY);
+
+	channel.SendMessage(port, clientTime, msg);
+
+	while (channel.UnsentFragmentsLeft()) {
+		channel.SendNextFragment(port, clientTime);
+	}
+
+	lastEmptyTime = clientTime;
+}
+
+/*
+==================
+idLoadTestClient::SendPingResponse
+==================
+*/
+void idLoadTestClient::SendPingResponse(int time)
+{
+	idBitMsg	msg;
+	byte		msgBuf[MAX_MESSAGE_SIZE];
+
+	msg.Init(msgBuf, sizeof(msgBuf));
+	idAsyncNetwork::WriteUnreliableHeader(msg, serverMessageSequence, gameInitId, snapshotSequence, CLIENT_UNRELIABLE_MESSAGE_PINGRESPONSE);
+	msg.WriteLong(time);
+
+	channel.SendMessage(port, clientTime, msg);
+
+	while (channel.UnsentFragmentsLeft()) {
+		channel.SendNextFragment(port, clientTime);
+	}
+}
+
+/*
+==================
+idLoadTestClient::SendReliable
+==================
+*/
+void idLoadTestClient::SendReliable(const idBitMsg &msg)
+{
+	if (!channel.SendReliableMessage(msg)) {
+		common->Printf("loadTest client %d: reliable messages overflow\n", index);
+		state = LTS_DISCONNECTED;
+	}
+}
+
+/*
+==================
+idLoadTestClient::GenerateUsercmd
+==================
+*/
+void idLoadTestClient::GenerateUsercmd(usercmd_t &cmd)
+{
+	const usercmd_t &previous = userCmds[(gameFrame - 1) & (MAX_USERCMD_BACKUP - 1)];
+
+	if (net_loadTestMovement.GetInteger() == 1) {
+		// run in circles and fire every other second
+		memset(&cmd, 0, sizeof(cmd));
+		cmd.forwardmove = 127;
+		cmd.buttons = BUTTON_RUN;
+
+		if ((gameTime / 1000) & 1) {
+			cmd.buttons |= BUTTON_ATTACK;
+		}
+
+		cmd.angles[YAW] = ANGLE2SHORT((gameTime + index * 1000) * 0.09f);
+		return;
+	}
+
+	// keep doing the same thing for a while and turn a bit every frame
+	cmd = previous;
+
+	if (random.RandomInt(30) == 0) {
+		cmd.forwardmove = (random.RandomInt(3) - 1) * 127;
+		cmd.rightmove = (random.RandomInt(3) - 1) * 127;
+		cmd.upmove = (random.RandomInt(8) == 0) ? 127 : 0;
+		cmd.buttons = BUTTON_RUN | ((random.RandomInt(3) == 0) ? BUTTON_ATTACK : 0);
+	}
+
+	if (random.RandomInt(200) == 0) {
+		cmd.impulse = random.RandomInt(10);
+		cmd.flags ^= UCF_IMPULSE_SEQUENCE;
+	}
+
+	cmd.angles[YAW] += random.RandomInt(1024) - 512;
+	cmd.angles[PITCH] = idMath::ClampInt(-4096, 4096, cmd.angles[PITCH] + random.RandomInt(256) - 128);
+}
+
+/*
+==================
+idLoadTestClient::SendUsercmds
+==================
+*/
+void idLoadTestClient::SendUsercmds(void)
+{
+	int			i, numFrames, numUsercmds, cmdIndex;
+	idBitMsg	msg;
+	byte		msgBuf[MAX_MESSAGE_SIZE];
+
+	if (clientTime - lastUsercmdTime < USERCMD_MSEC) {
+		return;
+	}
+
+	// generate a user command for every game frame that passed
+	numFrames = Min((clientTime - lastUsercmdTime) / USERCMD_MSEC, MAX_USERCMD_RELAY);
+	lastUsercmdTime = clientTime;
+
+	for (i = 0; i < numFrames; i++) {
+		gameFrame++;
+		gameTime += USERCMD_MSEC;
+		cmdIndex = gameFrame & (MAX_USERCMD_BACKUP - 1);
+		GenerateUsercmd(userCmds[cmdIndex]);
+		userCmds[cmdIndex].gameFrame = gameFrame;
+		userCmds[cmdIndex].gameTime = gameTime;
+	}
+
+	msg.Init(msgBuf, sizeof(msgBuf));
+	idAsyncNetwork::WriteUnreliableHeader(msg, serverMessageSequence, gameInitId, snapshotSequence, CLIENT_UNRELIABLE_MESSAGE_USERCMD);
+	msg.WriteShort(idAsyncNetwork::clientPrediction.GetInteger());
+
+	numUsercmds = idMath::ClampInt(0, 10, idAsyncNetwork::clientUsercmdBackup.GetInteger()) + 1;
+
+	idAsyncNetwork::WriteUserCmds(msg, gameFrame, numUsercmds, userCmds, 1);
+
+	channel.SendMessage(port, clientTime, msg);
+
+	while (channel.UnsentFragmentsLeft()) {
+		channel.SendNextFragment(port, clientTime);
+	}
+}
+
+/*
+==================
+idLoadTestClient::ConnectionlessMessage
+==================
+*/
+void idLoadTestClient::ConnectionlessMessage(const netadr_t from, const idBitMsg &msg)
+{
+	char		string[MAX_STRING_CHARS];
+	idBitMsg	outMsg;
+	byte		msgBuf[MAX_MESSAGE_SIZE];
+	idDict		serverSI;
+
+	msg.ReadString(string, sizeof(string));
+
+	if (idStr::Icmp(string, "challengeResponse") == 0) {
+		if (state != LTS_CHALLENGING) {
+			return;
+		}
+
+		serverChallenge = msg.ReadLong();
+		serverId = msg.ReadShort();
+		serverAddress = from;
+		state = LTS_CONNECTING;
+		lastConnectTime = -9999;
+		return;
+	}
+
+	if (idStr::Icmp(string, "pureServer") == 0) {
+		if (state != LTS_CONNECTING) {
+			return;
+		}
+
+		outMsg.Init(msgBuf, sizeof(msgBuf));
+		outMsg.WriteShort(CONNECTIONLESS_MESSAGE_ID);
+		outMsg.WriteString("pureClient");
+		outMsg.WriteLong(serverChallenge);
+		outMsg.WriteShort(clientId);
+		idAsyncNetwork::WritePureChecksums(outMsg);
+		SendConnectionless(outMsg);
+
+		// connect again right away now the pure checks are passed
+		lastConnectTime = -9999;
+		return;
+	}
+
+	if (idStr::Icmp(string, "connectResponse") == 0) {
+		if (state != LTS_CONNECTING) {
+			return;
+		}
+
+		channel.Init(from, clientId);
+		clientNum = msg.ReadLong();
+		gameInitId = msg.ReadLong();
+		gameFrame = msg.ReadLong();
+		gameTime = msg.ReadLong();
+		msg.ReadDeltaDict(serverSI, NULL);
+
+		if (msg.GetRemainingReadBits() >= 8) {
+			channel.SetCompression((channelCompression_t) idMath::ClampInt(0, CHANNEL_COMPRESSION_MAX, msg.ReadByte()));
+		}
+
+		state = LTS_CONNECTED;
+		lastPacketTime = clientTime;
+		lastUsercmdTime = clientTime;
+		return;
+	}
+
+	if (idStr::Icmp(string, "print") == 0) {
+		int opcode = msg.ReadLong();
+
+		if (opcode == SERVER_PRINT_GAMEDENY) {
+			msg.ReadLong();
+		}
+
+		msg.ReadString(string, sizeof(string));
+		common->Printf("loadTest client %d: %s\n", index, common->GetLanguageDict()->GetString(string));
+
+		if (opcode == SERVER_PRINT_BADCHALLENGE) {
+			state = LTS_CHALLENGING;
+			lastConnectTime = -9999;
+		}
+
+		return;
+	}
+
+	if (idStr::Icmp(string, "disconnect") == 0) {
+		common->Printf("loadTest client %d: disconnected by server\n", index);
+		state = LTS_DISCONNECTED;
+		return;
+	}
+}
+
+/*
+==================
+idLoadTestClient::ProcessReliableMessages
+==================
+*/
+void idLoadTestClient::ProcessReliableMessages(void)
+{
+	idBitMsg	msg, outMsg;
+	byte		msgBuf[MAX_MESSAGE_SIZE], outBuf[MAX_MESSAGE_SIZE];
+	idDict		info;
+	int			id;
+
+	msg.Init(msgBuf, sizeof(msgBuf));
+
+	while (channel.GetReliableMessage(msg)) {
+		id = msg.ReadByte();
+
+		switch (id) {
+			case SERVER_RELIABLE_MESSAGE_PURE: {
+				if (msg.ReadLong() != gameInitId) {
+					break;
+				}
+
+				outMsg.Init(outBuf, sizeof(outBuf));
+				outMsg.WriteByte(CLIENT_RELIABLE_MESSAGE_PURE);
+				outMsg.WriteLong(gameInitId);
+				idAsyncNetwork::WritePureChecksums(outMsg);
+				SendReliable(outMsg);
+				break;
+			}
+			case SERVER_RELIABLE_MESSAGE_ENTERGAME: {
+				info = *cvarSystem->MoveCVarsToDict(CVAR_USERINFO);
+				info.Set("ui_name", va("loadtest%d", index));
+				info.SetBool("ui_spectate", false);
+				info.SetBool("ui_ready", true);
+
+				outMsg.Init(outBuf, sizeof(outBuf));
+				outMsg.WriteByte(CLIENT_RELIABLE_MESSAGE_CLIENTINFO);
+				outMsg.WriteDeltaDict(info, NULL);
+				SendReliable(outMsg);
+				break;
+			}
+			case SERVER_RELIABLE_MESSAGE_DISCONNECT: {
+				if (msg.ReadLong() == clientNum) {
+					common->Printf("loadTest client %d: dropped by server\n", index);
+					state = LTS_DISCONNECTED;
+				}
+
+				break;
+			}
+			case SERVER_RELIABLE_MESSAGE_RELOAD: {
+				// start over so the pure checks are done again
+				state = LTS_CHALLENGING;
+				lastConnectTime = -9999;
+				break;
+			}
+			default: {
+				// game messages, user info and prints are of no interest
+				break;
+			}
+		}
+	}
+}
+
+/*
+==================
+idLoadTestClient::ProcessUnreliableMessage
+==================
+*/
+void idLoadTestClient::ProcessUnreliableMessage(const idBitMsg &msg)
+{
+	int serverGameInitId, snapshotGameFrame, snapshotGameTime;
+	int id;
+
+	serverGameInitId = msg.ReadLong();
+	id = msg.ReadByte();
+
+	switch (id) {
+		case SERVER_UNRELIABLE_MESSAGE_PING: {
+			SendPingResponse(msg.ReadLong());
+			break;
+		}
+		case SERVER_UNRELIABLE_MESSAGE_GAMEINIT: {
+			// there is no map to load so join the new game right away
+			gameInitId = serverGameInitId;
+			gameFrame = msg.ReadLong();
+			gameTime = msg.ReadLong();
+			snapshotSequence = 0;
+			channel.ResetRate();
+			state = LTS_CONNECTED;
+			break;
+		}
+		case SERVER_UNRELIABLE_MESSAGE_SNAPSHOT: {
+			if (serverGameInitId != gameInitId) {
+				break;
+			}
+
+			// only the header is read, acknowledging the sequence is all the server needs
+			snapshotSequence = msg.ReadLong();
+			snapshotGameFrame = msg.ReadLong();
+			snapshotGameTime = msg.ReadLong();
+			numSnapshots++;
+			state = LTS_INGAME;
+
+			if (gameTime < snapshotGameTime || gameTime > snapshotGameTime + idAsyncNetwork::clientMaxPrediction.GetInteger()) {
+				gameFrame = snapshotGameFrame;
+				gameTime = snapshotGameTime;
+			}
+
+			break;
+		}
+		default: {
+			break;
+		}
+	}
+}
+
+/*
+==================
+idLoadTestClient::ProcessMessage
+==================
+*/
+void idLoadTestClient::ProcessMessage(const netadr_t from, idBitMsg &msg)
+{
+	int id;
+
+	id = msg.ReadShort();
+
+	if (id == CONNECTIONLESS_MESSAGE_ID) {
+		ConnectionlessMessage(from, msg);
+		return;
+	}
+
+	if (state < LTS_CONNECTED || msg.GetRemaingData() < 4 || id != serverId) {
+		return;
+	}
+
+	if (!Sys_CompareNetAdrBase(from, channel.GetRemoteAddress())) {
+		return;
+	}
+
+	if (!channel.Process(from, clientTime, msg, serverMessageSequence)) {
+		return;
+	}
+
+	lastPacketTime = clientTime;
+	ProcessReliableMessages();
+
+	if (state >= LTS_CONNECTED) {
+		ProcessUnreliableMessage(msg);
+	}
+}
+
+/*
+==================
+idLoadTestClient::RunFrame
+==================
+*/
+void idLoadTestClient::RunFrame(int time)
+{
+	idBitMsg	msg;
+	byte		msgBuf[MAX_MESSAGE_SIZE];
+	netadr_t	from;
+	int			size;
+
+	if (state == LTS_DISCONNECTED) {
+		return;
+	}
+
+	clientTime = time;
+
+	while (port.GetPacket(from, msgBuf, size, sizeof(msgBuf))) {
+		msg.Init(msgBuf, sizeof(msgBuf));
+		msg.SetSize(size);
+		msg.BeginReading();
+		ProcessMessage(from, msg);
+
+		if (state == LTS_DISCONNECTED) {
+			Disconnect();
+			return;
+		}
+	}
+
+	if (state < LTS_CONNECTED) {
+		SetupConnection();
+		return;
+	}
+
+	if (clientTime - lastPacketTime > idAsyncNetwork::clientServerTimeout.GetInteger() * 1000) {
+		common->Printf("loadTest client %d: server timed out\n", index);
+		Disconnect();
+		return;
+	}
+
+	if (channel.UnsentFragmentsLeft()) {
+		channel.SendNextFragment(port, clientTime);
+	}
+
+	SendUsercmds();
+}
+
+/*
+==================
+idLoadTest::idLoadTest
+==================
+*/
+idLoadTest::idLoadTest()
+{
+	active = false;
+	numClients = 0;
+	numStarted = 0;
+	rampTime = 0;
+	nextStartTime = 0;
+	nextReportTime = 0;
+	memset(&serverAddress, 0, sizeof(serverAddress));
+}
+
+/*
+==================
+idLoadTest::Start
+
+  Connects a new client every rampTime msec until numClients are running.
+==================
+*/
+void idLoadTest::Start(const netadr_t adr, int numClients, int rampTime)
+{
+	Stop();
+
+	serverAddress = adr;
+	this->numClients = idMath::ClampInt(1, MAX_ASYNC_CLIENTS, numClients);
+	this->rampTime = Max(0, rampTime);
+	numStarted = 0;
+	nextStartTime = Sys_Milliseconds();
+	nextReportTime = nextStartTime + 1000;
+	active = true;
+
+	common->Printf("loadTest: connecting %d clients to %s, one every %d msec\n", this->numClients, Sys_NetAdrToString(serverAddress), this->rampTime);
+}
+
+/*
+==================
+idLoadTest::Stop
+==================
+*/
+void idLoadTest::Stop(void)
+{
+	int i;
+
+	if (!active) {
+		return;
+	}
+
+	for (i = 0; i < numStarted; i++) {
+		clients[i].Disconnect();
+	}
+
+	numStarted = 0;
+	active = false;
+}
+
+/*
+==================
+idLoadTest::RunFrame
+==================
+*/
+void idLoadTest::RunFrame(void)
+{
+	int i, time;
+
+	if (!active) {
+		return;
+	}
+
+	time = Sys_Milliseconds();
+
+	while (numStarted < numClients && time >= nextStartTime) {
+		clients[numStarted].Connect(serverAddress, numStarted);
+		numStarted++;
+		nextStartTime += rampTime;
+	}
+
+	for (i = 0; i < numStarted; i++) {
+		clients[i].RunFrame(time);
+	}
+
+	if (time >= nextReportTime) {
+		Report(time);
+		nextReportTime = time + 1000;
+	}
+}
+
+/*
+==================
+idLoadTest::Report
+
+  Prints one line per second so the numbers can be followed as clients are added.
+==================
+*/
+void idLoadTest::Report(int time)
+{
+	int i, numInGame, outgoingRate, incomingRate, snapshots;
+	float packetLoss, averageFrameTime, maxFrameTime;
+
+	numInGame = 0;
+	outgoingRate = 0;
+	incomingRate = 0;
+	snapshots = 0;
+	packetLoss = 0.0f;
+
+	for (i = 0; i < numStarted; i++) {
+		if (clients[i].GetState() != LTS_INGAME) {
+			continue;
+		}
+
+		numInGame++;
+		outgoingRate += clients[i].GetChannel().GetOutgoingRate();
+		incomingRate += clients[i].GetChannel().GetIncomingRate();
+		packetLoss += clients[i].GetChannel().GetIncomingPacketLoss();
+		snapshots += clients[i].GetNumSnapshots();
+		clients[i].ClearNumSnapshots();
+	}
+
+	if (numInGame) {
+		outgoingRate /= numInGame;
+		incomingRate /= numInGame;
+		packetLoss /= numInGame;
+		snapshots /= numInGame;
+	}
+
+	if (idAsyncNetwork::server.IsActive()) {
+		idAsyncNetwork::server.GetFrameTimes(averageFrameTime, maxFrameTime);
+		common->Printf("loadTest: %2d/%2d in game, server frame %.2f ms avg %.2f ms max, per client: in %d B/s out %d B/s %d snapshots/s loss %.1f%%\n",
+		               numInGame, numStarted, averageFrameTime, maxFrameTime, incomingRate, outgoingRate, snapshots, packetLoss);
+	} else {
+		common->Printf("loadTest: %2d/%2d in game, per client: in %d B/s out %d B/s %d snapshots/s loss %.1f%%\n",
+		               numInGame, numStarted, incomingRate, outgoingRate, snapshots, packetLoss);
+	}
+}
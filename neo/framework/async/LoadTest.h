@@ -0,0 +1,151 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+#ifndef __LOADTEST_H__
+#define __LOADTEST_H__
+
+/*
+===============================================================================
+
+  Headless clients for server load testing.
+
+  Each client has its own port and message channel and speaks the regular
+  client protocol without running a game. The clients connect, send scripted
+  or random user commands and acknowledge snapshots so the server does all
+  the work it does for real players.
+
+  The outgoing messages are written with the same idAsyncNetwork writers as
+  idAsyncClient uses. The connection state machine and the handling of the
+  server messages are a stripped down copy of idAsyncClient's, because that
+  one is tied to the session, the game and the single client port. Protocol
+  changes to those parts have to be made in both places.
+
+===============================================================================
+*/
+
+typedef enum {
+	LTS_DISCONNECTED,
+	LTS_CHALLENGING,
+	LTS_CONNECTING,
+	LTS_CONNECTED,
+	LTS_INGAME
+} loadTestState_t;
+
+class idLoadTestClient
+{
+	public:
+		idLoadTestClient();
+
+		void				Connect(const netadr_t adr, int index);
+		void				Disconnect(void);
+		void				RunFrame(int time);
+
+		loadTestState_t		GetState(void) const {
+			return state;
+		}
+		const idMsgChannel &GetChannel(void) const {
+			return channel;
+		}
+		int					GetNumSnapshots(void) const {
+			return numSnapshots;
+		}
+		void				ClearNumSnapshots(void) {
+			numSnapshots = 0;
+		}
+
+	private:
+		idPort				port;
+		idMsgChannel		channel;
+		netadr_t			serverAddress;
+		loadTestState_t		state;
+		idRandom			random;
+
+		int					index;
+		int					clientId;
+		int					clientNum;
+		int					clientTime;
+		int					serverId;
+		int					serverChallenge;
+		int					serverMessageSequence;
+
+		int					gameInitId;
+		int					gameFrame;
+		int					gameTime;
+		int					snapshotSequence;
+		int					numSnapshots;
+
+		int					lastConnectTime;
+		int					lastPacketTime;
+		int					lastEmptyTime;
+		int					lastUsercmdTime;
+
+		usercmd_t			userCmds[MAX_USERCMD_BACKUP];
+
+	private:
+		void				SendConnectionless(const idBitMsg &msg);
+		void				SetupConnection(void);
+		void				SendEmpty(bool force);
+		void				SendPingResponse(int time);
+		void				SendUsercmds(void);
+		void				SendReliable(const idBitMsg &msg);
+		void				GenerateUsercmd(usercmd_t &cmd);
+
+		void				ProcessMessage(const netadr_t from, idBitMsg &msg);
+		void				ConnectionlessMessage(const netadr_t from, const idBitMsg &msg);
+		void				ProcessUnreliableMessage(const idBitMsg &msg);
+		void				ProcessReliableMessages(void);
+};
+
+class idLoadTest
+{
+	public:
+		idLoadTest();
+
+		void				Start(const netadr_t adr, int numClients, int rampTime);
+		void				Stop(void);
+		void				RunFrame(void);
+
+		bool				IsActive(void) const {
+			return active;
+		}
+
+	private:
+		bool				active;
+		netadr_t			serverAddress;
+		int					numClients;
+		int					numStarted;
+		int					rampTime;
+		int					nextStartTime;
+		int					nextReportTime;
+		idLoadTestClient	clients[MAX_ASYNC_CLIENTS];
+
+	private:
+		void				Report(int time);
+};
+
+#endif /* !__LOADTEST_H__ */
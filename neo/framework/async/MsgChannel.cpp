@@ -55,6 +55,14 @@ All fragments will have the same sequence numbers.
 idCVar net_channelShowPackets("net_channelShowPackets", "0", CVAR_SYSTEM | CVAR_BOOL, "show all packets");
 idCVar net_channelShowDrop("net_channelShowDrop", "0", CVAR_SYSTEM | CVAR_BOOL, "show dropped packets");
 
+// uncompressed payloads of the messages sent after "testChannelCompression capture"
+#define	MAX_CAPTURED_MESSAGES	8
+
+static byte				capturedMessages[MAX_CAPTURED_MESSAGES][MAX_MESSAGE_SIZE];
+static int				capturedMessageSizes[MAX_CAPTURED_MESSAGES];
+static unsigned int		numCapturedMessages;
+static bool				captureMessages;
+
 /*
 ===============
 idMsgQueue::idMsgQueue
@@ -265,6 +273,8 @@ idMsgChannel::idMsgChannel
 idMsgChannel::idMsgChannel()
 {
 	id = -1;
+	compressor = NULL;
+	compression = CHANNEL_COMPRESSION_RUNLENGTH;
 }
 
 /*
@@ -279,7 +289,7 @@ void idMsgChannel::Init(const netadr_t adr, const int id)
 	this->remoteAddress = adr;
 	this->id = id;
 	this->maxRate = 50000;
-	this->compressor = idCompressor::AllocRunLength_ZeroBased();
+	SetCompression(CHANNEL_COMPRESSION_RUNLENGTH);
 
 	lastSendTime = 0;
 	lastDataBytes = 0;
@@ -313,6 +323,33 @@ void idMsgChannel::Shutdown(void)
 	compressor = NULL;
 }
 
+/*
+=================
+AllocChannelCompressor
+=================
+*/
+static idCompressor *AllocChannelCompressor(const channelCompression_t type)
+{
+	switch (type) {
+		case CHANNEL_COMPRESSION_RANGECODER:
+			return idCompressor::AllocRangeCoder();
+		default:
+			return idCompressor::AllocRunLength_ZeroBased();
+	}
+}
+
+/*
+=================
+idMsgChannel::SetCompression
+=================
+*/
+void idMsgChannel::SetCompression(const channelCompression_t type)
+{
+	delete compressor;
+	compressor = AllocChannelCompressor(type);
+	compression = type;
+}
+
 /*
 =================
 idMsgChannel::ResetRate
@@ -357,6 +394,7 @@ idMsgChannel::WriteMessageData
 */
 void idMsgChannel::WriteMessageData(idBitMsg &out, const idBitMsg &msg)
 {
+	int i;
 	idBitMsg tmp;
 	byte tmpBuf[MAX_MESSAGE_SIZE];
 
@@ -373,6 +411,17 @@ void idMsgChannel::WriteMessageData(idBitMsg &out, const idBitMsg &msg)
 	// write data
 	tmp.WriteData(msg.GetData(), msg.GetSize());
 
+	// keep a copy for testChannelCompression, only while it is capturing
+	if (captureMessages) {
+		i = numCapturedMessages++;
+		memcpy(capturedMessages[i], tmp.GetData(), tmp.GetSize());
+		capturedMessageSizes[i] = tmp.GetSize();
+
+		if (numCapturedMessages >= MAX_CAPTURED_MESSAGES) {
+			captureMessages = false;
+		}
+	}
+
 	// write message size
 	out.WriteShort(tmp.GetSize());
 
@@ -851,3 +900,139 @@ float idMsgChannel::GetIncomingPacketLoss(void) const
 
 	return incomingDroppedPackets * 100.0f / (incomingReceivedPackets + incomingDroppedPackets);
 }
+
+/*
+=================
+TestCompressionRoundTrip
+
+Compresses the data the way WriteMessageData does, decompresses it the way
+ReadMessageData does and compares the result.  Returns the compressed size,
+or -1 if the data didn't survive.
+=================
+*/
+static int TestCompressionRoundTrip(const channelCompression_t type, const byte *data, int size)
+{
+	idCompressor	*compressor;
+	idBitMsg		msg;
+	byte			msgBuf[MAX_MESSAGE_SIZE * 3];
+	byte			outBuf[MAX_MESSAGE_SIZE];
+	int				compressedSize;
+
+	compressor = AllocChannelCompressor(type);
+
+	msg.Init(msgBuf, sizeof(msgBuf));
+	{
+		idFile_BitMsg file(msg);
+		compressor->Init(&file, true, 3);
+		compressor->Write(data, size);
+		compressor->FinishCompress();
+	}
+	compressedSize = msg.GetSize();
+
+	memset(outBuf, 0xcd, sizeof(outBuf));
+	msg.BeginReading();
+	{
+		const idBitMsg &constMsg = msg;
+		idFile_BitMsg file(constMsg);
+		compressor->Init(&file, false, 3);
+		compressor->Read(outBuf, size);
+	}
+
+	delete compressor;
+
+	if (memcmp(data, outBuf, size) != 0) {
+		return -1;
+	}
+
+	return compressedSize;
+}
+
+/*
+=================
+TestCompressionBuffer
+=================
+*/
+static bool TestCompressionBuffer(const char *name, const byte *data, int size)
+{
+	static const char	*names[] = { "run length", "range coder" };
+	int					i, compressedSize;
+	bool				ok;
+
+	ok = true;
+	common->Printf("%-12s %6d bytes:", name, size);
+
+	for (i = 0; i <= CHANNEL_COMPRESSION_MAX; i++) {
+		compressedSize = TestCompressionRoundTrip((channelCompression_t)i, data, size);
+
+		if (compressedSize < 0) {
+			common->Printf("  %s FAILED", names[i]);
+			ok = false;
+		} else {
+			common->Printf("  %s %6d", names[i], compressedSize);
+		}
+	}
+
+	common->Printf("\n");
+
+	return ok;
+}
+
+/*
+=================
+idMsgChannel::TestCompression_f
+=================
+*/
+void idMsgChannel::TestCompression_f(const idCmdArgs &args)
+{
+	static const int	sizes[] = { 1, 7, 64, 300, 1400, 4096, MAX_MESSAGE_SIZE };
+	const int			numSizes = sizeof(sizes) / sizeof(sizes[0]);
+	byte				buffer[MAX_MESSAGE_SIZE];
+	idRandom			random;
+	int					i, j, numFailed;
+
+	if (args.Argc() > 1 && !idStr::Icmp(args.Argv(1), "capture")) {
+		numCapturedMessages = 0;
+		captureMessages = true;
+		common->Printf("capturing the next %d messages sent\n", MAX_CAPTURED_MESSAGES);
+		return;
+	}
+
+	random.SetSeed(args.Argc() > 1 ? atoi(args.Argv(1)) : 0);
+	numFailed = 0;
+
+	for (i = 0; i < numSizes; i++) {
+		// incompressible
+		for (j = 0; j < sizes[i]; j++) {
+			buffer[j] = random.RandomInt(256);
+		}
+
+		if (!TestCompressionBuffer("random", buffer, sizes[i])) {
+			numFailed++;
+		}
+
+		// mostly zero, like delta compressed snapshots
+		for (j = 0; j < sizes[i]; j++) {
+			buffer[j] = (random.RandomInt(8) == 0) ? random.RandomInt(256) : 0;
+		}
+
+		if (!TestCompressionBuffer("sparse", buffer, sizes[i])) {
+			numFailed++;
+		}
+	}
+
+	// the captured messages, snapshots when running a server
+	for (i = 0; i < (int)numCapturedMessages; i++) {
+		j = capturedMessageSizes[i];
+		memcpy(buffer, capturedMessages[i], j);
+
+		if (!TestCompressionBuffer("message", buffer, j)) {
+			numFailed++;
+		}
+	}
+
+	if (!numCapturedMessages) {
+		common->Printf("no messages captured, run \"testChannelCompression capture\" on a server or client to also test real messages\n");
+	}
+
+	common->Printf("%d buffers failed\n", numFailed);
+}
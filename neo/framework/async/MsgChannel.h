@@ -90,6 +90,13 @@ class idMsgQueue
 };
 
 
+// compression applied to the channel payload, negotiated at connect time
+typedef enum {
+	CHANNEL_COMPRESSION_RUNLENGTH,		// zero based run length, understood by every peer
+	CHANNEL_COMPRESSION_RANGECODER,		// adaptive range coding
+	CHANNEL_COMPRESSION_MAX = CHANNEL_COMPRESSION_RANGECODER
+} channelCompression_t;
+
 class idMsgChannel
 {
 	public:
@@ -124,6 +131,15 @@ class idMsgChannel
 			return incomingRateBytes;
 		}
 
+		// Sets the compression used for the channel payload. Both sides of the
+		// channel have to use the same compression.
+		void			SetCompression(const channelCompression_t type);
+
+		// Returns the compression used for the channel payload.
+		channelCompression_t GetCompression(void) const {
+			return compression;
+		}
+
 		// Returns the average outgoing compression ratio over the last second.
 		float			GetOutgoingCompression(void) const {
 			return outgoingCompression;
@@ -166,11 +182,16 @@ class idMsgChannel
 		// Removes any pending outgoing or incoming reliable messages.
 		void			ClearReliableMessages(void);
 
+		// Compresses and decompresses random buffers and the last messages sent on
+		// any channel with every channel compression, and compares the bytes.
+		static void		TestCompression_f(const idCmdArgs &args);
+
 	private:
 		netadr_t		remoteAddress;	// address of remote host
 		int				id;				// our identification used instead of port number
 		int				maxRate;		// maximum number of bytes that may go out per second
 		idCompressor 	*compressor;		// compressor used for data compression
+		channelCompression_t compression;	// type of the compressor
 
 		// variables to control the outgoing rate
 		int				lastSendTime;	// last time data was sent out
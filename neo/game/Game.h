@@ -158,6 +158,11 @@ class idGame
 		// Writes a snapshot of the server game state for the given client.
 		virtual void				ServerWriteSnapshot(int clientNum, int sequence, idBitMsg &msg, byte *clientInPVS, int numPVSClients) = 0;
 
+		// Prepares writing snapshots for the given clients. Until ServerEndSnapshots is called the game state
+		// must not change and ServerWriteSnapshot may be called for these clients from several threads at once.
+		virtual void				ServerBeginSnapshots(const int *clientNums, int numClients) = 0;
+		virtual void				ServerEndSnapshots(void) = 0;
+
 		// Patches the network entity states at the server with a snapshot for the given client.
 		virtual bool				ServerApplySnapshot(int clientNum, int sequence) = 0;
 
@@ -191,6 +196,9 @@ class idGame
 		virtual bool				DownloadRequest(const char *IP, const char *guid, const char *paks, char urls[ MAX_STRING_CHARS ]) = 0;
 
 		virtual void				GetMapLoadingGUI(char gui[ MAX_STRING_CHARS ]) = 0;
+
+		// Returns the memory the game allocated with the tag from its own heap.
+		virtual void				GetMemoryTagStats(const memTag_t tag, memTagStats_t &stats) = 0;
 };
 
 extern idGame 					*game;
@@ -320,7 +328,7 @@ extern idGameEdit 				*gameEdit;
 ===============================================================================
 */
 
-const int GAME_API_VERSION		= 8;
+const int GAME_API_VERSION		= 10;
 
 typedef struct {
 
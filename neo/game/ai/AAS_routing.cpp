@@ -142,7 +142,7 @@ void idAASLocal::CalculateAreaTravelTimes(void)
 		numAreaTravelTimes += numReach * numRevReach;
 	}
 
-	areaTravelTimes = (unsigned short *) Mem_Alloc(numAreaTravelTimes * sizeof(unsigned short));
+	areaTravelTimes = (unsigned short *) Mem_Alloc(numAreaTravelTimes * sizeof(unsigned short), TAG_AAS);
 	bytePtr = (byte *) areaTravelTimes;
 
 	for (n = 0; n < file->GetNumAreas(); n++) {
@@ -215,7 +215,7 @@ void idAASLocal::SetupRoutingCache(void)
 	}
 
 	areaCacheIndex = (idRoutingCache ** *) Mem_ClearedAlloc(file->GetNumClusters() * sizeof(idRoutingCache **) +
-	                 areaCacheIndexSize * sizeof(idRoutingCache *));
+	                 areaCacheIndexSize * sizeof(idRoutingCache *), TAG_AAS);
 	bytePtr = ((byte *)areaCacheIndex) + file->GetNumClusters() * sizeof(idRoutingCache **);
 
 	for (i = 0; i < file->GetNumClusters(); i++) {
@@ -224,12 +224,12 @@ void idAASLocal::SetupRoutingCache(void)
 	}
 
 	portalCacheIndexSize = file->GetNumAreas();
-	portalCacheIndex = (idRoutingCache **) Mem_ClearedAlloc(portalCacheIndexSize * sizeof(idRoutingCache *));
+	portalCacheIndex = (idRoutingCache **) Mem_ClearedAlloc(portalCacheIndexSize * sizeof(idRoutingCache *), TAG_AAS);
 
-	areaUpdate = (idRoutingUpdate *) Mem_ClearedAlloc(file->GetNumAreas() * sizeof(idRoutingUpdate));
-	portalUpdate = (idRoutingUpdate *) Mem_ClearedAlloc((file->GetNumPortals()+1) * sizeof(idRoutingUpdate));
+	areaUpdate = (idRoutingUpdate *) Mem_ClearedAlloc(file->GetNumAreas() * sizeof(idRoutingUpdate), TAG_AAS);
+	portalUpdate = (idRoutingUpdate *) Mem_ClearedAlloc((file->GetNumPortals()+1) * sizeof(idRoutingUpdate), TAG_AAS);
 
-	goalAreaTravelTimes = (unsigned short *) Mem_ClearedAlloc(file->GetNumAreas() * sizeof(unsigned short));
+	goalAreaTravelTimes = (unsigned short *) Mem_ClearedAlloc(file->GetNumAreas() * sizeof(unsigned short), TAG_AAS);
 
 	cacheListStart = cacheListEnd = NULL;
 	totalCacheMemory = 0;
@@ -29,6 +29,8 @@ If you have questions concerning this license or the applicable additional terms
 #include "../idlib/precompiled.h"
 #pragma hdrstop
 
+#include <pthread.h>
+
 #ifndef USE_LIBC_MALLOC
 #define USE_LIBC_MALLOC		0
 #endif
@@ -41,16 +43,48 @@ If you have questions concerning this license or the applicable additional terms
 //
 //	idHeap
 //
+//	Safe to use from any thread.  Small blocks are handed out from
+//	per thread caches without locking, the caches are refilled from
+//	and flushed to lists shared under a lock.  The medium and large
+//	heap managers are used under the same lock.
+//
 //===============================================================
 
-#define SMALL_HEADER_SIZE		( (intptr_t) ( sizeof( byte ) + sizeof( byte ) ) )
-#define MEDIUM_HEADER_SIZE		( (intptr_t) ( sizeof( mediumHeapEntry_s ) + sizeof( byte ) ) )
-#define LARGE_HEADER_SIZE		( (intptr_t) ( sizeof( intptr_t * ) + sizeof( byte ) ) )
+#define SMALL_CLASS_ALIGN		16								// small blocks come in multiples of 16 bytes, all 16 byte aligned
+#define SMALL_CLASS_MAX			512								// largest small block
+#define NUM_SMALL_CLASSES		( SMALL_CLASS_MAX / SMALL_CLASS_ALIGN )
+#define SMALL_CLASS( bytes )	( ( (bytes) - 1 ) / SMALL_CLASS_ALIGN )
+#define SMALL_CLASS_SIZE( c )	( ( (c) + 1 ) * SMALL_CLASS_ALIGN )
+#define SMALL_CHUNK_BITS		16								// the blocks of a class are carved from aligned 64 kB chunks
+#define SMALL_CHUNK_SIZE		( 1 << SMALL_CHUNK_BITS )
+#define SMALL_CHUNK_HEADER		16
+#define CHUNK_MAP_BITS			16								// the chunk map covers 48 bit addresses in two levels
+#define THREAD_CACHE_SIZE		8192							// bytes of free blocks a thread keeps per class
+
+// the last two header bytes hold the memory tag and the allocation identifier
+#define MEDIUM_HEADER_SIZE		( (intptr_t) ( sizeof( mediumHeapEntry_s ) + 2 * sizeof( byte ) ) )
+#define LARGE_HEADER_SIZE		( (intptr_t) ( sizeof( intptr_t * ) + 2 * sizeof( byte ) ) )
+#define ALIGNED_HEADER_SIZE		16								// original pointer, size, tag and identifier of a 16 byte aligned block
 
 #define ALIGN_SIZE( bytes )		( ( (bytes) + ALIGN - 1 ) & ~(ALIGN - 1) )
-#define SMALL_ALIGN( bytes )	( ALIGN_SIZE( (bytes) + SMALL_HEADER_SIZE ) - SMALL_HEADER_SIZE )
 #define MEDIUM_SMALLEST_SIZE	( ALIGN_SIZE( 256 ) + ALIGN_SIZE( MEDIUM_HEADER_SIZE ) )
 
+// the small blocks and statistics of one thread
+typedef struct memThreadCache_s {
+	void 					*firstFree[NUM_SMALL_CLASSES];
+	int						numFree[NUM_SMALL_CLASSES];
+	memoryStats_t			totalAllocs;
+	memoryStats_t			frameAllocs;
+	memoryStats_t			frameFrees;
+	struct memThreadCache_s *next;
+} memThreadCache_t;
+
+static __thread memThreadCache_t	*mem_threadCache = NULL;
+static __thread int					mem_threadCacheGeneration = 0;	// of the heap the cache belongs to
+static int							mem_heapGeneration = 0;
+
+void Mem_UpdateStats(memoryStats_t &stats, int size);
+
 
 class idHeap
 {
@@ -59,15 +93,22 @@ class idHeap
 		idHeap(void);
 		~idHeap(void);				// frees all associated data
 		void			Init(void);					// initialize
-		void 			*Allocate(const dword bytes);	// allocate memory
+		void 			*Allocate(const dword bytes, const memTag_t tag);	// allocate memory
 		void			Free(void *p);				// free memory
-		void 			*Allocate16(const dword bytes);  // allocate 16 byte aligned memory
+		void 			*Allocate16(const dword bytes, const memTag_t tag);  // allocate 16 byte aligned memory
 		void			Free16(void *p);				// free 16 byte aligned memory
 		dword			Msize(void *p);				// return size of data block
+		memTag_t		Mtag(void *p);				// return tag of data block
 		void			Dump(void);
 
 		void 			AllocDefragBlock(void);		// hack for huge renderbumps
 
+		void			UpdateAllocStats(int size);	// statistics are kept per thread
+		void			UpdateFreeStats(int size);
+		void			GetStats(memoryStats_t &stats);
+		void			GetFrameStats(memoryStats_t &allocs, memoryStats_t &frees);
+		void			ClearFrameStats(void);
+
 	private:
 
 		enum {
@@ -76,9 +117,9 @@ class idHeap
 
 		enum {
 			INVALID_ALLOC	= 0xdd,
-			SMALL_ALLOC		= 0xaa,						// small allocation
 			MEDIUM_ALLOC	= 0xbb,						// medium allocaction
-			LARGE_ALLOC		= 0xcc						// large allocaction
+			LARGE_ALLOC		= 0xcc,						// large allocaction
+			ALIGNED_ALLOC	= 0xee						// 16 byte aligned allocation
 		};
 
 		struct page_s {									// allocation page
@@ -100,11 +141,23 @@ class idHeap
 			dword				freeBlock;				// non-zero if free block
 		};
 
+		struct smallChunk_s {							// chunk carved into small blocks of one class
+			dword				sizeClass;
+			dword				blocks;					// offset of the first block, the tag of each block is stored in front
+			smallChunk_s 		*next;
+		};
+
 		// variables
-		void 			*smallFirstFree[256/ALIGN+1];	// small heap allocator lists (for allocs of 1-255 bytes)
-		page_s 		*smallCurPage;					// current page for small allocations
-		dword			smallCurPageOffset;				// byte offset in current page
-		page_s 		*smallFirstUsedPage;				// first used page of the small heap manager
+		pthread_mutex_t	lock;							// recursive, held for everything but the thread caches
+		int				generation;
+
+		void 			*smallFirstFree[NUM_SMALL_CLASSES];	// small blocks flushed by the thread caches
+		byte 			*smallCurBlock[NUM_SMALL_CLASSES];	// unused part of the newest chunk of each class
+		byte 			*smallEndBlock[NUM_SMALL_CLASSES];
+		smallChunk_s 	*smallChunks;					// all chunks, only freed with the heap
+		dword			smallChunksAllocated;
+		dword 			*smallChunkMap[1 << CHUNK_MAP_BITS];	// bit set for each chunk, read without locking
+		memThreadCache_t *threadCaches;					// one per thread that used the heap
 
 		page_s 		*mediumFirstFreePage;			// first partially free page
 		page_s 		*mediumLastFreePage;				// last partially free page
@@ -120,8 +173,6 @@ class idHeap
 		dword			pageRequests;					// page requests
 		dword			OSAllocs;						// number of allocs made to the OS
 
-		int				c_heapAllocRunningCount;
-
 		void			*defragBlock;					// a single huge block that can be allocated
 		// at startup, then freed when needed
 
@@ -129,8 +180,14 @@ class idHeap
 		page_s 		*AllocatePage(dword bytes);	// allocate page from the OS
 		void			FreePage(idHeap::page_s *p);	// free an OS allocated page
 
-		void 			*SmallAllocate(dword bytes);	// allocate memory (1-255 bytes) from small heap manager
-		void			SmallFree(void *ptr);			// free memory allocated by small heap manager
+		memThreadCache_t *GetThreadCache(void);			// cache of the calling thread
+		bool			IsSmallBlock(const void *ptr) const;
+		void			AllocateSmallChunk(dword sizeClass);
+		void			FillThreadCache(memThreadCache_t *cache, dword sizeClass);
+		void			FlushThreadCache(memThreadCache_t *cache, dword sizeClass, int count);
+		byte 			*SmallBlockTag(const void *ptr) const;
+		void 			*SmallAllocate(dword bytes, memTag_t tag);	// allocate memory (1-512 bytes) from the thread cache
+		void			SmallFree(void *ptr);			// free memory allocated by SmallAllocate
 
 		void 			*MediumAllocateFromPage(idHeap::page_s *p, dword sizeNeeded);
 		void 			*MediumAllocate(dword bytes);	// allocate memory (256-32768 bytes) from medium heap manager
@@ -151,6 +208,16 @@ idHeap::Init
 */
 void idHeap::Init()
 {
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&lock, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	// thread caches of an earlier heap are replaced on first use
+	generation			= ++mem_heapGeneration;
+
 	OSAllocs			= 0;
 	pageRequests		= 0;
 	pageSize			= 65536 - sizeof(idHeap::page_s);
@@ -160,18 +227,18 @@ void idHeap::Init()
 	swapPage			= NULL;
 
 	memset(smallFirstFree, 0, sizeof(smallFirstFree));	// init small heap manager
-	smallFirstUsedPage	= NULL;
-	smallCurPage		= AllocatePage(pageSize);
-	assert(smallCurPage);
-	smallCurPageOffset	= SMALL_ALIGN(0);
+	memset(smallCurBlock, 0, sizeof(smallCurBlock));
+	memset(smallEndBlock, 0, sizeof(smallEndBlock));
+	memset(smallChunkMap, 0, sizeof(smallChunkMap));
+	smallChunks			= NULL;
+	smallChunksAllocated = 0;
+	threadCaches		= NULL;
 
 	defragBlock = NULL;
 
 	mediumFirstFreePage	= NULL;								// init medium heap manager
 	mediumLastFreePage	= NULL;
 	mediumFirstUsedPage	= NULL;
-
-	c_heapAllocRunningCount = 0;
 }
 
 /*
@@ -195,17 +262,24 @@ idHeap::~idHeap(void)
 {
 
 	idHeap::page_s	*p;
+	int				i;
 
-	if (smallCurPage) {
-		FreePage(smallCurPage);			// free small-heap current allocation page
+	while (smallChunks) {					// free small-heap chunks
+		smallChunk_s *next = smallChunks->next;
+		::free(smallChunks);
+		smallChunks = next;
 	}
 
-	p = smallFirstUsedPage;					// free small-heap allocated pages
+	for (i = 0; i < (1 << CHUNK_MAP_BITS); i++) {
+		if (smallChunkMap[i]) {
+			::free(smallChunkMap[i]);
+		}
+	}
 
-	while (p) {
-		idHeap::page_s *next = p->next;
-		FreePage(p);
-		p= next;
+	while (threadCaches) {					// the caches only hold blocks of the freed chunks
+		memThreadCache_t *next = threadCaches->next;
+		::free(threadCaches);
+		threadCaches = next;
 	}
 
 	p = largeFirstUsedPage;					// free large-heap allocated pages
@@ -238,6 +312,8 @@ idHeap::~idHeap(void)
 		free(defragBlock);
 	}
 
+	pthread_mutex_destroy(&lock);
+
 	assert(pagesAllocated == 0);
 }
 
@@ -250,7 +326,10 @@ void idHeap::AllocDefragBlock(void)
 {
 	int		size = 0x40000000;
 
+	pthread_mutex_lock(&lock);
+
 	if (defragBlock) {
+		pthread_mutex_unlock(&lock);
 		return;
 	}
 
@@ -264,6 +343,8 @@ void idHeap::AllocDefragBlock(void)
 		size >>= 1;
 	}
 
+	pthread_mutex_unlock(&lock);
+
 	idLib::common->Printf("Allocated a %i mb defrag block\n", size / (1024*1024));
 }
 
@@ -272,27 +353,37 @@ void idHeap::AllocDefragBlock(void)
 idHeap::Allocate
 ================
 */
-void *idHeap::Allocate(const dword bytes)
+void *idHeap::Allocate(const dword bytes, const memTag_t tag)
 {
+	void *p;
+
 	if (!bytes) {
 		return NULL;
 	}
 
-	c_heapAllocRunningCount++;
-
 #if USE_LIBC_MALLOC
 	return malloc(bytes);
 #else
 
-	if (!(bytes & ~255)) {
-		return SmallAllocate(bytes);
+	if (bytes <= SMALL_CLASS_MAX) {
+		return SmallAllocate(bytes, tag);
 	}
 
+	pthread_mutex_lock(&lock);
+
 	if (!(bytes & ~32767)) {
-		return MediumAllocate(bytes);
+		p = MediumAllocate(bytes);
+	} else {
+		p = LargeAllocate(bytes);
 	}
 
-	return LargeAllocate(bytes);
+	pthread_mutex_unlock(&lock);
+
+	if (p) {
+		((byte *)p)[-2] = tag;
+	}
+
+	return p;
 #endif
 }
 
@@ -307,17 +398,18 @@ void idHeap::Free(void *p)
 		return;
 	}
 
-	c_heapAllocRunningCount--;
-
 #if USE_LIBC_MALLOC
 	free(p);
 #else
 
+	if (IsSmallBlock(p)) {
+		SmallFree(p);
+		return;
+	}
+
+	pthread_mutex_lock(&lock);
+
 	switch (((byte *)(p))[-1]) {
-		case SMALL_ALLOC: {
-			SmallFree(p);
-			break;
-		}
 		case MEDIUM_ALLOC: {
 			MediumFree(p);
 			break;
@@ -327,11 +419,14 @@ void idHeap::Free(void *p)
 			break;
 		}
 		default: {
+			pthread_mutex_unlock(&lock);
 			idLib::common->FatalError("idHeap::Free: invalid memory block (%s)", idLib::sys->GetCallStackCurStr(4));
-			break;
+			return;
 		}
 	}
 
+	pthread_mutex_unlock(&lock);
+
 #endif
 }
 
@@ -340,33 +435,45 @@ void idHeap::Free(void *p)
 idHeap::Allocate16
 ================
 */
-void *idHeap::Allocate16(const dword bytes)
+void *idHeap::Allocate16(const dword bytes, const memTag_t tag)
 {
 	byte *ptr, *alignedPtr;
 
-	ptr = (byte *) malloc(bytes + 16 + sizeof(intptr_t));
+#if !USE_LIBC_MALLOC
+
+	// the small blocks are 16 byte aligned already
+	if (bytes <= SMALL_CLASS_MAX) {
+		return SmallAllocate(bytes, tag);
+	}
+
+#endif
+
+	ptr = (byte *) malloc(bytes + 15 + ALIGNED_HEADER_SIZE);
 
 	if (!ptr) {
+		pthread_mutex_lock(&lock);
+
 		if (defragBlock) {
 			idLib::common->Printf("Freeing defragBlock on alloc of %i.\n", bytes);
 			free(defragBlock);
 			defragBlock = NULL;
-			ptr = (byte *) malloc(bytes + 16 + sizeof(intptr_t));
+			ptr = (byte *) malloc(bytes + 15 + ALIGNED_HEADER_SIZE);
 			AllocDefragBlock();
 		}
 
+		pthread_mutex_unlock(&lock);
+
 		if (!ptr) {
 			common->FatalError("malloc failure for %i", bytes);
 		}
 	}
 
-	alignedPtr = (byte *)((((intptr_t) ptr) + 15) & ~15);
+	alignedPtr = (byte *)((((intptr_t) ptr) + 15 + ALIGNED_HEADER_SIZE) & ~15);
 
-	if (alignedPtr - ptr < sizeof(intptr_t)) {
-		alignedPtr += 16;
-	}
-
-	*((intptr_t *)(alignedPtr - sizeof(intptr_t))) = (intptr_t) ptr;
+	*((intptr_t *)(alignedPtr - ALIGNED_HEADER_SIZE)) = (intptr_t) ptr;
+	*((dword *)(alignedPtr - 8)) = bytes;
+	alignedPtr[-2] = tag;
+	alignedPtr[-1] = ALIGNED_ALLOC;			// allocation identifier
 	return (void *) alignedPtr;
 }
 
@@ -377,7 +484,16 @@ idHeap::Free16
 */
 void idHeap::Free16(void *p)
 {
-	free((void *) *((intptr_t *)(((byte *) p) - sizeof(intptr_t))));
+#if !USE_LIBC_MALLOC
+
+	if (IsSmallBlock(p)) {
+		SmallFree(p);
+		return;
+	}
+
+#endif
+
+	free((void *) *((intptr_t *)(((byte *) p) - ALIGNED_HEADER_SIZE)));
 }
 
 /*
@@ -405,16 +521,20 @@ dword idHeap::Msize(void *p)
 #endif
 #else
 
+	if (IsSmallBlock(p)) {
+		return SMALL_CLASS_SIZE(((smallChunk_s *)(((intptr_t)p) & ~(SMALL_CHUNK_SIZE - 1)))->sizeClass);
+	}
+
 	switch (((byte *)(p))[-1]) {
-		case SMALL_ALLOC: {
-			return SMALL_ALIGN(((byte *)(p))[-SMALL_HEADER_SIZE] * ALIGN);
-		}
 		case MEDIUM_ALLOC: {
 			return ((mediumHeapEntry_s *)(((byte *)(p)) - ALIGN_SIZE(MEDIUM_HEADER_SIZE)))->size - ALIGN_SIZE(MEDIUM_HEADER_SIZE);
 		}
 		case LARGE_ALLOC: {
 			return ((idHeap::page_s *)(*((intptr_t *)(((byte *)p) - ALIGN_SIZE(LARGE_HEADER_SIZE)))))->dataSize - ALIGN_SIZE(LARGE_HEADER_SIZE);
 		}
+		case ALIGNED_ALLOC: {
+			return *((dword *)(((byte *)p) - 8));
+		}
 		default: {
 			idLib::common->FatalError("idHeap::Msize: invalid memory block (%s)", idLib::sys->GetCallStackCurStr(4));
 			return 0;
@@ -424,6 +544,42 @@ dword idHeap::Msize(void *p)
 #endif
 }
 
+/*
+================
+idHeap::Mtag
+
+  returns the tag the memory block was allocated with
+================
+*/
+memTag_t idHeap::Mtag(void *p)
+{
+	if (!p) {
+		return TAG_MISC;
+	}
+
+#if USE_LIBC_MALLOC
+	return TAG_MISC;
+#else
+
+	if (IsSmallBlock(p)) {
+		return (memTag_t) *SmallBlockTag(p);
+	}
+
+	switch (((byte *)(p))[-1]) {
+		case MEDIUM_ALLOC:
+		case LARGE_ALLOC:
+		case ALIGNED_ALLOC: {
+			return (memTag_t)((byte *)(p))[-2];
+		}
+		default: {
+			idLib::common->FatalError("idHeap::Mtag: invalid memory block (%s)", idLib::sys->GetCallStackCurStr(4));
+			return TAG_MISC;
+		}
+	}
+
+#endif
+}
+
 /*
 ================
 idHeap::Dump
@@ -433,17 +589,38 @@ idHeap::Dump
 */
 void idHeap::Dump(void)
 {
-	idHeap::page_s	*pg;
+	idHeap::page_s		*pg;
+	smallChunk_s		*chunk;
+	memThreadCache_t	*cache;
+	int					i, numChunks[NUM_SMALL_CLASSES], numThreadCaches, numCached;
+
+	pthread_mutex_lock(&lock);
+
+	memset(numChunks, 0, sizeof(numChunks));
 
-	for (pg = smallFirstUsedPage; pg; pg = pg->next) {
-		idLib::common->Printf("%p  bytes %-8d  (in use by small heap)\n", pg->data, pg->dataSize);
+	for (chunk = smallChunks; chunk; chunk = chunk->next) {
+		numChunks[chunk->sizeClass]++;
 	}
 
-	if (smallCurPage) {
-		pg = smallCurPage;
-		idLib::common->Printf("%p  bytes %-8d  (small heap active page)\n", pg->data, pg->dataSize);
+	for (i = 0; i < NUM_SMALL_CLASSES; i++) {
+		if (numChunks[i]) {
+			idLib::common->Printf("%8d chunks of %d kB  (small blocks of %d bytes)\n", numChunks[i], SMALL_CHUNK_SIZE >> 10, SMALL_CLASS_SIZE(i));
+		}
+	}
+
+	numThreadCaches = 0;
+	numCached = 0;
+
+	for (cache = threadCaches; cache; cache = cache->next) {
+		numThreadCaches++;
+
+		for (i = 0; i < NUM_SMALL_CLASSES; i++) {
+			numCached += cache->numFree[i] * SMALL_CLASS_SIZE(i);
+		}
 	}
 
+	idLib::common->Printf("%8d kB cached by %d threads\n", numCached >> 10, numThreadCaches);
+
 	for (pg = mediumFirstUsedPage; pg; pg = pg->next) {
 		idLib::common->Printf("%p  bytes %-8d  (completely used by medium heap)\n", pg->data, pg->dataSize);
 	}
@@ -457,6 +634,9 @@ void idHeap::Dump(void)
 	}
 
 	idLib::common->Printf("pages allocated : %d\n", pagesAllocated);
+	idLib::common->Printf("small chunks allocated : %d\n", smallChunksAllocated);
+
+	pthread_mutex_unlock(&lock);
 }
 
 /*
@@ -568,58 +748,233 @@ void idHeap::FreePage(idHeap::page_s *p)
 //
 //	small heap code
 //
+//	Blocks of up to SMALL_CLASS_MAX bytes are rounded up to a size class.
+//	Each thread keeps free lists of its own per class, so most small
+//	allocations and frees don't lock.  A block freed on another thread
+//	just joins that thread's cache.  The blocks of a class are carved
+//	from SMALL_CHUNK_SIZE aligned chunks, and a block is known to be
+//	small if its chunk is set in the chunk map.
+//
 //===============================================================
 
 /*
 ================
-idHeap::SmallAllocate
+idHeap::GetThreadCache
+================
+*/
+ID_INLINE memThreadCache_t *idHeap::GetThreadCache(void)
+{
+	memThreadCache_t *cache;
 
-  allocate memory (1-255 bytes) from the small heap manager
-  bytes = number of bytes to allocate
-  returns pointer to allocated memory
+	if (mem_threadCacheGeneration == generation) {
+		return mem_threadCache;
+	}
+
+	cache = (memThreadCache_t *) ::calloc(1, sizeof(memThreadCache_t));
+
+	if (!cache) {
+		common->FatalError("malloc failure for %i", (int)sizeof(memThreadCache_t));
+	}
+
+	cache->totalAllocs.minSize = cache->frameAllocs.minSize = cache->frameFrees.minSize = 0x0fffffff;
+	cache->totalAllocs.maxSize = cache->frameAllocs.maxSize = cache->frameFrees.maxSize = -1;
+
+	pthread_mutex_lock(&lock);
+	cache->next = threadCaches;
+	threadCaches = cache;
+	pthread_mutex_unlock(&lock);
+
+	mem_threadCache = cache;
+	mem_threadCacheGeneration = generation;
+
+	return cache;
+}
+
+/*
+================
+idHeap::IsSmallBlock
+================
+*/
+ID_INLINE bool idHeap::IsSmallBlock(const void *ptr) const
+{
+	uint64_t	address = (uint64_t)(uintptr_t) ptr;
+	dword		*chunks = __atomic_load_n(&smallChunkMap[(address >> (SMALL_CHUNK_BITS + CHUNK_MAP_BITS)) & ((1 << CHUNK_MAP_BITS) - 1)], __ATOMIC_ACQUIRE);
+	dword		index = (address >> SMALL_CHUNK_BITS) & ((1 << CHUNK_MAP_BITS) - 1);
+
+	return (chunks != NULL && (__atomic_load_n(&chunks[index >> 5], __ATOMIC_RELAXED) & (1u << (index & 31))) != 0);
+}
+
+/*
+================
+idHeap::SmallBlockTag
 ================
 */
-void *idHeap::SmallAllocate(dword bytes)
+ID_INLINE byte *idHeap::SmallBlockTag(const void *ptr) const
 {
-	// we need the at least sizeof( intptr_t ) bytes for the free list
-	if (bytes < sizeof(intptr_t)) {
-		bytes = sizeof(intptr_t);
+	smallChunk_s	*chunk = (smallChunk_s *)(((intptr_t)ptr) & ~(SMALL_CHUNK_SIZE - 1));
+	dword			index = ((byte *)ptr - ((byte *)chunk + chunk->blocks)) / SMALL_CLASS_SIZE(chunk->sizeClass);
+
+	return (byte *)chunk + SMALL_CHUNK_HEADER + index;
+}
+
+/*
+================
+idHeap::AllocateSmallChunk
+
+  starts a new chunk for the size class, the lock must be held
+================
+*/
+void idHeap::AllocateSmallChunk(dword sizeClass)
+{
+	smallChunk_s	*chunk;
+	void			*mem;
+	uint64_t		address;
+	dword			**chunks, index, size, numBlocks;
+
+	assert(sizeof(smallChunk_s) <= SMALL_CHUNK_HEADER);
+
+	if (posix_memalign(&mem, SMALL_CHUNK_SIZE, SMALL_CHUNK_SIZE) != 0) {
+		if (defragBlock) {
+			idLib::common->Printf("Freeing defragBlock on alloc of %i.\n", SMALL_CHUNK_SIZE);
+			free(defragBlock);
+			defragBlock = NULL;
+			AllocDefragBlock();
+		}
+
+		if (posix_memalign(&mem, SMALL_CHUNK_SIZE, SMALL_CHUNK_SIZE) != 0) {
+			common->FatalError("malloc failure for %i", SMALL_CHUNK_SIZE);
+		}
+	}
+
+	address = (uint64_t)(uintptr_t) mem;
+
+	if (address >> (SMALL_CHUNK_BITS + 2 * CHUNK_MAP_BITS)) {
+		common->FatalError("idHeap::AllocateSmallChunk: address %p outside the chunk map", mem);
 	}
 
-	// increase the number of bytes if necessary to make sure the next small allocation is aligned
-	bytes = SMALL_ALIGN(bytes);
+	chunks = &smallChunkMap[address >> (SMALL_CHUNK_BITS + CHUNK_MAP_BITS)];
+
+	if (!*chunks) {
+		dword *leaf = (dword *) ::calloc((1 << CHUNK_MAP_BITS) / 32, sizeof(dword));
 
-	byte *smallBlock = (byte *)(smallFirstFree[bytes / ALIGN]);
+		if (!leaf) {
+			common->FatalError("malloc failure for %i", (1 << CHUNK_MAP_BITS) / 8);
+		}
 
-	if (smallBlock) {
-		intptr_t *link = (intptr_t *)(smallBlock + SMALL_HEADER_SIZE);
-		smallBlock[1] = SMALL_ALLOC;					// allocation identifier
-		smallFirstFree[bytes / ALIGN] = (void *)(*link);
-		return (void *)(link);
+		__atomic_store_n(chunks, leaf, __ATOMIC_RELEASE);
 	}
 
-	dword bytesLeft = (intptr_t)(pageSize) - smallCurPageOffset;
+	// other threads only test chunks they got blocks from, so they never see it half set
+	index = (address >> SMALL_CHUNK_BITS) & ((1 << CHUNK_MAP_BITS) - 1);
+	__sync_fetch_and_or(&(*chunks)[index >> 5], 1u << (index & 31));
+
+	// a tag byte per block goes between the header and the blocks
+	size = SMALL_CLASS_SIZE(sizeClass);
+	numBlocks = (SMALL_CHUNK_SIZE - SMALL_CHUNK_HEADER - SMALL_CLASS_ALIGN) / (size + 1);
+
+	chunk = (smallChunk_s *) mem;
+	chunk->sizeClass = sizeClass;
+	chunk->blocks = SMALL_CHUNK_HEADER + ((numBlocks + SMALL_CLASS_ALIGN - 1) & ~(SMALL_CLASS_ALIGN - 1));
+	chunk->next = smallChunks;
+	smallChunks = chunk;
+	smallChunksAllocated++;
+
+	smallCurBlock[sizeClass] = (byte *) mem + chunk->blocks;
+	smallEndBlock[sizeClass] = smallCurBlock[sizeClass] + numBlocks * size;
+}
+
+/*
+================
+idHeap::FillThreadCache
+
+  gives the thread cache half its limit of blocks of the size class,
+  from the shared free list or new chunk space
+================
+*/
+void idHeap::FillThreadCache(memThreadCache_t *cache, dword sizeClass)
+{
+	void	*block;
+	dword	size;
+	int		count;
+
+	size = SMALL_CLASS_SIZE(sizeClass);
+	count = Max(THREAD_CACHE_SIZE / (int)size / 2, 1);
 
-	// if we need to allocate a new page
-	if (bytes >= bytesLeft) {
+	pthread_mutex_lock(&lock);
 
-		smallCurPage->next	= smallFirstUsedPage;
-		smallFirstUsedPage	= smallCurPage;
-		smallCurPage		= AllocatePage(pageSize);
+	for (; count > 0; count--) {
+		block = smallFirstFree[sizeClass];
 
-		if (!smallCurPage) {
-			return NULL;
+		if (block) {
+			smallFirstFree[sizeClass] = *((void **)block);
+		} else {
+			if (smallCurBlock[sizeClass] == smallEndBlock[sizeClass]) {
+				AllocateSmallChunk(sizeClass);
+			}
+
+			block = smallCurBlock[sizeClass];
+			smallCurBlock[sizeClass] += size;
 		}
 
-		// make sure the first allocation is aligned
-		smallCurPageOffset	= SMALL_ALIGN(0);
+		*((void **)block) = cache->firstFree[sizeClass];
+		cache->firstFree[sizeClass] = block;
+		cache->numFree[sizeClass]++;
 	}
 
-	smallBlock			= ((byte *)smallCurPage->data) + smallCurPageOffset;
-	smallBlock[0]		= (byte)(bytes / ALIGN);		// write # of bytes/ALIGN
-	smallBlock[1]		= SMALL_ALLOC;					// allocation identifier
-	smallCurPageOffset  += bytes + SMALL_HEADER_SIZE;	// increase the offset on the current page
-	return (smallBlock + SMALL_HEADER_SIZE);			// skip the first two bytes
+	pthread_mutex_unlock(&lock);
+}
+
+/*
+================
+idHeap::FlushThreadCache
+
+  returns blocks of the size class from the thread cache to the shared free list
+================
+*/
+void idHeap::FlushThreadCache(memThreadCache_t *cache, dword sizeClass, int count)
+{
+	void	*block;
+
+	pthread_mutex_lock(&lock);
+
+	for (; count > 0 && cache->firstFree[sizeClass]; count--) {
+		block = cache->firstFree[sizeClass];
+		cache->firstFree[sizeClass] = *((void **)block);
+		cache->numFree[sizeClass]--;
+
+		*((void **)block) = smallFirstFree[sizeClass];
+		smallFirstFree[sizeClass] = block;
+	}
+
+	pthread_mutex_unlock(&lock);
+}
+
+/*
+================
+idHeap::SmallAllocate
+
+  allocate memory (1-512 bytes) from the thread cache
+  bytes = number of bytes to allocate
+  returns pointer to allocated memory
+================
+*/
+void *idHeap::SmallAllocate(dword bytes, memTag_t tag)
+{
+	memThreadCache_t	*cache = GetThreadCache();
+	dword				sizeClass = SMALL_CLASS(bytes);
+	void				*block;
+
+	if (!cache->firstFree[sizeClass]) {
+		FillThreadCache(cache, sizeClass);
+	}
+
+	block = cache->firstFree[sizeClass];
+	cache->firstFree[sizeClass] = *((void **)block);
+	cache->numFree[sizeClass]--;
+
+	*SmallBlockTag(block) = tag;
+
+	return block;
 }
 
 /*
@@ -632,20 +987,133 @@ idHeap::SmallFree
 */
 void idHeap::SmallFree(void *ptr)
 {
-	((byte *)(ptr))[-1] = INVALID_ALLOC;
-
-	byte *d = ((byte *)ptr) - SMALL_HEADER_SIZE;
-	intptr_t *dt = (intptr_t *)ptr;
-	// index into the table with free small memory blocks
-	dword ix = *d;
+	memThreadCache_t	*cache = GetThreadCache();
+	dword				sizeClass = ((smallChunk_s *)(((intptr_t)ptr) & ~(SMALL_CHUNK_SIZE - 1)))->sizeClass;
+	int					limit;
 
 	// check if the index is correct
-	if (ix > (256 / ALIGN)) {
+	if (sizeClass >= NUM_SMALL_CLASSES) {
 		idLib::common->FatalError("SmallFree: invalid memory block");
 	}
 
-	*dt = (intptr_t)smallFirstFree[ix];	// write next index
-	smallFirstFree[ix] = (void *)d;		// link
+	*((void **)ptr) = cache->firstFree[sizeClass];
+	cache->firstFree[sizeClass] = ptr;
+	cache->numFree[sizeClass]++;
+
+	// don't let a thread that mostly frees hoard the blocks
+	limit = Max(THREAD_CACHE_SIZE / (int)SMALL_CLASS_SIZE(sizeClass), 2);
+
+	if (cache->numFree[sizeClass] > limit) {
+		FlushThreadCache(cache, sizeClass, limit / 2);
+	}
+}
+
+/*
+================
+idHeap::UpdateAllocStats
+================
+*/
+void idHeap::UpdateAllocStats(int size)
+{
+	memThreadCache_t *cache = GetThreadCache();
+
+	Mem_UpdateStats(cache->frameAllocs, size);
+	Mem_UpdateStats(cache->totalAllocs, size);
+}
+
+/*
+================
+idHeap::UpdateFreeStats
+================
+*/
+void idHeap::UpdateFreeStats(int size)
+{
+	memThreadCache_t *cache = GetThreadCache();
+
+	Mem_UpdateStats(cache->frameFrees, size);
+	cache->totalAllocs.num--;
+	cache->totalAllocs.totalSize -= size;
+}
+
+/*
+================
+idHeap::GetStats
+
+  sums up the statistics of all threads
+================
+*/
+void idHeap::GetStats(memoryStats_t &stats)
+{
+	memThreadCache_t *cache;
+
+	stats.num = stats.totalSize = 0;
+	stats.minSize = 0x0fffffff;
+	stats.maxSize = -1;
+
+	pthread_mutex_lock(&lock);
+
+	for (cache = threadCaches; cache; cache = cache->next) {
+		stats.num += cache->totalAllocs.num;
+		stats.totalSize += cache->totalAllocs.totalSize;
+		stats.minSize = Min(stats.minSize, cache->totalAllocs.minSize);
+		stats.maxSize = Max(stats.maxSize, cache->totalAllocs.maxSize);
+	}
+
+	pthread_mutex_unlock(&lock);
+}
+
+/*
+================
+idHeap::GetFrameStats
+================
+*/
+void idHeap::GetFrameStats(memoryStats_t &allocs, memoryStats_t &frees)
+{
+	memThreadCache_t *cache;
+
+	allocs.num = allocs.totalSize = frees.num = frees.totalSize = 0;
+	allocs.minSize = frees.minSize = 0x0fffffff;
+	allocs.maxSize = frees.maxSize = -1;
+
+	pthread_mutex_lock(&lock);
+
+	for (cache = threadCaches; cache; cache = cache->next) {
+		allocs.num += cache->frameAllocs.num;
+		allocs.totalSize += cache->frameAllocs.totalSize;
+		allocs.minSize = Min(allocs.minSize, cache->frameAllocs.minSize);
+		allocs.maxSize = Max(allocs.maxSize, cache->frameAllocs.maxSize);
+
+		frees.num += cache->frameFrees.num;
+		frees.totalSize += cache->frameFrees.totalSize;
+		frees.minSize = Min(frees.minSize, cache->frameFrees.minSize);
+		frees.maxSize = Max(frees.maxSize, cache->frameFrees.maxSize);
+	}
+
+	pthread_mutex_unlock(&lock);
+}
+
+/*
+================
+idHeap::ClearFrameStats
+
+  the other threads may be counting at the same time, which can only
+  make the frame statistics a little off
+================
+*/
+void idHeap::ClearFrameStats(void)
+{
+	memThreadCache_t *cache;
+
+	pthread_mutex_lock(&lock);
+
+	for (cache = threadCaches; cache; cache = cache->next) {
+		cache->frameAllocs.num = cache->frameFrees.num = 0;
+		cache->frameAllocs.minSize = cache->frameFrees.minSize = 0x0fffffff;
+		cache->frameAllocs.maxSize = cache->frameFrees.maxSize = -1;
+		cache->frameAllocs.totalSize = cache->frameFrees.totalSize = 0;
+	}
+
+	pthread_mutex_unlock(&lock);
 }
 
 //===============================================================
@@ -1052,9 +1520,21 @@ void idHeap::LargeFree(void *ptr)
 #undef new
 
 static idHeap 			*mem_heap = NULL;
-static memoryStats_t	mem_total_allocs = { 0, 0x0fffffff, -1, 0 };
-static memoryStats_t	mem_frame_allocs;
-static memoryStats_t	mem_frame_frees;
+static const memoryStats_t	mem_no_stats = { 0, 0x0fffffff, -1, 0 };
+static memTagStats_t	mem_tagStats[TAG_NUM_TAGS];
+
+static const char *mem_tagNames[TAG_NUM_TAGS] = {
+	"misc",
+	"geometry",
+	"images",
+	"sound",
+	"decls",
+	"entities",
+	"script",
+	"collision",
+	"aas",
+	"frame temp"
+};
 
 /*
 ==================
@@ -1063,10 +1543,9 @@ Mem_ClearFrameStats
 */
 void Mem_ClearFrameStats(void)
 {
-	mem_frame_allocs.num = mem_frame_frees.num = 0;
-	mem_frame_allocs.minSize = mem_frame_frees.minSize = 0x0fffffff;
-	mem_frame_allocs.maxSize = mem_frame_frees.maxSize = -1;
-	mem_frame_allocs.totalSize = mem_frame_frees.totalSize = 0;
+	if (mem_heap) {
+		mem_heap->ClearFrameStats();
+	}
 }
 
 /*
@@ -1076,8 +1555,12 @@ Mem_GetFrameStats
 */
 void Mem_GetFrameStats(memoryStats_t &allocs, memoryStats_t &frees)
 {
-	allocs = mem_frame_allocs;
-	frees = mem_frame_frees;
+	if (!mem_heap) {
+		allocs = frees = mem_no_stats;
+		return;
+	}
+
+	mem_heap->GetFrameStats(allocs, frees);
 }
 
 /*
@@ -1087,7 +1570,12 @@ Mem_GetStats
 */
 void Mem_GetStats(memoryStats_t &stats)
 {
-	stats = mem_total_allocs;
+	if (!mem_heap) {
+		stats = mem_no_stats;
+		return;
+	}
+
+	mem_heap->GetStats(stats);
 }
 
 /*
@@ -1117,8 +1605,7 @@ Mem_UpdateAllocStats
 */
 void Mem_UpdateAllocStats(int size)
 {
-	Mem_UpdateStats(mem_frame_allocs, size);
-	Mem_UpdateStats(mem_total_allocs, size);
+	mem_heap->UpdateAllocStats(size);
 }
 
 /*
@@ -1128,9 +1615,79 @@ Mem_UpdateFreeStats
 */
 void Mem_UpdateFreeStats(int size)
 {
-	Mem_UpdateStats(mem_frame_frees, size);
-	mem_total_allocs.num--;
-	mem_total_allocs.totalSize -= size;
+	mem_heap->UpdateFreeStats(size);
+}
+
+/*
+==================
+Mem_UpdateTagAllocStats
+
+  the tag totals are shared by all threads
+==================
+*/
+void Mem_UpdateTagAllocStats(const memTag_t tag, int size)
+{
+	memTagStats_t	*stats;
+	int				current, peak, old;
+
+	assert(tag >= 0 && tag < TAG_NUM_TAGS);
+
+	stats = &mem_tagStats[tag];
+
+	__sync_add_and_fetch(&stats->num, 1);
+	current = __sync_add_and_fetch(&stats->current, size);
+
+	// raise the peak unless another thread raised it further meanwhile
+	peak = __atomic_load_n(&stats->peak, __ATOMIC_RELAXED);
+
+	while (current > peak) {
+		old = __sync_val_compare_and_swap(&stats->peak, peak, current);
+
+		if (old == peak) {
+			break;
+		}
+
+		peak = old;
+	}
+}
+
+/*
+==================
+Mem_UpdateTagFreeStats
+==================
+*/
+void Mem_UpdateTagFreeStats(const memTag_t tag, int size)
+{
+	assert(tag >= 0 && tag < TAG_NUM_TAGS);
+
+	__sync_sub_and_fetch(&mem_tagStats[tag].num, 1);
+	__sync_sub_and_fetch(&mem_tagStats[tag].current, size);
+}
+
+/*
+==================
+Mem_GetTagStats
+==================
+*/
+void Mem_GetTagStats(const memTag_t tag, memTagStats_t &stats)
+{
+	assert(tag >= 0 && tag < TAG_NUM_TAGS);
+
+	stats = mem_tagStats[tag];
+}
+
+/*
+==================
+Mem_GetTagName
+==================
+*/
+const char *Mem_GetTagName(const memTag_t tag)
+{
+	if (tag < 0 || tag >= TAG_NUM_TAGS) {
+		return "unknown";
+	}
+
+	return mem_tagNames[tag];
 }
 
 
@@ -1141,7 +1698,7 @@ void Mem_UpdateFreeStats(int size)
 Mem_Alloc
 ==================
 */
-void *Mem_Alloc(const int size)
+void *Mem_Alloc(const int size, const memTag_t tag)
 {
 	if (!size) {
 		return NULL;
@@ -1154,8 +1711,10 @@ void *Mem_Alloc(const int size)
 		return malloc(size);
 	}
 
-	void *mem = mem_heap->Allocate(size);
-	Mem_UpdateAllocStats(mem_heap->Msize(mem));
+	void *mem = mem_heap->Allocate(size, tag);
+	int bytes = mem_heap->Msize(mem);
+	Mem_UpdateAllocStats(bytes);
+	Mem_UpdateTagAllocStats(tag, bytes);
 	return mem;
 }
 
@@ -1178,7 +1737,9 @@ void Mem_Free(void *ptr)
 		return;
 	}
 
-	Mem_UpdateFreeStats(mem_heap->Msize(ptr));
+	int bytes = mem_heap->Msize(ptr);
+	Mem_UpdateFreeStats(bytes);
+	Mem_UpdateTagFreeStats(mem_heap->Mtag(ptr), bytes);
 	mem_heap->Free(ptr);
 }
 
@@ -1187,7 +1748,7 @@ void Mem_Free(void *ptr)
 Mem_Alloc16
 ==================
 */
-void *Mem_Alloc16(const int size)
+void *Mem_Alloc16(const int size, const memTag_t tag)
 {
 	if (!size) {
 		return NULL;
@@ -1200,9 +1761,10 @@ void *Mem_Alloc16(const int size)
 		return malloc(size);
 	}
 
-	void *mem = mem_heap->Allocate16(size);
+	void *mem = mem_heap->Allocate16(size, tag);
 	// make sure the memory is 16 byte aligned
 	assert((((intptr_t)mem) & 15) == 0);
+	Mem_UpdateTagAllocStats(tag, mem_heap->Msize(mem));
 	return mem;
 }
 
@@ -1227,6 +1789,7 @@ void Mem_Free16(void *ptr)
 
 	// make sure the memory is 16 byte aligned
 	assert((((intptr_t)ptr) & 15) == 0);
+	Mem_UpdateTagFreeStats(mem_heap->Mtag(ptr), mem_heap->Msize(ptr));
 	mem_heap->Free16(ptr);
 }
 
@@ -1235,9 +1798,9 @@ void Mem_Free16(void *ptr)
 Mem_ClearedAlloc
 ==================
 */
-void *Mem_ClearedAlloc(const int size)
+void *Mem_ClearedAlloc(const int size, const memTag_t tag)
 {
-	void *mem = Mem_Alloc(size);
+	void *mem = Mem_Alloc(size, tag);
 	SIMDProcessor->Memset(mem, 0, size);
 	return mem;
 }
@@ -1273,6 +1836,18 @@ Mem_Dump_f
 */
 void Mem_Dump_f(const idCmdArgs &args)
 {
+	memoryStats_t stats;
+
+	if (!mem_heap) {
+		return;
+	}
+
+	Mem_GetStats(stats);
+
+	idLib::common->Printf("%8d total memory blocks allocated\n", stats.num);
+	idLib::common->Printf("%8d KB memory allocated\n", stats.totalSize >> 10);
+
+	mem_heap->Dump();
 }
 
 /*
@@ -1291,8 +1866,8 @@ Mem_Init
 */
 void Mem_Init(void)
 {
+	memset(mem_tagStats, 0, sizeof(mem_tagStats));
 	mem_heap = new idHeap;
-	Mem_ClearFrameStats();
 }
 
 /*
@@ -1335,12 +1910,14 @@ typedef struct debugMemory_s {
 	int						lineNumber;
 	int						frameNumber;
 	int						size;
+	int						tag;
 	address_t				callStack[MAX_CALLSTACK_DEPTH];
 	struct debugMemory_s 	*prev;
 	struct debugMemory_s 	*next;
 } debugMemory_t;
 
 static debugMemory_t 	*mem_debugMemory = NULL;
+static pthread_mutex_t	mem_debugLock;			// recursive, dumping allocates
 static char				mem_leakName[256] = "";
 
 /*
@@ -1404,6 +1981,8 @@ void Mem_Dump(const char *fileName)
 		return;
 	}
 
+	pthread_mutex_lock(&mem_debugLock);
+
 	totalSize = 0;
 
 	for (numBlocks = 0, b = mem_debugMemory; b; b = b->next, numBlocks++) {
@@ -1427,6 +2006,8 @@ void Mem_Dump(const char *fileName)
 		}
 	}
 
+	pthread_mutex_unlock(&mem_debugLock);
+
 	idLib::sys->ShutdownSymbols();
 
 	fprintf(f, "%8d total memory blocks allocated\r\n", numBlocks);
@@ -1486,6 +2067,8 @@ void Mem_DumpCompressed(const char *fileName, memorySortType_t memSort, int sort
 	totalSize = 0;
 	numBlocks = 0;
 
+	pthread_mutex_lock(&mem_debugLock);
+
 	for (b = mem_debugMemory; b; b = b->next) {
 
 		if (numFrames && b->frameNumber < idLib::frameNumber - numFrames) {
@@ -1537,6 +2120,8 @@ void Mem_DumpCompressed(const char *fileName, memorySortType_t memSort, int sort
 		}
 	}
 
+	pthread_mutex_unlock(&mem_debugLock);
+
 	// sort list
 	for (a = allocInfo; a; a = nexta) {
 		nexta = a->next;
@@ -1696,7 +2281,7 @@ void Mem_DumpCompressed_f(const idCmdArgs &args)
 Mem_AllocDebugMemory
 ==================
 */
-void *Mem_AllocDebugMemory(const int size, const char *fileName, const int lineNumber, const bool align16)
+void *Mem_AllocDebugMemory(const int size, const char *fileName, const int lineNumber, const bool align16, const memTag_t tag)
 {
 	void *p;
 	debugMemory_t *m;
@@ -1714,26 +2299,34 @@ void *Mem_AllocDebugMemory(const int size, const char *fileName, const int lineN
 	}
 
 	if (align16) {
-		p = mem_heap->Allocate16(size + sizeof(debugMemory_t));
+		p = mem_heap->Allocate16(size + sizeof(debugMemory_t), tag);
 	} else {
-		p = mem_heap->Allocate(size + sizeof(debugMemory_t));
+		p = mem_heap->Allocate(size + sizeof(debugMemory_t), tag);
 	}
 
 	Mem_UpdateAllocStats(size);
+	Mem_UpdateTagAllocStats(tag, size);
 
 	m = (debugMemory_t *) p;
 	m->fileName = fileName;
 	m->lineNumber = lineNumber;
 	m->frameNumber = idLib::frameNumber;
 	m->size = size;
-	m->next = mem_debugMemory;
+	m->tag = tag;
 	m->prev = NULL;
 
+	pthread_mutex_lock(&mem_debugLock);
+
+	m->next = mem_debugMemory;
+
 	if (mem_debugMemory) {
 		mem_debugMemory->prev = m;
 	}
 
 	mem_debugMemory = m;
+
+	pthread_mutex_unlock(&mem_debugLock);
+
 	idLib::sys->GetCallStack(m->callStack, MAX_CALLSTACK_DEPTH);
 
 	return (((byte *) p) + sizeof(debugMemory_t));
@@ -1768,6 +2361,9 @@ void Mem_FreeDebugMemory(void *p, const char *fileName, const int lineNumber, co
 	}
 
 	Mem_UpdateFreeStats(m->size);
+	Mem_UpdateTagFreeStats((memTag_t) m->tag, m->size);
+
+	pthread_mutex_lock(&mem_debugLock);
 
 	if (m->next) {
 		m->next->prev = m->prev;
@@ -1779,6 +2375,8 @@ void Mem_FreeDebugMemory(void *p, const char *fileName, const int lineNumber, co
 		mem_debugMemory = m->next;
 	}
 
+	pthread_mutex_unlock(&mem_debugLock);
+
 	m->fileName = fileName;
 	m->lineNumber = lineNumber;
 	m->frameNumber = idLib::frameNumber;
@@ -1797,13 +2395,13 @@ void Mem_FreeDebugMemory(void *p, const char *fileName, const int lineNumber, co
 Mem_Alloc
 ==================
 */
-void *Mem_Alloc(const int size, const char *fileName, const int lineNumber)
+void *Mem_Alloc(const int size, const char *fileName, const int lineNumber, const memTag_t tag)
 {
 	if (!size) {
 		return NULL;
 	}
 
-	return Mem_AllocDebugMemory(size, fileName, lineNumber, false);
+	return Mem_AllocDebugMemory(size, fileName, lineNumber, false, tag);
 }
 
 /*
@@ -1825,13 +2423,13 @@ void Mem_Free(void *ptr, const char *fileName, const int lineNumber)
 Mem_Alloc16
 ==================
 */
-void *Mem_Alloc16(const int size, const char *fileName, const int lineNumber)
+void *Mem_Alloc16(const int size, const char *fileName, const int lineNumber, const memTag_t tag)
 {
 	if (!size) {
 		return NULL;
 	}
 
-	void *mem = Mem_AllocDebugMemory(size, fileName, lineNumber, true);
+	void *mem = Mem_AllocDebugMemory(size, fileName, lineNumber, true, tag);
 	// make sure the memory is 16 byte aligned
 	assert((((int)mem) & 15) == 0);
 	return mem;
@@ -1858,9 +2456,9 @@ void Mem_Free16(void *ptr, const char *fileName, const int lineNumber)
 Mem_ClearedAlloc
 ==================
 */
-void *Mem_ClearedAlloc(const int size, const char *fileName, const int lineNumber)
+void *Mem_ClearedAlloc(const int size, const char *fileName, const int lineNumber, const memTag_t tag)
 {
-	void *mem = Mem_Alloc(size, fileName, lineNumber);
+	void *mem = Mem_Alloc(size, fileName, lineNumber, tag);
 	SIMDProcessor->Memset(mem, 0, size);
 	return mem;
 }
@@ -1886,6 +2484,14 @@ Mem_Init
 */
 void Mem_Init(void)
 {
+	pthread_mutexattr_t attr;
+
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&mem_debugLock, &attr);
+	pthread_mutexattr_destroy(&attr);
+
+	memset(mem_tagStats, 0, sizeof(mem_tagStats));
 	mem_heap = new idHeap;
 }
 
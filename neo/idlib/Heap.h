@@ -49,6 +49,27 @@ typedef struct {
 	int		totalSize;
 } memoryStats_t;
 
+// every allocation is accounted to the subsystem given by its tag
+typedef enum {
+	TAG_MISC,
+	TAG_GEOMETRY,			// renderer geometry
+	TAG_IMAGE,
+	TAG_SOUND,
+	TAG_DECL,
+	TAG_ENTITY,				// game entities
+	TAG_SCRIPT,
+	TAG_COLLISION,
+	TAG_AAS,
+	TAG_FRAME_TEMP,			// renderer frame temporary memory
+	TAG_NUM_TAGS
+} memTag_t;
+
+typedef struct {
+	int		num;			// number of blocks
+	int		current;		// bytes allocated
+	int		peak;			// highest number of bytes ever allocated
+} memTagStats_t;
+
 
 void		Mem_Init(void);
 void		Mem_Shutdown(void);
@@ -59,15 +80,17 @@ void		Mem_GetStats(memoryStats_t &stats);
 void		Mem_Dump_f(const class idCmdArgs &args);
 void		Mem_DumpCompressed_f(const class idCmdArgs &args);
 void		Mem_AllocDefragBlock(void);
+void		Mem_GetTagStats(const memTag_t tag, memTagStats_t &stats);
+const char *Mem_GetTagName(const memTag_t tag);
 
 
 #ifndef ID_DEBUG_MEMORY
 
-void 		*Mem_Alloc(const int size);
-void 		*Mem_ClearedAlloc(const int size);
+void 		*Mem_Alloc(const int size, const memTag_t tag = TAG_MISC);
+void 		*Mem_ClearedAlloc(const int size, const memTag_t tag = TAG_MISC);
 void		Mem_Free(void *ptr);
 char 		*Mem_CopyString(const char *in);
-void 		*Mem_Alloc16(const int size);
+void 		*Mem_Alloc16(const int size, const memTag_t tag = TAG_MISC);
 void		Mem_Free16(void *ptr);
 
 #ifdef ID_REDIRECT_NEWDELETE
@@ -93,11 +116,11 @@ __inline void operator delete[](void *p)
 
 #else /* ID_DEBUG_MEMORY */
 
-void 		*Mem_Alloc(const int size, const char *fileName, const int lineNumber);
-void 		*Mem_ClearedAlloc(const int size, const char *fileName, const int lineNumber);
+void 		*Mem_Alloc(const int size, const char *fileName, const int lineNumber, const memTag_t tag = TAG_MISC);
+void 		*Mem_ClearedAlloc(const int size, const char *fileName, const int lineNumber, const memTag_t tag = TAG_MISC);
 void		Mem_Free(void *ptr, const char *fileName, const int lineNumber);
 char 		*Mem_CopyString(const char *in, const char *fileName, const int lineNumber);
-void 		*Mem_Alloc16(const int size, const char *fileName, const int lineNumber);
+void 		*Mem_Alloc16(const int size, const char *fileName, const int lineNumber, const memTag_t tag = TAG_MISC);
 void		Mem_Free16(void *ptr, const char *fileName, const int lineNumber);
 
 #ifdef ID_REDIRECT_NEWDELETE
@@ -141,11 +164,12 @@ __inline void operator delete[](void *p)
 
 #endif
 
-#define		Mem_Alloc( size )				Mem_Alloc( size, __FILE__, __LINE__ )
-#define		Mem_ClearedAlloc( size )		Mem_ClearedAlloc( size, __FILE__, __LINE__ )
+// the optional tag goes after the file name and line number
+#define		Mem_Alloc( size, ... )			Mem_Alloc( size, __FILE__, __LINE__, ##__VA_ARGS__ )
+#define		Mem_ClearedAlloc( size, ... )	Mem_ClearedAlloc( size, __FILE__, __LINE__, ##__VA_ARGS__ )
 #define		Mem_Free( ptr )					Mem_Free( ptr, __FILE__, __LINE__ )
 #define		Mem_CopyString( s )				Mem_CopyString( s, __FILE__, __LINE__ )
-#define		Mem_Alloc16( size )				Mem_Alloc16( size, __FILE__, __LINE__ )
+#define		Mem_Alloc16( size, ... )		Mem_Alloc16( size, __FILE__, __LINE__, ##__VA_ARGS__ )
 #define		Mem_Free16( ptr )				Mem_Free16( ptr, __FILE__, __LINE__ )
 
 #endif /* ID_DEBUG_MEMORY */
@@ -283,6 +307,9 @@ class idDynamicAlloc
 		void							Shutdown(void);
 		void							SetFixedBlocks(int numBlocks) {}
 		void							SetLockMemory(bool lock) {}
+		void							SetMemoryTag(memTag_t tag) {
+			memoryTag = tag;
+		}
 		void							FreeEmptyBaseBlocks(void) {}
 
 		type 							*Alloc(const int num);
@@ -313,6 +340,7 @@ class idDynamicAlloc
 		}
 
 	private:
+		memTag_t						memoryTag;				// tag of all allocations
 		int								numUsedBlocks;			// number of used blocks
 		int								usedBlockMemory;		// total memory in used blocks
 
@@ -326,6 +354,7 @@ class idDynamicAlloc
 template<class type, int baseBlockSize, int minBlockSize>
 idDynamicAlloc<type, baseBlockSize, minBlockSize>::idDynamicAlloc(void)
 {
+	memoryTag = TAG_MISC;
 	Clear();
 }
 
@@ -357,7 +386,7 @@ type *idDynamicAlloc<type, baseBlockSize, minBlockSize>::Alloc(const int num)
 
 	numUsedBlocks++;
 	usedBlockMemory += num * sizeof(type);
-	return Mem_Alloc16(num * sizeof(type));
+	return Mem_Alloc16(num * sizeof(type), memoryTag);
 }
 
 template<class type, int baseBlockSize, int minBlockSize>
@@ -462,6 +491,7 @@ class idDynamicBlockAlloc
 		void							Shutdown(void);
 		void							SetFixedBlocks(int numBlocks);
 		void							SetLockMemory(bool lock);
+		void							SetMemoryTag(memTag_t tag);
 		void							FreeEmptyBaseBlocks(void);
 
 		type 							*Alloc(const int num);
@@ -495,6 +525,7 @@ class idDynamicBlockAlloc
 		idBTree<idDynamicBlock<type>,int,4>freeTree;			// B-Tree with free memory blocks
 		bool							allowAllocs;			// allow base block allocations
 		bool							lockMemory;				// lock memory so it cannot get swapped out
+		memTag_t						memoryTag;				// tag of the base blocks
 
 #ifdef DYNAMIC_BLOCK_ALLOC_CHECK
 		int								blockId[3];
@@ -523,6 +554,7 @@ class idDynamicBlockAlloc
 template<class type, int baseBlockSize, int minBlockSize>
 idDynamicBlockAlloc<type, baseBlockSize, minBlockSize>::idDynamicBlockAlloc(void)
 {
+	memoryTag = TAG_MISC;
 	Clear();
 }
 
@@ -571,7 +603,7 @@ void idDynamicBlockAlloc<type, baseBlockSize, minBlockSize>::SetFixedBlocks(int
 	idDynamicBlock<type> *block;
 
 	for (int i = numBaseBlocks; i < numBlocks; i++) {
-		block = (idDynamicBlock<type> *) Mem_Alloc16(baseBlockSize);
+		block = (idDynamicBlock<type> *) Mem_Alloc16(baseBlockSize, memoryTag);
 
 		if (lockMemory) {
 			idLib::sys->LockMemory(block, baseBlockSize);
@@ -609,6 +641,12 @@ void idDynamicBlockAlloc<type, baseBlockSize, minBlockSize>::SetLockMemory(bool
 	lockMemory = lock;
 }
 
+template<class type, int baseBlockSize, int minBlockSize>
+void idDynamicBlockAlloc<type, baseBlockSize, minBlockSize>::SetMemoryTag(memTag_t tag)
+{
+	memoryTag = tag;
+}
+
 template<class type, int baseBlockSize, int minBlockSize>
 void idDynamicBlockAlloc<type, baseBlockSize, minBlockSize>::FreeEmptyBaseBlocks(void)
 {
@@ -832,7 +870,7 @@ idDynamicBlock<type> *idDynamicBlockAlloc<type, baseBlockSize, minBlockSize>::Al
 		UnlinkFreeInternal(block);
 	} else if (allowAllocs) {
 		int allocSize = Max(baseBlockSize, alignedBytes + (int)sizeof(idDynamicBlock<type>));
-		block = (idDynamicBlock<type> *) Mem_Alloc16(allocSize);
+		block = (idDynamicBlock<type> *) Mem_Alloc16(allocSize, memoryTag);
 
 		if (lockMemory) {
 			idLib::sys->LockMemory(block, baseBlockSize);
@@ -148,6 +148,9 @@ void AssertFailed(const char *file, int line, const char *expression);
 #define assert( X )		if ( X ) { } else AssertFailed( __FILE__, __LINE__, #X )
 #endif
 
+// fails to compile when X is false, X must be a constant expression
+#define compile_time_assert( X )	{ typedef int compile_time_assert_failed[( X ) ? 1 : -1]; }
+
 class idException
 {
 	public:
@@ -472,6 +472,16 @@ int idParser::ReadSourceToken(idToken *token)
 
 	// if there's no token already available
 	while (!idParser::tokens) {
+		// preprocessed tokens are read after anything that was unread
+		if (idParser::sourceTokens) {
+			if (idParser::nextSourceToken >= idParser::numSourceTokens) {
+				return false;
+			}
+
+			*token = idParser::sourceTokens[idParser::nextSourceToken++];
+			return true;
+		}
+
 		// if there's a token to read from the script
 		if (idParser::scriptstack->ReadToken(token)) {
 			token->linesCrossed += changedScript;
@@ -1125,6 +1135,11 @@ int idParser::Directive_include(void)
 	script->SetFlags(idParser::flags);
 	script->SetPunctuations(idParser::punctuations);
 	idParser::PushScript(script);
+
+	if (idParser::includeList) {
+		idParser::includeList->AddUnique(script->GetFileName());
+	}
+
 	return true;
 }
 
@@ -3396,6 +3411,16 @@ void idParser::SetIncludePath(const char *path)
 	}
 }
 
+/*
+================
+idParser::SetIncludeList
+================
+*/
+void idParser::SetIncludeList(idList<idStr> *list)
+{
+	idParser::includeList = list;
+}
+
 /*
 ================
 idParser::SetPunctuations
@@ -3513,6 +3538,48 @@ int idParser::LoadMemory(const char *ptr, int length, const char *name)
 	return true;
 }
 
+/*
+================
+idParser::LoadTokens
+
+The tokens are read as they are, they are expected to contain no
+precompiler directives.  An empty script is kept on the stack for the
+file name and the lexer flags.
+================
+*/
+int idParser::LoadTokens(const idToken *tokens, int numTokens, const char *name)
+{
+	idLexer *script;
+
+	if (idParser::loaded) {
+		idLib::common->FatalError("idParser::LoadTokens: another source already loaded");
+		return false;
+	}
+
+	script = new idLexer;
+	script->LoadMemory("", 0, name);
+	script->SetFlags(idParser::flags);
+	script->SetPunctuations(idParser::punctuations);
+	script->next = NULL;
+	idParser::filename = name;
+	idParser::scriptstack = script;
+	idParser::tokens = NULL;
+	idParser::sourceTokens = tokens;
+	idParser::numSourceTokens = numTokens;
+	idParser::nextSourceToken = 0;
+	idParser::indentstack = NULL;
+	idParser::skip = 0;
+	idParser::loaded = true;
+
+	// the defines were expanded when the tokens were read
+	if (!idParser::definehash) {
+		idParser::defines = NULL;
+		idParser::definehash = (define_t **) Mem_ClearedAlloc(DEFINEHASHSIZE * sizeof(define_t *));
+	}
+
+	return true;
+}
+
 /*
 ================
 idParser::FreeSource
@@ -3547,6 +3614,10 @@ void idParser::FreeSource(bool keepDefines)
 		Mem_Free(indent);
 	}
 
+	sourceTokens = NULL;
+	numSourceTokens = 0;
+	nextSourceToken = 0;
+
 	if (!keepDefines) {
 		// free hash table
 		if (definehash) {
@@ -3631,6 +3702,10 @@ idParser::idParser()
 	this->defines = NULL;
 	this->tokens = NULL;
 	this->marker_p = NULL;
+	this->sourceTokens = NULL;
+	this->numSourceTokens = 0;
+	this->nextSourceToken = 0;
+	this->includeList = NULL;
 }
 
 /*
@@ -3650,6 +3725,10 @@ idParser::idParser(int flags)
 	this->defines = NULL;
 	this->tokens = NULL;
 	this->marker_p = NULL;
+	this->sourceTokens = NULL;
+	this->numSourceTokens = 0;
+	this->nextSourceToken = 0;
+	this->includeList = NULL;
 }
 
 /*
@@ -3669,6 +3748,10 @@ idParser::idParser(const char *filename, int flags, bool OSPath)
 	this->defines = NULL;
 	this->tokens = NULL;
 	this->marker_p = NULL;
+	this->sourceTokens = NULL;
+	this->numSourceTokens = 0;
+	this->nextSourceToken = 0;
+	this->includeList = NULL;
 	LoadFile(filename, OSPath);
 }
 
@@ -3689,6 +3772,10 @@ idParser::idParser(const char *ptr, int length, const char *name, int flags)
 	this->defines = NULL;
 	this->tokens = NULL;
 	this->marker_p = NULL;
+	this->sourceTokens = NULL;
+	this->numSourceTokens = 0;
+	this->nextSourceToken = 0;
+	this->includeList = NULL;
 	LoadMemory(ptr, length, name);
 }
 
@@ -89,6 +89,9 @@ class idParser
 		// load a source from the given memory with the given length
 		// NOTE: the ptr is expected to point at a valid C string: ptr[length] == '\0'
 		int				LoadMemory(const char *ptr, int length, const char *name);
+		// load a source from tokens that were already read and preprocessed by ReadToken
+		// NOTE: the tokens are not copied and must stay valid until the source is freed
+		int				LoadTokens(const idToken *tokens, int numTokens, const char *name);
 		// free the current source
 		void			FreeSource(bool keepDefines = false);
 		// returns true if a source is loaded
@@ -149,6 +152,8 @@ class idParser
 		void			AddBuiltinDefines(void);
 		// set the source include path
 		void			SetIncludePath(const char *path);
+		// append the name of every file included from now on to the given list
+		void			SetIncludeList(idList<idStr> *list);
 		// set the punctuation set
 		void			SetPunctuations(const punctuation_t *p);
 		// returns a pointer to the punctuation with the given id
@@ -195,6 +200,10 @@ class idParser
 		indent_t 		*indentstack;				// stack with indents
 		int				skip;						// > 0 if skipping conditional code
 		const char		*marker_p;
+		const idToken	*sourceTokens;				// preprocessed tokens when loaded with LoadTokens
+		int				numSourceTokens;
+		int				nextSourceToken;
+		idList<idStr>	*includeList;				// files included by the source
 
 		static define_t *globaldefines;				// list with global defines added to every source loaded
 
@@ -41,6 +41,12 @@ idGuiModel::idGuiModel()
 {
 	indexes.SetGranularity(1000);
 	verts.SetGranularity(1000);
+
+	clearCount = 0;
+	captureClearCount = -1;
+	captureSurface = 0;
+	captureVert = 0;
+	captureIndex = 0;
 }
 
 /*
@@ -55,6 +61,7 @@ void idGuiModel::Clear()
 	surfaces.SetNum(0, false);
 	indexes.SetNum(0, false);
 	verts.SetNum(0, false);
+	clearCount++;
 	AdvanceSurf();
 }
 
@@ -691,3 +698,156 @@ void idGuiModel::DrawStretchTri(idVec2 p1, idVec2 p2, idVec2 p3, idVec2 t1, idVe
 	memcpy(&verts[numVerts], tempVerts, vertCount * sizeof(verts[0]));
 }
 
+/*
+=============
+BeginCapture
+
+Marks the start of drawing that EndCapture will copy out
+=============
+*/
+void idGuiModel::BeginCapture()
+{
+	captureClearCount = clearCount;
+	captureSurface = surfaces.Num() - 1;
+	captureVert = verts.Num();
+	captureIndex = indexes.Num();
+}
+
+/*
+=============
+EndCapture
+
+Copies the verts and indexes added since BeginCapture, split by the
+material and color they were drawn with.  Indexes are stored relative
+to the first vertex of each captured surface.
+=============
+*/
+bool idGuiModel::EndCapture(idGuiCapture &capture)
+{
+	int			i, j;
+	int			firstVert, firstIndex;
+	guiCaptureSurface_t	cs;
+
+	capture.surfaces.SetNum(0, false);
+	capture.verts.SetNum(0, false);
+	capture.indexes.SetNum(0, false);
+
+	if (captureClearCount != clearCount || captureSurface < 0 || captureSurface >= surfaces.Num()
+	    || verts.Num() < captureVert || indexes.Num() < captureIndex) {
+		return false;
+	}
+
+	for (i = captureSurface; i < surfaces.Num(); i++) {
+		const guiModelSurface_t *s = &surfaces[i];
+
+		firstVert = Max(s->firstVert, captureVert);
+		firstIndex = Max(s->firstIndex, captureIndex);
+
+		cs.material = s->material;
+		cs.color[0] = s->color[0];
+		cs.color[1] = s->color[1];
+		cs.color[2] = s->color[2];
+		cs.color[3] = s->color[3];
+		cs.numVerts = s->firstVert + s->numVerts - firstVert;
+		cs.numIndexes = s->firstIndex + s->numIndexes - firstIndex;
+
+		if (cs.numVerts <= 0 || cs.numIndexes <= 0) {
+			continue;
+		}
+
+		capture.surfaces.Append(cs);
+
+		for (j = 0; j < cs.numVerts; j++) {
+			capture.verts.Append(verts[firstVert + j]);
+		}
+
+		for (j = 0; j < cs.numIndexes; j++) {
+			capture.indexes.Append(indexes[firstIndex + j] - (firstVert - s->firstVert));
+		}
+	}
+
+	capture.material = surf->material;
+	capture.color[0] = surf->color[0];
+	capture.color[1] = surf->color[1];
+	capture.color[2] = surf->color[2];
+	capture.color[3] = surf->color[3];
+
+	return true;
+}
+
+/*
+=============
+DrawCapture
+
+Adds previously captured drawing back to the model, leaving the current
+material and color as they were at the end of the capture
+=============
+*/
+void idGuiModel::DrawCapture(const idGuiCapture &capture)
+{
+	int			i, j;
+	int			numVerts, numIndexes;
+	int			vert, index;
+
+	if (!glConfig.isInitialized) {
+		return;
+	}
+
+	vert = 0;
+	index = 0;
+
+	for (i = 0; i <= capture.surfaces.Num(); i++) {
+		const idMaterial *material;
+		const float *color;
+
+		if (i < capture.surfaces.Num()) {
+			material = capture.surfaces[i].material;
+			color = capture.surfaces[i].color;
+		} else {
+			material = capture.material;
+			color = capture.color;
+		}
+
+		// break the current surface if the material or color changes
+		if (material != surf->material || color[0] != surf->color[0] || color[1] != surf->color[1]
+		    || color[2] != surf->color[2] || color[3] != surf->color[3]) {
+			if (surf->numVerts) {
+				AdvanceSurf();
+			}
+
+			if (material != surf->material) {
+				const_cast<idMaterial *>(material)->EnsureNotPurged();	// in case it was a gui item started before a level change
+			}
+
+			surf->material = material;
+			surf->color[0] = color[0];
+			surf->color[1] = color[1];
+			surf->color[2] = color[2];
+			surf->color[3] = color[3];
+		}
+
+		if (i == capture.surfaces.Num()) {
+			break;
+		}
+
+		const guiCaptureSurface_t *cs = &capture.surfaces[i];
+
+		numVerts = verts.Num();
+		numIndexes = indexes.Num();
+
+		verts.AssureSize(numVerts + cs->numVerts);
+		indexes.AssureSize(numIndexes + cs->numIndexes);
+
+		memcpy(&verts[numVerts], &capture.verts[vert], cs->numVerts * sizeof(verts[0]));
+
+		for (j = 0; j < cs->numIndexes; j++) {
+			indexes[numIndexes + j] = numVerts - surf->firstVert + capture.indexes[index + j];
+		}
+
+		surf->numVerts += cs->numVerts;
+		surf->numIndexes += cs->numIndexes;
+
+		vert += cs->numVerts;
+		index += cs->numIndexes;
+	}
+}
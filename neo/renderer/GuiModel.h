@@ -57,6 +57,10 @@ class idGuiModel
 		                       float s1, float t1, float s2, float t2, const idMaterial *hShader);
 		void	DrawStretchTri(idVec2 p1, idVec2 p2, idVec2 p3, idVec2 t1, idVec2 t2, idVec2 t3, const idMaterial *material);
 
+		void	BeginCapture();
+		bool	EndCapture(idGuiCapture &capture);
+		void	DrawCapture(const idGuiCapture &capture);
+
 		//---------------------------
 	private:
 		void	AdvanceSurf();
@@ -67,5 +71,11 @@ class idGuiModel
 		idList<guiModelSurface_t>	surfaces;
 		idList<glIndex_t>		indexes;
 		idList<idDrawVert>	verts;
+
+		int						clearCount;		// a capture is lost if the model is cleared
+		int						captureClearCount;
+		int						captureSurface;
+		int						captureVert;
+		int						captureIndex;
 };
 
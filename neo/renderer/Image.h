@@ -115,6 +115,48 @@ typedef struct {
 	unsigned long dwReserved2[3];
 } ddsFileHeader_t;
 
+// ETC formats, which may be missing from the headers
+#ifndef GL_ETC1_RGB8_OES
+#define GL_ETC1_RGB8_OES					0x8D64
+#endif
+#ifndef GL_COMPRESSED_RGB8_ETC2
+#define GL_COMPRESSED_RGB8_ETC2				0x9274
+#endif
+#ifndef GL_COMPRESSED_RGBA8_ETC2_EAC
+#define GL_COMPRESSED_RGBA8_ETC2_EAC		0x9278
+#endif
+
+// the ETC cache is written as KTX files, each level is an int size and the blocks
+#define KTX_ENDIANNESS		0x04030201
+
+typedef struct {
+	byte			identifier[12];
+	int				endianness;
+	int				glType;
+	int				glTypeSize;
+	int				glFormat;
+	int				glInternalFormat;
+	int				glBaseInternalFormat;
+	int				pixelWidth;
+	int				pixelHeight;
+	int				pixelDepth;
+	int				numberOfArrayElements;
+	int				numberOfFaces;
+	int				numberOfMipmapLevels;
+	int				bytesOfKeyValueData;
+} ktxFileHeader_t;
+
+// the settings the levels were encoded with, the only key/value pair of the ETC cache
+#define KTX_ETC_KEY			"idETCEncode"
+
+typedef struct {
+	int				keyAndValueByteSize;
+	char			key[12];
+	int				quality;				// image_etcQuality
+	int				sourceWidth;			// before downsizing
+	int				sourceHeight;
+} ktxETCKeyValue_t;
+
 
 // increasing numeric values imply more information is stored
 typedef enum {
@@ -141,6 +183,40 @@ typedef enum {
 
 #define	MAX_IMAGE_NAME	256
 
+// enough for the largest tga, rounded up to a power of two
+#define MAX_IMAGE_LEVELS	17
+
+class idImage;
+
+// the mip levels of a 2D image, built by idImage::BuildMipChain without any GL calls
+typedef struct {
+	const byte 			*pic;
+	int					width, height;
+	textureDepth_t		depth;
+	bool				preserveBorder;
+	bool				swapNormalAlpha;		// rxgb swizzle of normal maps
+	bool				writeTGA;				// debug tga of the first level, written before the swap
+	GLenum				internalFormat;			// selected by BuildMipChain
+	int					numLevels;
+	int					firstUploadLevel;		// the levels before only shrink the image to the allowed size
+	byte 				*levels[MAX_IMAGE_LEVELS];
+	int					levelWidths[MAX_IMAGE_LEVELS];
+	int					levelHeights[MAX_IMAGE_LEVELS];
+	byte 				*compressed[MAX_IMAGE_LEVELS];	// ETC blocks of the upload levels
+	int					compressedSizes[MAX_IMAGE_LEVELS];
+	byte 				*buffer;				// all levels in a single allocation
+} imageMipChain_t;
+
+// an image going through idImageManager::LoadImages
+typedef struct {
+	idImage 			*image;
+	struct imageDecode_s *decode;				// file decoded on a job thread, NULL if pic was loaded directly
+	byte 				*pic;
+	int					width, height;
+	int					imageHash;
+	imageMipChain_t		chain;
+} imageLoad_t;
+
 class idImage
 {
 	public:
@@ -205,7 +281,19 @@ class idImage
 		void		WritePrecompressedImage();
 		bool		CheckPrecompressedImage(bool fullLoad);
 		void		UploadPrecompressedImage(byte *data, int len);
+		void		ImageProgramStringToETCFileName(const char *imageProg, char *fileName) const;
+		void		WriteETCImage(const imageMipChain_t &chain);
+		bool		CheckETCImage();
 		void		ActuallyLoadImage(bool checkForPrecompressed, bool fromBackEnd);
+		// ActuallyLoadImage split up for idImageManager::LoadImages, the static ones run on the job threads
+		bool		StartLoad(imageLoad_t &load, bool checkForPrecompressed);
+		static void	DecodeLoadJob(void *parms);
+		void		PrepareLoad(imageLoad_t &load);
+		static void	BuildLoadJob(void *parms);
+		void		FinishLoad(imageLoad_t &load);
+		void		StartMipChain(const byte *pic, int width, int height, imageMipChain_t &chain);
+		void		BuildMipChain(imageMipChain_t &chain) const;
+		void		UploadMipChain(imageMipChain_t &chain);
 		void		StartBackgroundImageLoad();
 		int			BitsForInternalFormat(int internalFormat) const;
 		void		UploadCompressedNormalMap(int width, int height, const byte *rgba, int mipLevel);
@@ -225,7 +313,7 @@ class idImage
 		idImage				*partialImage;			// shrunken, space-saving version
 		bool				isPartialImage;			// true if this is pointed to by another image
 		bool				backgroundLoadInProgress;	// true if another thread is reading the complete d3t file
-		backgroundDownload_t	bgl;
+		asyncRead_t			bgl;
 		idImage 			*bglNext;				// linked from tr.backgroundImageLoads
 
 		// parameters that define this image
@@ -267,8 +355,9 @@ ID_INLINE idImage::idImage()
 	frameUsed = 0;
 	classification = 0;
 	backgroundLoadInProgress = false;
-	bgl.opcode = DLTYPE_FILE;
 	bgl.f = NULL;
+	bgl.buffer = NULL;
+	bgl.status = ASYNC_READ_QUEUED;
 	bglNext = NULL;
 	imgName[0] = '\0';
 	generatorFunction = NULL;
@@ -354,6 +443,10 @@ class idImageManager
 		// Called only by renderSystem::EndLevelLoad
 		void				EndLevelLoad();
 
+		// Loads the images like ActuallyLoadImage, with the decoding and mip mapping
+		// spread over the job threads.  Only the GL uploads are done on this thread.
+		void				LoadImages(idImage **loadImages, int numImages);
+
 		// used to clear and then write the dds conversion batch file
 		void				StartBuild();
 		void				FinishBuild(bool removeDups = false);
@@ -390,6 +483,10 @@ class idImageManager
 		static idCVar		image_downSizeBumpLimit;	// downsize bump limit
 		static idCVar		image_ignoreHighQuality;	// ignore high quality on materials
 		static idCVar		image_downSizeLimit;		// downsize diffuse limit
+		static idCVar		image_parallelLoad;			// decode and mip map images on the job threads
+		static idCVar		image_useETC;				// ETC compression on OpenGL ES
+		static idCVar		image_etcQuality;			// 1 = slower ETC encoding with less error
+		static idCVar		image_cacheETC;				// write and use etc/*.ktx files
 
 		// built-in images
 		idImage 			*defaultImage;
@@ -413,6 +510,7 @@ class idImageManager
 		idImage 			*specularTableImage;			// 1D intensity texture with our specular function
 		idImage 			*specular2DTableImage;		// 2D intensity texture with our specular function with variable specularity
 		idImage 			*borderClampImage;			// white inside, black outside
+		idImage 			*shadowMapAtlasImage;		// linear depth packed in RGBA, rendered by the GLSL back end
 
 		//--------------------------------------------------------
 
@@ -443,6 +541,11 @@ class idImageManager
 
 		int	numActiveBackgroundImageLoads;
 		const static int MAX_BACKGROUND_IMAGE_LOADS = 8;
+
+		// time spent in LoadImages, for the level load report
+		double				loadDecodeTime;				// reading files and decoding
+		double				loadBuildTime;				// mip mapping
+		double				loadUploadTime;
 };
 
 extern idImageManager	*globalImages;		// pointer to global list for the rest of the system
@@ -464,6 +567,7 @@ byte *R_ResampleTexture(const byte *in, int inwidth, int inheight,
                         int outwidth, int outheight);
 byte *R_MipMapWithAlphaSpecularity(const byte *in, int width, int height);
 byte *R_MipMap(const byte *in, int width, int height, bool preserveBorder);
+void R_MipMapBuffer(const byte *in, int width, int height, bool preserveBorder, byte *out);
 byte *R_MipMap3D(const byte *in, int width, int height, int depth, bool preserveBorder);
 
 // these operate in-place on the provided pixels
@@ -486,6 +590,24 @@ void R_LoadImage(const char *name, byte **pic, int *width, int *height, ID_TIME_
 // pic is in top to bottom raster format
 bool R_LoadCubeImages(const char *cname, cubeFiles_t extensions, byte *pic[6], int *size, ID_TIME_T *timestamp);
 
+// R_LoadImage of a tga or jpg in three steps, only R_DecodeImage is safe on other threads
+struct imageDecode_s *R_StartImageDecode(const char *name, ID_TIME_T *timestamp);
+void R_DecodeImage(struct imageDecode_s *decode);
+byte *R_FinishImageDecode(struct imageDecode_s *decode, int *width, int *height);
+
+/*
+====================================================================
+
+IMAGEETC
+
+====================================================================
+*/
+
+// these don't allocate, so they are safe on the job threads
+int R_ETCSize(int width, int height, bool alpha);
+void R_EncodeETC(const byte *rgba, int width, int height, bool alpha, int quality, byte *out);
+void R_DecodeETC(const byte *in, int width, int height, bool alpha, byte *rgba);
+
 /*
 ====================================================================
 
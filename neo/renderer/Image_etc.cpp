@@ -0,0 +1,666 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+#include "tr_local.h"
+
+/*
+
+ETC1 and ETC2 EAC block compression, for the compressed uploads on OpenGL ES,
+which doesn't have S3TC.
+
+Each 4x4 block of color is 64 bits holding two half blocks, side by side or
+one above the other, each with a base color and one of eight intensity
+modifier tables.  The color is the same for ETC1 and the ETC2 RGB formats,
+the ETC2 RGBA8 format puts a 64 bit EAC block of alpha in front of it.
+
+The texels of a block are numbered down the columns, the order of the
+pixel indexes in the block.  None of this makes any allocations or GL calls,
+so it is safe on the job threads.
+
+*/
+
+static const int ETC_MAX_ERROR = 0x7fffffff;
+
+static const int etcModifierTable[8][4] = {
+	{   2,   8,   -2,   -8 },
+	{   5,  17,   -5,  -17 },
+	{   9,  29,   -9,  -29 },
+	{  13,  42,  -13,  -42 },
+	{  18,  60,  -18,  -60 },
+	{  24,  80,  -24,  -80 },
+	{  33, 106,  -33, -106 },
+	{  47, 183,  -47, -183 }
+};
+
+static const int eacModifierTable[16][8] = {
+	{ -3, -6,  -9, -15, 2, 5, 8, 14 },
+	{ -3, -7, -10, -13, 2, 6, 9, 12 },
+	{ -2, -5,  -8, -13, 1, 4, 7, 12 },
+	{ -2, -4,  -6, -13, 1, 3, 5, 12 },
+	{ -3, -6,  -8, -12, 2, 5, 7, 11 },
+	{ -3, -7,  -9, -11, 2, 6, 8, 10 },
+	{ -4, -7,  -8, -11, 3, 6, 7, 10 },
+	{ -3, -5,  -8, -11, 2, 4, 7, 10 },
+	{ -2, -6,  -8, -10, 1, 5, 7,  9 },
+	{ -2, -5,  -8, -10, 1, 4, 7,  9 },
+	{ -2, -4,  -8, -10, 1, 3, 7,  9 },
+	{ -2, -5,  -7, -10, 1, 4, 6,  9 },
+	{ -3, -4,  -7, -10, 2, 3, 6,  9 },
+	{ -1, -2,  -3, -10, 0, 1, 2,  9 },
+	{ -4, -6,  -8,  -9, 3, 5, 7,  8 },
+	{ -3, -5,  -7,  -9, 2, 4, 6,  8 }
+};
+
+// the texels of each half block, for the flip bit clear ( side by side ) and set ( one above the other )
+static const int etcHalfBlockTexels[2][2][8] = {
+	{ { 0, 1, 2, 3, 4, 5, 6, 7 }, { 8, 9, 10, 11, 12, 13, 14, 15 } },
+	{ { 0, 1, 4, 5, 8, 9, 12, 13 }, { 2, 3, 6, 7, 10, 11, 14, 15 } }
+};
+
+typedef struct {
+	int		color[2][3];		// quantized base colors of the half blocks
+	int		table[2];
+	byte	indexes[16];
+	bool	differential;		// 5 bit color and a 3 bit signed delta, instead of two 4 bit colors
+	bool	flip;
+} etcBlock_t;
+
+/*
+================
+R_ETCClamp
+================
+*/
+static ID_INLINE int R_ETCClamp(int value)
+{
+	if (value < 0) {
+		return 0;
+	}
+
+	if (value > 255) {
+		return 255;
+	}
+
+	return value;
+}
+
+/*
+================
+R_ETCExpand
+
+Replicates the high bits of a quantized color into the low bits
+================
+*/
+static ID_INLINE int R_ETCExpand(int value, int bits)
+{
+	if (bits == 4) {
+		return (value << 4) | value;
+	}
+
+	return (value << 3) | (value >> 2);
+}
+
+/*
+================
+R_ETCExtractBlock
+
+Blocks hanging off the edge of small mip levels repeat the last column and row
+================
+*/
+static void R_ETCExtractBlock(const byte *rgba, int width, int height, int x, int y, byte block[16][4])
+{
+	int		i, bx, by;
+
+	for (i = 0; i < 16; i++) {
+		bx = x + (i >> 2);
+		by = y + (i & 3);
+
+		if (bx >= width) {
+			bx = width - 1;
+		}
+
+		if (by >= height) {
+			by = height - 1;
+		}
+
+		*(int *)block[i] = *(const int *)(rgba + (by * width + bx) * 4);
+	}
+}
+
+/*
+================
+R_ETCHalfBlockError
+
+Picks the modifier table with the least squared error for a base color,
+and fills in the indexes of the half block's texels
+================
+*/
+static int R_ETCHalfBlockError(const byte block[16][4], const int *texels, const int base[3], int *bestTable, byte indexes[16])
+{
+	int		t, j, m;
+	int		error, bestError, texelError, bestTexelError;
+	int		dr, dg, db;
+	byte	texelIndexes[8];
+
+	bestError = ETC_MAX_ERROR;
+
+	for (t = 0; t < 8; t++) {
+		error = 0;
+
+		for (j = 0; j < 8 && error < bestError; j++) {
+			const byte *texel = block[texels[j]];
+
+			bestTexelError = ETC_MAX_ERROR;
+
+			for (m = 0; m < 4; m++) {
+				dr = R_ETCClamp(base[0] + etcModifierTable[t][m]) - texel[0];
+				dg = R_ETCClamp(base[1] + etcModifierTable[t][m]) - texel[1];
+				db = R_ETCClamp(base[2] + etcModifierTable[t][m]) - texel[2];
+				texelError = dr * dr + dg * dg + db * db;
+
+				if (texelError < bestTexelError) {
+					bestTexelError = texelError;
+					texelIndexes[j] = m;
+				}
+			}
+
+			error += bestTexelError;
+		}
+
+		if (error < bestError) {
+			bestError = error;
+			*bestTable = t;
+
+			for (j = 0; j < 8; j++) {
+				indexes[texels[j]] = texelIndexes[j];
+			}
+		}
+	}
+
+	return bestError;
+}
+
+/*
+================
+R_ETCSearchHalfBlock
+
+Quantizes the average color of a half block, and with a quality above 0
+also tries the neighbouring colors
+================
+*/
+static int R_ETCSearchHalfBlock(const byte block[16][4], const int *texels, const int average[3], int bits, int quality,
+                                int color[3], int *table, byte indexes[16])
+{
+	int		c, dr, dg, db, maxValue, range;
+	int		center[3], test[3], base[3];
+	int		testTable, error, bestError;
+	byte	testIndexes[16];
+
+	maxValue = (1 << bits) - 1;
+
+	for (c = 0; c < 3; c++) {
+		center[c] = (average[c] * maxValue + 127) / 255;
+	}
+
+	range = (quality > 0) ? 1 : 0;
+	bestError = ETC_MAX_ERROR;
+
+	for (dr = -range; dr <= range; dr++) {
+		for (dg = -range; dg <= range; dg++) {
+			for (db = -range; db <= range; db++) {
+				test[0] = idMath::ClampInt(0, maxValue, center[0] + dr);
+				test[1] = idMath::ClampInt(0, maxValue, center[1] + dg);
+				test[2] = idMath::ClampInt(0, maxValue, center[2] + db);
+
+				for (c = 0; c < 3; c++) {
+					base[c] = R_ETCExpand(test[c], bits);
+				}
+
+				error = R_ETCHalfBlockError(block, texels, base, &testTable, testIndexes);
+
+				if (error < bestError) {
+					bestError = error;
+					color[0] = test[0];
+					color[1] = test[1];
+					color[2] = test[2];
+					*table = testTable;
+
+					for (c = 0; c < 8; c++) {
+						indexes[texels[c]] = testIndexes[texels[c]];
+					}
+				}
+			}
+		}
+	}
+
+	return bestError;
+}
+
+/*
+================
+R_ETCSearchHalfBlocks
+================
+*/
+static int R_ETCSearchHalfBlocks(const byte block[16][4], const int average[2][3], int bits, int quality, etcBlock_t &b)
+{
+	int		h, error;
+
+	error = 0;
+
+	for (h = 0; h < 2; h++) {
+		error += R_ETCSearchHalfBlock(block, etcHalfBlockTexels[b.flip][h], average[h], bits, quality, b.color[h], &b.table[h], b.indexes);
+	}
+
+	return error;
+}
+
+/*
+================
+R_ETCDeltaInRange
+
+The differential mode stores the second color as a 3 bit signed delta
+================
+*/
+static bool R_ETCDeltaInRange(const etcBlock_t &b)
+{
+	int		c, delta;
+
+	for (c = 0; c < 3; c++) {
+		delta = b.color[1][c] - b.color[0][c];
+
+		if (delta < -4 || delta > 3) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/*
+================
+R_ETCSearchBlock
+
+Tries both modes for one orientation of the half blocks
+================
+*/
+static int R_ETCSearchBlock(const byte block[16][4], bool flip, int quality, etcBlock_t &out)
+{
+	int			h, c, j;
+	int			average[2][3];
+	int			error, bestError;
+	etcBlock_t	test;
+
+	for (h = 0; h < 2; h++) {
+		for (c = 0; c < 3; c++) {
+			average[h][c] = 0;
+
+			for (j = 0; j < 8; j++) {
+				average[h][c] += block[etcHalfBlockTexels[flip][h][j]][c];
+			}
+
+			average[h][c] = (average[h][c] + 4) / 8;
+		}
+	}
+
+	bestError = ETC_MAX_ERROR;
+	test.flip = flip;
+
+	// the differential mode has more color precision, but the half blocks must be close
+	test.differential = true;
+	error = R_ETCSearchHalfBlocks(block, average, 5, quality, test);
+
+	// if the searched colors drifted apart, fall back to the plain averages
+	if (!R_ETCDeltaInRange(test) && quality > 0) {
+		error = R_ETCSearchHalfBlocks(block, average, 5, 0, test);
+	}
+
+	if (R_ETCDeltaInRange(test)) {
+		bestError = error;
+		out = test;
+	}
+
+	test.differential = false;
+	error = R_ETCSearchHalfBlocks(block, average, 4, quality, test);
+
+	if (error < bestError) {
+		bestError = error;
+		out = test;
+	}
+
+	return bestError;
+}
+
+/*
+================
+R_ETCPackBlock
+================
+*/
+static void R_ETCPackBlock(const etcBlock_t &b, byte out[8])
+{
+	unsigned int	high, low;
+	int				i;
+
+	if (b.differential) {
+		high = (b.color[0][0] << 27) | (((b.color[1][0] - b.color[0][0]) & 7) << 24) |
+		       (b.color[0][1] << 19) | (((b.color[1][1] - b.color[0][1]) & 7) << 16) |
+		       (b.color[0][2] << 11) | (((b.color[1][2] - b.color[0][2]) & 7) << 8) | 2;
+	} else {
+		high = (b.color[0][0] << 28) | (b.color[1][0] << 24) |
+		       (b.color[0][1] << 20) | (b.color[1][1] << 16) |
+		       (b.color[0][2] << 12) | (b.color[1][2] << 8);
+	}
+
+	high |= (b.table[0] << 5) | (b.table[1] << 2);
+
+	if (b.flip) {
+		high |= 1;
+	}
+
+	// the high bit of every index is in the upper half
+	low = 0;
+
+	for (i = 0; i < 16; i++) {
+		low |= ((b.indexes[i] >> 1) << (i + 16)) | ((b.indexes[i] & 1) << i);
+	}
+
+	out[0] = high >> 24;
+	out[1] = high >> 16;
+	out[2] = high >> 8;
+	out[3] = high;
+	out[4] = low >> 24;
+	out[5] = low >> 16;
+	out[6] = low >> 8;
+	out[7] = low;
+}
+
+/*
+================
+R_EncodeETC1Block
+================
+*/
+static void R_EncodeETC1Block(const byte block[16][4], int quality, byte out[8])
+{
+	etcBlock_t	best, test;
+	int			error, bestError;
+
+	bestError = R_ETCSearchBlock(block, false, quality, best);
+
+	if (bestError > 0) {
+		error = R_ETCSearchBlock(block, true, quality, test);
+
+		if (error < bestError) {
+			best = test;
+		}
+	}
+
+	R_ETCPackBlock(best, out);
+}
+
+/*
+================
+R_DecodeETC1Block
+================
+*/
+static void R_DecodeETC1Block(const byte in[8], byte block[16][4])
+{
+	unsigned int	high, low;
+	int				base[2][3], table[2];
+	int				c, i, h, index, delta;
+
+	high = (in[0] << 24) | (in[1] << 16) | (in[2] << 8) | in[3];
+	low = (in[4] << 24) | (in[5] << 16) | (in[6] << 8) | in[7];
+
+	for (c = 0; c < 3; c++) {
+		if (high & 2) {
+			base[0][c] = (high >> (27 - c * 8)) & 31;
+			delta = (high >> (24 - c * 8)) & 7;
+
+			if (delta & 4) {
+				delta -= 8;
+			}
+
+			// out of range colors are the other ETC2 modes, which the encoder never makes
+			base[1][c] = R_ETCExpand((base[0][c] + delta) & 31, 5);
+			base[0][c] = R_ETCExpand(base[0][c], 5);
+		} else {
+			base[0][c] = R_ETCExpand((high >> (28 - c * 8)) & 15, 4);
+			base[1][c] = R_ETCExpand((high >> (24 - c * 8)) & 15, 4);
+		}
+	}
+
+	table[0] = (high >> 5) & 7;
+	table[1] = (high >> 2) & 7;
+
+	for (i = 0; i < 16; i++) {
+		if (high & 1) {
+			h = ((i & 3) >= 2);
+		} else {
+			h = ((i >> 2) >= 2);
+		}
+
+		index = (((low >> (i + 16)) & 1) << 1) | ((low >> i) & 1);
+
+		for (c = 0; c < 3; c++) {
+			block[i][c] = R_ETCClamp(base[h][c] + etcModifierTable[table[h]][index]);
+		}
+
+		block[i][3] = 255;
+	}
+}
+
+/*
+================
+R_EncodeEACBlock
+
+Fits the multiplier and base to the alpha range for every table,
+a quality above 0 also tries the neighbouring values
+================
+*/
+static void R_EncodeEACBlock(const byte block[16][4], int quality, byte out[8])
+{
+	int		i, j, t, m, b, low, high, range;
+	int		minAlpha, maxAlpha, multiplier, base;
+	int		error, bestError, texelError, bestTexelError, diff;
+	int		bestBase, bestMultiplier, bestTable;
+	byte	indexes[16], bestIndexes[16];
+	int		bits;
+
+	minAlpha = 255;
+	maxAlpha = 0;
+
+	for (i = 0; i < 16; i++) {
+		minAlpha = Min(minAlpha, (int)block[i][3]);
+		maxAlpha = Max(maxAlpha, (int)block[i][3]);
+	}
+
+	range = (quality > 0) ? 1 : 0;
+	bestError = ETC_MAX_ERROR;
+	bestBase = minAlpha;
+	bestMultiplier = 1;
+	bestTable = 0;
+	memset(bestIndexes, 0, sizeof(bestIndexes));
+
+	for (t = 0; t < 16 && bestError > 0; t++) {
+		low = eacModifierTable[t][3];
+		high = eacModifierTable[t][7];
+		multiplier = idMath::ClampInt(1, 15, (maxAlpha - minAlpha + (high - low) / 2) / (high - low));
+
+		for (m = multiplier - range; m <= multiplier + range; m++) {
+			if (m < 1 || m > 15) {
+				continue;
+			}
+
+			base = (minAlpha + maxAlpha - (high + low) * m) / 2;
+
+			for (b = base - range * 2; b <= base + range * 2; b++) {
+				if (b < 0 || b > 255) {
+					continue;
+				}
+
+				error = 0;
+
+				for (i = 0; i < 16 && error < bestError; i++) {
+					bestTexelError = ETC_MAX_ERROR;
+
+					for (j = 0; j < 8; j++) {
+						diff = R_ETCClamp(b + eacModifierTable[t][j] * m) - block[i][3];
+						texelError = diff * diff;
+
+						if (texelError < bestTexelError) {
+							bestTexelError = texelError;
+							indexes[i] = j;
+						}
+					}
+
+					error += bestTexelError;
+				}
+
+				if (error < bestError) {
+					bestError = error;
+					bestBase = b;
+					bestMultiplier = m;
+					bestTable = t;
+					memcpy(bestIndexes, indexes, sizeof(bestIndexes));
+				}
+			}
+		}
+	}
+
+	out[0] = bestBase;
+	out[1] = (bestMultiplier << 4) | bestTable;
+
+	// 3 bits per texel, 8 texels in each three bytes
+	for (i = 0; i < 2; i++) {
+		bits = 0;
+
+		for (j = 0; j < 8; j++) {
+			bits |= bestIndexes[i * 8 + j] << (21 - j * 3);
+		}
+
+		out[2 + i * 3] = bits >> 16;
+		out[3 + i * 3] = bits >> 8;
+		out[4 + i * 3] = bits;
+	}
+}
+
+/*
+================
+R_DecodeEACBlock
+================
+*/
+static void R_DecodeEACBlock(const byte in[8], byte block[16][4])
+{
+	int		i, j, bits, multiplier, table;
+
+	multiplier = in[1] >> 4;
+	table = in[1] & 15;
+
+	for (i = 0; i < 2; i++) {
+		bits = (in[2 + i * 3] << 16) | (in[3 + i * 3] << 8) | in[4 + i * 3];
+
+		for (j = 0; j < 8; j++) {
+			block[i * 8 + j][3] = R_ETCClamp(in[0] + eacModifierTable[table][(bits >> (21 - j * 3)) & 7] * multiplier);
+		}
+	}
+}
+
+/*
+================
+R_ETCSize
+
+Bytes of an ETC1 or ETC2 RGBA8 level, blocks are padded out to 4x4 texels
+================
+*/
+int R_ETCSize(int width, int height, bool alpha)
+{
+	return ((width + 3) / 4) * ((height + 3) / 4) * (alpha ? 16 : 8);
+}
+
+/*
+================
+R_EncodeETC
+
+Encodes an RGBA level as ETC1, or ETC2 RGBA8 with an EAC alpha if alpha is set.
+Out must have R_ETCSize bytes.
+================
+*/
+void R_EncodeETC(const byte *rgba, int width, int height, bool alpha, int quality, byte *out)
+{
+	int		x, y;
+	byte	block[16][4];
+
+	for (y = 0; y < height; y += 4) {
+		for (x = 0; x < width; x += 4) {
+			R_ETCExtractBlock(rgba, width, height, x, y, block);
+
+			if (alpha) {
+				R_EncodeEACBlock(block, quality, out);
+				out += 8;
+			}
+
+			R_EncodeETC1Block(block, quality, out);
+			out += 8;
+		}
+	}
+}
+
+/*
+================
+R_DecodeETC
+
+Reference decoder for the blocks made by R_EncodeETC, used to check the encoder
+================
+*/
+void R_DecodeETC(const byte *in, int width, int height, bool alpha, byte *rgba)
+{
+	int		x, y, i, bx, by;
+	byte	block[16][4];
+
+	for (y = 0; y < height; y += 4) {
+		for (x = 0; x < width; x += 4) {
+			if (alpha) {
+				R_DecodeETC1Block(in + 8, block);
+				R_DecodeEACBlock(in, block);
+				in += 16;
+			} else {
+				R_DecodeETC1Block(in, block);
+				in += 8;
+			}
+
+			for (i = 0; i < 16; i++) {
+				bx = x + (i >> 2);
+				by = y + (i & 3);
+
+				if (bx < width && by < height) {
+					*(int *)(rgba + (by * width + bx) * 4) = *(int *)block[i];
+				}
+			}
+		}
+	}
+}
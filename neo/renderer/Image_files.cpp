@@ -37,6 +37,9 @@ This file only has a single entry point:
 
 void R_LoadImage( const char *name, byte **pic, int *width, int *height, bool makePowerOf2 );
 
+and R_StartImageDecode / R_DecodeImage / R_FinishImageDecode, which split the
+tga and jpg loads so the pixels can be decoded on the job threads.
+
 */
 
 /*
@@ -169,6 +172,7 @@ void R_WritePalTGA(const char *filename, const byte *data, const byte *palette,
 static void LoadBMP(const char *name, byte **pic, int *width, int *height, ID_TIME_T *timestamp);
 static void LoadTGA(const char *name, byte **pic, int *width, int *height, ID_TIME_T *timestamp);
 static void LoadJPG(const char *name, byte **pic, int *width, int *height, ID_TIME_T *timestamp);
+static void R_MakePowerOfTwo(byte **pic, int *width, int *height);
 
 
 /*
@@ -340,7 +344,7 @@ static void LoadBMP(const char *name, byte **pic, int *width, int *height, ID_TI
 	if (height)
 		*height = rows;
 
-	bmpRGBA = (byte *)R_StaticAlloc(numPixels * 4);
+	bmpRGBA = (byte *)R_StaticAlloc(numPixels * 4, TAG_IMAGE);
 	*pic = bmpRGBA;
 
 
@@ -461,14 +465,14 @@ static void LoadPCX(const char *filename, byte **pic, byte **palette, int *width
 		return;
 	}
 
-	out = (byte *)R_StaticAlloc((ymax+1) * (xmax+1));
+	out = (byte *)R_StaticAlloc((ymax+1) * (xmax+1), TAG_IMAGE);
 
 	*pic = out;
 
 	pix = out;
 
 	if (palette) {
-		*palette = (byte *)R_StaticAlloc(768);
+		*palette = (byte *)R_StaticAlloc(768, TAG_IMAGE);
 		memcpy(*palette, (byte *)pcx + len - 768, 768);
 	}
 
@@ -531,7 +535,7 @@ static void LoadPCX32(const char *filename, byte **pic, int *width, int *height,
 	}
 
 	c = (*width) * (*height);
-	pic32 = *pic = (byte *)R_StaticAlloc(4 * c);
+	pic32 = *pic = (byte *)R_StaticAlloc(4 * c, TAG_IMAGE);
 
 	for (i = 0 ; i < c ; i++) {
 		p = pic8[i];
@@ -556,34 +560,15 @@ TARGA LOADING
 
 /*
 =============
-LoadTGA
+R_ParseTGAHeader
+
+Reads and checks the header, returns the start of the pixels
 =============
 */
-static void LoadTGA(const char *name, byte **pic, int *width, int *height, ID_TIME_T *timestamp)
+static const byte *R_ParseTGAHeader(const char *name, const byte *buffer, int fileSize, TargaHeader &targa_header)
 {
-	int		columns, rows, numPixels, fileSize, numBytes;
-	byte	*pixbuf;
-	int		row, column;
-	byte	*buf_p;
-	byte	*buffer;
-	TargaHeader	targa_header;
-	byte		*targa_rgba;
-
-	if (!pic) {
-		fileSystem->ReadFile(name, NULL, timestamp);
-		return;	// just getting timestamp
-	}
-
-	*pic = NULL;
-
-	//
-	// load the file
-	//
-	fileSize = fileSystem->ReadFile(name, (void **)&buffer, timestamp);
-
-	if (!buffer) {
-		return;
-	}
+	const byte	*buf_p;
+	int			numBytes;
 
 	buf_p = buffer;
 
@@ -591,18 +576,18 @@ static void LoadTGA(const char *name, byte **pic, int *width, int *height, ID_TI
 	targa_header.colormap_type = *buf_p++;
 	targa_header.image_type = *buf_p++;
 
-	targa_header.colormap_index = LittleShort(*(short *)buf_p);
+	targa_header.colormap_index = LittleShort(*(const short *)buf_p);
 	buf_p += 2;
-	targa_header.colormap_length = LittleShort(*(short *)buf_p);
+	targa_header.colormap_length = LittleShort(*(const short *)buf_p);
 	buf_p += 2;
 	targa_header.colormap_size = *buf_p++;
-	targa_header.x_origin = LittleShort(*(short *)buf_p);
+	targa_header.x_origin = LittleShort(*(const short *)buf_p);
 	buf_p += 2;
-	targa_header.y_origin = LittleShort(*(short *)buf_p);
+	targa_header.y_origin = LittleShort(*(const short *)buf_p);
 	buf_p += 2;
-	targa_header.width = LittleShort(*(short *)buf_p);
+	targa_header.width = LittleShort(*(const short *)buf_p);
 	buf_p += 2;
-	targa_header.height = LittleShort(*(short *)buf_p);
+	targa_header.height = LittleShort(*(const short *)buf_p);
 	buf_p += 2;
 	targa_header.pixel_size = *buf_p++;
 	targa_header.attributes = *buf_p++;
@@ -619,6 +604,11 @@ static void LoadTGA(const char *name, byte **pic, int *width, int *height, ID_TI
 		common->Error("LoadTGA( %s ): Only 32 or 24 bit images supported (no colormaps)\n", name);
 	}
 
+	// R_DecodeTGA can't report errors
+	if (targa_header.pixel_size != 32 && targa_header.pixel_size != 24 && targa_header.pixel_size != 8) {
+		common->Error("LoadTGA( %s ): illegal pixel_size '%d'\n", name, targa_header.pixel_size);
+	}
+
 	if (targa_header.image_type == 2 || targa_header.image_type == 3) {
 		numBytes = targa_header.width * targa_header.height * (targa_header.pixel_size >> 3);
 
@@ -627,24 +617,28 @@ static void LoadTGA(const char *name, byte **pic, int *width, int *height, ID_TI
 		}
 	}
 
-	columns = targa_header.width;
-	rows = targa_header.height;
-	numPixels = columns * rows;
-
-	if (width) {
-		*width = columns;
+	if (targa_header.id_length != 0) {
+		buf_p += targa_header.id_length;  // skip TARGA image comment
 	}
 
-	if (height) {
-		*height = rows;
-	}
+	return buf_p;
+}
 
-	targa_rgba = (byte *)R_StaticAlloc(numPixels*4);
-	*pic = targa_rgba;
+/*
+=============
+R_DecodeTGA
 
-	if (targa_header.id_length != 0) {
-		buf_p += targa_header.id_length;  // skip TARGA image comment
-	}
+Only touches the given buffers, so it can run on a job thread
+=============
+*/
+static void R_DecodeTGA(const TargaHeader &targa_header, const byte *buf_p, byte *targa_rgba)
+{
+	int		columns, rows;
+	byte	*pixbuf;
+	int		row, column;
+
+	columns = targa_header.width;
+	rows = targa_header.height;
 
 	if (targa_header.image_type == 2 || targa_header.image_type == 3) {
 		// Uncompressed RGB or gray scale image
@@ -685,9 +679,6 @@ static void LoadTGA(const char *name, byte **pic, int *width, int *height, ID_TI
 						*pixbuf++ = blue;
 						*pixbuf++ = alphabyte;
 						break;
-					default:
-						common->Error("LoadTGA( %s ): illegal pixel_size '%d'\n", name, targa_header.pixel_size);
-						break;
 				}
 			}
 		}
@@ -720,9 +711,6 @@ static void LoadTGA(const char *name, byte **pic, int *width, int *height, ID_TI
 							red = *buf_p++;
 							alphabyte = *buf_p++;
 							break;
-						default:
-							common->Error("LoadTGA( %s ): illegal pixel_size '%d'\n", name, targa_header.pixel_size);
-							break;
 					}
 
 					for (j = 0; j < packetSize; j++) {
@@ -766,9 +754,6 @@ static void LoadTGA(const char *name, byte **pic, int *width, int *height, ID_TI
 								*pixbuf++ = blue;
 								*pixbuf++ = alphabyte;
 								break;
-							default:
-								common->Error("LoadTGA( %s ): illegal pixel_size '%d'\n", name, targa_header.pixel_size);
-								break;
 						}
 
 						column++;
@@ -794,10 +779,53 @@ breakOut:
 	}
 
 	if ((targa_header.attributes & (1<<5))) {			// image flp bit
-		R_VerticalFlip(*pic, *width, *height);
+		R_VerticalFlip(targa_rgba, columns, rows);
 	}
+}
 
-	fileSystem->FreeFile(buffer);
+/*
+=============
+LoadTGA
+=============
+*/
+static void LoadTGA(const char *name, byte **pic, int *width, int *height, ID_TIME_T *timestamp)
+{
+	int		fileSize;
+	const byte	*buffer;
+	const byte	*pixels;
+	TargaHeader	targa_header;
+
+	if (!pic) {
+		fileSystem->ReadFile(name, NULL, timestamp);
+		return;	// just getting timestamp
+	}
+
+	*pic = NULL;
+
+	//
+	// load the file
+	//
+	fileSize = fileSystem->ReadFileView(name, (const void **)&buffer, timestamp);
+
+	if (!buffer) {
+		return;
+	}
+
+	pixels = R_ParseTGAHeader(name, buffer, fileSize, targa_header);
+
+	if (width) {
+		*width = targa_header.width;
+	}
+
+	if (height) {
+		*height = targa_header.height;
+	}
+
+	*pic = (byte *)R_StaticAlloc(targa_header.width * targa_header.height * 4, TAG_IMAGE);
+
+	R_DecodeTGA(targa_header, pixels, *pic);
+
+	fileSystem->FreeFileView(buffer);
 }
 
 /*
@@ -809,21 +837,11 @@ Interfaces with the huge libjpeg
 =========================================================
 */
 
-/*
-=============
-LoadJPG
-=============
-*/
-static void LoadJPG(const char *filename, unsigned char **pic, int *width, int *height, ID_TIME_T *timestamp)
-{
+typedef struct {
 	/* This struct contains the JPEG decompression parameters and pointers to
 	 * working space (which is allocated as needed by the JPEG library).
 	 */
 	struct jpeg_decompress_struct cinfo;
-	/* We use our private extension JPEG error handler.
-	 * Note that this struct must live as long as the main JPEG parameter
-	 * struct, to avoid dangling-pointer problems.
-	 */
 	/* This struct represents a JPEG error handler.  It is declared separately
 	 * because applications often want to supply a specialized error handler
 	 * (see the second half of this file for an example).  But here we just
@@ -833,52 +851,17 @@ static void LoadJPG(const char *filename, unsigned char **pic, int *width, int *
 	 * struct, to avoid dangling-pointer problems.
 	 */
 	struct jpeg_error_mgr jerr;
-	/* More stuff */
-	JSAMPARRAY buffer;		/* Output row buffer */
-	int row_stride;		/* physical row width in output buffer */
-	unsigned char *out;
-	byte	*fbuffer;
-	int	len;
-	byte  *bbuf;
-
-	/* In this example we want to open the input file before doing anything else,
-	 * so that the setjmp() error recovery below can assume the file is open.
-	 * VERY IMPORTANT: use "b" option to fopen() if you are on a machine that
-	 * requires it in order to read binary files.
-	 */
-
-	// JDC: because fill_input_buffer() blindly copies INPUT_BUF_SIZE bytes,
-	// we need to make sure the file buffer is padded or it may crash
-	if (pic) {
-		*pic = NULL;		// until proven otherwise
-	}
-
-	{
-		idFile *f;
-
-		f = fileSystem->OpenFileRead(filename);
-
-		if (!f) {
-			return;
-		}
-
-		len = f->Length();
-
-		if (timestamp) {
-			*timestamp = f->Timestamp();
-		}
-
-		if (!pic) {
-			fileSystem->CloseFile(f);
-			return;	// just getting timestamp
-		}
-
-		fbuffer = (byte *)Mem_ClearedAlloc(len + 4096);
-		f->Read(fbuffer, len);
-		fileSystem->CloseFile(f);
-	}
+} jpegDecode_t;
 
+/*
+=============
+R_StartJPG
 
+Reads the header, the output size is known afterwards
+=============
+*/
+static void R_StartJPG(const char *filename, const byte *fbuffer, int len, jpegDecode_t &jpg)
+{
 	/* Step 1: allocate and initialize JPEG decompression object */
 
 	/* We have to set up the error handler first, in case the initialization
@@ -886,18 +869,18 @@ static void LoadJPG(const char *filename, unsigned char **pic, int *width, int *
 	 * This routine fills in the contents of struct jerr, and returns jerr's
 	 * address which we place into the link field in cinfo.
 	 */
-	cinfo.err = jpeg_std_error(&jerr);
+	jpg.cinfo.err = jpeg_std_error(&jpg.jerr);
 
 	/* Now we can initialize the JPEG decompression object. */
-	jpeg_create_decompress(&cinfo);
+	jpeg_create_decompress(&jpg.cinfo);
 
 	/* Step 2: specify data source (eg, a file) */
 
-	jpeg_mem_src(&cinfo, fbuffer, len);
+	jpeg_mem_src(&jpg.cinfo, (unsigned char *)fbuffer, len);
 
 	/* Step 3: read file parameters with jpeg_read_header() */
 
-	(void) jpeg_read_header(&cinfo, true);
+	(void) jpeg_read_header(&jpg.cinfo, true);
 	/* We can ignore the return value from jpeg_read_header since
 	 *   (a) suspension is not possible with the stdio data source, and
 	 *   (b) we passed TRUE to reject a tables-only JPEG file as an error.
@@ -912,30 +895,32 @@ static void LoadJPG(const char *filename, unsigned char **pic, int *width, int *
 
 	/* Step 5: Start decompressor */
 
-	(void) jpeg_start_decompress(&cinfo);
+	(void) jpeg_start_decompress(&jpg.cinfo);
 	/* We can ignore the return value since suspension is not possible
 	 * with the stdio data source.
 	 */
 
-	/* We may need to do some setup of our own at this point before reading
-	 * the data.  After jpeg_start_decompress() we have the correct scaled
-	 * output image dimensions available, as well as the output colormap
-	 * if we asked for color quantization.
-	 * In this example, we need to make an output work buffer of the right size.
-	 */
-	/* JSAMPLEs per row in output buffer */
-	row_stride = cinfo.output_width * cinfo.output_components;
-
-	if (cinfo.output_components!=4) {
+	if (jpg.cinfo.output_components!=4) {
 		common->DWarning("JPG %s is unsupported color depth (%d)",
-		                 filename, cinfo.output_components);
+		                 filename, jpg.cinfo.output_components);
 	}
+}
 
-	out = (byte *)R_StaticAlloc(cinfo.output_width*cinfo.output_height*4);
+/*
+=============
+R_DecodeJPG
 
-	*pic = out;
-	*width = cinfo.output_width;
-	*height = cinfo.output_height;
+Only touches the given buffers, so it can run on a job thread
+=============
+*/
+static void R_DecodeJPG(jpegDecode_t &jpg, byte *out)
+{
+	JSAMPARRAY buffer;		/* Output row buffer */
+	int row_stride;		/* physical row width in output buffer */
+	byte  *bbuf;
+
+	/* JSAMPLEs per row in output buffer */
+	row_stride = jpg.cinfo.output_width * jpg.cinfo.output_components;
 
 	/* Step 6: while (scan lines remain to be read) */
 	/*           jpeg_read_scanlines(...); */
@@ -943,33 +928,30 @@ static void LoadJPG(const char *filename, unsigned char **pic, int *width, int *
 	/* Here we use the library's state variable cinfo.output_scanline as the
 	 * loop counter, so that we don't have to keep track ourselves.
 	 */
-	while (cinfo.output_scanline < cinfo.output_height) {
+	while (jpg.cinfo.output_scanline < jpg.cinfo.output_height) {
 		/* jpeg_read_scanlines expects an array of pointers to scanlines.
 		 * Here the array is only one element long, but you could ask for
 		 * more than one scanline at a time if that's more convenient.
 		 */
-		bbuf = ((out+(row_stride*cinfo.output_scanline)));
+		bbuf = ((out+(row_stride*jpg.cinfo.output_scanline)));
 		buffer = &bbuf;
-		(void) jpeg_read_scanlines(&cinfo, buffer, 1);
+		(void) jpeg_read_scanlines(&jpg.cinfo, buffer, 1);
 	}
 
 	// clear all the alphas to 255
 	{
 		int	i, j;
-		byte	*buf;
 
-		buf = *pic;
-
-		j = cinfo.output_width * cinfo.output_height * 4;
+		j = jpg.cinfo.output_width * jpg.cinfo.output_height * 4;
 
 		for (i = 3 ; i < j ; i+=4) {
-			buf[i] = 255;
+			out[i] = 255;
 		}
 	}
 
 	/* Step 7: Finish decompression */
 
-	(void) jpeg_finish_decompress(&cinfo);
+	(void) jpeg_finish_decompress(&jpg.cinfo);
 	/* We can ignore the return value since suspension is not possible
 	 * with the stdio data source.
 	 */
@@ -977,24 +959,214 @@ static void LoadJPG(const char *filename, unsigned char **pic, int *width, int *
 	/* Step 8: Release JPEG decompression object */
 
 	/* This is an important step since it will release a good deal of memory. */
-	jpeg_destroy_decompress(&cinfo);
+	jpeg_destroy_decompress(&jpg.cinfo);
+}
 
-	/* After finish_decompress, we can close the input file.
-	 * Here we postpone it until after no more JPEG errors are possible,
-	 * so as to simplify the setjmp error logic above.  (Actually, I don't
-	 * think that jpeg_destroy can do an error exit, but why assume anything...)
-	 */
-	Mem_Free(fbuffer);
+/*
+=============
+LoadJPG
+=============
+*/
+static void LoadJPG(const char *filename, unsigned char **pic, int *width, int *height, ID_TIME_T *timestamp)
+{
+	jpegDecode_t	jpg;
+	const byte	*fbuffer;
+	int	len;
 
-	/* At this point you may want to check to see whether any corrupt-data
-	 * warnings occurred (test whether jerr.pub.num_warnings is nonzero).
-	 */
+	if (!pic) {
+		fileSystem->ReadFile(filename, NULL, timestamp);
+		return;	// just getting timestamp
+	}
+
+	*pic = NULL;		// until proven otherwise
+
+	len = fileSystem->ReadFileView(filename, (const void **)&fbuffer, timestamp);
 
-	/* And we're done! */
+	if (!fbuffer) {
+		return;
+	}
+
+	R_StartJPG(filename, fbuffer, len, jpg);
+
+	*pic = (byte *)R_StaticAlloc(jpg.cinfo.output_width*jpg.cinfo.output_height*4, TAG_IMAGE);
+	*width = jpg.cinfo.output_width;
+	*height = jpg.cinfo.output_height;
+
+	R_DecodeJPG(jpg, *pic);
+
+	fileSystem->FreeFileView(fbuffer);
 }
 
 //===================================================================
 
+// an image file that is read on the render thread and decoded by R_DecodeImage
+typedef struct imageDecode_s {
+	const byte 			*fileData;
+	bool				jpg;
+	TargaHeader			targaHeader;
+	const byte 			*targaPixels;
+	jpegDecode_t		jpgDecode;
+	byte 				*pic;
+	int					width;
+	int					height;
+} imageDecode_t;
+
+/*
+=================
+R_StartImageDecode
+
+Reads a tga or jpg file and its header, so the pixels can be decoded by
+R_DecodeImage on any thread.  Follows the naming rules of R_LoadImage.
+
+Returns NULL if the file wasn't found or is of another type, R_LoadImage
+should be used for it then.
+=================
+*/
+imageDecode_t *R_StartImageDecode(const char *cname, ID_TIME_T *timestamp)
+{
+	idStr			name = cname;
+	idStr			ext;
+	imageDecode_t	*decode;
+	const byte 		*buffer;
+	int				fileSize;
+
+	*timestamp = FILE_NOT_FOUND_TIMESTAMP;
+
+	name.DefaultFileExtension(".tga");
+
+	if (name.Length()<5) {
+		return NULL;
+	}
+
+	name.ToLower();
+	name.ExtractFileExtension(ext);
+
+	if (ext != "tga" && ext != "jpg") {
+		return NULL;
+	}
+
+	fileSize = fileSystem->ReadFileView(name, (const void **)&buffer, timestamp);
+
+	// try the jpg if the tga is missing
+	if (!buffer && ext == "tga") {
+		name.StripFileExtension();
+		name.DefaultFileExtension(".jpg");
+		ext = "jpg";
+		fileSize = fileSystem->ReadFileView(name, (const void **)&buffer, timestamp);
+	}
+
+	if (!buffer) {
+		return NULL;
+	}
+
+	decode = new imageDecode_t;
+	decode->fileData = buffer;
+	decode->jpg = (ext == "jpg");
+
+	if (decode->jpg) {
+		R_StartJPG(name, buffer, fileSize, decode->jpgDecode);
+		decode->width = decode->jpgDecode.cinfo.output_width;
+		decode->height = decode->jpgDecode.cinfo.output_height;
+	} else {
+		decode->targaPixels = R_ParseTGAHeader(name, buffer, fileSize, decode->targaHeader);
+		decode->width = decode->targaHeader.width;
+		decode->height = decode->targaHeader.height;
+	}
+
+	if (decode->width < 1 || decode->height < 1) {
+		if (decode->jpg) {
+			jpeg_destroy_decompress(&decode->jpgDecode.cinfo);
+		}
+
+		fileSystem->FreeFileView(buffer);
+		delete decode;
+		return NULL;
+	}
+
+	decode->pic = (byte *)R_StaticAlloc(decode->width * decode->height * 4, TAG_IMAGE);
+
+	return decode;
+}
+
+/*
+=================
+R_DecodeImage
+
+Only touches the file data and the pic of the decode, so it can run on a job thread
+=================
+*/
+void R_DecodeImage(imageDecode_t *decode)
+{
+	if (decode->jpg) {
+		R_DecodeJPG(decode->jpgDecode, decode->pic);
+	} else {
+		R_DecodeTGA(decode->targaHeader, decode->targaPixels, decode->pic);
+	}
+}
+
+/*
+=================
+R_FinishImageDecode
+
+Releases the file and frees the decode, returns the pic resized to powers of two
+=================
+*/
+byte *R_FinishImageDecode(imageDecode_t *decode, int *width, int *height)
+{
+	byte	*pic;
+
+	fileSystem->FreeFileView(decode->fileData);
+
+	pic = decode->pic;
+	*width = decode->width;
+	*height = decode->height;
+
+	delete decode;
+
+	R_MakePowerOfTwo(&pic, width, height);
+
+	return pic;
+}
+
+/*
+=================
+R_MakePowerOfTwo
+
+Resamples the image to exact power of 2 sizes
+=================
+*/
+static void R_MakePowerOfTwo(byte **pic, int *width, int *height)
+{
+	int		w, h;
+	int		scaled_width, scaled_height;
+	byte	*resampledBuffer;
+
+	w = *width;
+	h = *height;
+
+	for (scaled_width = 1 ; scaled_width < w ; scaled_width<<=1)
+		;
+
+	for (scaled_height = 1 ; scaled_height < h ; scaled_height<<=1)
+		;
+
+	if (scaled_width != w || scaled_height != h) {
+		if (globalImages->image_roundDown.GetBool() && scaled_width > w) {
+			scaled_width >>= 1;
+		}
+
+		if (globalImages->image_roundDown.GetBool() && scaled_height > h) {
+			scaled_height >>= 1;
+		}
+
+		resampledBuffer = R_ResampleTexture(*pic, w, h, scaled_width, scaled_height);
+		R_StaticFree(*pic);
+		*pic = resampledBuffer;
+		*width = scaled_width;
+		*height = scaled_height;
+	}
+}
+
 /*
 =================
 R_LoadImage
@@ -1076,34 +1248,7 @@ void R_LoadImage(const char *cname, byte **pic, int *width, int *height, ID_TIME
 	// convert to exact power of 2 sizes
 	//
 	if (pic && *pic && makePowerOf2) {
-		int		w, h;
-		int		scaled_width, scaled_height;
-		byte	*resampledBuffer;
-
-		w = *width;
-		h = *height;
-
-		for (scaled_width = 1 ; scaled_width < w ; scaled_width<<=1)
-			;
-
-		for (scaled_height = 1 ; scaled_height < h ; scaled_height<<=1)
-			;
-
-		if (scaled_width != w || scaled_height != h) {
-			if (globalImages->image_roundDown.GetBool() && scaled_width > w) {
-				scaled_width >>= 1;
-			}
-
-			if (globalImages->image_roundDown.GetBool() && scaled_height > h) {
-				scaled_height >>= 1;
-			}
-
-			resampledBuffer = R_ResampleTexture(*pic, w, h, scaled_width, scaled_height);
-			R_StaticFree(*pic);
-			*pic = resampledBuffer;
-			*width = scaled_width;
-			*height = scaled_height;
-		}
+		R_MakePowerOfTwo(pic, width, height);
 	}
 }
 
@@ -68,6 +68,10 @@ idCVar idImageManager::image_downSizeSpecularLimit("image_downSizeSpecularLimit"
 idCVar idImageManager::image_downSizeBumpLimit("image_downSizeBumpLimit", "128", CVAR_RENDERER | CVAR_ARCHIVE, "controls normal map downsample limit");
 idCVar idImageManager::image_ignoreHighQuality("image_ignoreHighQuality", "0", CVAR_RENDERER | CVAR_ARCHIVE, "ignore high quality setting on materials");
 idCVar idImageManager::image_downSizeLimit("image_downSizeLimit", "256", CVAR_RENDERER | CVAR_ARCHIVE, "controls diffuse map downsample limit");
+idCVar idImageManager::image_useETC("image_useETC", "1", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_BOOL, "use ETC1/ETC2 compression on OpenGL ES if available");
+idCVar idImageManager::image_etcQuality("image_etcQuality", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "1 = slower ETC encoding with less error", 0, 1);
+idCVar idImageManager::image_cacheETC("image_cacheETC", "1", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_BOOL, "write ETC encoded images to etc/*.ktx and use them if present");
+idCVar idImageManager::image_parallelLoad("image_parallelLoad", "1", CVAR_RENDERER | CVAR_BOOL, "decode and mip map the images on the job threads during level load");
 // do this with a pointer, in case we want to make the actual manager
 // a private virtual subclass
 idImageManager	imageManager;
@@ -404,6 +408,23 @@ static void R_RGBA8Image(idImage *image)
 	                     TF_DEFAULT, false, TR_REPEAT, TD_HIGH_QUALITY);
 }
 
+/*
+================
+R_ShadowMapAtlasImage
+
+Cleared to the farthest depth, the GLSL back end reallocates it at
+the atlas size of the view and renders into it
+================
+*/
+static void R_ShadowMapAtlasImage(idImage *image)
+{
+	byte	data[DEFAULT_SIZE][DEFAULT_SIZE][4];
+
+	memset(data, 255, sizeof(data));
+	image->GenerateImage((byte *)data, DEFAULT_SIZE, DEFAULT_SIZE,
+	                     TF_NEAREST, false, TR_CLAMP, TD_HIGH_QUALITY);
+}
+
 static void R_RGB8Image(idImage *image)
 {
 	byte	data[DEFAULT_SIZE][DEFAULT_SIZE][4];
@@ -490,7 +511,7 @@ static void CreateSquareLight(void)
 
 	width = height = 128;
 
-	buffer = (byte *)R_StaticAlloc(128 * 128 * 4);
+	buffer = (byte *)R_StaticAlloc(128 * 128 * 4, TAG_IMAGE);
 
 	for (x = 0 ; x < 128 ; x++) {
 		if (x < 32) {
@@ -544,7 +565,7 @@ static void CreateFlashOff(void)
 	width = 256;
 	height = 4;
 
-	buffer = (byte *)R_StaticAlloc(width * height * 4);
+	buffer = (byte *)R_StaticAlloc(width * height * 4, TAG_IMAGE);
 
 	for (x = 0 ; x < width ; x++) {
 		for (y = 0 ; y < height ; y++) {
@@ -1823,6 +1844,85 @@ void idImageManager::ReloadAllImages()
 	R_ReloadImages_f(args);
 }
 
+/*
+===============
+R_TestETC_f
+
+Encodes an image with R_EncodeETC and compares the R_DecodeETC
+result with the original
+===============
+*/
+void R_TestETC_f(const idCmdArgs &args)
+{
+	byte		*pic, *compressed, *decoded;
+	int			width, height, quality, size, i, c;
+	double		rgbError, alphaError, diff;
+	idTimer		timer;
+
+	if (args.Argc() < 2) {
+		common->Printf("usage: testETC <image> [quality]\n");
+		return;
+	}
+
+	R_LoadImageProgram(args.Argv(1), &pic, &width, &height, NULL);
+
+	if (!pic) {
+		common->Printf("couldn't load %s\n", args.Argv(1));
+		return;
+	}
+
+	if (args.Argc() > 2) {
+		quality = atoi(args.Argv(2));
+	} else {
+		quality = globalImages->image_etcQuality.GetInteger();
+	}
+
+	decoded = (byte *)R_StaticAlloc(width * height * 4, TAG_IMAGE);
+
+	for (int alpha = 0; alpha < 2; alpha++) {
+		size = R_ETCSize(width, height, alpha != 0);
+		compressed = (byte *)R_StaticAlloc(size, TAG_IMAGE);
+
+		timer.Clear();
+		timer.Start();
+		R_EncodeETC(pic, width, height, alpha != 0, quality, compressed);
+		timer.Stop();
+
+		R_DecodeETC(compressed, width, height, alpha != 0, decoded);
+
+		rgbError = 0;
+		alphaError = 0;
+
+		for (i = 0; i < width * height * 4; i += 4) {
+			for (c = 0; c < 3; c++) {
+				diff = pic[i + c] - decoded[i + c];
+				rgbError += diff * diff;
+			}
+
+			diff = pic[i + 3] - decoded[i + 3];
+			alphaError += diff * diff;
+		}
+
+		rgbError /= width * height * 3;
+		alphaError /= width * height;
+
+		// peak signal to noise ratio, higher is better
+		common->Printf("%s: %ix%i, %i bytes, %5.0f msec, rgb %5.2f dB", alpha ? "ETC2 EAC" : "ETC1    ", width, height,
+		               size, timer.Milliseconds(), rgbError ? 10.0 * log10(255.0 * 255.0 / rgbError) : 99.99);
+
+		if (alpha) {
+			common->Printf(", alpha %5.2f dB", alphaError ? 10.0 * log10(255.0 * 255.0 / alphaError) : 99.99);
+		}
+
+		common->Printf("\n");
+
+		R_StaticFree(compressed);
+	}
+
+	R_StaticFree(decoded);
+	R_StaticFree(pic);
+}
+
 /*
 ===============
 R_CombineCubeImages_f
@@ -1941,7 +2041,7 @@ void idImage::StartBackgroundImageLoad()
 	char	filename[MAX_IMAGE_NAME];
 	ImageProgramStringToCompressedFileName(imgName, filename);
 
-	bgl.completed = false;
+	bgl.status = ASYNC_READ_QUEUED;
 	bgl.f = fileSystem->OpenFileRead(filename);
 
 	if (!bgl.f) {
@@ -1949,17 +2049,20 @@ void idImage::StartBackgroundImageLoad()
 		return;
 	}
 
-	bgl.file.position = 0;
-	bgl.file.length = bgl.f->Length();
+	bgl.offset = 0;
+	bgl.length = bgl.f->Length();
 
-	if (bgl.file.length < sizeof(ddsFileHeader_t)) {
+	if (bgl.length < sizeof(ddsFileHeader_t)) {
 		common->Warning("idImageManager::StartBackgroundImageLoad: %s had a bad file length", imgName.c_str());
 		return;
 	}
 
-	bgl.file.buffer = R_StaticAlloc(bgl.file.length);
+	bgl.buffer = R_StaticAlloc(bgl.length, TAG_IMAGE);
+	bgl.priority = ASYNC_READ_PRIORITY_LOW;
+	bgl.callback = NULL;
+	bgl.userData = this;
 
-	fileSystem->BackgroundDownload(&bgl);
+	fileSystem->AsyncRead(&bgl);
 
 	imageManager.numActiveBackgroundImageLoads++;
 
@@ -2009,12 +2112,20 @@ void idImageManager::CompleteBackgroundImageLoads()
 	for (idImage *image = backgroundImageLoads ; image ; image = next) {
 		next = image->bglNext;
 
-		if (image->bgl.completed) {
+		if (image->bgl.status != ASYNC_READ_QUEUED && image->bgl.status != ASYNC_READ_INPROGRESS) {
 			numActiveBackgroundImageLoads--;
 			fileSystem->CloseFile(image->bgl.f);
+			image->bgl.f = NULL;
+
 			// upload the image
-			image->UploadPrecompressedImage((byte *)image->bgl.file.buffer, image->bgl.file.length);
-			R_StaticFree(image->bgl.file.buffer);
+			if (image->bgl.status == ASYNC_READ_DONE) {
+				image->UploadPrecompressedImage((byte *)image->bgl.buffer, image->bgl.length);
+			} else {
+				common->Warning("R_CompleteBackgroundImageLoad: couldn't read %s", image->imgName.c_str());
+			}
+
+			R_StaticFree(image->bgl.buffer);
+			image->bgl.buffer = NULL;
 
 			if (image_showBackgroundLoads.GetBool()) {
 				common->Printf("R_CompleteBackgroundImageLoad: %s\n", image->imgName.c_str());
@@ -2115,6 +2226,10 @@ void idImageManager::Init()
 
 	images.Resize(1024, 1024);
 
+	loadDecodeTime = 0;
+	loadBuildTime = 0;
+	loadUploadTime = 0;
+
 	// clear the cached LRU
 	cacheLRU.cacheUsageNext = &cacheLRU;
 	cacheLRU.cacheUsagePrev = &cacheLRU;
@@ -2148,10 +2263,12 @@ void idImageManager::Init()
 	accumImage = ImageFromFunction("_accum", R_RGBA8Image);
 	scratchCubeMapImage = ImageFromFunction("_scratchCubeMap", makeNormalizeVectorCubeMap);
 	currentRenderImage = ImageFromFunction("_currentRender", R_RGBA8Image);
+	shadowMapAtlasImage = ImageFromFunction("_shadowMapAtlas", R_ShadowMapAtlasImage);
 
 	cmdSystem->AddCommand("reloadImages", R_ReloadImages_f, CMD_FL_RENDERER, "reloads images");
 	cmdSystem->AddCommand("listImages", R_ListImages_f, CMD_FL_RENDERER, "lists images");
 	cmdSystem->AddCommand("combineCubeImages", R_CombineCubeImages_f, CMD_FL_RENDERER, "combines six images for roq compression");
+	cmdSystem->AddCommand("testETC", R_TestETC_f, CMD_FL_RENDERER, "reports the error and encode time of ETC compressing an image");
 
 	// should forceLoadImages be here?
 }
@@ -2224,7 +2341,7 @@ void idImageManager::EndLevelLoad()
 
 	int		purgeCount = 0;
 	int		keepCount = 0;
-	int		loadCount = 0;
+	idList<idImage *>	loadList;
 
 	// purge the ones we don't need
 	for (int i = 0 ; i < images.Num() ; i++) {
@@ -2254,23 +2371,106 @@ void idImageManager::EndLevelLoad()
 
 		if (image->levelLoadReferenced && image->texnum == idImage::TEXTURE_NOT_LOADED && !image->partialImage) {
 //			common->Printf( "Loading %s\n", image->imgName.c_str() );
-			loadCount++;
-			image->ActuallyLoadImage(true, false);
-
-			if ((loadCount & 15) == 0) {
-				session->PacifierUpdate();
-			}
+			loadList.Append(image);
 		}
 	}
 
+	loadDecodeTime = 0;
+	loadBuildTime = 0;
+	loadUploadTime = 0;
+
+	LoadImages(loadList.Ptr(), loadList.Num());
+
 	int	end = Sys_Milliseconds();
 	common->Printf("%5i purged from previous\n", purgeCount);
 	common->Printf("%5i kept from previous\n", keepCount);
-	common->Printf("%5i new loaded\n", loadCount);
+	common->Printf("%5i new loaded\n", loadList.Num());
+	common->Printf("%5.1f seconds decoding, %5.1f mip mapping, %5.1f uploading\n",
+	               loadDecodeTime * 0.001, loadBuildTime * 0.001, loadUploadTime * 0.001);
 	common->Printf("all images loaded in %5.1f seconds\n", (end-start) * 0.001);
 	common->Printf("----------------------------------------\n");
 }
 
+/*
+====================
+R_RunImageLoadJobs
+====================
+*/
+static void R_RunImageLoadJobs(xjob_t job, imageLoad_t *loads, int numLoads)
+{
+	if (idImageManager::image_parallelLoad.GetBool()) {
+		Sys_RunJobs(job, loads, sizeof(loads[0]), numLoads);
+	} else {
+		for (int i = 0; i < numLoads; i++) {
+			job(&loads[i]);
+		}
+	}
+}
+
+/*
+====================
+idImageManager::LoadImages
+
+The images go through in batches, to bound the memory held by the decoded
+images and to keep the pacifier going.  The files are read and the GL
+calls are made on this thread, the pixels are decoded and mip mapped by
+the job threads in between.
+====================
+*/
+void idImageManager::LoadImages(idImage **loadImages, int numImages)
+{
+	const int	LOAD_BATCH_SIZE = 16;
+	imageLoad_t	*loads;
+	idTimer		timer;
+	int			i, j, numLoads;
+
+	loads = new imageLoad_t[ LOAD_BATCH_SIZE ];
+
+	for (i = 0; i < numImages; i += LOAD_BATCH_SIZE) {
+		timer.Clear();
+		timer.Start();
+
+		numLoads = 0;
+
+		for (j = i; j < numImages && j < i + LOAD_BATCH_SIZE; j++) {
+			if (loadImages[j]->StartLoad(loads[numLoads], true)) {
+				numLoads++;
+			}
+		}
+
+		R_RunImageLoadJobs(idImage::DecodeLoadJob, loads, numLoads);
+
+		for (j = 0; j < numLoads; j++) {
+			loads[j].image->PrepareLoad(loads[j]);
+		}
+
+		timer.Stop();
+		loadDecodeTime += timer.Milliseconds();
+
+		timer.Clear();
+		timer.Start();
+
+		R_RunImageLoadJobs(idImage::BuildLoadJob, loads, numLoads);
+
+		timer.Stop();
+		loadBuildTime += timer.Milliseconds();
+
+		timer.Clear();
+		timer.Start();
+
+		for (j = 0; j < numLoads; j++) {
+			loads[j].image->FinishLoad(loads[j]);
+		}
+
+		timer.Stop();
+		loadUploadTime += timer.Milliseconds();
+
+		session->PacifierUpdate();
+	}
+
+	delete[] loads;
+}
+
 /*
 ===============
 idImageManager::StartBuild
@@ -54,6 +54,12 @@ static bool FormatIsDXT(int internalFormat)
 }
 #endif
 
+static bool FormatIsETC(int internalFormat)
+{
+	return (internalFormat == GL_ETC1_RGB8_OES || internalFormat == GL_COMPRESSED_RGB8_ETC2
+	        || internalFormat == GL_COMPRESSED_RGBA8_ETC2_EAC);
+}
+
 int MakePowerOfTwo(int num)
 {
 	int		pot;
@@ -114,6 +120,11 @@ int idImage::BitsForInternalFormat(int internalFormat) const
 		case GL_COMPRESSED_RGBA_ARB:
 			return 8;			// not sure
 #endif
+		case GL_ETC1_RGB8_OES:
+		case GL_COMPRESSED_RGB8_ETC2:
+			return 4;
+		case GL_COMPRESSED_RGBA8_ETC2_EAC:
+			return 8;
 		default:
 #if !defined(GL_ES_VERSION_2_0)
 			common->Error("R_BitsForInternalFormat: BAD FORMAT:%i", internalFormat);
@@ -238,7 +249,6 @@ This may need to scan six cube map images
 GLenum idImage::SelectInternalFormat(const byte **dataPtrs, int numDataPtrs, int width, int height,
                                      textureDepth_t minimumDepth) const
 {
-#if !defined(GL_ES_VERSION_2_0)
 	int		i, c;
 	const byte	*scan;
 	int		rgbOr, rgbAnd, aOr, aAnd;
@@ -291,6 +301,29 @@ GLenum idImage::SelectInternalFormat(const byte **dataPtrs, int numDataPtrs, int
 		needAlpha = true;
 	}
 
+#if defined(GL_ES_VERSION_2_0)
+	// ETC has nothing for normal maps, and they always need the alpha channel for swizzling
+	if (minimumDepth == TD_BUMP || minimumDepth == TD_HIGH_QUALITY
+	    || !globalImages->image_useCompression.GetBool() || !globalImages->image_useETC.GetBool()) {
+		return GL_RGBA8;
+	}
+
+	// the alpha channel of a specular map is assumed to be unintentional,
+	// and ETC2 takes ETC1 blocks, so it is used even for those
+	if (!needAlpha || minimumDepth == TD_SPECULAR) {
+		if (glConfig.etc2Available) {
+			return GL_COMPRESSED_RGB8_ETC2;
+		}
+
+		if (glConfig.etc1Available) {
+			return GL_ETC1_RGB8_OES;
+		}
+	} else if (glConfig.etc2Available) {
+		return GL_COMPRESSED_RGBA8_ETC2_EAC;
+	}
+
+	return GL_RGBA8;
+#else
 	// catch normal maps first
 	if (minimumDepth == TD_BUMP) {
 #if !defined(GL_ES_VERSION_2_0)
@@ -407,8 +440,6 @@ GLenum idImage::SelectInternalFormat(const byte **dataPtrs, int numDataPtrs, int
 	}
 
 	return GL_RGBA4;	// two bytes
-#else
-	return GL_RGBA8;	// four bytes
 #endif
 }
 
@@ -536,13 +567,33 @@ void idImage::GetDownsize(int &scaled_width, int &scaled_height) const
 	}
 }
 
+/*
+================
+R_SwapNormalAlpha
+
+Moves the red channel of the uploaded levels into alpha for rxgb
+================
+*/
+static void R_SwapNormalAlpha(imageMipChain_t &chain)
+{
+	int		i, j, c;
+
+	for (i = chain.firstUploadLevel; i < chain.numLevels; i++) {
+		c = chain.levelWidths[i] * chain.levelHeights[i] * 4;
+
+		for (j = 0; j < c; j += 4) {
+			chain.levels[i][ j + 3 ] = chain.levels[i][ j ];
+			chain.levels[i][ j ] = 0;
+		}
+	}
+}
+
 /*
 ================
 GenerateImage
 
 The alpha channel bytes should be 255 if you don't
 want the channel.
-
 We need a material characteristic to ask for specific texture modes.
 
 Designed limitations of flexibility:
@@ -569,10 +620,7 @@ void idImage::GenerateImage(const byte *pic, int width, int height,
                             textureFilter_t filterParm, bool allowDownSizeParm,
                             textureRepeat_t repeatParm, textureDepth_t depthParm)
 {
-	bool	preserveBorder;
-	byte		*scaledBuffer;
-	int			scaled_width, scaled_height;
-	byte		*shrunk;
+	imageMipChain_t	chain;
 
 	PurgeImage();
 
@@ -589,12 +637,23 @@ void idImage::GenerateImage(const byte *pic, int width, int height,
 		return;
 	}
 
-	// don't let mip mapping smear the texture into the clamped border
-	if (repeat == TR_CLAMP_TO_ZERO) {
-		preserveBorder = true;
-	} else {
-		preserveBorder = false;
-	}
+	StartMipChain(pic, width, height, chain);
+	BuildMipChain(chain);
+	UploadMipChain(chain);
+}
+
+/*
+================
+StartMipChain
+
+Sizes and allocates the levels for GenerateImage, the filter, repeat
+and depth of the image must be set
+================
+*/
+void idImage::StartMipChain(const byte *pic, int width, int height, imageMipChain_t &chain)
+{
+	int		scaled_width, scaled_height;
+	int		i, size, compressedSize;
 
 	// make sure it is a power of 2
 	scaled_width = MakePowerOfTwo(width);
@@ -607,24 +666,47 @@ void idImage::GenerateImage(const byte *pic, int width, int height,
 	// Optionally modify our width/height based on options/hardware
 	GetDownsize(scaled_width, scaled_height);
 
-	scaledBuffer = NULL;
+	chain.pic = pic;
+	chain.width = width;
+	chain.height = height;
+	chain.depth = depth;
+	chain.internalFormat = 0;
 
-	// generate the texture number
-	glGenTextures(1, &texnum);
+	// don't let mip mapping smear the texture into the clamped border
+	chain.preserveBorder = (repeat == TR_CLAMP_TO_ZERO);
+
+	// swap the red and alpha for rxgb support
+	// do this even on tga normal maps so we only have to use
+	// one fragment program
+	// if the image is precompressed ( either in palletized mode or true rxgb mode )
+	// then it is loaded above and the swap never happens here
+	chain.swapNormalAlpha = (depth == TD_BUMP && globalImages->image_useNormalCompression.GetInteger() != 1);
+
+	chain.writeTGA = (generatorFunction == NULL && (depth == TD_BUMP && globalImages->image_writeNormalTGA.GetBool() || depth != TD_BUMP && globalImages->image_writeTGA.GetBool()));
+
+	// the first level is the pic, shrunk down to the allowed size, then
+	// all the mip levels down to 1x1
+	chain.numLevels = 0;
+	chain.firstUploadLevel = 0;
+
+	while (1) {
+		if (chain.numLevels == MAX_IMAGE_LEVELS) {
+			common->Error("R_CreateImage: image too large");
+		}
+
+		chain.levelWidths[chain.numLevels] = width;
+		chain.levelHeights[chain.numLevels] = height;
+		chain.numLevels++;
+
+		// one might have shrunk down below the target size
+		if (width > scaled_width || height > scaled_height) {
+			chain.firstUploadLevel = chain.numLevels;
+		}
+
+		if (width == 1 && height == 1) {
+			break;
+		}
 
-	// select proper internal format before we resample
-	internalFormat = SelectInternalFormat(&pic, 1, width, height, depth);
-
-	// copy or resample data as appropriate for first MIP level
-	if ((scaled_width == width) && (scaled_height == height)) {
-		// we must copy even if unchanged, because the border zeroing
-		// would otherwise modify const data
-		scaledBuffer = (byte *)R_StaticAlloc(sizeof(unsigned) * scaled_width * scaled_height);
-		memcpy(scaledBuffer, pic, width*height*4);
-	} else {
-		// resample down as needed (FIXME: this doesn't seem like it resamples anymore!)
-		// scaledBuffer = R_ResampleTexture( pic, width, height, width >>= 1, height >>= 1 );
-		scaledBuffer = R_MipMap(pic, width, height, preserveBorder);
 		width >>= 1;
 		height >>= 1;
 
@@ -635,162 +717,187 @@ void idImage::GenerateImage(const byte *pic, int width, int height,
 		if (height < 1) {
 			height = 1;
 		}
+	}
 
-		while (width > scaled_width || height > scaled_height) {
-			shrunk = R_MipMap(scaledBuffer, width, height, preserveBorder);
-			R_StaticFree(scaledBuffer);
-			scaledBuffer = shrunk;
+	// the pic is used directly when it is shrunk, otherwise it is
+	// copied because the border zeroing would modify const data
+	size = 0;
 
-			width >>= 1;
-			height >>= 1;
+	for (i = (chain.firstUploadLevel > 0) ? 1 : 0; i < chain.numLevels; i++) {
+		size += chain.levelWidths[i] * chain.levelHeights[i] * 4;
+	}
 
-			if (width < 1) {
-				width = 1;
-			}
+	// room for the ETC blocks of the upload levels, in case BuildMipChain selects
+	// an ETC format, the alpha size covers both
+	compressedSize = 0;
 
-			if (height < 1) {
-				height = 1;
-			}
+	if ((glConfig.etc1Available || glConfig.etc2Available) && depth != TD_BUMP) {
+		for (i = chain.firstUploadLevel; i < chain.numLevels; i++) {
+			compressedSize += R_ETCSize(chain.levelWidths[i], chain.levelHeights[i], true);
 		}
-
-		// one might have shrunk down below the target size
-		scaled_width = width;
-		scaled_height = height;
 	}
 
-	uploadHeight = scaled_height;
-	uploadWidth = scaled_width;
-	type = TT_2D;
+	chain.buffer = (byte *)R_StaticAlloc(size + compressedSize, TAG_IMAGE);
 
-	// zero the border if desired, allowing clamped projection textures
-	// even after picmip resampling or careless artists.
-	if (repeat == TR_CLAMP_TO_ZERO) {
-		byte	rgba[4];
+	size = 0;
 
-		rgba[0] = rgba[1] = rgba[2] = 0;
-		rgba[3] = 255;
-		R_SetBorderTexels((byte *)scaledBuffer, width, height, rgba);
+	for (i = 0; i < chain.numLevels; i++) {
+		if (i == 0 && chain.firstUploadLevel > 0) {
+			chain.levels[i] = (byte *)pic;
+			continue;
+		}
+
+		chain.levels[i] = chain.buffer + size;
+		size += chain.levelWidths[i] * chain.levelHeights[i] * 4;
 	}
 
-	if (repeat == TR_CLAMP_TO_ZERO_ALPHA) {
-		byte	rgba[4];
+	for (i = 0; i < chain.numLevels; i++) {
+		chain.compressedSizes[i] = 0;
 
-		rgba[0] = rgba[1] = rgba[2] = 255;
-		rgba[3] = 0;
-		R_SetBorderTexels((byte *)scaledBuffer, width, height, rgba);
+		if (compressedSize == 0 || i < chain.firstUploadLevel) {
+			chain.compressed[i] = NULL;
+			continue;
+		}
+
+		chain.compressed[i] = chain.buffer + size;
+		size += R_ETCSize(chain.levelWidths[i], chain.levelHeights[i], true);
 	}
+}
 
-	if (generatorFunction == NULL && (depth == TD_BUMP && globalImages->image_writeNormalTGA.GetBool() || depth != TD_BUMP && globalImages->image_writeTGA.GetBool())) {
-		// Optionally write out the texture to a .tga
-		char filename[MAX_IMAGE_NAME];
-		ImageProgramStringToCompressedFileName(imgName, filename);
-		char *ext = strrchr(filename, '.');
+/*
+================
+BuildMipChain
 
-		if (ext) {
-			strcpy(ext, ".tga");
-			// swap the red/alpha for the write
-			/*
-			if ( depth == TD_BUMP ) {
-				for ( int i = 0; i < scaled_width * scaled_height * 4; i += 4 ) {
-					scaledBuffer[ i ] = scaledBuffer[ i + 3 ];
-					scaledBuffer[ i + 3 ] = 0;
-				}
+Fills in the levels allocated by StartMipChain.  Doesn't make any GL calls
+or allocations, so it can run on a job thread.
+================
+*/
+void idImage::BuildMipChain(imageMipChain_t &chain) const
+{
+	int		i;
+	byte	rgba[4];
+
+	// select proper internal format before we resample
+	chain.internalFormat = SelectInternalFormat(&chain.pic, 1, chain.width, chain.height, chain.depth);
+
+	for (i = 0; i < chain.numLevels; i++) {
+		if (i == 0) {
+			if (chain.firstUploadLevel > 0) {
+				continue;	// the pic itself
 			}
-			*/
-			R_WriteTGA(filename, scaledBuffer, scaled_width, scaled_height, false);
-
-			// put it back
-			/*
-			if ( depth == TD_BUMP ) {
-				for ( int i = 0; i < scaled_width * scaled_height * 4; i += 4 ) {
-					scaledBuffer[ i + 3 ] = scaledBuffer[ i ];
-					scaledBuffer[ i ] = 0;
-				}
+
+			memcpy(chain.levels[0], chain.pic, chain.width * chain.height * 4);
+		} else {
+			// preserve the border after mip map unless repeating
+			R_MipMapBuffer(chain.levels[i - 1], chain.levelWidths[i - 1], chain.levelHeights[i - 1], chain.preserveBorder, chain.levels[i]);
+		}
+
+		if (i == chain.firstUploadLevel) {
+			// zero the border if desired, allowing clamped projection textures
+			// even after picmip resampling or careless artists.
+			if (repeat == TR_CLAMP_TO_ZERO) {
+				rgba[0] = rgba[1] = rgba[2] = 0;
+				rgba[3] = 255;
+				R_SetBorderTexels(chain.levels[i], chain.levelWidths[i], chain.levelHeights[i], rgba);
+			}
+
+			if (repeat == TR_CLAMP_TO_ZERO_ALPHA) {
+				rgba[0] = rgba[1] = rgba[2] = 255;
+				rgba[3] = 0;
+				R_SetBorderTexels(chain.levels[i], chain.levelWidths[i], chain.levelHeights[i], rgba);
+			}
+		} else if (i > chain.firstUploadLevel) {
+			// this is a visualization tool that shades each mip map
+			// level with a different color so you can see the
+			// rasterizer's texture level selection algorithm
+			// Changing the color doesn't help with lumminance/alpha/intensity formats...
+			if (chain.depth == TD_DIFFUSE && globalImages->image_colorMipLevels.GetBool()) {
+				R_BlendOverTexture(chain.levels[i], chain.levelWidths[i] * chain.levelHeights[i], mipBlendColors[i - chain.firstUploadLevel]);
 			}
-			*/
 		}
 	}
 
-	// swap the red and alpha for rxgb support
-	// do this even on tga normal maps so we only have to use
-	// one fragment program
-	// if the image is precompressed ( either in palletized mode or true rxgb mode )
-	// then it is loaded above and the swap never happens here
-	if (depth == TD_BUMP && globalImages->image_useNormalCompression.GetInteger() != 1) {
-		for (int i = 0; i < scaled_width * scaled_height * 4; i += 4) {
-			scaledBuffer[ i + 3 ] = scaledBuffer[ i ];
-			scaledBuffer[ i ] = 0;
-		}
+	// the swap doesn't change the mip filtering, so it is done on all levels
+	// at once, after the tga is written if it is wanted
+	if (chain.swapNormalAlpha && !chain.writeTGA) {
+		R_SwapNormalAlpha(chain);
 	}
 
-	// upload the main image level
-	Bind();
+	// ETC is encoded here, as the levels are, so it runs on the job threads too
+	if (FormatIsETC(chain.internalFormat)) {
+		if (!chain.compressed[chain.firstUploadLevel]) {
+			chain.internalFormat = GL_RGBA8;
+			return;
+		}
 
+		bool alpha = (chain.internalFormat == GL_COMPRESSED_RGBA8_ETC2_EAC);
 
-#if !defined(GL_ES_VERSION_2_0)
-	if (internalFormat == GL_COLOR_INDEX8_EXT) {
-		/*
-		if ( depth == TD_BUMP ) {
-			for ( int i = 0; i < scaled_width * scaled_height * 4; i += 4 ) {
-				scaledBuffer[ i ] = scaledBuffer[ i + 3 ];
-				scaledBuffer[ i + 3 ] = 0;
-			}
+		for (i = chain.firstUploadLevel; i < chain.numLevels; i++) {
+			R_EncodeETC(chain.levels[i], chain.levelWidths[i], chain.levelHeights[i], alpha,
+			            globalImages->image_etcQuality.GetInteger(), chain.compressed[i]);
+			chain.compressedSizes[i] = R_ETCSize(chain.levelWidths[i], chain.levelHeights[i], alpha);
 		}
-		*/
-		UploadCompressedNormalMap(scaled_width, scaled_height, scaledBuffer, 0);
-	} else
-#endif
-	{
-		glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, scaled_width, scaled_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, scaledBuffer);
 	}
+}
 
-	// create and upload the mip map levels, which we do in all cases, even if we don't think they are needed
-	int		miplevel;
+/*
+================
+UploadMipChain
+================
+*/
+void idImage::UploadMipChain(imageMipChain_t &chain)
+{
+	int		i, first;
 
-	miplevel = 0;
+	first = chain.firstUploadLevel;
 
-	while (scaled_width > 1 || scaled_height > 1) {
-		// preserve the border after mip map unless repeating
-		shrunk = R_MipMap(scaledBuffer, scaled_width, scaled_height, preserveBorder);
-		R_StaticFree(scaledBuffer);
-		scaledBuffer = shrunk;
+	uploadWidth = chain.levelWidths[first];
+	uploadHeight = chain.levelHeights[first];
+	internalFormat = chain.internalFormat;
+	type = TT_2D;
 
-		scaled_width >>= 1;
-		scaled_height >>= 1;
+	// generate the texture number
+	glGenTextures(1, &texnum);
 
-		if (scaled_width < 1) {
-			scaled_width = 1;
-		}
+	if (chain.writeTGA) {
+		// Optionally write out the texture to a .tga
+		char filename[MAX_IMAGE_NAME];
+		ImageProgramStringToCompressedFileName(imgName, filename);
+		char *ext = strrchr(filename, '.');
 
-		if (scaled_height < 1) {
-			scaled_height = 1;
+		if (ext) {
+			strcpy(ext, ".tga");
+			R_WriteTGA(filename, chain.levels[first], uploadWidth, uploadHeight, false);
 		}
 
-		miplevel++;
-
-		// this is a visualization tool that shades each mip map
-		// level with a different color so you can see the
-		// rasterizer's texture level selection algorithm
-		// Changing the color doesn't help with lumminance/alpha/intensity formats...
-		if (depth == TD_DIFFUSE && globalImages->image_colorMipLevels.GetBool()) {
-			R_BlendOverTexture((byte *)scaledBuffer, scaled_width * scaled_height, mipBlendColors[miplevel]);
+		if (chain.swapNormalAlpha) {
+			R_SwapNormalAlpha(chain);
 		}
+	}
 
-		// upload the mip map
+	// upload the main image level
+	Bind();
+
+	// and the mip map levels, which we do in all cases, even if we don't think they are needed
+	for (i = first; i < chain.numLevels; i++) {
 #if !defined(GL_ES_VERSION_2_0)
 		if (internalFormat == GL_COLOR_INDEX8_EXT) {
-			UploadCompressedNormalMap(scaled_width, scaled_height, scaledBuffer, miplevel);
+			UploadCompressedNormalMap(chain.levelWidths[i], chain.levelHeights[i], chain.levels[i], i - first);
+		} else
+#else
+		if (FormatIsETC(internalFormat)) {
+			glCompressedTexImage2D(GL_TEXTURE_2D, i - first, internalFormat, chain.levelWidths[i], chain.levelHeights[i],
+			                       0, chain.compressedSizes[i], chain.compressed[i]);
 		} else
 #endif
 		{
-			glTexImage2D(GL_TEXTURE_2D, miplevel, internalFormat, scaled_width, scaled_height,
-			              0, GL_RGBA, GL_UNSIGNED_BYTE, scaledBuffer);
+			glTexImage2D(GL_TEXTURE_2D, i - first, internalFormat, chain.levelWidths[i], chain.levelHeights[i],
+			             0, GL_RGBA, GL_UNSIGNED_BYTE, chain.levels[i]);
 		}
 	}
 
-	if (scaledBuffer != 0) {
-		R_StaticFree(scaledBuffer);
-	}
+	R_StaticFree(chain.buffer);
+	chain.buffer = NULL;
 
 	SetImageFilterAndRepeat();
 
@@ -798,7 +905,6 @@ void idImage::GenerateImage(const byte *pic, int width, int height,
 	GL_CheckErrors();
 }
 
-
 #if !defined(GL_ES_VERSION_2_0)
 /*
 ==================
@@ -861,7 +967,7 @@ void idImage::Generate3DImage(const byte *pic, int width, int height, int picDep
 	int		miplevel;
 	byte	*scaledBuffer, *shrunk;
 
-	scaledBuffer = (byte *)R_StaticAlloc(scaled_width * scaled_height * scaled_depth * 4);
+	scaledBuffer = (byte *)R_StaticAlloc(scaled_width * scaled_height * scaled_depth * 4, TAG_IMAGE);
 	memcpy(scaledBuffer, pic, scaled_width * scaled_height * scaled_depth * 4);
 	miplevel = 0;
 
@@ -1104,6 +1210,20 @@ void idImage::ImageProgramStringToCompressedFileName(const char *imageProg, char
 	strcat(fileName, ".dds");
 }
 
+/*
+================
+ImageProgramStringToETCFileName
+
+The same mangling as the .dds files, but in etc/ with a .ktx extension
+================
+*/
+void idImage::ImageProgramStringToETCFileName(const char *imageProg, char *fileName) const
+{
+	ImageProgramStringToCompressedFileName(imageProg, fileName);
+	memcpy(fileName, "etc/", 4);
+	strcpy(strrchr(fileName, '.'), ".ktx");
+}
+
 /*
 ==================
 NumLevelsForImageSize
@@ -1122,6 +1242,252 @@ int	idImage::NumLevelsForImageSize(int width, int height) const
 	return numLevels;
 }
 
+static const byte ktxIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+/*
+================
+WriteETCImage
+
+Saves the ETC levels encoded by BuildMipChain, so they don't have to be
+encoded again the next time the image is loaded
+================
+*/
+void idImage::WriteETCImage(const imageMipChain_t &chain)
+{
+	ktxFileHeader_t	header;
+	ktxETCKeyValue_t keyValue;
+	char			filename[MAX_IMAGE_NAME];
+	idFile			*f;
+	int				i, size, first;
+
+	if (!FormatIsETC(chain.internalFormat) || generatorFunction || !globalImages->image_cacheETC.GetBool()) {
+		return;
+	}
+
+	ImageProgramStringToETCFileName(imgName, filename);
+
+	f = fileSystem->OpenFileWrite(filename);
+
+	if (!f) {
+		common->Warning("WriteETCImage: couldn't write %s", filename);
+		return;
+	}
+
+	first = chain.firstUploadLevel;
+
+	memset(&header, 0, sizeof(header));
+	memcpy(header.identifier, ktxIdentifier, sizeof(header.identifier));
+	header.endianness = LittleLong(KTX_ENDIANNESS);
+	header.glTypeSize = LittleLong(1);
+	header.glInternalFormat = LittleLong(chain.internalFormat);
+	header.glBaseInternalFormat = LittleLong((chain.internalFormat == GL_COMPRESSED_RGBA8_ETC2_EAC) ? GL_RGBA : GL_RGB);
+	header.pixelWidth = LittleLong(chain.levelWidths[first]);
+	header.pixelHeight = LittleLong(chain.levelHeights[first]);
+	header.numberOfFaces = LittleLong(1);
+	header.numberOfMipmapLevels = LittleLong(chain.numLevels - first);
+	header.bytesOfKeyValueData = LittleLong(sizeof(keyValue));
+
+	memset(&keyValue, 0, sizeof(keyValue));
+	keyValue.keyAndValueByteSize = LittleLong(sizeof(keyValue) - sizeof(keyValue.keyAndValueByteSize));
+	strcpy(keyValue.key, KTX_ETC_KEY);
+	keyValue.quality = LittleLong(globalImages->image_etcQuality.GetInteger());
+	keyValue.sourceWidth = LittleLong(chain.width);
+	keyValue.sourceHeight = LittleLong(chain.height);
+
+	f->Write(&header, sizeof(header));
+	f->Write(&keyValue, sizeof(keyValue));
+
+	// the blocks are 8 bytes, so the levels never need padding
+	for (i = first; i < chain.numLevels; i++) {
+		size = LittleLong(chain.compressedSizes[i]);
+		f->Write(&size, sizeof(size));
+		f->Write(chain.compressed[i], chain.compressedSizes[i]);
+	}
+
+	fileSystem->CloseFile(f);
+}
+
+/*
+================
+CheckETCImage
+
+Loads an image saved by WriteETCImage, if it is newer than the source
+image, was encoded with the current quality at least at the size the
+current downsize settings give, and the driver can take its format
+================
+*/
+bool idImage::CheckETCImage()
+{
+#if defined(GL_ES_VERSION_2_0)
+	char			filename[MAX_IMAGE_NAME];
+	ID_TIME_T		cacheTimestamp;
+	ktxFileHeader_t	*header;
+	ktxETCKeyValue_t *keyValue;
+	byte			*data;
+	int				len, pos, format, numLevels, i;
+	int				width, height, uw, uh, skipMip;
+	int				expectedWidth, expectedHeight;
+	int				levelWidth, levelHeight;
+	int				sizes[MAX_IMAGE_LEVELS];
+
+	if (!glConfig.isInitialized || !globalImages->image_cacheETC.GetBool()
+	    || !globalImages->image_useETC.GetBool() || !globalImages->image_useCompression.GetBool()) {
+		return false;
+	}
+
+	if (depth == TD_BUMP || depth == TD_HIGH_QUALITY) {
+		return false;
+	}
+
+	ImageProgramStringToETCFileName(imgName, filename);
+
+	fileSystem->ReadFile(filename, NULL, &cacheTimestamp);
+
+	if (cacheTimestamp == FILE_NOT_FOUND_TIMESTAMP) {
+		return false;
+	}
+
+	if (timestamp != FILE_NOT_FOUND_TIMESTAMP && cacheTimestamp < timestamp) {
+		// the image has changed after being encoded
+		return false;
+	}
+
+	len = fileSystem->ReadFile(filename, (void **)&data, NULL);
+
+	if (len < (int)sizeof(ktxFileHeader_t)) {
+		if (data) {
+			fileSystem->FreeFile(data);
+		}
+
+		return false;
+	}
+
+	header = (ktxFileHeader_t *)data;
+	format = LittleLong(header->glInternalFormat);
+	width = LittleLong(header->pixelWidth);
+	height = LittleLong(header->pixelHeight);
+	numLevels = LittleLong(header->numberOfMipmapLevels);
+
+	if (memcmp(header->identifier, ktxIdentifier, sizeof(header->identifier)) || LittleLong(header->endianness) != KTX_ENDIANNESS
+	    || !FormatIsETC(format) || width < 1 || height < 1 || numLevels < 1 || numLevels > MAX_IMAGE_LEVELS) {
+		common->Printf("CheckETCImage( %s ): bad header\n", filename);
+		fileSystem->FreeFile(data);
+		return false;
+	}
+
+	// re-encode if the settings changed since it was written, caches without the settings included
+	keyValue = (ktxETCKeyValue_t *)(data + sizeof(ktxFileHeader_t));
+
+	if (LittleLong(header->bytesOfKeyValueData) != sizeof(ktxETCKeyValue_t) || len < (int)(sizeof(ktxFileHeader_t) + sizeof(ktxETCKeyValue_t))
+	    || LittleLong(keyValue->keyAndValueByteSize) != sizeof(ktxETCKeyValue_t) - sizeof(keyValue->keyAndValueByteSize)
+	    || memcmp(keyValue->key, KTX_ETC_KEY, sizeof(KTX_ETC_KEY))) {
+		common->DPrintf("CheckETCImage( %s ): no encode settings\n", filename);
+		fileSystem->FreeFile(data);
+		return false;
+	}
+
+	expectedWidth = LittleLong(keyValue->sourceWidth);
+	expectedHeight = LittleLong(keyValue->sourceHeight);
+	GetDownsize(expectedWidth, expectedHeight);
+
+	if (LittleLong(keyValue->quality) != globalImages->image_etcQuality.GetInteger() || width < expectedWidth || height < expectedHeight) {
+		common->DPrintf("CheckETCImage( %s ): encoded with other settings\n", filename);
+		fileSystem->FreeFile(data);
+		return false;
+	}
+
+	// ETC2 takes the ETC1 blocks
+	if (format == GL_ETC1_RGB8_OES && !glConfig.etc1Available) {
+		format = GL_COMPRESSED_RGB8_ETC2;
+	}
+
+	if (format != GL_ETC1_RGB8_OES && !glConfig.etc2Available) {
+		fileSystem->FreeFile(data);
+		return false;
+	}
+
+	// check all the levels before making the texture
+	pos = sizeof(ktxFileHeader_t) + LittleLong(header->bytesOfKeyValueData);
+	uw = width;
+	uh = height;
+
+	for (i = 0; i < numLevels; i++) {
+		if (pos < 0 || pos + 4 > len) {
+			break;
+		}
+
+		sizes[i] = LittleLong(*(int *)(data + pos));
+		pos += 4;
+
+		if (sizes[i] != R_ETCSize(uw, uh, format == GL_COMPRESSED_RGBA8_ETC2_EAC) || pos + sizes[i] > len) {
+			break;
+		}
+
+		pos += sizes[i];
+		uw = Max(uw >> 1, 1);
+		uh = Max(uh >> 1, 1);
+	}
+
+	if (i != numLevels) {
+		common->Printf("CheckETCImage( %s ): truncated or bad levels\n", filename);
+		fileSystem->FreeFile(data);
+		return false;
+	}
+
+	timestamp = cacheTimestamp;
+
+	// generate the texture number
+	glGenTextures(1, &texnum);
+
+	precompressedFile = true;
+	internalFormat = format;
+	type = TT_2D;
+
+	// we may skip some mip maps if we are downsizing
+	uploadWidth = expectedWidth;
+	uploadHeight = expectedHeight;
+
+	Bind();
+
+	pos = sizeof(ktxFileHeader_t) + LittleLong(header->bytesOfKeyValueData);
+	uw = width;
+	uh = height;
+	skipMip = 0;
+	levelWidth = levelHeight = 1;
+
+	for (i = 0; i < numLevels; i++) {
+		pos += 4;
+
+		if (uw > uploadWidth || uh > uploadHeight) {
+			skipMip++;
+		} else {
+			if (i == skipMip) {
+				levelWidth = uw;
+				levelHeight = uh;
+			}
+
+			glCompressedTexImage2D(GL_TEXTURE_2D, i - skipMip, internalFormat, uw, uh, 0, sizes[i], data + pos);
+		}
+
+		pos += sizes[i];
+		uw = Max(uw >> 1, 1);
+		uh = Max(uh >> 1, 1);
+	}
+
+	fileSystem->FreeFile(data);
+
+	// the cache may have been encoded at a smaller size
+	uploadWidth = levelWidth;
+	uploadHeight = levelHeight;
+
+	SetImageFilterAndRepeat();
+
+	return true;
+#else
+	return false;
+#endif
+}
+
 /*
 ================
 WritePrecompressedImage
@@ -1337,7 +1703,7 @@ void idImage::WritePrecompressedImage()
 		}
 
 		if (data == NULL) {
-			data = (byte *)R_StaticAlloc(size);
+			data = (byte *)R_StaticAlloc(size, TAG_IMAGE);
 		}
 
 		if (FormatIsDXT(altInternalFormat)) {
@@ -1502,7 +1868,7 @@ bool idImage::CheckPrecompressedImage(bool fullLoad)
 		len = globalImages->image_cacheMinK.GetInteger() * 1024;
 	}
 
-	byte *data = (byte *)R_StaticAlloc(len);
+	byte *data = (byte *)R_StaticAlloc(len, TAG_IMAGE);
 
 	f->Read(data, len);
 
@@ -1532,7 +1898,7 @@ bool idImage::CheckPrecompressedImage(bool fullLoad)
 
 	return true;
 #else
-	return false;
+	return CheckETCImage();
 #endif
 }
 
@@ -1692,24 +2058,49 @@ On exit, the idImage will have a valid OpenGL texture number that can be bound
 */
 void	idImage::ActuallyLoadImage(bool checkForPrecompressed, bool fromBackEnd)
 {
-	int		width, height;
-	byte	*pic;
+	imageLoad_t	load;
+
+	if (!StartLoad(load, checkForPrecompressed)) {
+		return;
+	}
+
+	DecodeLoadJob(&load);
+	PrepareLoad(load);
+	BuildLoadJob(&load);
+	FinishLoad(load);
+}
+
+/*
+===============
+StartLoad
+
+Completely loads the images that can't be split up, and returns false.
+Otherwise the file is read and the load goes on with DecodeLoadJob,
+PrepareLoad, BuildLoadJob and FinishLoad.
+===============
+*/
+bool idImage::StartLoad(imageLoad_t &load, bool checkForPrecompressed)
+{
+	int		width;
+
+	memset(&load, 0, sizeof(load));
+	load.image = this;
 
 	// this is the ONLY place generatorFunction will ever be called
 	if (generatorFunction) {
 		generatorFunction(this);
-		return;
+		return false;
 	}
 
 	// if we are a partial image, we are only going to load from a compressed file
 	if (isPartialImage) {
 		if (CheckPrecompressedImage(false)) {
-			return;
+			return false;
 		}
 
 		// this is an error -- the partial image failed to load
 		MakeDefault();
-		return;
+		return false;
 	}
 
 	//
@@ -1724,7 +2115,7 @@ void	idImage::ActuallyLoadImage(bool checkForPrecompressed, bool fromBackEnd)
 		if (pics[0] == NULL) {
 			common->Warning("Couldn't load cube image: %s", imgName.c_str());
 			MakeDefault();
-			return;
+			return false;
 		}
 
 		GenerateCubeImage((const byte **)pics, width, filter, allowDownSize, depth);
@@ -1735,53 +2126,129 @@ void	idImage::ActuallyLoadImage(bool checkForPrecompressed, bool fromBackEnd)
 				R_StaticFree(pics[i]);
 			}
 		}
-	} else {
-		// see if we have a pre-generated image file that is
-		// already image processed and compressed
-		if (checkForPrecompressed && globalImages->image_usePrecompressedTextures.GetBool()) {
-			if (CheckPrecompressedImage(true)) {
-				// we got the precompressed image
-				return;
-			}
 
-			// fall through to load the normal image
+		return false;
+	}
+
+	// see if we have a pre-generated image file that is
+	// already image processed and compressed
+	if (checkForPrecompressed && globalImages->image_usePrecompressedTextures.GetBool()) {
+		if (CheckPrecompressedImage(true)) {
+			// we got the precompressed image
+			return false;
 		}
 
-		R_LoadImageProgram(imgName, &pic, &width, &height, &timestamp, &depth);
+		// fall through to load the normal image
+	}
+
+	// plain files are decoded later, image programs are run right away
+	if (imgName.Find('(') == -1) {
+		load.decode = R_StartImageDecode(imgName, &timestamp);
+	}
+
+	if (!load.decode) {
+		R_LoadImageProgram(imgName, &load.pic, &load.width, &load.height, &timestamp, &depth);
 
-		if (pic == NULL) {
+		if (load.pic == NULL) {
 			common->Warning("Couldn't load image: %s", imgName.c_str());
 			MakeDefault();
-			return;
+			return false;
 		}
+	}
+
+	return true;
+}
+
+/*
+===============
+DecodeLoadJob
+===============
+*/
+void idImage::DecodeLoadJob(void *parms)
+{
+	imageLoad_t *load = (imageLoad_t *)parms;
+
+	if (load->decode) {
+		R_DecodeImage(load->decode);
+	}
+}
+
+/*
+===============
+PrepareLoad
 
-		/*
-				// swap the red and alpha for rxgb support
-				// do this even on tga normal maps so we only have to use
-				// one fragment program
-				// if the image is precompressed ( either in palletized mode or true rxgb mode )
-				// then it is loaded above and the swap never happens here
-				if ( depth == TD_BUMP && globalImages->image_useNormalCompression.GetInteger() != 1 ) {
-					for ( int i = 0; i < width * height * 4; i += 4 ) {
-						pic[ i + 3 ] = pic[ i ];
-						pic[ i ] = 0;
-					}
+Finishes the decode and allocates the mip levels
+===============
+*/
+void idImage::PrepareLoad(imageLoad_t &load)
+{
+	if (load.decode) {
+		load.pic = R_FinishImageDecode(load.decode, &load.width, &load.height);
+		load.decode = NULL;
+	}
+
+	PurgeImage();
+
+	// without a rendering context only the parms are kept, like in GenerateImage
+	if (glConfig.isInitialized) {
+		StartMipChain(load.pic, load.width, load.height, load.chain);
+	}
+}
+
+/*
+===============
+BuildLoadJob
+===============
+*/
+void idImage::BuildLoadJob(void *parms)
+{
+	imageLoad_t *load = (imageLoad_t *)parms;
+
+	/*
+			// swap the red and alpha for rxgb support
+			// do this even on tga normal maps so we only have to use
+			// one fragment program
+			// if the image is precompressed ( either in palletized mode or true rxgb mode )
+			// then it is loaded above and the swap never happens here
+			if ( depth == TD_BUMP && globalImages->image_useNormalCompression.GetInteger() != 1 ) {
+				for ( int i = 0; i < width * height * 4; i += 4 ) {
+					pic[ i + 3 ] = pic[ i ];
+					pic[ i ] = 0;
 				}
-		*/
-		// build a hash for checking duplicate image files
-		// NOTE: takes about 10% of image load times (SD)
-		// may not be strictly necessary, but some code uses it, so let's leave it in
-		imageHash = MD4_BlockChecksum(pic, width * height * 4);
-
-		GenerateImage(pic, width, height, filter, allowDownSize, repeat, depth);
-		timestamp = timestamp;
-		precompressedFile = false;
+			}
+	*/
+	// build a hash for checking duplicate image files
+	// NOTE: takes about 10% of image load times (SD)
+	// may not be strictly necessary, but some code uses it, so let's leave it in
+	load->imageHash = MD4_BlockChecksum(load->pic, load->width * load->height * 4);
 
-		R_StaticFree(pic);
+	if (load->chain.numLevels) {
+		load->image->BuildMipChain(load->chain);
+	}
+}
+
+/*
+===============
+FinishLoad
+
+Uploads the levels, on the render thread
+===============
+*/
+void idImage::FinishLoad(imageLoad_t &load)
+{
+	imageHash = load.imageHash;
 
-		// write out the precompressed version of this file if needed
-		WritePrecompressedImage();
+	if (load.chain.numLevels) {
+		WriteETCImage(load.chain);
+		UploadMipChain(load.chain);
 	}
+
+	precompressedFile = false;
+
+	R_StaticFree(load.pic);
+
+	// write out the precompressed version of this file if needed
+	WritePrecompressedImage();
 }
 
 //=========================================================================================================
@@ -1888,11 +2355,17 @@ void idImage::Bind()
 		if (tmu->current2DMap != texnum) {
 			tmu->current2DMap = texnum;
 			glBindTexture(GL_TEXTURE_2D, texnum);
+			backEnd.pc.c_textureBinds++;
+		} else {
+			backEnd.pc.c_textureBindsSkipped++;
 		}
 	} else if (type == TT_CUBIC) {
 		if (tmu->currentCubeMap != texnum) {
 			tmu->currentCubeMap = texnum;
 			glBindTexture(GL_TEXTURE_CUBE_MAP, texnum);
+			backEnd.pc.c_textureBinds++;
+		} else {
+			backEnd.pc.c_textureBindsSkipped++;
 		}
 	}
 #if !defined(GL_ES_VERSION_2_0)
@@ -1900,6 +2373,9 @@ void idImage::Bind()
 		if (tmu->current3DMap != texnum) {
 			tmu->current3DMap = texnum;
 			glBindTexture(GL_TEXTURE_3D, texnum);
+			backEnd.pc.c_textureBinds++;
+		} else {
+			backEnd.pc.c_textureBindsSkipped++;
 		}
 	}
 #endif
@@ -2337,6 +2813,15 @@ void idImage::Print() const
 			common->Printf("RGBAC ");
 			break;
 #endif
+		case GL_ETC1_RGB8_OES:
+			common->Printf("ETC1  ");
+			break;
+		case GL_COMPRESSED_RGB8_ETC2:
+			common->Printf("ETC2  ");
+			break;
+		case GL_COMPRESSED_RGBA8_ETC2_EAC:
+			common->Printf("EAC   ");
+			break;
 		case 0:
 			common->Printf("      ");
 			break;
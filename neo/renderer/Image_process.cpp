@@ -62,7 +62,7 @@ byte *R_ResampleTexture(const byte *in, int inwidth, int inheight,
 		outheight = MAX_DIMENSION;
 	}
 
-	out = (byte *)R_StaticAlloc(outwidth * outheight * 4);
+	out = (byte *)R_StaticAlloc(outwidth * outheight * 4, TAG_IMAGE);
 	out_p = out;
 
 	fracstep = inwidth*0x10000/outwidth;
@@ -117,7 +117,7 @@ byte *R_Dropsample(const byte *in, int inwidth, int inheight,
 	const byte	*pix1;
 	byte		*out, *out_p;
 
-	out = (byte *)R_StaticAlloc(outwidth * outheight * 4);
+	out = (byte *)R_StaticAlloc(outwidth * outheight * 4, TAG_IMAGE);
 	out_p = out;
 
 	for (i=0 ; i<outheight ; i++, out_p += outwidth*4) {
@@ -374,7 +374,7 @@ byte *R_MipMapWithAlphaSpecularity(const byte *in, int width, int height)
 		newHeight = 1;
 	}
 
-	out = (byte *)R_StaticAlloc(newWidth * newHeight * 4);
+	out = (byte *)R_StaticAlloc(newWidth * newHeight * 4, TAG_IMAGE);
 	out_p = out;
 
 	in_p = in;
@@ -434,24 +434,13 @@ smeared clamps...
 */
 byte *R_MipMap(const byte *in, int width, int height, bool preserveBorder)
 {
-	int		i, j;
-	const byte	*in_p;
-	byte	*out, *out_p;
-	int		row;
-	byte	border[4];
+	byte	*out;
 	int		newWidth, newHeight;
 
 	if (width < 1 || height < 1 || (width + height == 2)) {
 		common->FatalError("R_MipMap called with size %i,%i", width, height);
 	}
 
-	border[0] = in[0];
-	border[1] = in[1];
-	border[2] = in[2];
-	border[3] = in[3];
-
-	row = width * 4;
-
 	newWidth = width >> 1;
 	newHeight = height >> 1;
 
@@ -463,7 +452,35 @@ byte *R_MipMap(const byte *in, int width, int height, bool preserveBorder)
 		newHeight = 1;
 	}
 
-	out = (byte *)R_StaticAlloc(newWidth * newHeight * 4);
+	out = (byte *)R_StaticAlloc(newWidth * newHeight * 4, TAG_IMAGE);
+
+	R_MipMapBuffer(in, width, height, preserveBorder, out);
+
+	return out;
+}
+
+/*
+================
+R_MipMapBuffer
+
+R_MipMap into a buffer of the caller, doesn't allocate so it can run on a job thread
+================
+*/
+void R_MipMapBuffer(const byte *in, int width, int height, bool preserveBorder, byte *out)
+{
+	int		i, j;
+	const byte	*in_p;
+	byte	*out_p;
+	int		row;
+	byte	border[4];
+
+	border[0] = in[0];
+	border[1] = in[1];
+	border[2] = in[2];
+	border[3] = in[3];
+
+	row = width * 4;
+
 	out_p = out;
 
 	in_p = in;
@@ -490,7 +507,7 @@ byte *R_MipMap(const byte *in, int width, int height, bool preserveBorder)
 			}
 		}
 
-		return out;
+		return;
 	}
 
 	for (i=0 ; i<height ; i++, in_p+=row) {
@@ -506,8 +523,6 @@ byte *R_MipMap(const byte *in, int width, int height, bool preserveBorder)
 	if (preserveBorder) {
 		R_SetBorderTexels(out, width, height, border);
 	}
-
-	return out;
 }
 
 /*
@@ -553,7 +568,7 @@ byte *R_MipMap3D(const byte *in, int width, int height, int depth, bool preserve
 	newHeight = height >> 1;
 	newDepth = depth >> 1;
 
-	out = (byte *)R_StaticAlloc(newWidth * newHeight * newDepth * 4);
+	out = (byte *)R_StaticAlloc(newWidth * newHeight * newDepth * 4, TAG_IMAGE);
 	out_p = out;
 
 	in_p = in;
@@ -656,7 +671,7 @@ void R_RotatePic(byte *data, int width)
 	int		i, j;
 	int		*temp;
 
-	temp = (int *)R_StaticAlloc(width * width * 4);
+	temp = (int *)R_StaticAlloc(width * width * 4, TAG_IMAGE);
 
 	for (i = 0 ; i < width ; i++) {
 		for (j = 0 ; j < width ; j++) {
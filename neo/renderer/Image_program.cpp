@@ -85,7 +85,7 @@ static void R_HeightmapToNormalMap(byte *data, int width, int height, float scal
 
 	// copy and convert to grey scale
 	j = width * height;
-	depth = (byte *)R_StaticAlloc(j);
+	depth = (byte *)R_StaticAlloc(j, TAG_IMAGE);
 
 	for (i = 0 ; i < j ; i++) {
 		depth[i] = (data[i*4] + data[i*4+1] + data[i*4+2]) / 3;
@@ -274,7 +274,7 @@ static void R_SmoothNormalMap(byte *data, int width, int height)
 		{ 1, 1, 1 }
 	};
 
-	orig = (byte *)R_StaticAlloc(width * height * 4);
+	orig = (byte *)R_StaticAlloc(width * height * 4, TAG_IMAGE);
 	memcpy(orig, data, width * height * 4);
 
 	for (i = 0 ; i < width ; i++) {
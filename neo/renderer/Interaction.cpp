@@ -308,7 +308,7 @@ static srfTriangles_t *R_CreateLightTris(const idRenderEntityLocal *ent,
 	bool		includeBackFaces;
 	int			faceNum;
 
-	tr.pc.c_createLightTris++;
+	__sync_fetch_and_add(&tr.pc.c_createLightTris, 1);
 	c_backfaced = 0;
 	c_distance = 0;
 
@@ -525,14 +525,10 @@ idInteraction *idInteraction::AllocAndLink(idRenderEntityLocal *edef, idRenderLi
 	}
 
 	// update the interaction table
-	if (renderWorld->interactionTable) {
-		int index = ldef->index * renderWorld->interactionTableWidth + edef->index;
-
-		if (renderWorld->interactionTable[index] != NULL) {
+	if (renderWorld->interactionTable.IsInitialized()) {
+		if (!renderWorld->interactionTable.Add(interaction)) {
 			common->Error("idInteraction::AllocAndLink: non NULL table entry");
 		}
-
-		renderWorld->interactionTable[ index ] = interaction;
 	}
 
 	return interaction;
@@ -631,14 +627,10 @@ void idInteraction::UnlinkAndFree(void)
 	// clear the table pointer
 	idRenderWorldLocal *renderWorld = this->lightDef->world;
 
-	if (renderWorld->interactionTable) {
-		int index = this->lightDef->index * renderWorld->interactionTableWidth + this->entityDef->index;
-
-		if (renderWorld->interactionTable[index] != this) {
+	if (renderWorld->interactionTable.IsInitialized()) {
+		if (!renderWorld->interactionTable.Remove(this)) {
 			common->Error("idInteraction::UnlinkAndFree: interactionTable wasn't set");
 		}
-
-		renderWorld->interactionTable[index] = NULL;
 	}
 
 	Unlink();
@@ -882,13 +874,14 @@ void idInteraction::CreateInteraction(const idRenderModel *model)
 	bool				interactionGenerated;
 	idBounds			bounds;
 
-	tr.pc.c_createInteractions++;
+	__sync_fetch_and_add(&tr.pc.c_createInteractions, 1);
 
 	bounds = model->Bounds(&entityDef->parms);
 
 	// if it doesn't contact the light frustum, none of the surfaces will
+	// the empty interaction is relinked by LinkActiveInteraction, the lists are shared with other lights
 	if (R_CullLocalBox(bounds, entityDef->modelMatrix, 6, lightDef->frustum)) {
-		MakeEmpty();
+		numSurfaces = 0;
 		return;
 	}
 
@@ -965,8 +958,13 @@ void idInteraction::CreateInteraction(const idRenderModel *model)
 		// if the interaction has shadows and this surface casts a shadow
 		if (HasShadows() && shader->SurfaceCastsShadow() && tri->silEdges != NULL) {
 
+			if (tr.useShadowMaps) {
+				// the surface itself is drawn into the shadow map of the light, so
+				// there is no shadow volume to build, even for the base areas
+				interactionGenerated = true;
+
 			// if the light has an optimized shadow volume, don't create shadows for any models that are part of the base areas
-			if (lightDef->parms.prelightModel == NULL || !model->IsStaticWorldModel() || !r_useOptimizedShadows.GetBool()) {
+			} else if (lightDef->parms.prelightModel == NULL || !model->IsStaticWorldModel() || !r_useOptimizedShadows.GetBool()) {
 
 				// this is the only place during gameplay (outside the utilities) that R_CreateShadowVolume() is called
 				sint->shadowTris = R_CreateShadowVolume(entityDef, tri, lightDef, shadowGen, sint->cullInfo);
@@ -993,7 +991,7 @@ void idInteraction::CreateInteraction(const idRenderModel *model)
 
 	// if none of the surfaces generated anything, don't even bother checking?
 	if (!interactionGenerated) {
-		MakeEmpty();
+		numSurfaces = 0;
 	}
 }
 
@@ -1088,13 +1086,33 @@ instantiate the dynamic model to find out
 ==================
 */
 void idInteraction::AddActiveInteraction(void)
+{
+	idScreenRect	shadowScissor;
+	idRenderModel	*model;
+
+	model = PrepareActiveInteraction(shadowScissor, false);
+
+	if (model == NULL) {
+		return;
+	}
+
+	CreateActiveInteraction(model);
+	LinkActiveInteraction(shadowScissor);
+}
+
+/*
+==================
+idInteraction::PrepareActiveInteraction
+
+Everything that has to happen on the main thread before the light and
+shadow triangles can be created, including the game callbacks of the
+dynamic model.
+==================
+*/
+idRenderModel *idInteraction::PrepareActiveInteraction(idScreenRect &shadowScissor, bool deriveFacePlanes)
 {
 	viewLight_t 	*vLight;
 	viewEntity_t 	*vEntity;
-	idScreenRect	shadowScissor;
-	idScreenRect	lightScissor;
-	idVec3			localLightOrigin;
-	idVec3			localViewOrigin;
 
 	vLight = lightDef->viewLight;
 	vEntity = entityDef->viewEntity;
@@ -1117,7 +1135,7 @@ void idInteraction::AddActiveInteraction(void)
 		// this will also cull the case where the light origin is inside the
 		// view frustum and the entity bounds are outside the view frustum
 		if (CullInteractionByViewFrustum(tr.viewDef->viewFrustum)) {
-			return;
+			return NULL;
 		}
 
 		// calculate the shadow scissor rectangle
@@ -1126,7 +1144,7 @@ void idInteraction::AddActiveInteraction(void)
 
 	// get out before making the dynamic model if the shadow scissor rectangle is empty
 	if (shadowScissor.IsEmpty()) {
-		return;
+		return NULL;
 	}
 
 	// We will need the dynamic surface created to make interactions, even if the
@@ -1135,7 +1153,7 @@ void idInteraction::AddActiveInteraction(void)
 	idRenderModel *model = R_EntityDefDynamicModel(entityDef);
 
 	if (model == NULL || model->NumSurfaces() <= 0) {
-		return;
+		return NULL;
 	}
 
 	// the dynamic model may have changed since we built the surface list
@@ -1145,11 +1163,93 @@ void idInteraction::AddActiveInteraction(void)
 
 	dynamicModelFrameCount = entityDef->dynamicModelFrameCount;
 
+	// the face planes are derived on first use, which would race when several
+	// lights hit the same surface, so derive them up front
+	if (deriveFacePlanes) {
+		if (IsDeferred()) {
+			for (int c = 0; c < model->NumSurfaces(); c++) {
+				srfTriangles_t *tri = model->Surface(c)->geometry;
+
+				if (tri != NULL && (!tri->facePlanes || !tri->facePlanesCalculated)) {
+					R_DeriveFacePlanes(tri);
+				}
+			}
+		} else {
+			for (int i = 0; i < numSurfaces; i++) {
+				srfTriangles_t *tri = const_cast<srfTriangles_t *>(surfaces[i].ambientTris);
+
+				if (surfaces[i].lightTris == LIGHT_TRIS_DEFERRED && (!tri->facePlanes || !tri->facePlanesCalculated)) {
+					R_DeriveFacePlanes(tri);
+				}
+			}
+		}
+	}
+
+	return model;
+}
+
+/*
+==================
+idInteraction::CreateActiveInteraction
+
+Builds the light and shadow triangles that are still missing.
+==================
+*/
+void idInteraction::CreateActiveInteraction(const idRenderModel *model)
+{
+	viewLight_t 	*vLight;
+	viewEntity_t 	*vEntity;
+	idScreenRect	lightScissor;
+
+	vLight = lightDef->viewLight;
+	vEntity = entityDef->viewEntity;
+
 	// actually create the interaction if needed, building light and shadow surfaces as needed
 	if (IsDeferred()) {
 		CreateInteraction(model);
 	}
 
+	lightScissor = vLight->scissorRect;
+	lightScissor.Intersect(vEntity->scissorRect);
+
+	if (lightScissor.IsEmpty()) {
+		return;
+	}
+
+	for (int i = 0; i < numSurfaces; i++) {
+		surfaceInteraction_t *sint = &surfaces[i];
+
+		// make sure we have created this interaction, which may have been deferred
+		// on a previous use that only needed the shadow
+		if (sint->lightTris == LIGHT_TRIS_DEFERRED && sint->ambientTris->ambientViewCount == tr.viewCount) {
+			sint->lightTris = R_CreateLightTris(vEntity->entityDef, sint->ambientTris, vLight->lightDef, sint->shader, sint->cullInfo);
+			R_FreeInteractionCullInfo(sint->cullInfo);
+		}
+	}
+}
+
+/*
+==================
+idInteraction::LinkActiveInteraction
+==================
+*/
+void idInteraction::LinkActiveInteraction(const idScreenRect &shadowScissor)
+{
+	viewLight_t 	*vLight;
+	viewEntity_t 	*vEntity;
+	idScreenRect	lightScissor;
+	idVec3			localLightOrigin;
+	idVec3			localViewOrigin;
+
+	// CreateInteraction only marks the interaction empty, relink it here
+	if (IsEmpty()) {
+		MakeEmpty();
+		return;
+	}
+
+	vLight = lightDef->viewLight;
+	vEntity = entityDef->viewEntity;
+
 	R_GlobalPointToLocal(vEntity->modelMatrix, lightDef->globalLightOrigin, localLightOrigin);
 	R_GlobalPointToLocal(vEntity->modelMatrix, tr.viewDef->renderView.vieworg, localViewOrigin);
 
@@ -1166,17 +1266,10 @@ void idInteraction::AddActiveInteraction(void)
 
 		// see if the base surface is visible, we may still need to add shadows even if empty
 		if (!lightScissorsEmpty && sint->ambientTris && sint->ambientTris->ambientViewCount == tr.viewCount) {
-
-			// make sure we have created this interaction, which may have been deferred
-			// on a previous use that only needed the shadow
-			if (sint->lightTris == LIGHT_TRIS_DEFERRED) {
-				sint->lightTris = R_CreateLightTris(vEntity->entityDef, sint->ambientTris, vLight->lightDef, sint->shader, sint->cullInfo);
-				R_FreeInteractionCullInfo(sint->cullInfo);
-			}
-
 			srfTriangles_t *lightTris = sint->lightTris;
 
-			if (lightTris) {
+			// CreateActiveInteraction has created any deferred light triangles
+			if (lightTris && lightTris != LIGHT_TRIS_DEFERRED) {
 
 				// try to cull before adding
 				// FIXME: this may not be worthwhile. We have already done culling on the ambient,
@@ -1225,6 +1318,11 @@ void idInteraction::AddActiveInteraction(void)
 			}
 		}
 
+		if (tr.useShadowMaps) {
+			LinkShadowCaster(sint);
+			continue;
+		}
+
 		srfTriangles_t *shadowTris = sint->shadowTris;
 
 		// the shadows will always have to be added, unless we can tell they
@@ -1300,6 +1398,65 @@ void idInteraction::AddActiveInteraction(void)
 	}
 }
 
+/*
+==================
+idInteraction::LinkShadowCaster
+
+With shadow maps the surface is added to the shadow casters of
+the light instead of a shadow volume.  Casters are not culled to
+the view, they may shadow visible surfaces from anywhere in the light.
+==================
+*/
+void idInteraction::LinkShadowCaster(const surfaceInteraction_t *sint)
+{
+	srfTriangles_t	*tri;
+
+	tri = sint->ambientTris;
+
+	if (!tri || !sint->shader || !HasShadows() || !sint->shader->SurfaceCastsShadow() || !tri->silEdges) {
+		return;
+	}
+
+	// "invisible ink" surfaces don't interact with the light, so they don't shadow it either
+	if (sint->shader->Spectrum() != lightDef->lightShader->Spectrum()) {
+		return;
+	}
+
+	// check for view specific shadow suppression (player shadows, etc)
+	if (!r_skipSuppress.GetBool()) {
+		if (entityDef->parms.suppressShadowInViewID &&
+		    entityDef->parms.suppressShadowInViewID == tr.viewDef->renderView.viewID) {
+			return;
+		}
+
+		if (entityDef->parms.suppressShadowInLightID &&
+		    entityDef->parms.suppressShadowInLightID == lightDef->parms.lightId) {
+			return;
+		}
+	}
+
+	// the caster is drawn from the ambient surface vertexes
+	if (!tri->ambientCache) {
+		if (!R_CreateAmbientCache(tri, sint->shader->ReceivesLighting())) {
+			// skip if we were out of vertex memory
+			return;
+		}
+	}
+
+	// touch the ambient surface so it won't get purged
+	vertexCache.Touch(tri->ambientCache);
+
+	if (!tri->indexCache) {
+		vertexCache.Alloc(tri->indexes, tri->numIndexes * sizeof(tri->indexes[0]), &tri->indexCache, true);
+	}
+
+	if (tri->indexCache) {
+		vertexCache.Touch(tri->indexCache);
+	}
+
+	R_LinkLightSurf(&lightDef->viewLight->shadowCasters, tri, entityDef->viewEntity, lightDef, NULL, lightDef->viewLight->scissorRect, false);
+}
+
 /*
 ===================
 R_ShowInteractionMemory_f
@@ -1368,4 +1525,203 @@ void R_ShowInteractionMemory_f(const idCmdArgs &args)
 	common->Printf("%i deferred interactions, %i empty interactions\n", deferredInteractions, emptyInteractions);
 	common->Printf("%5i indexes %5i verts in %5i light tris\n", lightTriIndexes, lightTriVerts, lightTris);
 	common->Printf("%5i indexes %5i verts in %5i shadow tris\n", shadowTriIndexes, shadowTriVerts, shadowTris);
+
+	if (tr.primaryWorld->interactionTable.IsInitialized()) {
+		common->Printf("%i interactions in the table totalling %ik\n", tr.primaryWorld->interactionTable.Num(),
+		               tr.primaryWorld->interactionTable.MemoryUsed() / 1024);
+	}
+}
+
+/*
+===========================================================================
+
+idInteractionTable
+
+===========================================================================
+*/
+
+/*
+===================
+idInteractionTable::idInteractionTable
+===================
+*/
+idInteractionTable::idInteractionTable(void)
+{
+	entries = NULL;
+	size = 0;
+	numEntries = 0;
+}
+
+/*
+===================
+idInteractionTable::~idInteractionTable
+===================
+*/
+idInteractionTable::~idInteractionTable(void)
+{
+	Shutdown();
+}
+
+/*
+===================
+idInteractionTable::Init
+===================
+*/
+void idInteractionTable::Init(int numInteractions)
+{
+	Shutdown();
+
+	// keep the load factor at or below one half
+	Resize(idMath::CeilPowerOfTwo(Max(numInteractions * 2, 1024)));
+}
+
+/*
+===================
+idInteractionTable::Shutdown
+===================
+*/
+void idInteractionTable::Shutdown(void)
+{
+	if (entries) {
+		R_StaticFree(entries);
+	}
+
+	entries = NULL;
+	size = 0;
+	numEntries = 0;
+}
+
+/*
+===================
+idInteractionTable::Slot
+===================
+*/
+int idInteractionTable::Slot(int lightIndex, int entityIndex) const
+{
+	unsigned int hash;
+
+	hash = (unsigned int)lightIndex * 0x9e3779b1u ^ (unsigned int)entityIndex * 0x85ebca6bu;
+	hash ^= hash >> 16;
+
+	return hash & (size - 1);
+}
+
+/*
+===================
+idInteractionTable::Resize
+===================
+*/
+void idInteractionTable::Resize(int newSize)
+{
+	entry_t		*oldEntries = entries;
+	int			oldSize = size;
+	int			i, j;
+
+	entries = (entry_t *)R_ClearedStaticAlloc(newSize * sizeof(entries[0]));
+	size = newSize;
+
+	for (i = 0; i < oldSize; i++) {
+		if (!oldEntries[i].interaction) {
+			continue;
+		}
+
+		for (j = Slot(oldEntries[i].lightIndex, oldEntries[i].entityIndex); entries[j].interaction; j = (j + 1) & (size - 1)) {
+		}
+
+		entries[j] = oldEntries[i];
+	}
+
+	if (oldEntries) {
+		R_StaticFree(oldEntries);
+	}
+}
+
+/*
+===================
+idInteractionTable::Find
+===================
+*/
+idInteraction *idInteractionTable::Find(int lightIndex, int entityIndex) const
+{
+	int		i;
+
+	for (i = Slot(lightIndex, entityIndex); entries[i].interaction; i = (i + 1) & (size - 1)) {
+		if (entries[i].lightIndex == lightIndex && entries[i].entityIndex == entityIndex) {
+			return entries[i].interaction;
+		}
+	}
+
+	return NULL;
+}
+
+/*
+===================
+idInteractionTable::Add
+===================
+*/
+bool idInteractionTable::Add(idInteraction *interaction)
+{
+	int		lightIndex = interaction->lightDef->index;
+	int		entityIndex = interaction->entityDef->index;
+	int		i;
+
+	if ((numEntries + 1) * 2 > size) {
+		Resize(size * 2);
+	}
+
+	for (i = Slot(lightIndex, entityIndex); entries[i].interaction; i = (i + 1) & (size - 1)) {
+		if (entries[i].lightIndex == lightIndex && entries[i].entityIndex == entityIndex) {
+			return false;
+		}
+	}
+
+	entries[i].lightIndex = lightIndex;
+	entries[i].entityIndex = entityIndex;
+	entries[i].interaction = interaction;
+	numEntries++;
+
+	return true;
+}
+
+/*
+===================
+idInteractionTable::Remove
+
+Shifts the following entries of the probe sequence back into the
+hole, so lookups never need tombstones.
+===================
+*/
+bool idInteractionTable::Remove(const idInteraction *interaction)
+{
+	int		lightIndex = interaction->lightDef->index;
+	int		entityIndex = interaction->entityDef->index;
+	int		i, j, k;
+
+	for (i = Slot(lightIndex, entityIndex); entries[i].interaction; i = (i + 1) & (size - 1)) {
+		if (entries[i].lightIndex == lightIndex && entries[i].entityIndex == entityIndex) {
+			break;
+		}
+	}
+
+	if (entries[i].interaction != interaction) {
+		return false;
+	}
+
+	entries[i].interaction = NULL;
+	numEntries--;
+
+	for (j = (i + 1) & (size - 1); entries[j].interaction; j = (j + 1) & (size - 1)) {
+		k = Slot(entries[j].lightIndex, entries[j].entityIndex);
+
+		// leave the entry if its home slot is cyclically in ( i, j ]
+		if (i <= j ? (i < k && k <= j) : (i < k || k <= j)) {
+			continue;
+		}
+
+		entries[i] = entries[j];
+		entries[j].interaction = NULL;
+		i = j;
+	}
+
+	return true;
 }
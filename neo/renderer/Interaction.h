@@ -151,6 +151,17 @@ class idInteraction
 		// calls R_LinkLightSurf() for each one
 		void					AddActiveInteraction(void);
 
+		// AddActiveInteraction split in three steps so the creation can run in a job
+		// culls the interaction and instantiates the dynamic model, returns NULL if there is nothing to add
+		// face planes of the surfaces still to be created are derived when they will be created in a job
+		idRenderModel *			PrepareActiveInteraction(idScreenRect &shadowScissor, bool deriveFacePlanes);
+
+		// creates the light and shadow surfaces, only touches this interaction so it is safe to run in a job
+		void					CreateActiveInteraction(const idRenderModel *model);
+
+		// adds the vertex caches and links the surfaces to the view light, main thread only
+		void					LinkActiveInteraction(const idScreenRect &shadowScissor);
+
 	private:
 		enum {
 			FRUSTUM_UNINITIALIZED,
@@ -167,6 +178,9 @@ class idInteraction
 		// actually create the interaction
 		void					CreateInteraction(const idRenderModel *model);
 
+		// adds the surface to the shadow casters of the view light when using shadow maps
+		void					LinkShadowCaster(const surfaceInteraction_t *sint);
+
 		// unlink from entity and light lists
 		void					Unlink(void);
 
@@ -179,6 +193,61 @@ class idInteraction
 		idScreenRect			CalcInteractionScissorRectangle(const idFrustum &viewFrustum);
 };
 
+/*
+===============================================================================
+
+	Sparse lightDef / entityDef table of all interactions.
+
+	An open addressed hash with linear probing, grown as needed, so the
+	memory follows the number of interactions instead of the number of
+	lightDefs times the number of entityDefs.
+
+===============================================================================
+*/
+
+class idInteractionTable
+{
+	public:
+		idInteractionTable(void);
+		~idInteractionTable(void);
+
+		void					Init(int numInteractions);
+		void					Shutdown(void);
+		bool					IsInitialized(void) const {
+			return (entries != NULL);
+		}
+
+		idInteraction 			*Find(int lightIndex, int entityIndex) const;
+
+		// returns false if the light and entity already have an interaction
+		bool					Add(idInteraction *interaction);
+
+		// returns false if the interaction is not in the table
+		bool					Remove(const idInteraction *interaction);
+
+		int						Num(void) const {
+			return numEntries;
+		}
+		int						MemoryUsed(void) const {
+			return size * sizeof(entries[0]);
+		}
+
+	private:
+		typedef struct {
+			int					lightIndex;
+			int					entityIndex;
+			idInteraction 		*interaction;		// NULL = free slot
+		} entry_t;
+
+		entry_t 				*entries;
+		int						size;				// always a power of two
+		int						numEntries;
+
+	private:
+		int						Slot(int lightIndex, int entityIndex) const;
+		void					Resize(int newSize);
+};
+
 
 void R_CalcInteractionFacing(const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo);
 void R_CalcInteractionCullBits(const idRenderEntityLocal *ent, const srfTriangles_t *tri, const idRenderLightLocal *light, srfCullInfo_t &cullInfo);
@@ -2505,17 +2505,17 @@ bool idMaterial::Parse(const char *text, const int textLength)
 	*/
 
 	if (numStages) {
-		stages = (shaderStage_t *)R_StaticAlloc(numStages * sizeof(stages[0]));
+		stages = (shaderStage_t *)R_StaticAlloc(numStages * sizeof(stages[0]), TAG_DECL);
 		memcpy(stages, pd->parseStages, numStages * sizeof(stages[0]));
 	}
 
 	if (numOps) {
-		ops = (expOp_t *)R_StaticAlloc(numOps * sizeof(ops[0]));
+		ops = (expOp_t *)R_StaticAlloc(numOps * sizeof(ops[0]), TAG_DECL);
 		memcpy(ops, pd->shaderOps, numOps * sizeof(ops[0]));
 	}
 
 	if (numRegisters) {
-		expressionRegisters = (float *)R_StaticAlloc(numRegisters * sizeof(expressionRegisters[0]));
+		expressionRegisters = (float *)R_StaticAlloc(numRegisters * sizeof(expressionRegisters[0]), TAG_DECL);
 		memcpy(expressionRegisters, pd->shaderRegisters, numRegisters * sizeof(expressionRegisters[0]));
 	}
 
@@ -2843,7 +2843,7 @@ void idMaterial::CheckForConstantRegisters()
 	}
 
 	// evaluate the registers once, and save them
-	constantRegisters = (float *)R_ClearedStaticAlloc(GetNumRegisters() * sizeof(float));
+	constantRegisters = (float *)R_ClearedStaticAlloc(GetNumRegisters() * sizeof(float), TAG_DECL);
 
 	float shaderParms[MAX_ENTITY_SHADER_PARMS];
 	memset(shaderParms, 0, sizeof(shaderParms));
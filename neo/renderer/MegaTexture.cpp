@@ -663,7 +663,7 @@ void	idMegaTexture::GenerateMegaPreview(const char *fileName)
 		}
 	}
 
-	byte *pic = (byte *)R_StaticAlloc(width * height * tileBytes);
+	byte *pic = (byte *)R_StaticAlloc(width * height * tileBytes, TAG_IMAGE);
 	byte	*oldBlock = (byte *)_alloca(tileBytes);
 
 	for (int y = 0 ; y < height ; y++) {
@@ -788,7 +788,7 @@ void idMegaTexture::MakeMegaTexture_f(const idCmdArgs &args)
 
 	// we will process this one row of tiles at a time, since the entire thing
 	// won't fit in memory
-	byte	*targa_rgba = (byte *)R_StaticAlloc(TILE_SIZE * targa_header.width * 4);
+	byte	*targa_rgba = (byte *)R_StaticAlloc(TILE_SIZE * targa_header.width * 4, TAG_IMAGE);
 
 	int blockRowsRemaining = mtHeader.tilesHigh;
 
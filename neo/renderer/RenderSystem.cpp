@@ -72,6 +72,22 @@ static void R_PerformanceCounters(void)
 		}
 	}
 
+	if (r_showPrimitives.GetInteger() > 2) {
+		common->Printf("sorted:%i materialChanges:%i bufferChanges:%i\n",
+		               tr.pc.c_sortedSurfs, tr.pc.c_materialChanges, tr.pc.c_bufferChanges);
+	}
+
+	if (r_showOcclusion.GetInteger() != 0) {
+		common->Printf("occluderTris:%i tests:%i entities:%i lights:%i occluded %.2f msec\n",
+		               tr.pc.c_occluderTris, tr.pc.c_occlusionTests,
+		               tr.pc.c_occludedEntities, tr.pc.c_occludedLights, tr.pc.occlusionMsec);
+	}
+
+	if (r_showShadowMaps.GetBool()) {
+		common->Printf("shadowMaps lights:%i faces:%i texels:%ik\n",
+		               tr.pc.c_shadowMapLights, tr.pc.c_shadowMapFaces, tr.pc.c_shadowMapTexels >> 10);
+	}
+
 	if (r_showDynamic.GetBool()) {
 		common->Printf("callback:%i md5:%i dfrmVerts:%i dfrmTris:%i tangTris:%i guis:%i\n",
 		               tr.pc.c_entityDefCallbacks,
@@ -83,6 +99,11 @@ static void R_PerformanceCounters(void)
 		              );
 	}
 
+	if (r_showGuiCache.GetBool()) {
+		common->Printf("guiWindows cached:%i (verts:%i) rebuilt:%i\n",
+		               tr.pc.c_guiCaptureDraws, tr.pc.c_guiCaptureVerts, tr.pc.c_guiCaptures);
+	}
+
 	if (r_showCull.GetBool()) {
 		common->Printf("%i sin %i sclip  %i sout %i bin %i bout\n",
 		               tr.pc.c_sphere_cull_in, tr.pc.c_sphere_cull_clip, tr.pc.c_sphere_cull_out,
@@ -118,6 +139,21 @@ static void R_PerformanceCounters(void)
 		common->Printf("lightScale: %f\n", backEnd.pc.maxLightValue);
 	}
 
+	if (r_showStateCalls.GetBool()) {
+		common->Printf("uniforms:%i (skipped:%i) binds:%i (skipped:%i) activeTex:%i (skipped:%i)\n",
+		               backEnd.pc.c_uniforms, backEnd.pc.c_uniformsSkipped,
+		               backEnd.pc.c_textureBinds, backEnd.pc.c_textureBindsSkipped,
+		               backEnd.pc.c_activeTextures, backEnd.pc.c_activeTexturesSkipped);
+	}
+
+	if (r_showGLCommands.GetBool()) {
+		const qglCounters_t *glc = QGL_FrameCounters();
+
+		common->Printf("gl:%i draws:%i indexes:%i state:%i uniforms:%i binds:%i buffer:%ik texture:%ik log:%ik\n",
+		               glc->commands, glc->drawCalls, glc->drawIndexes, glc->stateChanges, glc->uniforms,
+		               glc->textureBinds, glc->bufferBytes >> 10, glc->textureBytes >> 10, glc->logBytes >> 10);
+	}
+
 	memset(&tr.pc, 0, sizeof(tr.pc));
 	memset(&backEnd.pc, 0, sizeof(backEnd.pc));
 }
@@ -296,6 +332,16 @@ static void R_CheckCvars(void)
 
 	// check for changes to logging state
 	GLimp_EnableLogging(r_logFile.GetInteger() != 0);
+
+	// count or record the GL command stream
+	QGL_SetRecording(Max(r_glRecord.GetInteger(), r_showGLCommands.GetBool() ? 1 : 0));
+
+	// interactions are built either with shadow volumes or with shadow casters
+	if (tr.useShadowMaps != R_ShadowMapsAvailable()) {
+		tr.useShadowMaps = !tr.useShadowMaps;
+		R_FreeDerivedData();
+		R_ReCreateWorldReferences();
+	}
 }
 
 /*
@@ -377,6 +423,41 @@ void idRenderSystemLocal::DrawStretchTri(idVec2 p1, idVec2 p2, idVec2 p3, idVec2
 	tr.guiModel->DrawStretchTri(p1, p2, p3, t1, t2, t3, material);
 }
 
+/*
+=============
+BeginGuiCapture
+=============
+*/
+void idRenderSystemLocal::BeginGuiCapture(void)
+{
+	guiModel->BeginCapture();
+}
+
+/*
+=============
+EndGuiCapture
+=============
+*/
+bool idRenderSystemLocal::EndGuiCapture(idGuiCapture &capture)
+{
+	tr.pc.c_guiCaptures++;
+
+	return guiModel->EndCapture(capture);
+}
+
+/*
+=============
+DrawGuiCapture
+=============
+*/
+void idRenderSystemLocal::DrawGuiCapture(const idGuiCapture &capture)
+{
+	tr.pc.c_guiCaptureDraws++;
+	tr.pc.c_guiCaptureVerts += capture.verts.Num();
+
+	guiModel->DrawCapture(capture);
+}
+
 /*
 =============
 GlobalToNormalizedDeviceCoordinates
@@ -972,11 +1053,11 @@ void idRenderSystemLocal::CaptureRenderToFile(const char *fileName, bool fixAlph
 
 	// include extra space for OpenGL padding to word boundaries
 	int	c = (rc->width + 3) * rc->height;
-	byte *data = (byte *)R_StaticAlloc(c * 3);
+	byte *data = (byte *)R_StaticAlloc(c * 3, TAG_MISC);
 
 	glReadPixels(rc->x, rc->y, rc->width, rc->height, GL_RGB, GL_UNSIGNED_BYTE, data);
 
-	byte *data2 = (byte *)R_StaticAlloc(c * 4);
+	byte *data2 = (byte *)R_StaticAlloc(c * 4, TAG_MISC);
 
 	for (int i = 0 ; i < c ; i++) {
 		data2[ i * 4 ] = data[ i * 3 ];
@@ -74,6 +74,8 @@ typedef struct glconfig_s {
 	bool				textureNonPowerOfTwoAvailable;
 	bool				depthBoundsTestAvailable;
 	bool				GLSLAvailable;
+	bool				etc1Available;
+	bool				etc2Available;			// also takes ETC1 blocks
 
 	int					vidWidth, vidHeight;	// passed to R_BeginFrame
 
@@ -144,6 +146,25 @@ const int SCREEN_HEIGHT			= 480;
 
 class idRenderWorld;
 
+// 2D drawing captured from the gui model, so a gui window that did not
+// change can add the same geometry again without regenerating it
+typedef struct {
+	const idMaterial	*material;
+	float				color[4];
+	int					numVerts;
+	int					numIndexes;
+} guiCaptureSurface_t;
+
+class idGuiCapture
+{
+	public:
+		idList<guiCaptureSurface_t>	surfaces;
+		idList<idDrawVert>		verts;
+		idList<glIndex_t>		indexes;		// relative to the first vertex of their surface
+		const idMaterial		*material;		// current material and color at the end of the capture
+		float					color[4];
+};
+
 
 class idRenderSystem
 {
@@ -191,6 +212,14 @@ class idRenderSystem
 		virtual void			DrawStretchPic(float x, float y, float w, float h, float s1, float t1, float s2, float t2, const idMaterial *material) = 0;
 
 		virtual void			DrawStretchTri(idVec2 p1, idVec2 p2, idVec2 p3, idVec2 t1, idVec2 t2, idVec2 t3, const idMaterial *material) = 0;
+
+		// the 2D drawing between BeginGuiCapture and EndGuiCapture is copied out, and
+		// DrawGuiCapture adds it again in a later frame.  EndGuiCapture returns false
+		// if the gui model was cleared in between.
+		virtual void			BeginGuiCapture(void) = 0;
+		virtual bool			EndGuiCapture(idGuiCapture &capture) = 0;
+		virtual void			DrawGuiCapture(const idGuiCapture &capture) = 0;
+
 		virtual void			GlobalToNormalizedDeviceCoordinates(const idVec3 &global, idVec3 &ndc) = 0;
 		virtual void			GetGLSettings(int &width, int &height) = 0;
 		virtual void			PrintMemInfo(MemInfo_t *mi) = 0;
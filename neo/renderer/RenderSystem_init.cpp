@@ -38,7 +38,7 @@ glconfig_t	glConfig;
 static void GfxInfo_f(const idCmdArgs &args);
 
 idCVar r_inhibitFragmentProgram("r_inhibitFragmentProgram", "0", CVAR_RENDERER | CVAR_BOOL, "ignore the fragment program extension");
-idCVar r_glDriver("r_glDriver", "", CVAR_RENDERER, "\"opengl32\", etc.");
+idCVar r_glDriver("r_glDriver", "", CVAR_RENDERER, "\"opengl32\", etc., \"null\" discards all GL commands");
 idCVar r_useLightPortalFlow("r_useLightPortalFlow", "1", CVAR_RENDERER | CVAR_BOOL, "use a more precise area reference determination");
 idCVar r_multiSamples("r_multiSamples", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "number of antialiasing samples");
 idCVar r_mode("r_mode", "3", CVAR_ARCHIVE | CVAR_RENDERER | CVAR_INTEGER, "video mode number");
@@ -55,12 +55,14 @@ idCVar r_useSilRemap("r_useSilRemap", "1", CVAR_RENDERER | CVAR_BOOL, "consider
 idCVar r_useNodeCommonChildren("r_useNodeCommonChildren", "1", CVAR_RENDERER | CVAR_BOOL, "stop pushing reference bounds early when possible");
 idCVar r_useShadowProjectedCull("r_useShadowProjectedCull", "1", CVAR_RENDERER | CVAR_BOOL, "discard triangles outside light volume before shadowing");
 idCVar r_useShadowSurfaceScissor("r_useShadowSurfaceScissor", "1", CVAR_RENDERER | CVAR_BOOL, "scissor shadows by the scissor rect of the interaction surfaces");
-idCVar r_useInteractionTable("r_useInteractionTable", "1", CVAR_RENDERER | CVAR_BOOL, "create a full entityDefs * lightDefs table to make finding interactions faster");
+idCVar r_useInteractionTable("r_useInteractionTable", "1", CVAR_RENDERER | CVAR_BOOL, "keep a hash table of the lightDef / entityDef interactions to make finding them faster");
+idCVar r_useParallelInteractions("r_useParallelInteractions", "1", CVAR_RENDERER | CVAR_BOOL, "create the light and shadow surfaces of each visible light in a job, linking them stays serial");
 idCVar r_useTurboShadow("r_useTurboShadow", "1", CVAR_RENDERER | CVAR_BOOL, "use the infinite projection with W technique for dynamic shadows");
 idCVar r_useDeferredTangents("r_useDeferredTangents", "1", CVAR_RENDERER | CVAR_BOOL, "defer tangents calculations after deform");
 idCVar r_useCachedDynamicModels("r_useCachedDynamicModels", "1", CVAR_RENDERER | CVAR_BOOL, "cache snapshots of dynamic models");
 
 idCVar r_useStateCaching("r_useStateCaching", "1", CVAR_RENDERER | CVAR_BOOL, "avoid redundant state changes in GL_*() calls");
+idCVar r_useStateSort("r_useStateSort", "1", CVAR_RENDERER | CVAR_BOOL, "sort opaque surfaces by material, vertex buffer and depth to group state changes");
 idCVar r_useInfiniteFarZ("r_useInfiniteFarZ", "1", CVAR_RENDERER | CVAR_BOOL, "use the no-far-clip-plane trick");
 
 idCVar r_znear("r_znear", "3", CVAR_RENDERER | CVAR_FLOAT, "near Z clip plane distance", 0.001f, 200.0f);
@@ -108,6 +110,8 @@ idCVar r_useLightScissors("r_useLightScissors", "1", CVAR_RENDERER | CVAR_BOOL,
 idCVar r_useClippedLightScissors("r_useClippedLightScissors", "1", CVAR_RENDERER | CVAR_INTEGER, "0 = full screen when near clipped, 1 = exact when near clipped, 2 = exact always", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2>);
 idCVar r_useEntityCulling("r_useEntityCulling", "1", CVAR_RENDERER | CVAR_BOOL, "0 = none, 1 = box");
 idCVar r_useEntityScissors("r_useEntityScissors", "0", CVAR_RENDERER | CVAR_BOOL, "1 = use custom scissor rectangle for each entity");
+idCVar r_useOcclusionCulling("r_useOcclusionCulling", "0", CVAR_RENDERER | CVAR_BOOL, "1 = skip lights and entities hidden by the world in a software depth buffer");
+idCVar r_occlusionMaxTris("r_occlusionMaxTris", "4096", CVAR_RENDERER | CVAR_INTEGER, "maximum number of occluder triangles rasterized per view");
 idCVar r_useInteractionCulling("r_useInteractionCulling", "1", CVAR_RENDERER | CVAR_BOOL, "1 = cull interactions");
 idCVar r_useInteractionScissors("r_useInteractionScissors", "2", CVAR_RENDERER | CVAR_INTEGER, "1 = use a custom scissor rectangle for each shadow interaction, 2 = also crop using portal scissors", -2, 2, idCmdSystem::ArgCompletion_Integer<-2,2>);
 idCVar r_useShadowCulling("r_useShadowCulling", "1", CVAR_RENDERER | CVAR_BOOL, "try to cull shadows from partially visible lights");
@@ -133,6 +137,11 @@ idCVar r_lightSourceRadius("r_lightSourceRadius", "0", CVAR_RENDERER | CVAR_FLOA
 idCVar r_flareSize("r_flareSize", "1", CVAR_RENDERER | CVAR_FLOAT, "scale the flare deforms from the material def");
 
 idCVar r_useExternalShadows("r_useExternalShadows", "1", CVAR_RENDERER | CVAR_INTEGER, "1 = skip drawing caps when outside the light volume, 2 = force to no caps for testing", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2>);
+idCVar r_useShadowMaps("r_useShadowMaps", "0", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_BOOL, "use shadow maps instead of stencil shadow volumes, only on the GLSL back end");
+idCVar r_shadowMapAtlasSize("r_shadowMapAtlasSize", "2048", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "size of the texture holding all shadow maps of a view", 256, 8192);
+idCVar r_shadowMapSize("r_shadowMapSize", "512", CVAR_RENDERER | CVAR_ARCHIVE | CVAR_INTEGER, "size of the largest shadow map face, smaller lights on screen get smaller faces", 32, 4096);
+idCVar r_shadowMapBias("r_shadowMapBias", "1", CVAR_RENDERER | CVAR_FLOAT, "shadow map depth bias in world units");
+idCVar r_shadowMapSlopeBias("r_shadowMapSlopeBias", "1.5", CVAR_RENDERER | CVAR_FLOAT, "shadow map depth bias in texels, scaled by the slope of the surface to the light");
 idCVar r_useOptimizedShadows("r_useOptimizedShadows", "1", CVAR_RENDERER | CVAR_BOOL, "use the dmap generated static shadow volumes");
 idCVar r_useScissor("r_useScissor", "1", CVAR_RENDERER | CVAR_BOOL, "scissor clip as portals and lights are processed");
 idCVar r_useCombinerDisplayLists("r_useCombinerDisplayLists", "1", CVAR_RENDERER | CVAR_BOOL | CVAR_NOCHEAT, "put all nvidia register combiner programming in display lists");
@@ -157,6 +166,7 @@ idCVar r_showVertexColor("r_showVertexColor", "0", CVAR_RENDERER | CVAR_BOOL, "d
 idCVar r_showUpdates("r_showUpdates", "0", CVAR_RENDERER | CVAR_BOOL, "report entity and light updates and ref counts");
 idCVar r_showDemo("r_showDemo", "0", CVAR_RENDERER | CVAR_BOOL, "report reads and writes to the demo file");
 idCVar r_showDynamic("r_showDynamic", "0", CVAR_RENDERER | CVAR_BOOL, "report stats on dynamic surface generation");
+idCVar r_showGuiCache("r_showGuiCache", "0", CVAR_RENDERER | CVAR_BOOL, "report gui windows drawn from their cached geometry");
 idCVar r_showLightScale("r_showLightScale", "0", CVAR_RENDERER | CVAR_BOOL, "report the scale factor applied to drawing for overbrights");
 idCVar r_showDefs("r_showDefs", "0", CVAR_RENDERER | CVAR_BOOL, "report the number of modeDefs and lightDefs in view");
 idCVar r_showTrace("r_showTrace", "0", CVAR_RENDERER | CVAR_INTEGER, "show the intersection of an eye trace with the world", idCmdSystem::ArgCompletion_Integer<0,2>);
@@ -168,6 +178,8 @@ idCVar r_showShadows("r_showShadows", "0", CVAR_RENDERER | CVAR_INTEGER, "1 = vi
 idCVar r_showShadowCount("r_showShadowCount", "0", CVAR_RENDERER | CVAR_INTEGER, "colors screen based on shadow volume depth complexity, >= 2 = print overdraw count based on stencil index values, 3 = only show turboshadows, 4 = only show static shadows", 0, 4, idCmdSystem::ArgCompletion_Integer<0,4>);
 idCVar r_showLightScissors("r_showLightScissors", "0", CVAR_RENDERER | CVAR_BOOL, "show light scissor rectangles");
 idCVar r_showEntityScissors("r_showEntityScissors", "0", CVAR_RENDERER | CVAR_BOOL, "show entity scissor rectangles");
+idCVar r_showShadowMaps("r_showShadowMaps", "0", CVAR_RENDERER | CVAR_BOOL, "report the lights and texels in the shadow map atlas");
+idCVar r_showOcclusion("r_showOcclusion", "0", CVAR_RENDERER | CVAR_INTEGER, "report occlusion culling, 2 = also show culled entity and light bounds, 3 = also show the occluded screen tiles", 0, 3, idCmdSystem::ArgCompletion_Integer<0,3>);
 idCVar r_showInteractionFrustums("r_showInteractionFrustums", "0", CVAR_RENDERER | CVAR_INTEGER, "1 = show a frustum for each interaction, 2 = also draw lines to light origin, 3 = also draw entity bbox", 0, 3, idCmdSystem::ArgCompletion_Integer<0,3>);
 idCVar r_showInteractionScissors("r_showInteractionScissors", "0", CVAR_RENDERER | CVAR_INTEGER, "1 = show screen rectangle which contains the interaction frustum, 2 = also draw construction lines", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2>);
 idCVar r_showLightCount("r_showLightCount", "0", CVAR_RENDERER | CVAR_INTEGER, "1 = colors surfaces based on light count, 2 = also count everything through walls, 3 = also print overdraw", 0, 3, idCmdSystem::ArgCompletion_Integer<0,3>);
@@ -180,7 +192,10 @@ idCVar r_showCull("r_showCull", "0", CVAR_RENDERER | CVAR_BOOL, "report sphere a
 idCVar r_showInteractions("r_showInteractions", "0", CVAR_RENDERER | CVAR_BOOL, "report interaction generation activity");
 idCVar r_showDepth("r_showDepth", "0", CVAR_RENDERER | CVAR_BOOL, "display the contents of the depth buffer and the depth range");
 idCVar r_showSurfaces("r_showSurfaces", "0", CVAR_RENDERER | CVAR_BOOL, "report surface/light/shadow counts");
-idCVar r_showPrimitives("r_showPrimitives", "0", CVAR_RENDERER | CVAR_INTEGER, "report drawsurf/index/vertex counts");
+idCVar r_showPrimitives("r_showPrimitives", "0", CVAR_RENDERER | CVAR_INTEGER, "report drawsurf/index/vertex counts, 2 = more detail, 3 = also report sorted surface state changes");
+idCVar r_glRecord("r_glRecord", "0", CVAR_RENDERER | CVAR_INTEGER, "0 = call the GL driver directly, 1 = count GL commands, 2 = also record the GL command stream", 0, 2, idCmdSystem::ArgCompletion_Integer<0,2>);
+idCVar r_showGLCommands("r_showGLCommands", "0", CVAR_RENDERER | CVAR_BOOL, "report the GL commands issued each frame");
+idCVar r_showStateCalls("r_showStateCalls", "0", CVAR_RENDERER | CVAR_BOOL, "report glUniform/glBindTexture/glActiveTexture calls issued and skipped");
 idCVar r_showEdges("r_showEdges", "0", CVAR_RENDERER | CVAR_BOOL, "draw the sil edges");
 idCVar r_showTexturePolarity("r_showTexturePolarity", "0", CVAR_RENDERER | CVAR_BOOL, "shade triangles by texture area polarity");
 idCVar r_showTangentSpace("r_showTangentSpace", "0", CVAR_RENDERER | CVAR_INTEGER, "shade triangles by tangent space, 1 = use 1st tangent vector, 2 = use 2nd tangent vector, 3 = use normal vector", 0, 3, idCmdSystem::ArgCompletion_Integer<0,3>);
@@ -303,6 +318,15 @@ static void R_CheckPortableExtensions(void)
 		glConfig.textureCompressionAvailable = false;
 	}
 
+#if defined(GL_ES_VERSION_2_0)
+	// GL_OES_compressed_ETC1_RGB8_texture, ETC2 and EAC are core in OpenGL ES 3.0
+	glConfig.etc1Available = R_CheckExtension("GL_OES_compressed_ETC1_RGB8_texture");
+	glConfig.etc2Available = (idStr::Icmpn(glConfig.version_string, "OpenGL ES 3", 11) == 0);
+#else
+	glConfig.etc1Available = false;
+	glConfig.etc2Available = false;
+#endif
+
 #if !defined(GL_ES_VERSION_2_0)
 	// GL_EXT_texture_filter_anisotropic
 	glConfig.anisotropicAvailable = R_CheckExtension("GL_EXT_texture_filter_anisotropic");
@@ -460,6 +484,8 @@ void R_InitOpenGL(void)
 	tr.viewportOffset[0] = 0;
 	tr.viewportOffset[1] = 0;
 
+	QGL_Init(idStr::Icmp(r_glDriver.GetString(), "null") == 0);
+
 	//
 	// initialize OS specific portions of the renderSystem
 	//
@@ -474,7 +500,8 @@ void R_InitOpenGL(void)
 		parms.multiSamples = r_multiSamples.GetInteger();
 		parms.stereo = false;
 
-		if (GLimp_Init(parms)) {
+		// the null driver has no window or context to create
+		if (QGL_NullDriver() || GLimp_Init(parms)) {
 			// it worked
 			break;
 		}
@@ -491,8 +518,16 @@ void R_InitOpenGL(void)
 		r_multiSamples.SetInteger(0);
 	}
 
-	// input and sound systems need to be tied to the new window
-	Sys_InitInput();
+	if (QGL_NullDriver()) {
+		glConfig.colorBits = 24;
+		glConfig.depthBits = 24;
+		glConfig.stencilBits = 8;
+		glConfig.isFullscreen = false;
+	} else {
+		// input and sound systems need to be tied to the new window
+		Sys_InitInput();
+	}
+
 	soundSystem->InitHW();
 
 	// get our config strings
@@ -1005,7 +1040,7 @@ If ref isn't specified, the full session UpdateScreen will be done.
 void R_ReadTiledPixels(int width, int height, byte *buffer, renderView_t *ref = NULL)
 {
 	// include extra space for OpenGL padding to word boundaries
-	byte	*temp = (byte *)R_StaticAlloc((glConfig.vidWidth+3) * glConfig.vidHeight * 3);
+	byte	*temp = (byte *)R_StaticAlloc((glConfig.vidWidth+3) * glConfig.vidHeight * 3, TAG_MISC);
 
 	int	oldWidth = glConfig.vidWidth;
 	int oldHeight = glConfig.vidHeight;
@@ -1089,13 +1124,13 @@ void idRenderSystemLocal::TakeScreenshot(int width, int height, const char *file
 
 	int	pix = width * height;
 
-	buffer = (byte *)R_StaticAlloc(pix*3 + 18);
+	buffer = (byte *)R_StaticAlloc(pix*3 + 18, TAG_MISC);
 	memset(buffer, 0, 18);
 
 	if (blends <= 1) {
 		R_ReadTiledPixels(width, height, buffer + 18, ref);
 	} else {
-		unsigned short *shortBuffer = (unsigned short *)R_StaticAlloc(pix*2*3);
+		unsigned short *shortBuffer = (unsigned short *)R_StaticAlloc(pix*2*3, TAG_MISC);
 		memset(shortBuffer, 0, pix*2*3);
 
 		// enable anti-aliasing jitter
@@ -1922,6 +1957,8 @@ void R_InitCommands(void)
 	cmdSystem->AddCommand("sizeDown", R_SizeDown_f, CMD_FL_RENDERER, "makes the rendered view smaller");
 	cmdSystem->AddCommand("reloadGuis", R_ReloadGuis_f, CMD_FL_RENDERER, "reloads guis");
 	cmdSystem->AddCommand("listGuis", R_ListGuis_f, CMD_FL_RENDERER, "lists guis");
+	cmdSystem->AddCommand("compileGuis", R_CompileGuis_f, CMD_FL_RENDERER, "compiles a gui, or all guis, to the form loaded when gui_compiled is set");
+	cmdSystem->AddCommand("guiTextBenchmark", R_GuiTextBenchmark_f, CMD_FL_RENDERER, "times drawing a screen full of gui text");
 	cmdSystem->AddCommand("touchGui", R_TouchGui_f, CMD_FL_RENDERER, "touches a gui");
 	cmdSystem->AddCommand("screenshot", R_ScreenShot_f, CMD_FL_RENDERER, "takes a screenshot");
 	cmdSystem->AddCommand("envshot", R_EnvShot_f, CMD_FL_RENDERER, "takes an environment shot");
@@ -1941,6 +1978,8 @@ void R_InitCommands(void)
 	cmdSystem->AddCommand("listRenderLightDefs", R_ListRenderLightDefs_f, CMD_FL_RENDERER, "lists the light defs");
 	cmdSystem->AddCommand("listModes", R_ListModes_f, CMD_FL_RENDERER, "lists all video modes");
 	cmdSystem->AddCommand("reloadSurface", R_ReloadSurface_f, CMD_FL_RENDERER, "reloads the decl and images for selected surface");
+	cmdSystem->AddCommand("recordGLStream", R_RecordGLStream_f, CMD_FL_RENDERER, "records the GL command stream to a file");
+	cmdSystem->AddCommand("stopGLStream", R_StopGLStream_f, CMD_FL_RENDERER, "stops recording the GL command stream");
 }
 
 /*
@@ -1961,8 +2000,8 @@ void idRenderSystemLocal::Clear(void)
 	tiledViewport[1] = 0;
 	backEndRenderer = BE_BAD;
 	backEndRendererMaxLight = 1.0f;
+	useShadowMaps = false;
 	ambientLightVector.Zero();
-	sortOffset = 0;
 	worlds.Clear();
 	primaryWorld = NULL;
 	memset(&primaryRenderView, 0, sizeof(primaryRenderView));
@@ -2068,6 +2107,9 @@ void idRenderSystemLocal::Shutdown(void)
 		logFile = 0;
 	}
 
+	// close the GL command stream
+	QGL_Shutdown();
+
 	// free frame memory
 	R_ShutdownFrameData();
 
@@ -153,10 +153,6 @@ idRenderWorldLocal::idRenderWorldLocal()
 
 	doublePortals = NULL;
 	numInterAreaPortals = 0;
-
-	interactionTable = 0;
-	interactionTableWidth = 0;
-	interactionTableHeight = 0;
 }
 
 /*
@@ -175,20 +171,6 @@ idRenderWorldLocal::~idRenderWorldLocal()
 	RB_ClearDebugText(0);
 }
 
-/*
-===================
-ResizeInteractionTable
-===================
-*/
-void idRenderWorldLocal::ResizeInteractionTable()
-{
-	// we overflowed the interaction table, so dump it
-	// we may want to resize this in the future if it turns out to be common
-	common->Printf("idRenderWorldLocal::ResizeInteractionTable: overflowed interactionTableWidth, dumping\n");
-	R_StaticFree(interactionTable);
-	interactionTable = NULL;
-}
-
 /*
 ===================
 AddEntityDef
@@ -201,10 +183,6 @@ qhandle_t idRenderWorldLocal::AddEntityDef(const renderEntity_t *re)
 
 	if (entityHandle == -1) {
 		entityHandle = entityDefs.Append(NULL);
-
-		if (interactionTable && entityDefs.Num() > interactionTableWidth) {
-			ResizeInteractionTable();
-		}
 	}
 
 	UpdateEntityDef(entityHandle, re);
@@ -390,10 +368,6 @@ qhandle_t idRenderWorldLocal::AddLightDef(const renderLight_t *rlight)
 
 	if (lightHandle == -1) {
 		lightHandle = lightDefs.Append(NULL);
-
-		if (interactionTable && lightDefs.Num() > interactionTableHeight) {
-			ResizeInteractionTable();
-		}
 	}
 
 	UpdateLightDef(lightHandle, rlight);
@@ -1593,11 +1567,6 @@ void idRenderWorldLocal::GenerateAllInteractions()
 
 	// build the interaction table
 	if (r_useInteractionTable.GetBool()) {
-		interactionTableWidth = entityDefs.Num() + 100;
-		interactionTableHeight = lightDefs.Num() + 100;
-		int	size =  interactionTableWidth * interactionTableHeight * sizeof(*interactionTable);
-		interactionTable = (idInteraction **)R_ClearedStaticAlloc(size);
-
 		int	count = 0;
 
 		for (int i = 0 ; i < this->lightDefs.Num() ; i++) {
@@ -1607,18 +1576,26 @@ void idRenderWorldLocal::GenerateAllInteractions()
 				continue;
 			}
 
-			idInteraction	*inter;
+			for (idInteraction *inter = ldef->firstInteraction; inter != NULL; inter = inter->lightNext) {
+				count++;
+			}
+		}
 
-			for (inter = ldef->firstInteraction; inter != NULL; inter = inter->lightNext) {
-				idRenderEntityLocal	*edef = inter->entityDef;
-				int index = ldef->index * interactionTableWidth + edef->index;
+		interactionTable.Init(count);
 
-				interactionTable[ index ] = inter;
-				count++;
+		for (int i = 0 ; i < this->lightDefs.Num() ; i++) {
+			idRenderLightLocal	*ldef = this->lightDefs[i];
+
+			if (!ldef) {
+				continue;
+			}
+
+			for (idInteraction *inter = ldef->firstInteraction; inter != NULL; inter = inter->lightNext) {
+				interactionTable.Add(inter);
 			}
 		}
 
-		common->Printf("interactionTable size: %d bytes\n", size);
+		common->Printf("interactionTable size: %d bytes\n", interactionTable.MemoryUsed());
 		common->Printf("%d interaction take %zd bytes\n", count, count * sizeof(idInteraction));
 	}
 
@@ -468,10 +468,7 @@ void idRenderWorldLocal::FreeDefs()
 
 	generateAllInteractionsCalled = false;
 
-	if (interactionTable) {
-		R_StaticFree(interactionTable);
-		interactionTable = NULL;
-	}
+	interactionTable.Shutdown();
 
 	// free all lightDefs
 	for (i = 0 ; i < lightDefs.Num() ; i++) {
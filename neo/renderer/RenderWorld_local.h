@@ -160,13 +160,9 @@ class idRenderWorldLocal : public idRenderWorld
 		idBlockAlloc<areaNumRef_t, 1024>	areaNumRefAllocator;
 
 		// all light / entity interactions are referenced here for fast lookup without
-		// having to crawl the doubly linked lists.  EnntityDefs are sequential for better
-		// cache access, because the table is accessed by light in idRenderWorldLocal::CreateLightDefInteractions()
-		// Growing this table is time consuming, so we add a pad value to the number
-		// of entityDefs and lightDefs
-		idInteraction 		**interactionTable;
-		int						interactionTableWidth;		// entityDefs
-		int						interactionTableHeight;		// lightDefs
+		// having to crawl the doubly linked lists.  The table is sparse, so it only
+		// costs memory for the interactions that exist
+		idInteractionTable		interactionTable;
 
 
 		bool					generateAllInteractionsCalled;
@@ -240,8 +236,6 @@ class idRenderWorldLocal : public idRenderWorld
 		//--------------------------
 		// RenderWorld.cpp
 
-		void					ResizeInteractionTable();
-
 		void					AddEntityRefToArea(idRenderEntityLocal *def, portalArea_t *area);
 		void					AddLightRefToArea(idRenderLightLocal *light, portalArea_t *area);
 
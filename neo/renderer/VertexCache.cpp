@@ -32,9 +32,6 @@ If you have questions concerning this license or the applicable additional terms
 #include "tr_local.h"
 
 #if !defined(GL_ES_VERSION_2_0)
-#define glBindBuffer	glBindBufferARB
-#define glBufferData	glBufferDataARB
-
 #define GL_ARRAY_BUFFER	GL_ARRAY_BUFFER_ARB
 #define GL_DYNAMIC_DRAW	GL_DYNAMIC_DRAW_ARB
 #endif
@@ -302,7 +299,7 @@ void idVertexCache::Alloc(void *data, int size, vertCache_t **buffer, bool index
 			}
 		}
 	} else {
-		block->virtMem = Mem_Alloc(size);
+		block->virtMem = Mem_Alloc(size, TAG_GEOMETRY);
 		SIMDProcessor->Memcpy(block->virtMem, data, size);
 	}
 }
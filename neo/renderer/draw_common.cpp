@@ -1716,6 +1716,11 @@ void	RB_STD_DrawView(void)
 	drawSurfs = (drawSurf_t **)&backEnd.viewDef->drawSurfs[0];
 	numDrawSurfs = backEnd.viewDef->numDrawSurfs;
 
+	// the shadow maps are rendered to their own framebuffer first
+	if (tr.backEndRenderer == BE_GLSL) {
+		RB_GLSL_RenderShadowMaps();
+	}
+
 	// clear the z buffer, set the projection matrix, etc
 	RB_BeginDrawingView();
 
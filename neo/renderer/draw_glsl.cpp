@@ -35,6 +35,13 @@ shaderProgram_t	interactionShader;
 shaderProgram_t	shadowShader;
 shaderProgram_t	defaultShader;
 shaderProgram_t	depthFillShader;
+shaderProgram_t	interactionShadowMapShader;
+shaderProgram_t	shadowMapDepthShader;
+
+static GLuint	shadowMapFramebuffer;
+static GLuint	shadowMapDepthbuffer;
+static GLuint	shadowMapAttachedTexnum;
+static int		shadowMapAttachedSize;
 
 /*
 =========================================================================================
@@ -51,9 +58,15 @@ GL_SelectTextureNoClient
 */
 static void GL_SelectTextureNoClient(int unit)
 {
+	if (backEnd.glState.currenttmu == unit && r_useStateCaching.GetBool()) {
+		backEnd.pc.c_activeTexturesSkipped++;
+		return;
+	}
+
 	backEnd.glState.currenttmu = unit;
 	glActiveTexture(GL_TEXTURE0 + unit);
 	RB_LogComment("glActiveTexture( %i )\n", unit);
+	backEnd.pc.c_activeTextures++;
 }
 
 /*
@@ -149,23 +162,92 @@ void	RB_GLSL_DrawInteraction(const drawInteraction_t *din)
 }
 
 
+/*
+==================
+RB_GLSL_SetShadowMapUniforms
+
+Moves the face matrix into the tile of the atlas and loads the
+lookup parameters of the light
+==================
+*/
+static void RB_GLSL_SetShadowMapUniforms(const viewLight_t *vLight)
+{
+	const float	*face;
+	float		matrix[16];
+	float		invAtlasSize, tileScale, border;
+	idVec4		rows[4], origin, tiles[3], parms, bias;
+	int			i;
+
+	invAtlasSize = 1.0f / backEnd.viewDef->shadowMapAtlasSize;
+	tileScale = 0.5f * vLight->shadowMapSize * invAtlasSize;
+	border = 1.0f + 2.0f * SHADOWMAP_BORDER / vLight->shadowMapSize;
+
+	// projected and parallel lights look up the single face from the vertex program
+	face = vLight->shadowMapMatrix[0];
+
+	for (i = 0; i < 4; i++) {
+		rows[i].Set(face[i], face[4 + i], face[8 + i], face[12 + i]);
+	}
+
+	rows[0] = rows[0] * tileScale + rows[3] * (tileScale + vLight->shadowMapTiles[0][0] * invAtlasSize);
+	rows[1] = rows[1] * tileScale + rows[3] * (tileScale + vLight->shadowMapTiles[0][1] * invAtlasSize);
+	// the depth plane never uses x and y
+	rows[2] = rows[2] * vLight->shadowMapDepthPlane.z + rows[3] * vLight->shadowMapDepthPlane.w;
+
+	for (i = 0; i < 4; i++) {
+		matrix[i] = rows[i].x;
+		matrix[4 + i] = rows[i].y;
+		matrix[8 + i] = rows[i].z;
+		matrix[12 + i] = rows[i].w;
+	}
+
+	GL_UniformMatrix4fv(offsetof(shaderProgram_t, shadowMatrix), matrix);
+
+	// point lights pick the cube face in the fragment program
+	origin.Set(vLight->globalLightOrigin.x, vLight->globalLightOrigin.y, vLight->globalLightOrigin.z, vLight->numShadowMapFaces);
+	GL_Uniform4fv(offsetof(shaderProgram_t, shadowLightOrigin), origin.ToFloatPtr());
+
+	for (i = 0; i < 3; i++) {
+		if (vLight->numShadowMapFaces == 6) {
+			tiles[i].Set(vLight->shadowMapTiles[i * 2][0], vLight->shadowMapTiles[i * 2][1],
+			             vLight->shadowMapTiles[i * 2 + 1][0], vLight->shadowMapTiles[i * 2 + 1][1]);
+			tiles[i] *= invAtlasSize;
+		} else {
+			tiles[i].Zero();
+		}
+
+		GL_Uniform4fv(offsetof(shaderProgram_t, shadowTiles) + i * sizeof(GLint), tiles[i].ToFloatPtr());
+	}
+
+	parms.Set(tileScale / border, tileScale, invAtlasSize, vLight->shadowMapDepthScale);
+	GL_Uniform4fv(offsetof(shaderProgram_t, shadowParms), parms.ToFloatPtr());
+
+	bias.Set(r_shadowMapBias.GetFloat() * vLight->shadowMapDepthScale, r_shadowMapSlopeBias.GetFloat(),
+	         vLight->shadowMapTexelSize.x, vLight->shadowMapTexelSize.y);
+	GL_Uniform4fv(offsetof(shaderProgram_t, shadowBias), bias.ToFloatPtr());
+}
+
 /*
 =============
-RB_GLSL_CreateDrawInteractions
+RB_GLSL_CreateDrawInteractionsWithProgram
 
 =============
 */
-void RB_GLSL_CreateDrawInteractions(const drawSurf_t *surf)
+static void RB_GLSL_CreateDrawInteractionsWithProgram(const drawSurf_t *surf, shaderProgram_t *program)
 {
+	bool	shadowMap;
+
 	if (!surf) {
 		return;
 	}
 
+	shadowMap = (program == &interactionShadowMapShader);
+
 	// perform setup here that will be constant for all interactions
 	GL_State(GLS_SRCBLEND_ONE | GLS_DSTBLEND_ONE | GLS_DEPTHMASK | backEnd.depthFunc);
 
 	// bind the vertex and fragment shader
-	GL_UseProgram(&interactionShader);
+	GL_UseProgram(program);
 
 	// enable the vertex arrays
 	GL_EnableVertexAttribArray(offsetof(shaderProgram_t, attr_TexCoord));
@@ -179,6 +261,14 @@ void RB_GLSL_CreateDrawInteractions(const drawSurf_t *surf)
 	GL_SelectTextureNoClient(5);
 	globalImages->specularTableImage->Bind();
 
+	// texture 6 is the shadow map atlas
+	if (shadowMap) {
+		GL_SelectTextureNoClient(6);
+		globalImages->shadowMapAtlasImage->Bind();
+
+		RB_GLSL_SetShadowMapUniforms(backEnd.vLight);
+	}
+
 	for (; surf ; surf=surf->nextOnLight) {
 		// perform setup here that will not change over multiple interaction passes
 
@@ -187,6 +277,11 @@ void RB_GLSL_CreateDrawInteractions(const drawSurf_t *surf)
 		myGlMultMatrix(surf->space->modelViewMatrix, backEnd.viewDef->projectionMatrix, mat);
 		GL_UniformMatrix4fv(offsetof(shaderProgram_t, modelViewProjectionMatrix), mat);
 
+		// the shadow map is looked up in global space
+		if (shadowMap) {
+			GL_UniformMatrix4fv(offsetof(shaderProgram_t, modelMatrix), surf->space->modelMatrix);
+		}
+
 		// set the vertex pointers
 		idDrawVert	*ac = (idDrawVert *)vertexCache.Position(surf->geo->ambientCache);
 
@@ -211,6 +306,11 @@ void RB_GLSL_CreateDrawInteractions(const drawSurf_t *surf)
 	GL_DisableVertexAttribArray(offsetof(shaderProgram_t, attr_Color));	// gl_Color
 
 	// disable features
+	if (shadowMap) {
+		GL_SelectTextureNoClient(6);
+		globalImages->BindNull();
+	}
+
 	GL_SelectTextureNoClient(5);
 	globalImages->BindNull();
 
@@ -232,6 +332,17 @@ void RB_GLSL_CreateDrawInteractions(const drawSurf_t *surf)
 	GL_UseProgram(NULL);
 }
 
+/*
+=============
+RB_GLSL_CreateDrawInteractions
+
+=============
+*/
+void RB_GLSL_CreateDrawInteractions(const drawSurf_t *surf)
+{
+	RB_GLSL_CreateDrawInteractionsWithProgram(surf, &interactionShader);
+}
+
 
 /*
 ==================
@@ -270,33 +381,42 @@ void RB_GLSL_DrawInteractions(void)
 
 		lightShader = vLight->lightShader;
 
-		// clear the stencil buffer if needed
-		if (vLight->globalShadows || vLight->localShadows) {
-			backEnd.currentScissor = vLight->scissorRect;
+		if (vLight->numShadowMapFaces) {
+			// the interaction program looks up the shadow map, there
+			// are no shadow volumes to test against the stencil buffer
+			glStencilFunc(GL_ALWAYS, 128, 255);
 
-			if (r_useScissor.GetBool()) {
-				glScissor(backEnd.viewDef->viewport.x1 + backEnd.currentScissor.x1,
-				          backEnd.viewDef->viewport.y1 + backEnd.currentScissor.y1,
-				          backEnd.currentScissor.x2 + 1 - backEnd.currentScissor.x1,
-				          backEnd.currentScissor.y2 + 1 - backEnd.currentScissor.y1);
+			RB_GLSL_CreateDrawInteractionsWithProgram(vLight->localInteractions, &interactionShadowMapShader);
+			RB_GLSL_CreateDrawInteractionsWithProgram(vLight->globalInteractions, &interactionShadowMapShader);
+		} else {
+			// clear the stencil buffer if needed
+			if (vLight->globalShadows || vLight->localShadows) {
+				backEnd.currentScissor = vLight->scissorRect;
+
+				if (r_useScissor.GetBool()) {
+					glScissor(backEnd.viewDef->viewport.x1 + backEnd.currentScissor.x1,
+					          backEnd.viewDef->viewport.y1 + backEnd.currentScissor.y1,
+					          backEnd.currentScissor.x2 + 1 - backEnd.currentScissor.x1,
+					          backEnd.currentScissor.y2 + 1 - backEnd.currentScissor.y1);
+				}
+
+				glClear(GL_STENCIL_BUFFER_BIT);
+			} else {
+				// no shadows, so no need to read or write the stencil buffer
+				// we might in theory want to use GL_ALWAYS instead of disabling
+				// completely, to satisfy the invarience rules
+				glStencilFunc(GL_ALWAYS, 128, 255);
 			}
 
-			glClear(GL_STENCIL_BUFFER_BIT);
-		} else {
-			// no shadows, so no need to read or write the stencil buffer
-			// we might in theory want to use GL_ALWAYS instead of disabling
-			// completely, to satisfy the invarience rules
-			glStencilFunc(GL_ALWAYS, 128, 255);
+			GL_UseProgram(&shadowShader);
+			RB_StencilShadowPass(vLight->globalShadows);
+			RB_GLSL_CreateDrawInteractions(vLight->localInteractions);
+			GL_UseProgram(&shadowShader);
+			RB_StencilShadowPass(vLight->localShadows);
+			RB_GLSL_CreateDrawInteractions(vLight->globalInteractions);
+			GL_UseProgram(NULL);	// if there weren't any globalInteractions, it would have stayed on
 		}
 
-		GL_UseProgram(&shadowShader);
-		RB_StencilShadowPass(vLight->globalShadows);
-		RB_GLSL_CreateDrawInteractions(vLight->localInteractions);
-		GL_UseProgram(&shadowShader);
-		RB_StencilShadowPass(vLight->localShadows);
-		RB_GLSL_CreateDrawInteractions(vLight->globalInteractions);
-		GL_UseProgram(NULL);	// if there weren't any globalInteractions, it would have stayed on
-
 		// translucent surfaces never get stencil shadowed
 		if (r_skipTranslucent.GetBool()) {
 			continue;
@@ -319,6 +439,138 @@ void RB_GLSL_DrawInteractions(void)
 	*/
 }
 
+/*
+==================
+RB_GLSL_BindShadowMapFramebuffer
+
+Attaches the atlas image, which may have been purged and regenerated
+at its default size, and a depth buffer of the same size
+==================
+*/
+static bool RB_GLSL_BindShadowMapFramebuffer(int atlasSize)
+{
+	idImage	*atlas;
+	GLenum	status;
+
+	atlas = globalImages->shadowMapAtlasImage;
+
+	if (!shadowMapFramebuffer) {
+		glGenFramebuffers(1, &shadowMapFramebuffer);
+		glGenRenderbuffers(1, &shadowMapDepthbuffer);
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, shadowMapFramebuffer);
+
+	GL_SelectTexture(0);
+	atlas->Bind();
+
+	if (atlas->uploadWidth != atlasSize || atlas->uploadHeight != atlasSize) {
+		atlas->uploadWidth = atlasSize;
+		atlas->uploadHeight = atlasSize;
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, atlasSize, atlasSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, NULL);
+		shadowMapAttachedTexnum = 0;
+	}
+
+	if (shadowMapAttachedTexnum != atlas->texnum) {
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, atlas->texnum, 0);
+		shadowMapAttachedTexnum = atlas->texnum;
+	}
+
+	if (shadowMapAttachedSize != atlasSize) {
+		glBindRenderbuffer(GL_RENDERBUFFER, shadowMapDepthbuffer);
+		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT16, atlasSize, atlasSize);
+		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, shadowMapDepthbuffer);
+		glBindRenderbuffer(GL_RENDERBUFFER, 0);
+		shadowMapAttachedSize = atlasSize;
+	}
+
+	// the atlas can't be sampled while it is rendered to
+	globalImages->BindNull();
+
+	status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+
+	if (status != GL_FRAMEBUFFER_COMPLETE) {
+		common->Printf("RB_GLSL_BindShadowMapFramebuffer: framebuffer incomplete (0x%x)\n", status);
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		return false;
+	}
+
+	return true;
+}
+
+/*
+==================
+RB_GLSL_RenderShadowMaps
+
+Renders the shadow casters of each light with a shadow map into its
+faces in the atlas, before the view itself is drawn.  Casters are drawn
+two sided, so closed models don't need a consistent winding to the light.
+==================
+*/
+void RB_GLSL_RenderShadowMaps(void)
+{
+	const viewLight_t	*vLight;
+	const drawSurf_t	*surf;
+	float				mat[16];
+	int					i, x, y, size;
+
+	if (!backEnd.viewDef->shadowMapAtlasSize || !shadowMapDepthShader.program) {
+		return;
+	}
+
+	RB_LogComment("---------- RB_GLSL_RenderShadowMaps ----------\n");
+
+	if (!RB_GLSL_BindShadowMapFramebuffer(backEnd.viewDef->shadowMapAtlasSize)) {
+		return;
+	}
+
+	GL_UseProgram(&shadowMapDepthShader);
+	GL_EnableVertexAttribArray(offsetof(shaderProgram_t, attr_Vertex));
+
+	// 2D views leave the depth test disabled
+	glEnable(GL_DEPTH_TEST);
+	GL_State(GLS_DEPTHFUNC_LESS);
+	GL_Cull(CT_TWO_SIDED);
+
+	// the clear is the farthest packed depth
+	glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
+
+	for (vLight = backEnd.viewDef->viewLights; vLight; vLight = vLight->next) {
+		if (!vLight->numShadowMapFaces) {
+			continue;
+		}
+
+		GL_Uniform4fv(offsetof(shaderProgram_t, shadowDepthPlane), vLight->shadowMapDepthPlane.ToFloatPtr());
+
+		size = vLight->shadowMapSize;
+
+		for (i = 0; i < vLight->numShadowMapFaces; i++) {
+			x = vLight->shadowMapTiles[i][0];
+			y = vLight->shadowMapTiles[i][1];
+
+			glViewport(x, y, size, size);
+			glScissor(x, y, size, size);
+			glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+
+			for (surf = vLight->shadowCasters; surf; surf = surf->nextOnLight) {
+				myGlMultMatrix(surf->space->modelMatrix, vLight->shadowMapMatrix[i], mat);
+				GL_UniformMatrix4fv(offsetof(shaderProgram_t, modelViewProjectionMatrix), mat);
+
+				idDrawVert *ac = (idDrawVert *)vertexCache.Position(surf->geo->ambientCache);
+				GL_VertexAttribPointer(offsetof(shaderProgram_t, attr_Vertex), 3, GL_FLOAT, false, sizeof(idDrawVert), ac->xyz.ToFloatPtr());
+
+				RB_DrawElementsWithCounters(surf->geo);
+			}
+		}
+	}
+
+	GL_DisableVertexAttribArray(offsetof(shaderProgram_t, attr_Vertex));
+	GL_UseProgram(NULL);
+
+	// RB_BeginDrawingView sets the viewport and scissor of the view again
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
 //===================================================================================
 
 
@@ -485,6 +737,18 @@ static void RB_GLSL_GetUniformLocations(shaderProgram_t *shader)
 	shader->modelMatrix = glGetUniformLocation(shader->program, "u_modelMatrix");
 	shader->textureMatrix = glGetUniformLocation(shader->program, "u_textureMatrix");
 
+	shader->shadowMatrix = glGetUniformLocation(shader->program, "u_shadowMatrix");
+	shader->shadowLightOrigin = glGetUniformLocation(shader->program, "u_shadowLightOrigin");
+
+	for (i = 0; i < 3; i++) {
+		idStr::snPrintf(buffer, sizeof(buffer), "u_shadowTile%d", i);
+		shader->shadowTiles[i] = glGetUniformLocation(shader->program, buffer);
+	}
+
+	shader->shadowParms = glGetUniformLocation(shader->program, "u_shadowParms");
+	shader->shadowBias = glGetUniformLocation(shader->program, "u_shadowBias");
+	shader->shadowDepthPlane = glGetUniformLocation(shader->program, "u_shadowDepthPlane");
+
 	shader->attr_TexCoord = glGetAttribLocation(shader->program, "attr_TexCoord");
 	shader->attr_Tangent = glGetAttribLocation(shader->program, "attr_Tangent");
 	shader->attr_Bitangent = glGetAttribLocation(shader->program, "attr_Bitangent");
@@ -508,6 +772,42 @@ static void RB_GLSL_GetUniformLocations(shaderProgram_t *shader)
 	GL_UseProgram(NULL);
 }
 
+/*
+=================
+RB_GLSL_InitOptionalShader
+
+Programs for optional features, which are not part of the original
+data.  If a file is missing the program is left unavailable.
+=================
+*/
+static void RB_GLSL_InitOptionalShader(const char *name, shaderProgram_t *shader)
+{
+	memset(shader, 0, sizeof(shaderProgram_t));
+
+	R_LoadGLSLShader(va("%s.vert", name), shader, GL_VERTEX_SHADER);
+	R_LoadGLSLShader(va("%s.frag", name), shader, GL_FRAGMENT_SHADER);
+
+	if (!shader->vertexShader || !shader->fragmentShader) {
+		if (shader->vertexShader) {
+			glDeleteShader(shader->vertexShader);
+		}
+
+		if (shader->fragmentShader) {
+			glDeleteShader(shader->fragmentShader);
+		}
+
+		memset(shader, 0, sizeof(shaderProgram_t));
+		return;
+	}
+
+	if (!R_LinkGLSLShader(shader, true) && !R_ValidateGLSLProgram(shader)) {
+		memset(shader, 0, sizeof(shaderProgram_t));
+		return;
+	}
+
+	RB_GLSL_GetUniformLocations(shader);
+}
+
 static bool RB_GLSL_InitShaders(void)
 {
 	memset(&interactionShader, 0, sizeof(shaderProgram_t));
@@ -555,6 +855,10 @@ static bool RB_GLSL_InitShaders(void)
 		RB_GLSL_GetUniformLocations(&depthFillShader);
 	}
 
+	// load shadow map shaders
+	RB_GLSL_InitOptionalShader("interactionShadowMap", &interactionShadowMapShader);
+	RB_GLSL_InitOptionalShader("shadowMapDepth", &shadowMapDepthShader);
+
 	return true;
 }
 
@@ -582,6 +886,12 @@ void R_GLSL_Init(void)
 {
 	glConfig.allowGLSLPath = false;
 
+	// the shadow map framebuffer belonged to the previous context
+	shadowMapFramebuffer = 0;
+	shadowMapDepthbuffer = 0;
+	shadowMapAttachedTexnum = 0;
+	shadowMapAttachedSize = 0;
+
 	common->Printf("---------- R_GLSL_Init ----------\n");
 
 	if (!glConfig.GLSLAvailable) {
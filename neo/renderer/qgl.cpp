@@ -0,0 +1,1605 @@
+
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+// the wrappers below call the driver entry points, not the qgl pointers
+#define QGL_NO_REDIRECT
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+#include "tr_local.h"
+
+/*
+=============================================================================================
+
+QGL COMMAND RECORDER
+
+The renderer calls the GL ES 2.0 core through the qgl function pointers, which normally
+point straight at the driver.  When the command stream is counted or recorded they point
+at the wrappers in this file instead, which count each command by category, optionally
+append it to an in-memory log, and then call the driver.  With r_glDriver "null" there
+is no driver at all: the wrappers discard every command and answer the few queries the
+renderer makes with plausible values, so the front end and back end can be profiled on
+a machine without a GPU or a display.
+
+Each logged command is a header word holding the command number in the low eight bits
+and the number of argument words that follow in the upper bits.  Arguments are written
+as 32 bit words, and the data behind pointers (uploads, strings, client side indexes) is
+inlined as a byte count followed by the padded bytes.  Client side vertex array pointers
+are written as plain addresses.  recordGLStream appends every frame's log to a file,
+after a header with the command names, for offline replay.
+
+=============================================================================================
+*/
+
+#define QGLPROC(name, rettype, args) QGLCMD_##name,
+typedef enum {
+#include "qgl_procs.h"
+	QGLCMD_EndFrame,
+	QGLCMD_NUM_COMMANDS
+} qglCommand_t;
+#undef QGLPROC
+
+#define QGLPROC(name, rettype, args) #name,
+static const char *qglCommandNames[QGLCMD_NUM_COMMANDS] = {
+#include "qgl_procs.h"
+	"EndFrame"
+};
+#undef QGLPROC
+
+// the driver entry points are used until QGL_Init
+#define QGLPROC(name, rettype, args) rettype (GL_APIENTRY *q##name) args = name;
+#include "qgl_procs.h"
+#undef QGLPROC
+
+const int	QGL_STREAM_ID = ('S' << 24) + ('L' << 16) + ('G' << 8) + 'Q';
+const int	QGL_STREAM_VERSION = 1;
+const int	QGL_MAX_INLINE_BYTES = 32 << 20;	// larger uploads only record their size
+const int	QGL_MIN_LOG_BYTES = 1 << 20;
+
+static bool				qglNullDriver;
+static int				qglRecordMode;
+static GLint			qglElementBuffer;		// client side indexes are inlined
+static GLuint			qglNullNames;			// objects and locations handed out by the null driver
+
+static qglCounters_t	qglCounters;
+static qglCounters_t	qglFrameCounters;
+
+static byte 			*qglLog;
+static int				qglLogUsed;
+static int				qglLogSize;
+static int				qglCommandStart;
+
+static idFile			*qglStreamFile;
+static int				qglStreamFrames;
+
+static const char		*qglNullExtensions = "GL_ARB_multitexture GL_ARB_texture_cube_map GL_ARB_texture_non_power_of_two GL_ARB_vertex_buffer_object GL_ARB_shading_language_100";
+
+/*
+=============================================================================================
+
+COMMAND LOG
+
+=============================================================================================
+*/
+
+/*
+==================
+QGL_Reserve
+==================
+*/
+static byte *QGL_Reserve(int bytes)
+{
+	byte	*newLog;
+	int		newSize;
+
+	if (qglLogUsed + bytes > qglLogSize) {
+		newSize = Max(qglLogSize * 2, Max(qglLogUsed + bytes, QGL_MIN_LOG_BYTES));
+		newLog = (byte *)R_StaticAlloc(newSize, TAG_MISC);
+
+		if (qglLog) {
+			memcpy(newLog, qglLog, qglLogUsed);
+			R_StaticFree(qglLog);
+		}
+
+		qglLog = newLog;
+		qglLogSize = newSize;
+	}
+
+	qglLogUsed += bytes;
+
+	return qglLog + qglLogUsed - bytes;
+}
+
+/*
+==================
+QGL_Begin
+==================
+*/
+static void QGL_Begin(qglCommand_t command)
+{
+	qglCounters.commands++;
+
+	if (qglRecordMode < 2) {
+		return;
+	}
+
+	qglCommandStart = qglLogUsed;
+	*(int *)QGL_Reserve(4) = command;
+}
+
+/*
+==================
+QGL_End
+
+Stores the argument count in the command header
+==================
+*/
+static void QGL_End(void)
+{
+	if (qglRecordMode < 2) {
+		return;
+	}
+
+	*(int *)(qglLog + qglCommandStart) |= ((qglLogUsed - qglCommandStart - 4) >> 2) << 8;
+}
+
+/*
+==================
+QGL_Int
+==================
+*/
+static void QGL_Int(int value)
+{
+	if (qglRecordMode < 2) {
+		return;
+	}
+
+	*(int *)QGL_Reserve(4) = value;
+}
+
+/*
+==================
+QGL_Float
+==================
+*/
+static void QGL_Float(float value)
+{
+	if (qglRecordMode < 2) {
+		return;
+	}
+
+	*(float *)QGL_Reserve(4) = value;
+}
+
+/*
+==================
+QGL_Data
+
+Writes the byte count and the data padded to a whole word.
+Missing or oversized data only records its negated size.
+==================
+*/
+static void QGL_Data(const void *data, int bytes)
+{
+	byte	*dest;
+	int		padded;
+
+	if (qglRecordMode < 2) {
+		return;
+	}
+
+	if (!data || bytes > QGL_MAX_INLINE_BYTES) {
+		QGL_Int(-bytes);
+		return;
+	}
+
+	QGL_Int(bytes);
+
+	padded = (bytes + 3) & ~3;
+	dest = QGL_Reserve(padded);
+	memcpy(dest, data, bytes);
+	memset(dest + bytes, 0, padded - bytes);
+}
+
+/*
+==================
+QGL_String
+==================
+*/
+static void QGL_String(const char *string)
+{
+	QGL_Data(string, string ? strlen(string) + 1 : 0);
+}
+
+/*
+==================
+QGL_Names
+==================
+*/
+static void QGL_Names(GLsizei n, const GLuint *names)
+{
+	QGL_Data(names, n * sizeof(GLuint));
+}
+
+/*
+==================
+QGL_PixelBytes
+
+The size of tightly packed pixels, which never exceeds the size of the
+client data with any row alignment.
+==================
+*/
+static int QGL_PixelBytes(GLsizei width, GLsizei height, GLenum format, GLenum type)
+{
+	int		components;
+	int		bytes;
+
+	switch (format) {
+		case GL_ALPHA:
+		case GL_LUMINANCE:
+		case GL_DEPTH_COMPONENT:
+			components = 1;
+			break;
+		case GL_LUMINANCE_ALPHA:
+			components = 2;
+			break;
+		case GL_RGB:
+			components = 3;
+			break;
+		default:
+			components = 4;
+			break;
+	}
+
+	switch (type) {
+		case GL_UNSIGNED_SHORT_5_6_5:
+		case GL_UNSIGNED_SHORT_4_4_4_4:
+		case GL_UNSIGNED_SHORT_5_5_5_1:
+			bytes = 2;
+			break;
+		case GL_UNSIGNED_SHORT:
+			bytes = components * 2;
+			break;
+		case GL_UNSIGNED_INT:
+		case GL_FLOAT:
+			bytes = components * 4;
+			break;
+		default:
+			bytes = components;
+			break;
+	}
+
+	return width * height * bytes;
+}
+
+/*
+=============================================================================================
+
+NULL DRIVER QUERIES
+
+=============================================================================================
+*/
+
+/*
+==================
+QGL_NullString
+==================
+*/
+static const GLubyte *QGL_NullString(GLenum name)
+{
+	switch (name) {
+		case GL_VENDOR:
+			return (const GLubyte *)"id Software";
+		case GL_RENDERER:
+			return (const GLubyte *)"null";
+		case GL_VERSION:
+			return (const GLubyte *)"2.0 null";
+		case GL_EXTENSIONS:
+			return (const GLubyte *)qglNullExtensions;
+		default:
+			return (const GLubyte *)"";
+	}
+}
+
+/*
+==================
+QGL_NullInteger
+==================
+*/
+static GLint QGL_NullInteger(GLenum pname)
+{
+	switch (pname) {
+		case GL_MAX_TEXTURE_SIZE:
+			return 4096;
+		case GL_MAX_TEXTURE_IMAGE_UNITS:
+			return 16;
+#if !defined(GL_ES_VERSION_2_0)
+		case GL_MAX_TEXTURE_UNITS_ARB:
+		case GL_MAX_TEXTURE_COORDS_ARB:
+			return 8;
+#endif
+		case GL_ELEMENT_ARRAY_BUFFER_BINDING:
+			return qglElementBuffer;
+		default:
+			return 0;
+	}
+}
+
+/*
+=============================================================================================
+
+WRAPPERS
+
+=============================================================================================
+*/
+
+static void GL_APIENTRY rec_glActiveTexture(GLenum texture)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glActiveTexture);
+	QGL_Int(texture);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glActiveTexture(texture);
+	}
+}
+
+static void GL_APIENTRY rec_glAttachShader(GLuint program, GLuint shader)
+{
+	QGL_Begin(QGLCMD_glAttachShader);
+	QGL_Int(program);
+	QGL_Int(shader);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glAttachShader(program, shader);
+	}
+}
+
+static void GL_APIENTRY rec_glBindAttribLocation(GLuint program, GLuint index, const GLchar *name)
+{
+	QGL_Begin(QGLCMD_glBindAttribLocation);
+	QGL_Int(program);
+	QGL_Int(index);
+	QGL_String(name);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glBindAttribLocation(program, index, name);
+	}
+}
+
+static void GL_APIENTRY rec_glBindBuffer(GLenum target, GLuint buffer)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glBindBuffer);
+	QGL_Int(target);
+	QGL_Int(buffer);
+	QGL_End();
+
+	if (target == GL_ELEMENT_ARRAY_BUFFER) {
+		qglElementBuffer = buffer;
+	}
+
+	if (!qglNullDriver) {
+		glBindBuffer(target, buffer);
+	}
+}
+
+static void GL_APIENTRY rec_glBindFramebuffer(GLenum target, GLuint framebuffer)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glBindFramebuffer);
+	QGL_Int(target);
+	QGL_Int(framebuffer);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glBindFramebuffer(target, framebuffer);
+	}
+}
+
+static void GL_APIENTRY rec_glBindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glBindRenderbuffer);
+	QGL_Int(target);
+	QGL_Int(renderbuffer);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glBindRenderbuffer(target, renderbuffer);
+	}
+}
+
+static void GL_APIENTRY rec_glBindTexture(GLenum target, GLuint texture)
+{
+	qglCounters.textureBinds++;
+	QGL_Begin(QGLCMD_glBindTexture);
+	QGL_Int(target);
+	QGL_Int(texture);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glBindTexture(target, texture);
+	}
+}
+
+static void GL_APIENTRY rec_glBlendFunc(GLenum sfactor, GLenum dfactor)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glBlendFunc);
+	QGL_Int(sfactor);
+	QGL_Int(dfactor);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glBlendFunc(sfactor, dfactor);
+	}
+}
+
+static void GL_APIENTRY rec_glBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+	qglCounters.bufferBytes += size;
+	QGL_Begin(QGLCMD_glBufferData);
+	QGL_Int(target);
+	QGL_Data(data, size);
+	QGL_Int(usage);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glBufferData(target, size, data, usage);
+	}
+}
+
+static void GL_APIENTRY rec_glBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+	qglCounters.bufferBytes += size;
+	QGL_Begin(QGLCMD_glBufferSubData);
+	QGL_Int(target);
+	QGL_Int(offset);
+	QGL_Data(data, size);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glBufferSubData(target, offset, size, data);
+	}
+}
+
+static GLenum GL_APIENTRY rec_glCheckFramebufferStatus(GLenum target)
+{
+	QGL_Begin(QGLCMD_glCheckFramebufferStatus);
+	QGL_Int(target);
+	QGL_End();
+
+	if (qglNullDriver) {
+		return GL_FRAMEBUFFER_COMPLETE;
+	}
+
+	return glCheckFramebufferStatus(target);
+}
+
+static void GL_APIENTRY rec_glClear(GLbitfield mask)
+{
+	QGL_Begin(QGLCMD_glClear);
+	QGL_Int(mask);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glClear(mask);
+	}
+}
+
+static void GL_APIENTRY rec_glClearColor(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glClearColor);
+	QGL_Float(red);
+	QGL_Float(green);
+	QGL_Float(blue);
+	QGL_Float(alpha);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glClearColor(red, green, blue, alpha);
+	}
+}
+
+static void GL_APIENTRY rec_glClearDepthf(GLfloat d)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glClearDepthf);
+	QGL_Float(d);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glClearDepthf(d);
+	}
+}
+
+static void GL_APIENTRY rec_glClearStencil(GLint s)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glClearStencil);
+	QGL_Int(s);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glClearStencil(s);
+	}
+}
+
+static void GL_APIENTRY rec_glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glColorMask);
+	QGL_Int(red);
+	QGL_Int(green);
+	QGL_Int(blue);
+	QGL_Int(alpha);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glColorMask(red, green, blue, alpha);
+	}
+}
+
+static void GL_APIENTRY rec_glCompileShader(GLuint shader)
+{
+	QGL_Begin(QGLCMD_glCompileShader);
+	QGL_Int(shader);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glCompileShader(shader);
+	}
+}
+
+static void GL_APIENTRY rec_glCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void *data)
+{
+	qglCounters.textureBytes += imageSize;
+	QGL_Begin(QGLCMD_glCompressedTexImage2D);
+	QGL_Int(target);
+	QGL_Int(level);
+	QGL_Int(internalformat);
+	QGL_Int(width);
+	QGL_Int(height);
+	QGL_Int(border);
+	QGL_Data(data, imageSize);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glCompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data);
+	}
+}
+
+static void GL_APIENTRY rec_glCopyTexImage2D(GLenum target, GLint level, GLenum internalformat, GLint x, GLint y, GLsizei width, GLsizei height, GLint border)
+{
+	QGL_Begin(QGLCMD_glCopyTexImage2D);
+	QGL_Int(target);
+	QGL_Int(level);
+	QGL_Int(internalformat);
+	QGL_Int(x);
+	QGL_Int(y);
+	QGL_Int(width);
+	QGL_Int(height);
+	QGL_Int(border);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glCopyTexImage2D(target, level, internalformat, x, y, width, height, border);
+	}
+}
+
+static void GL_APIENTRY rec_glCopyTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	QGL_Begin(QGLCMD_glCopyTexSubImage2D);
+	QGL_Int(target);
+	QGL_Int(level);
+	QGL_Int(xoffset);
+	QGL_Int(yoffset);
+	QGL_Int(x);
+	QGL_Int(y);
+	QGL_Int(width);
+	QGL_Int(height);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glCopyTexSubImage2D(target, level, xoffset, yoffset, x, y, width, height);
+	}
+}
+
+static GLuint GL_APIENTRY rec_glCreateProgram(void)
+{
+	GLuint	program;
+
+	program = qglNullDriver ? ++qglNullNames : glCreateProgram();
+
+	QGL_Begin(QGLCMD_glCreateProgram);
+	QGL_Int(program);
+	QGL_End();
+
+	return program;
+}
+
+static GLuint GL_APIENTRY rec_glCreateShader(GLenum type)
+{
+	GLuint	shader;
+
+	shader = qglNullDriver ? ++qglNullNames : glCreateShader(type);
+
+	QGL_Begin(QGLCMD_glCreateShader);
+	QGL_Int(type);
+	QGL_Int(shader);
+	QGL_End();
+
+	return shader;
+}
+
+static void GL_APIENTRY rec_glCullFace(GLenum mode)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glCullFace);
+	QGL_Int(mode);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glCullFace(mode);
+	}
+}
+
+static void GL_APIENTRY rec_glDeleteShader(GLuint shader)
+{
+	QGL_Begin(QGLCMD_glDeleteShader);
+	QGL_Int(shader);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glDeleteShader(shader);
+	}
+}
+
+static void GL_APIENTRY rec_glDeleteTextures(GLsizei n, const GLuint *textures)
+{
+	QGL_Begin(QGLCMD_glDeleteTextures);
+	QGL_Names(n, textures);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glDeleteTextures(n, textures);
+	}
+}
+
+static void GL_APIENTRY rec_glDepthFunc(GLenum func)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glDepthFunc);
+	QGL_Int(func);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glDepthFunc(func);
+	}
+}
+
+static void GL_APIENTRY rec_glDepthMask(GLboolean flag)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glDepthMask);
+	QGL_Int(flag);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glDepthMask(flag);
+	}
+}
+
+static void GL_APIENTRY rec_glDepthRangef(GLfloat n, GLfloat f)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glDepthRangef);
+	QGL_Float(n);
+	QGL_Float(f);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glDepthRangef(n, f);
+	}
+}
+
+static void GL_APIENTRY rec_glDisable(GLenum cap)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glDisable);
+	QGL_Int(cap);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glDisable(cap);
+	}
+}
+
+static void GL_APIENTRY rec_glDisableVertexAttribArray(GLuint index)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glDisableVertexAttribArray);
+	QGL_Int(index);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glDisableVertexAttribArray(index);
+	}
+}
+
+static void GL_APIENTRY rec_glDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+{
+	qglCounters.drawCalls++;
+	qglCounters.drawIndexes += count;
+	QGL_Begin(QGLCMD_glDrawElements);
+	QGL_Int(mode);
+	QGL_Int(count);
+	QGL_Int(type);
+
+	if (qglElementBuffer) {
+		QGL_Int((int)(intptr_t)indices);
+	} else {
+		QGL_Data(indices, count * (type == GL_UNSIGNED_INT ? 4 : type == GL_UNSIGNED_SHORT ? 2 : 1));
+	}
+
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glDrawElements(mode, count, type, indices);
+	}
+}
+
+static void GL_APIENTRY rec_glEnable(GLenum cap)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glEnable);
+	QGL_Int(cap);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glEnable(cap);
+	}
+}
+
+static void GL_APIENTRY rec_glEnableVertexAttribArray(GLuint index)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glEnableVertexAttribArray);
+	QGL_Int(index);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glEnableVertexAttribArray(index);
+	}
+}
+
+static void GL_APIENTRY rec_glFinish(void)
+{
+	QGL_Begin(QGLCMD_glFinish);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glFinish();
+	}
+}
+
+static void GL_APIENTRY rec_glFlush(void)
+{
+	QGL_Begin(QGLCMD_glFlush);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glFlush();
+	}
+}
+
+static void GL_APIENTRY rec_glFramebufferRenderbuffer(GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glFramebufferRenderbuffer);
+	QGL_Int(target);
+	QGL_Int(attachment);
+	QGL_Int(renderbuffertarget);
+	QGL_Int(renderbuffer);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glFramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
+	}
+}
+
+static void GL_APIENTRY rec_glFramebufferTexture2D(GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glFramebufferTexture2D);
+	QGL_Int(target);
+	QGL_Int(attachment);
+	QGL_Int(textarget);
+	QGL_Int(texture);
+	QGL_Int(level);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glFramebufferTexture2D(target, attachment, textarget, texture, level);
+	}
+}
+
+/*
+==================
+QGL_GenNames
+
+The null driver hands out names that are never reused
+==================
+*/
+static void QGL_GenNames(GLsizei n, GLuint *names)
+{
+	int		i;
+
+	for (i = 0 ; i < n ; i++) {
+		names[i] = ++qglNullNames;
+	}
+}
+
+static void GL_APIENTRY rec_glGenBuffers(GLsizei n, GLuint *buffers)
+{
+	if (qglNullDriver) {
+		QGL_GenNames(n, buffers);
+	} else {
+		glGenBuffers(n, buffers);
+	}
+
+	QGL_Begin(QGLCMD_glGenBuffers);
+	QGL_Names(n, buffers);
+	QGL_End();
+}
+
+static void GL_APIENTRY rec_glGenFramebuffers(GLsizei n, GLuint *framebuffers)
+{
+	if (qglNullDriver) {
+		QGL_GenNames(n, framebuffers);
+	} else {
+		glGenFramebuffers(n, framebuffers);
+	}
+
+	QGL_Begin(QGLCMD_glGenFramebuffers);
+	QGL_Names(n, framebuffers);
+	QGL_End();
+}
+
+static void GL_APIENTRY rec_glGenRenderbuffers(GLsizei n, GLuint *renderbuffers)
+{
+	if (qglNullDriver) {
+		QGL_GenNames(n, renderbuffers);
+	} else {
+		glGenRenderbuffers(n, renderbuffers);
+	}
+
+	QGL_Begin(QGLCMD_glGenRenderbuffers);
+	QGL_Names(n, renderbuffers);
+	QGL_End();
+}
+
+static void GL_APIENTRY rec_glGenTextures(GLsizei n, GLuint *textures)
+{
+	if (qglNullDriver) {
+		QGL_GenNames(n, textures);
+	} else {
+		glGenTextures(n, textures);
+	}
+
+	QGL_Begin(QGLCMD_glGenTextures);
+	QGL_Names(n, textures);
+	QGL_End();
+}
+
+static GLint GL_APIENTRY rec_glGetAttribLocation(GLuint program, const GLchar *name)
+{
+	GLint	location;
+
+	location = qglNullDriver ? ++qglNullNames : glGetAttribLocation(program, name);
+
+	QGL_Begin(QGLCMD_glGetAttribLocation);
+	QGL_Int(program);
+	QGL_String(name);
+	QGL_Int(location);
+	QGL_End();
+
+	return location;
+}
+
+static GLenum GL_APIENTRY rec_glGetError(void)
+{
+	QGL_Begin(QGLCMD_glGetError);
+	QGL_End();
+
+	if (qglNullDriver) {
+		return GL_NO_ERROR;
+	}
+
+	return glGetError();
+}
+
+static void GL_APIENTRY rec_glGetFloatv(GLenum pname, GLfloat *data)
+{
+	QGL_Begin(QGLCMD_glGetFloatv);
+	QGL_Int(pname);
+	QGL_End();
+
+	if (qglNullDriver) {
+		*data = 0.0f;
+	} else {
+		glGetFloatv(pname, data);
+	}
+}
+
+static void GL_APIENTRY rec_glGetIntegerv(GLenum pname, GLint *data)
+{
+	QGL_Begin(QGLCMD_glGetIntegerv);
+	QGL_Int(pname);
+	QGL_End();
+
+	if (qglNullDriver) {
+		*data = QGL_NullInteger(pname);
+	} else {
+		glGetIntegerv(pname, data);
+	}
+}
+
+static void GL_APIENTRY rec_glGetProgramiv(GLuint program, GLenum pname, GLint *params)
+{
+	QGL_Begin(QGLCMD_glGetProgramiv);
+	QGL_Int(program);
+	QGL_Int(pname);
+	QGL_End();
+
+	if (qglNullDriver) {
+		*params = (pname == GL_LINK_STATUS || pname == GL_VALIDATE_STATUS) ? GL_TRUE : 0;
+	} else {
+		glGetProgramiv(program, pname, params);
+	}
+}
+
+static void GL_APIENTRY rec_glGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog)
+{
+	QGL_Begin(QGLCMD_glGetShaderInfoLog);
+	QGL_Int(shader);
+	QGL_End();
+
+	if (qglNullDriver) {
+		if (length) {
+			*length = 0;
+		}
+
+		if (bufSize > 0) {
+			infoLog[0] = '\0';
+		}
+	} else {
+		glGetShaderInfoLog(shader, bufSize, length, infoLog);
+	}
+}
+
+static const GLubyte *GL_APIENTRY rec_glGetString(GLenum name)
+{
+	QGL_Begin(QGLCMD_glGetString);
+	QGL_Int(name);
+	QGL_End();
+
+	if (qglNullDriver) {
+		return QGL_NullString(name);
+	}
+
+	return glGetString(name);
+}
+
+static GLint GL_APIENTRY rec_glGetUniformLocation(GLuint program, const GLchar *name)
+{
+	GLint	location;
+
+	location = qglNullDriver ? ++qglNullNames : glGetUniformLocation(program, name);
+
+	QGL_Begin(QGLCMD_glGetUniformLocation);
+	QGL_Int(program);
+	QGL_String(name);
+	QGL_Int(location);
+	QGL_End();
+
+	return location;
+}
+
+static void GL_APIENTRY rec_glLineWidth(GLfloat width)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glLineWidth);
+	QGL_Float(width);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glLineWidth(width);
+	}
+}
+
+static void GL_APIENTRY rec_glLinkProgram(GLuint program)
+{
+	QGL_Begin(QGLCMD_glLinkProgram);
+	QGL_Int(program);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glLinkProgram(program);
+	}
+}
+
+static void GL_APIENTRY rec_glPixelStorei(GLenum pname, GLint param)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glPixelStorei);
+	QGL_Int(pname);
+	QGL_Int(param);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glPixelStorei(pname, param);
+	}
+}
+
+static void GL_APIENTRY rec_glPolygonOffset(GLfloat factor, GLfloat units)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glPolygonOffset);
+	QGL_Float(factor);
+	QGL_Float(units);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glPolygonOffset(factor, units);
+	}
+}
+
+static void GL_APIENTRY rec_glReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels)
+{
+	QGL_Begin(QGLCMD_glReadPixels);
+	QGL_Int(x);
+	QGL_Int(y);
+	QGL_Int(width);
+	QGL_Int(height);
+	QGL_Int(format);
+	QGL_Int(type);
+	QGL_End();
+
+	if (qglNullDriver) {
+		memset(pixels, 0, QGL_PixelBytes(width, height, format, type));
+	} else {
+		glReadPixels(x, y, width, height, format, type, pixels);
+	}
+}
+
+static void GL_APIENTRY rec_glRenderbufferStorage(GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
+{
+	QGL_Begin(QGLCMD_glRenderbufferStorage);
+	QGL_Int(target);
+	QGL_Int(internalformat);
+	QGL_Int(width);
+	QGL_Int(height);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glRenderbufferStorage(target, internalformat, width, height);
+	}
+}
+
+static void GL_APIENTRY rec_glScissor(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glScissor);
+	QGL_Int(x);
+	QGL_Int(y);
+	QGL_Int(width);
+	QGL_Int(height);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glScissor(x, y, width, height);
+	}
+}
+
+static void GL_APIENTRY rec_glShaderSource(GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length)
+{
+	int		i;
+
+	QGL_Begin(QGLCMD_glShaderSource);
+	QGL_Int(shader);
+	QGL_Int(count);
+
+	for (i = 0 ; i < count ; i++) {
+		QGL_Data(string[i], (length && length[i] >= 0) ? length[i] : strlen(string[i]));
+	}
+
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glShaderSource(shader, count, string, length);
+	}
+}
+
+static void GL_APIENTRY rec_glStencilFunc(GLenum func, GLint ref, GLuint mask)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glStencilFunc);
+	QGL_Int(func);
+	QGL_Int(ref);
+	QGL_Int(mask);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glStencilFunc(func, ref, mask);
+	}
+}
+
+static void GL_APIENTRY rec_glStencilMask(GLuint mask)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glStencilMask);
+	QGL_Int(mask);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glStencilMask(mask);
+	}
+}
+
+static void GL_APIENTRY rec_glStencilOp(GLenum fail, GLenum zfail, GLenum zpass)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glStencilOp);
+	QGL_Int(fail);
+	QGL_Int(zfail);
+	QGL_Int(zpass);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glStencilOp(fail, zfail, zpass);
+	}
+}
+
+static void GL_APIENTRY rec_glStencilOpSeparate(GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glStencilOpSeparate);
+	QGL_Int(face);
+	QGL_Int(sfail);
+	QGL_Int(dpfail);
+	QGL_Int(dppass);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glStencilOpSeparate(face, sfail, dpfail, dppass);
+	}
+}
+
+static void GL_APIENTRY rec_glTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels)
+{
+	int		bytes;
+
+	bytes = QGL_PixelBytes(width, height, format, type);
+
+	qglCounters.textureBytes += bytes;
+	QGL_Begin(QGLCMD_glTexImage2D);
+	QGL_Int(target);
+	QGL_Int(level);
+	QGL_Int(internalformat);
+	QGL_Int(width);
+	QGL_Int(height);
+	QGL_Int(border);
+	QGL_Int(format);
+	QGL_Int(type);
+	QGL_Data(pixels, bytes);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glTexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
+	}
+}
+
+static void GL_APIENTRY rec_glTexParameterf(GLenum target, GLenum pname, GLfloat param)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glTexParameterf);
+	QGL_Int(target);
+	QGL_Int(pname);
+	QGL_Float(param);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glTexParameterf(target, pname, param);
+	}
+}
+
+static void GL_APIENTRY rec_glTexParameterfv(GLenum target, GLenum pname, const GLfloat *params)
+{
+	// the border color is the only vector parameter set
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glTexParameterfv);
+	QGL_Int(target);
+	QGL_Int(pname);
+	QGL_Data(params, 4 * sizeof(GLfloat));
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glTexParameterfv(target, pname, params);
+	}
+}
+
+static void GL_APIENTRY rec_glTexParameteri(GLenum target, GLenum pname, GLint param)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glTexParameteri);
+	QGL_Int(target);
+	QGL_Int(pname);
+	QGL_Int(param);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glTexParameteri(target, pname, param);
+	}
+}
+
+static void GL_APIENTRY rec_glTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels)
+{
+	int		bytes;
+
+	bytes = QGL_PixelBytes(width, height, format, type);
+
+	qglCounters.textureBytes += bytes;
+	QGL_Begin(QGLCMD_glTexSubImage2D);
+	QGL_Int(target);
+	QGL_Int(level);
+	QGL_Int(xoffset);
+	QGL_Int(yoffset);
+	QGL_Int(width);
+	QGL_Int(height);
+	QGL_Int(format);
+	QGL_Int(type);
+	QGL_Data(pixels, bytes);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glTexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
+	}
+}
+
+static void GL_APIENTRY rec_glUniform1fv(GLint location, GLsizei count, const GLfloat *value)
+{
+	qglCounters.uniforms++;
+	QGL_Begin(QGLCMD_glUniform1fv);
+	QGL_Int(location);
+	QGL_Data(value, count * sizeof(GLfloat));
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glUniform1fv(location, count, value);
+	}
+}
+
+static void GL_APIENTRY rec_glUniform1i(GLint location, GLint v0)
+{
+	qglCounters.uniforms++;
+	QGL_Begin(QGLCMD_glUniform1i);
+	QGL_Int(location);
+	QGL_Int(v0);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glUniform1i(location, v0);
+	}
+}
+
+static void GL_APIENTRY rec_glUniform4fv(GLint location, GLsizei count, const GLfloat *value)
+{
+	qglCounters.uniforms++;
+	QGL_Begin(QGLCMD_glUniform4fv);
+	QGL_Int(location);
+	QGL_Data(value, count * 4 * sizeof(GLfloat));
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glUniform4fv(location, count, value);
+	}
+}
+
+static void GL_APIENTRY rec_glUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+{
+	qglCounters.uniforms++;
+	QGL_Begin(QGLCMD_glUniformMatrix4fv);
+	QGL_Int(location);
+	QGL_Int(transpose);
+	QGL_Data(value, count * 16 * sizeof(GLfloat));
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glUniformMatrix4fv(location, count, transpose, value);
+	}
+}
+
+static void GL_APIENTRY rec_glUseProgram(GLuint program)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glUseProgram);
+	QGL_Int(program);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glUseProgram(program);
+	}
+}
+
+static void GL_APIENTRY rec_glValidateProgram(GLuint program)
+{
+	QGL_Begin(QGLCMD_glValidateProgram);
+	QGL_Int(program);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glValidateProgram(program);
+	}
+}
+
+static void GL_APIENTRY rec_glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glVertexAttribPointer);
+	QGL_Int(index);
+	QGL_Int(size);
+	QGL_Int(type);
+	QGL_Int(normalized);
+	QGL_Int(stride);
+	QGL_Int((int)(intptr_t)pointer);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glVertexAttribPointer(index, size, type, normalized, stride, pointer);
+	}
+}
+
+static void GL_APIENTRY rec_glViewport(GLint x, GLint y, GLsizei width, GLsizei height)
+{
+	qglCounters.stateChanges++;
+	QGL_Begin(QGLCMD_glViewport);
+	QGL_Int(x);
+	QGL_Int(y);
+	QGL_Int(width);
+	QGL_Int(height);
+	QGL_End();
+
+	if (!qglNullDriver) {
+		glViewport(x, y, width, height);
+	}
+}
+
+/*
+=============================================================================================
+
+INTERFACE
+
+=============================================================================================
+*/
+
+/*
+==================
+QGL_InstallPointers
+==================
+*/
+static void QGL_InstallPointers(void)
+{
+	if (qglNullDriver || qglRecordMode > 0) {
+#define QGLPROC(name, rettype, args) q##name = rec_##name;
+#include "qgl_procs.h"
+#undef QGLPROC
+	} else {
+#define QGLPROC(name, rettype, args) q##name = name;
+#include "qgl_procs.h"
+#undef QGLPROC
+	}
+}
+
+/*
+==================
+QGL_Init
+==================
+*/
+void QGL_Init(bool nullDriver)
+{
+	qglNullDriver = nullDriver;
+	qglElementBuffer = 0;
+
+	if (qglNullDriver) {
+		common->Printf("...using the null GL driver\n");
+	}
+
+	QGL_InstallPointers();
+}
+
+/*
+==================
+QGL_Shutdown
+==================
+*/
+void QGL_Shutdown(void)
+{
+	R_StopGLStream_f(idCmdArgs());
+
+	if (qglLog) {
+		R_StaticFree(qglLog);
+	}
+
+	qglLog = NULL;
+	qglLogUsed = 0;
+	qglLogSize = 0;
+}
+
+/*
+==================
+QGL_NullDriver
+==================
+*/
+bool QGL_NullDriver(void)
+{
+	return qglNullDriver;
+}
+
+/*
+==================
+QGL_SetRecording
+==================
+*/
+void QGL_SetRecording(int mode)
+{
+	if (qglStreamFile) {
+		mode = 2;
+	}
+
+	mode = idMath::ClampInt(0, 2, mode);
+
+	if (mode == qglRecordMode) {
+		return;
+	}
+
+	// the wrappers start out with the driver's index buffer binding
+	if (qglRecordMode == 0 && !qglNullDriver && glConfig.isInitialized) {
+		glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &qglElementBuffer);
+	}
+
+	qglRecordMode = mode;
+	qglLogUsed = 0;
+
+	QGL_InstallPointers();
+}
+
+/*
+==================
+QGL_EndFrame
+==================
+*/
+void QGL_EndFrame(void)
+{
+	// not counted as a command
+	if (qglRecordMode == 2) {
+		*(int *)QGL_Reserve(4) = QGLCMD_EndFrame | (1 << 8);
+		QGL_Int(qglStreamFrames);
+	}
+
+	qglCounters.logBytes = qglLogUsed;
+
+	if (qglStreamFile) {
+		qglStreamFile->Write(qglLog, qglLogUsed);
+		qglStreamFrames++;
+	}
+
+	qglFrameCounters = qglCounters;
+	memset(&qglCounters, 0, sizeof(qglCounters));
+	qglLogUsed = 0;
+}
+
+/*
+==================
+QGL_FrameCounters
+==================
+*/
+const qglCounters_t *QGL_FrameCounters(void)
+{
+	return &qglFrameCounters;
+}
+
+/*
+==================
+R_RecordGLStream_f
+
+recordGLStream <filename>
+==================
+*/
+void R_RecordGLStream_f(const idCmdArgs &args)
+{
+	idStr	fileName;
+	int		i;
+
+	if (args.Argc() != 2) {
+		common->Printf("USAGE: recordGLStream <filename>\n");
+		return;
+	}
+
+	R_StopGLStream_f(args);
+
+	fileName = args.Argv(1);
+	fileName.DefaultFileExtension(".glstream");
+
+	qglStreamFile = fileSystem->OpenFileWrite(fileName);
+
+	if (!qglStreamFile) {
+		common->Warning("couldn't open %s", fileName.c_str());
+		return;
+	}
+
+	qglStreamFile->WriteInt(QGL_STREAM_ID);
+	qglStreamFile->WriteInt(QGL_STREAM_VERSION);
+	qglStreamFile->WriteInt(QGLCMD_NUM_COMMANDS);
+
+	for (i = 0 ; i < QGLCMD_NUM_COMMANDS ; i++) {
+		qglStreamFile->WriteString(qglCommandNames[i]);
+	}
+
+	qglStreamFrames = 0;
+
+	// the partial frame in the log would not start at a frame boundary
+	QGL_SetRecording(2);
+	qglLogUsed = 0;
+
+	common->Printf("recording the GL command stream to %s\n", fileName.c_str());
+}
+
+/*
+==================
+R_StopGLStream_f
+==================
+*/
+void R_StopGLStream_f(const idCmdArgs &args)
+{
+	if (!qglStreamFile) {
+		return;
+	}
+
+	fileSystem->CloseFile(qglStreamFile);
+	qglStreamFile = NULL;
+
+	common->Printf("recorded %i frames of GL commands\n", qglStreamFrames);
+}
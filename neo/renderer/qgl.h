@@ -77,4 +77,88 @@ extern void (GL_APIENTRY *qglGetCompressedTexImageARB)(GLenum target, GLint leve
 extern void (GL_APIENTRY *qglDepthBoundsEXT)(GLclampd zmin, GLclampd zmax);
 #endif
 
+// GL ES 2.0 core, called through these pointers so the recorder in qgl.cpp
+// can count, record or discard the command stream
+#define QGLPROC(name, rettype, args) extern rettype (GL_APIENTRY *q##name) args;
+#include "qgl_procs.h"
+#undef QGLPROC
+
+// qgl.cpp defines QGL_NO_REDIRECT to reach the driver entry points
+#ifndef QGL_NO_REDIRECT
+#define glActiveTexture	qglActiveTexture
+#define glAttachShader	qglAttachShader
+#define glBindAttribLocation	qglBindAttribLocation
+#define glBindBuffer	qglBindBuffer
+#define glBindFramebuffer	qglBindFramebuffer
+#define glBindRenderbuffer	qglBindRenderbuffer
+#define glBindTexture	qglBindTexture
+#define glBlendFunc	qglBlendFunc
+#define glBufferData	qglBufferData
+#define glBufferSubData	qglBufferSubData
+#define glCheckFramebufferStatus	qglCheckFramebufferStatus
+#define glClear	qglClear
+#define glClearColor	qglClearColor
+#define glClearDepthf	qglClearDepthf
+#define glClearStencil	qglClearStencil
+#define glColorMask	qglColorMask
+#define glCompileShader	qglCompileShader
+#define glCompressedTexImage2D	qglCompressedTexImage2D
+#define glCopyTexImage2D	qglCopyTexImage2D
+#define glCopyTexSubImage2D	qglCopyTexSubImage2D
+#define glCreateProgram	qglCreateProgram
+#define glCreateShader	qglCreateShader
+#define glCullFace	qglCullFace
+#define glDeleteShader	qglDeleteShader
+#define glDeleteTextures	qglDeleteTextures
+#define glDepthFunc	qglDepthFunc
+#define glDepthMask	qglDepthMask
+#define glDepthRangef	qglDepthRangef
+#define glDisable	qglDisable
+#define glDisableVertexAttribArray	qglDisableVertexAttribArray
+#define glDrawElements	qglDrawElements
+#define glEnable	qglEnable
+#define glEnableVertexAttribArray	qglEnableVertexAttribArray
+#define glFinish	qglFinish
+#define glFlush	qglFlush
+#define glFramebufferRenderbuffer	qglFramebufferRenderbuffer
+#define glFramebufferTexture2D	qglFramebufferTexture2D
+#define glGenBuffers	qglGenBuffers
+#define glGenFramebuffers	qglGenFramebuffers
+#define glGenRenderbuffers	qglGenRenderbuffers
+#define glGenTextures	qglGenTextures
+#define glGetAttribLocation	qglGetAttribLocation
+#define glGetError	qglGetError
+#define glGetFloatv	qglGetFloatv
+#define glGetIntegerv	qglGetIntegerv
+#define glGetProgramiv	qglGetProgramiv
+#define glGetShaderInfoLog	qglGetShaderInfoLog
+#define glGetString	qglGetString
+#define glGetUniformLocation	qglGetUniformLocation
+#define glLineWidth	qglLineWidth
+#define glLinkProgram	qglLinkProgram
+#define glPixelStorei	qglPixelStorei
+#define glPolygonOffset	qglPolygonOffset
+#define glReadPixels	qglReadPixels
+#define glRenderbufferStorage	qglRenderbufferStorage
+#define glScissor	qglScissor
+#define glShaderSource	qglShaderSource
+#define glStencilFunc	qglStencilFunc
+#define glStencilMask	qglStencilMask
+#define glStencilOp	qglStencilOp
+#define glStencilOpSeparate	qglStencilOpSeparate
+#define glTexImage2D	qglTexImage2D
+#define glTexParameterf	qglTexParameterf
+#define glTexParameterfv	qglTexParameterfv
+#define glTexParameteri	qglTexParameteri
+#define glTexSubImage2D	qglTexSubImage2D
+#define glUniform1fv	qglUniform1fv
+#define glUniform1i	qglUniform1i
+#define glUniform4fv	qglUniform4fv
+#define glUniformMatrix4fv	qglUniformMatrix4fv
+#define glUseProgram	qglUseProgram
+#define glValidateProgram	qglValidateProgram
+#define glVertexAttribPointer	qglVertexAttribPointer
+#define glViewport	qglViewport
+#endif
+
 #endif
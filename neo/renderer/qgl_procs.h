@@ -0,0 +1,110 @@
+
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+/*
+** QGL_PROCS.H
+**
+** The OpenGL ES 2.0 core entry points the renderer calls through the qgl
+** function pointers.  This file is included with QGLPROC(name, return type,
+** parameters) defined and has no include guard.
+*/
+
+QGLPROC(glActiveTexture, void, (GLenum texture))
+QGLPROC(glAttachShader, void, (GLuint program, GLuint shader))
+QGLPROC(glBindAttribLocation, void, (GLuint program, GLuint index, const GLchar *name))
+QGLPROC(glBindBuffer, void, (GLenum target, GLuint buffer))
+QGLPROC(glBindFramebuffer, void, (GLenum target, GLuint framebuffer))
+QGLPROC(glBindRenderbuffer, void, (GLenum target, GLuint renderbuffer))
+QGLPROC(glBindTexture, void, (GLenum target, GLuint texture))
+QGLPROC(glBlendFunc, void, (GLenum sfactor, GLenum dfactor))
+QGLPROC(glBufferData, void, (GLenum target, GLsizeiptr size, const void *data, GLenum usage))
+QGLPROC(glBufferSubData, void, (GLenum target, GLintptr offset, GLsizeiptr size, const void *data))
+QGLPROC(glCheckFramebufferStatus, GLenum, (GLenum target))
+QGLPROC(glClear, void, (GLbitfield mask))
+QGLPROC(glClearColor, void, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha))
+QGLPROC(glClearDepthf, void, (GLfloat d))
+QGLPROC(glClearStencil, void, (GLint s))
+QGLPROC(glColorMask, void, (GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha))
+QGLPROC(glCompileShader, void, (GLuint shader))
+QGLPROC(glCompressedTexImage2D, void, (GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void *data))
+QGLPROC(glCopyTexImage2D, void, (GLenum target, GLint level, GLenum internalformat, GLint x, GLint y, GLsizei width, GLsizei height, GLint border))
+QGLPROC(glCopyTexSubImage2D, void, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint x, GLint y, GLsizei width, GLsizei height))
+QGLPROC(glCreateProgram, GLuint, (void))
+QGLPROC(glCreateShader, GLuint, (GLenum type))
+QGLPROC(glCullFace, void, (GLenum mode))
+QGLPROC(glDeleteShader, void, (GLuint shader))
+QGLPROC(glDeleteTextures, void, (GLsizei n, const GLuint *textures))
+QGLPROC(glDepthFunc, void, (GLenum func))
+QGLPROC(glDepthMask, void, (GLboolean flag))
+QGLPROC(glDepthRangef, void, (GLfloat n, GLfloat f))
+QGLPROC(glDisable, void, (GLenum cap))
+QGLPROC(glDisableVertexAttribArray, void, (GLuint index))
+QGLPROC(glDrawElements, void, (GLenum mode, GLsizei count, GLenum type, const void *indices))
+QGLPROC(glEnable, void, (GLenum cap))
+QGLPROC(glEnableVertexAttribArray, void, (GLuint index))
+QGLPROC(glFinish, void, (void))
+QGLPROC(glFlush, void, (void))
+QGLPROC(glFramebufferRenderbuffer, void, (GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer))
+QGLPROC(glFramebufferTexture2D, void, (GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level))
+QGLPROC(glGenBuffers, void, (GLsizei n, GLuint *buffers))
+QGLPROC(glGenFramebuffers, void, (GLsizei n, GLuint *framebuffers))
+QGLPROC(glGenRenderbuffers, void, (GLsizei n, GLuint *renderbuffers))
+QGLPROC(glGenTextures, void, (GLsizei n, GLuint *textures))
+QGLPROC(glGetAttribLocation, GLint, (GLuint program, const GLchar *name))
+QGLPROC(glGetError, GLenum, (void))
+QGLPROC(glGetFloatv, void, (GLenum pname, GLfloat *data))
+QGLPROC(glGetIntegerv, void, (GLenum pname, GLint *data))
+QGLPROC(glGetProgramiv, void, (GLuint program, GLenum pname, GLint *params))
+QGLPROC(glGetShaderInfoLog, void, (GLuint shader, GLsizei bufSize, GLsizei *length, GLchar *infoLog))
+QGLPROC(glGetString, const GLubyte *, (GLenum name))
+QGLPROC(glGetUniformLocation, GLint, (GLuint program, const GLchar *name))
+QGLPROC(glLineWidth, void, (GLfloat width))
+QGLPROC(glLinkProgram, void, (GLuint program))
+QGLPROC(glPixelStorei, void, (GLenum pname, GLint param))
+QGLPROC(glPolygonOffset, void, (GLfloat factor, GLfloat units))
+QGLPROC(glReadPixels, void, (GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels))
+QGLPROC(glRenderbufferStorage, void, (GLenum target, GLenum internalformat, GLsizei width, GLsizei height))
+QGLPROC(glScissor, void, (GLint x, GLint y, GLsizei width, GLsizei height))
+QGLPROC(glShaderSource, void, (GLuint shader, GLsizei count, const GLchar *const *string, const GLint *length))
+QGLPROC(glStencilFunc, void, (GLenum func, GLint ref, GLuint mask))
+QGLPROC(glStencilMask, void, (GLuint mask))
+QGLPROC(glStencilOp, void, (GLenum fail, GLenum zfail, GLenum zpass))
+QGLPROC(glStencilOpSeparate, void, (GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass))
+QGLPROC(glTexImage2D, void, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void *pixels))
+QGLPROC(glTexParameterf, void, (GLenum target, GLenum pname, GLfloat param))
+QGLPROC(glTexParameterfv, void, (GLenum target, GLenum pname, const GLfloat *params))
+QGLPROC(glTexParameteri, void, (GLenum target, GLenum pname, GLint param))
+QGLPROC(glTexSubImage2D, void, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void *pixels))
+QGLPROC(glUniform1fv, void, (GLint location, GLsizei count, const GLfloat *value))
+QGLPROC(glUniform1i, void, (GLint location, GLint v0))
+QGLPROC(glUniform4fv, void, (GLint location, GLsizei count, const GLfloat *value))
+QGLPROC(glUniformMatrix4fv, void, (GLint location, GLsizei count, GLboolean transpose, const GLfloat *value))
+QGLPROC(glUseProgram, void, (GLuint program))
+QGLPROC(glValidateProgram, void, (GLuint program))
+QGLPROC(glVertexAttribPointer, void, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer))
+QGLPROC(glViewport, void, (GLint x, GLint y, GLsizei width, GLsizei height))
@@ -137,6 +137,7 @@ GL_SelectTexture
 void GL_SelectTexture(int unit)
 {
 	if (backEnd.glState.currenttmu == unit) {
+		backEnd.pc.c_activeTexturesSkipped++;
 		return;
 	}
 
@@ -154,6 +155,7 @@ void GL_SelectTexture(int unit)
 	RB_LogComment("glActiveTextureARB( %i );\nglClientActiveTextureARB( %i );\n", unit, unit);
 
 	backEnd.glState.currenttmu = unit;
+	backEnd.pc.c_activeTextures++;
 }
 
 /*
@@ -173,6 +175,52 @@ void GL_UseProgram(shaderProgram_t *program)
 	GL_CheckErrors();
 }
 
+/*
+====================
+GL_UniformIsCurrent
+
+Returns true if the current program already holds the value in the
+uniform at location, otherwise updates the program's shadow copy so
+the caller can load it.
+====================
+*/
+static bool GL_UniformIsCurrent(GLint location, const GLfloat *value, int numFloats)
+{
+	uniformShadow_t	*shadow;
+	int				slot;
+
+	compile_time_assert(MAX_UNIFORM_SHADOWS == offsetof(shaderProgram_t, u_fragmentMap) / sizeof(GLint));
+
+	// the program doesn't use this uniform
+	if (*(GLint *)((char *)backEnd.glState.currentProgram + location) == -1) {
+		backEnd.pc.c_uniformsSkipped++;
+		return true;
+	}
+
+	slot = location / sizeof(GLint);
+
+	// not a shadowed location, always load it
+	if (slot < 0 || slot >= MAX_UNIFORM_SHADOWS) {
+		assert(0);
+		backEnd.pc.c_uniforms++;
+		return false;
+	}
+
+	shadow = &backEnd.glState.currentProgram->uniformShadows[slot];
+
+	if (r_useStateCaching.GetBool() && shadow->numFloats == numFloats && !memcmp(shadow->value, value, numFloats * sizeof(float))) {
+		backEnd.pc.c_uniformsSkipped++;
+		return true;
+	}
+
+	// always keep the shadow up to date, so it is valid if state caching is turned back on
+	shadow->numFloats = numFloats;
+	memcpy(shadow->value, value, numFloats * sizeof(float));
+
+	backEnd.pc.c_uniforms++;
+	return false;
+}
+
 /*
 ====================
 GL_Uniform1fv
@@ -186,6 +234,10 @@ void GL_Uniform1fv(GLint location, const GLfloat *value)
 		return;
 	}
 
+	if (GL_UniformIsCurrent(location, value, 1)) {
+		return;
+	}
+
 	glUniform1fv(*(GLint *)((char *)backEnd.glState.currentProgram + location), 1, value);
 
 	GL_CheckErrors();
@@ -204,6 +256,10 @@ void GL_Uniform4fv(GLint location, const GLfloat *value)
 		return;
 	}
 
+	if (GL_UniformIsCurrent(location, value, 4)) {
+		return;
+	}
+
 	glUniform4fv(*(GLint *)((char *)backEnd.glState.currentProgram + location), 1, value);
 
 	GL_CheckErrors();
@@ -222,6 +278,10 @@ void GL_UniformMatrix4fv(GLint location, const GLfloat *value)
 		return;
 	}
 
+	if (GL_UniformIsCurrent(location, value, 16)) {
+		return;
+	}
+
 	glUniformMatrix4fv(*(GLint *)((char *)backEnd.glState.currentProgram + location), 1, GL_FALSE, value);
 
 	GL_CheckErrors();
@@ -713,9 +773,11 @@ const void	RB_SwapBuffers(const void *data)
 	RB_LogComment("***************** RB_SwapBuffers *****************\n\n\n");
 
 	// don't flip if drawing to front buffer
-	if (!r_frontBuffer.GetBool()) {
+	if (!r_frontBuffer.GetBool() && !QGL_NullDriver()) {
 		GLimp_SwapBuffers();
 	}
+
+	QGL_EndFrame();
 }
 
 /*
@@ -226,3 +226,32 @@ void R_ListGuis_f(const idCmdArgs &args)
 {
 	uiManager->ListGuis();
 }
+
+/*
+================
+R_CompileGuis_f
+
+Compiles the given gui, or all guis, to the preprocessed
+form that is loaded when gui_compiled is set
+================
+*/
+void R_CompileGuis_f(const idCmdArgs &args)
+{
+	uiManager->CompileGuis(args.Argv(1));
+}
+
+/*
+================
+R_GuiTextBenchmark_f
+================
+*/
+void R_GuiTextBenchmark_f(const idCmdArgs &args)
+{
+	int frames = 100;
+
+	if (args.Argc() > 1) {
+		frames = atoi(args.Argv(1));
+	}
+
+	uiManager->BenchmarkText(frames);
+}
@@ -471,11 +471,10 @@ void idRenderWorldLocal::CreateLightDefInteractions(idRenderLightLocal *ldef)
 
 			// if any of the edef's interaction match this light, we don't
 			// need to consider it.
-			if (r_useInteractionTable.GetBool() && this->interactionTable) {
-				// allocating these tables may take several megs on big maps, but it saves 3% to 5% of
-				// the CPU time.  The table is updated at interaction::AllocAndLink() and interaction::UnlinkAndFree()
-				int index = ldef->index * this->interactionTableWidth + edef->index;
-				inter = this->interactionTable[ index ];
+			if (r_useInteractionTable.GetBool() && this->interactionTable.IsInitialized()) {
+				// the table saves 3% to 5% of the CPU time.  It is updated at
+				// interaction::AllocAndLink() and interaction::UnlinkAndFree()
+				inter = this->interactionTable.Find(ldef->index, edef->index);
 
 				if (inter) {
 					// if this entity wasn't in view already, the scissor rect will be empty,
@@ -543,6 +542,48 @@ void idRenderWorldLocal::CreateLightDefInteractions(idRenderLightLocal *ldef)
 
 //===============================================================================================================
 
+/*
+=================
+R_DrawSurfSortKey
+
+The material sort is in the top 16 bits, so the passes still see the surfaces
+in sort order.  Opaque surfaces on entities don't depend on the draw order, so
+the material, the vertex buffer and the view depth are packed below it to
+group the surfaces that share state, front to back.  Everything else keeps
+zero low bits and is drawn in the order it was added, as the sort is stable.
+=================
+*/
+static uint64_t R_DrawSurfSortKey(const drawSurf_t *drawSurf)
+{
+	const idMaterial		*shader = drawSurf->material;
+	const srfTriangles_t	*tri = drawSurf->geo;
+	const float				*m = drawSurf->space->modelViewMatrix;
+	idVec3					center;
+	uint64_t				key;
+	int						sort, buffer, depth;
+
+	sort = idMath::FtoiFast((shader->GetSort() - SS_SUBVIEW) * 256.0f);
+	key = (uint64_t)idMath::ClampInt(0, 0xffff, sort) << 48;
+
+	// guis on entities don't have an entityDef and depend on their order
+	if (!r_useStateSort.GetBool() || shader->GetSort() != SS_OPAQUE || shader->Coverage() == MC_TRANSLUCENT
+	    || !drawSurf->space->entityDef) {
+		return key;
+	}
+
+	buffer = (tri->ambientCache && tri->ambientCache->vbo) ? tri->ambientCache->vbo : 0;
+
+	// distance along the view direction, in world units
+	center = tri->bounds.GetCenter();
+	depth = idMath::FtoiFast(-(center[0] * m[2] + center[1] * m[6] + center[2] * m[10] + m[14]));
+
+	key |= (uint64_t)(shader->Index() & 0xffff) << 32;
+	key |= (uint64_t)(buffer & 0xfff) << 20;
+	key |= (uint64_t)idMath::ClampInt(0, 0xfffff, depth);
+
+	return key;
+}
+
 /*
 =================
 R_LinkLightSurf
@@ -563,6 +604,7 @@ void R_LinkLightSurf(const drawSurf_t **link, const srfTriangles_t *tri, const v
 	drawSurf->space = space;
 	drawSurf->material = shader;
 	drawSurf->scissorRect = scissor;
+	drawSurf->sortKey = shader ? R_DrawSurfSortKey(drawSurf) : 0;
 	drawSurf->dsFlags = 0;
 
 	if (viewInsideShadow) {
@@ -858,6 +900,13 @@ void R_AddLightSurfaces(void)
 			}
 		}
 
+		// the light volume is completely hidden behind the world
+		if (R_LightIsOccluded(vLight)) {
+			*ptr = vLight->next;
+			light->viewCount = -1;
+			continue;
+		}
+
 		if (r_useLightScissors.GetBool()) {
 			// calculate the screen area covered by the light frustum
 			// which will be used to crop the stencil cull
@@ -913,7 +962,8 @@ void R_AddLightSurfaces(void)
 		}
 
 		// add the prelight shadows for the static world geometry
-		if (light->parms.prelightModel && r_useOptimizedShadows.GetBool()) {
+		// shadow maps draw the world surfaces themselves as casters
+		if (light->parms.prelightModel && r_useOptimizedShadows.GetBool() && !tr.useShadowMaps) {
 
 			if (!light->parms.prelightModel->NumSurfaces()) {
 				common->Error("no surfs in prelight model '%s'", light->parms.prelightModel->Name());
@@ -1104,13 +1154,9 @@ void R_AddDrawSurf(const srfTriangles_t *tri, const viewEntity_t *space, const r
 	drawSurf->space = space;
 	drawSurf->material = shader;
 	drawSurf->scissorRect = scissor;
-	drawSurf->sort = shader->GetSort() + tr.sortOffset;
+	drawSurf->sortKey = R_DrawSurfSortKey(drawSurf);
 	drawSurf->dsFlags = 0;
 
-	// bumping this offset each time causes surfaces with equal sort orders to still
-	// deterministically draw in the order they are added
-	tr.sortOffset += 0.000001f;
-
 	// if it doesn't fit, resize the list
 	if (tr.viewDef->numDrawSurfs == tr.viewDef->maxDrawSurfs) {
 		drawSurf_t	**old = tr.viewDef->drawSurfs;
@@ -1375,6 +1421,125 @@ idScreenRect R_CalcEntityScissorRectangle(viewEntity_t *vEntity)
 	return R_ScreenRectFromViewFrustumBounds(bounds);
 }
 
+/*
+=========================================================================================
+
+PARALLEL INTERACTION CREATION
+
+The interactions are prepared in the serial entity walk, the light and shadow
+surfaces are then created with one job per view light, and finally linked to
+the view lights in the order they were prepared so the result matches the serial path.
+
+=========================================================================================
+*/
+
+typedef struct {
+	idInteraction			*inter;
+	const idRenderModel		*model;
+	idScreenRect			shadowScissor;
+	float					floatTime;		// entity time group when prepared
+	int						time;
+	int						nextInLight;	// next interaction of the same light, -1 ends the chain
+} interactionWork_t;
+
+typedef struct {
+	int						first;			// -1 if the light has nothing to create
+} interactionJob_t;
+
+static idList<interactionWork_t>	interactionWork;
+static idList<interactionJob_t>		interactionJobs;
+
+/*
+==================
+R_CreateInteractionsJob
+==================
+*/
+static void R_CreateInteractionsJob(void *parms)
+{
+	interactionJob_t *job = (interactionJob_t *)parms;
+
+	for (int i = job->first; i != -1; i = interactionWork[i].nextInLight) {
+		interactionWork[i].inter->CreateActiveInteraction(interactionWork[i].model);
+	}
+}
+
+/*
+==================
+R_BeginInteractionWork
+==================
+*/
+static void R_BeginInteractionWork(void)
+{
+	viewLight_t	*vLight;
+
+	interactionWork.SetNum(0, false);
+	interactionJobs.SetNum(0, false);
+
+	for (vLight = tr.viewDef->viewLights; vLight; vLight = vLight->next) {
+		vLight->interactionJob = interactionJobs.Num();
+		interactionJobs.Alloc().first = -1;
+	}
+}
+
+/*
+==================
+R_QueueActiveInteraction
+==================
+*/
+static void R_QueueActiveInteraction(idInteraction *inter)
+{
+	interactionWork_t	work;
+	interactionJob_t	*job;
+
+	work.model = inter->PrepareActiveInteraction(work.shadowScissor, true);
+
+	if (work.model == NULL) {
+		return;
+	}
+
+	job = &interactionJobs[inter->lightDef->viewLight->interactionJob];
+
+	work.inter = inter;
+	work.floatTime = tr.viewDef->floatTime;
+	work.time = tr.viewDef->renderView.time;
+	work.nextInLight = job->first;
+
+	job->first = interactionWork.Append(work);
+}
+
+/*
+==================
+R_FinishInteractionWork
+==================
+*/
+static void R_FinishInteractionWork(void)
+{
+	float	floatTime;
+	int		time;
+
+	if (interactionWork.Num() == 0) {
+		return;
+	}
+
+	R_SetTriSurfAllocatorsShared(true);
+	Sys_RunJobs(R_CreateInteractionsJob, interactionJobs.Ptr(), sizeof(interactionJobs[0]), interactionJobs.Num());
+	R_SetTriSurfAllocatorsShared(false);
+
+	// the shader registers are evaluated while linking, so restore the entity time group
+	floatTime = tr.viewDef->floatTime;
+	time = tr.viewDef->renderView.time;
+
+	for (int i = 0; i < interactionWork.Num(); i++) {
+		tr.viewDef->floatTime = interactionWork[i].floatTime;
+		tr.viewDef->renderView.time = interactionWork[i].time;
+
+		interactionWork[i].inter->LinkActiveInteraction(interactionWork[i].shadowScissor);
+	}
+
+	tr.viewDef->floatTime = floatTime;
+	tr.viewDef->renderView.time = time;
+}
+
 /*
 ===================
 R_AddModelSurfaces
@@ -1384,6 +1549,9 @@ interactions get created.  This is all done on a sort-by-model basis
 to keep source data in cache (most likely L2) as any interactions and
 shadows are generated, since dynamic models will typically be lit by
 two or more lights.
+
+With r_useParallelInteractions the interactions are only prepared while
+walking the entities and get created and linked at the end.
 ===================
 */
 void R_AddModelSurfaces(void)
@@ -1391,11 +1559,18 @@ void R_AddModelSurfaces(void)
 	viewEntity_t		*vEntity;
 	idInteraction		*inter, *next;
 	idRenderModel		*model;
+	bool				parallel;
 
 	// clear the ambient surface list
 	tr.viewDef->numDrawSurfs = 0;
 	tr.viewDef->maxDrawSurfs = 0;	// will be set to INITIAL_DRAWSURFS on R_AddDrawSurf
 
+	parallel = r_useParallelInteractions.GetBool();
+
+	if (parallel) {
+		R_BeginInteractionWork();
+	}
+
 	// go through each entity that is either visible to the view, or to
 	// any light that intersects the view (for shadows)
 	for (vEntity = tr.viewDef->viewEntitys; vEntity; vEntity = vEntity->next) {
@@ -1411,6 +1586,11 @@ void R_AddModelSurfaces(void)
 			}
 		}
 
+		// an entity hidden behind the world may still cast shadows into view
+		if (!vEntity->scissorRect.IsEmpty() && R_EntityIsOccluded(vEntity)) {
+			vEntity->scissorRect.Clear();
+		}
+
 		float oldFloatTime;
 		int oldTime;
 
@@ -1471,7 +1651,11 @@ void R_AddModelSurfaces(void)
 						continue;
 					}
 
-					inter->AddActiveInteraction();
+					if (parallel) {
+						R_QueueActiveInteraction(inter);
+					} else {
+						inter->AddActiveInteraction();
+					}
 				}
 			}
 		} else {
@@ -1487,7 +1671,11 @@ void R_AddModelSurfaces(void)
 					continue;
 				}
 
-				inter->AddActiveInteraction();
+				if (parallel) {
+					R_QueueActiveInteraction(inter);
+				} else {
+					inter->AddActiveInteraction();
+				}
 			}
 		}
 
@@ -1497,6 +1685,10 @@ void R_AddModelSurfaces(void)
 		}
 
 	}
+
+	if (parallel) {
+		R_FinishInteractionWork();
+	}
 }
 
 /*
@@ -1516,6 +1708,7 @@ void R_RemoveUnecessaryViewLights(void)
 		if (!vLight->localInteractions && !vLight->globalInteractions && !vLight->translucentInteractions) {
 			vLight->localShadows = NULL;
 			vLight->globalShadows = NULL;
+			vLight->shadowCasters = NULL;
 		}
 	}
 
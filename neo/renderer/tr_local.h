@@ -115,7 +115,7 @@ typedef struct drawSurf_s {
 	const srfTriangles_t	*geo;
 	const struct viewEntity_s *space;
 	const idMaterial		*material;	// may be NULL for shadow volumes
-	float					sort;		// material->sort, modified by gui / entity sort offsets
+	uint64_t				sortKey;	// material->sort, then the state for opaque surfaces, see R_DrawSurfSortKey
 	const float				*shaderRegisters;	// evaluated and adjusted for referenceShaders
 	const struct drawSurf_s	*nextOnLight;	// viewLight chains
 	idScreenRect			scissorRect;	// for scissor clipping, local inside renderView viewport
@@ -339,6 +339,20 @@ typedef struct viewLight_s {
 	const struct drawSurf_s	*localShadows;				// don't shadow local Surfaces
 	const struct drawSurf_s	*globalInteractions;		// get shadows from everything
 	const struct drawSurf_s	*translucentInteractions;	// get shadows from everything
+
+	// with shadow maps the casting surfaces are linked here instead of the shadow volumes
+	const struct drawSurf_s	*shadowCasters;
+
+	// placement in the shadow map atlas, set by R_AllocShadowMaps
+	int						numShadowMapFaces;			// 0 = no shadow map, 6 for point lights
+	int						shadowMapSize;				// size in texels of each face
+	int						shadowMapTiles[6][2];		// lower left corner of each face in the atlas
+	float					shadowMapMatrix[6][16];		// global space to clip space for each face
+	idVec4					shadowMapDepthPlane;		// clip space to the linear depth stored in the map
+	float					shadowMapDepthScale;		// stored depth per world unit
+	idVec2					shadowMapTexelSize;			// texel size in stored depth is x * depth + y
+
+	int						interactionJob;				// job creating the interactions of this light with r_useParallelInteractions
 } viewLight_t;
 
 
@@ -435,6 +449,7 @@ typedef struct viewDef_s {
 	// crossing a closed door.  This is used to avoid drawing interactions
 	// when the light is behind a closed door.
 
+	int					shadowMapAtlasSize;		// 0 = no viewLights have shadow maps
 } viewDef_t;
 
 
@@ -559,6 +574,8 @@ void R_AddDrawViewCmd(viewDef_t *parms);
 
 void R_ReloadGuis_f(const idCmdArgs &args);
 void R_ListGuis_f(const idCmdArgs &args);
+void R_CompileGuis_f(const idCmdArgs &args);
+void R_GuiTextBenchmark_f(const idCmdArgs &args);
 
 void *R_GetCommandBuffer(int bytes);
 
@@ -594,6 +611,13 @@ typedef struct {
 	int		c_tangentIndexes;	// R_DeriveTangents()
 	int		c_entityUpdates, c_lightUpdates, c_entityReferences, c_lightReferences;
 	int		c_guiSurfs;
+	int		c_guiCaptures, c_guiCaptureDraws, c_guiCaptureVerts;	// rebuilt and cached gui windows
+	int		c_sortedSurfs;		// R_SortDrawSurfs(), including the light interaction chains
+	int		c_materialChanges, c_bufferChanges;	// between neighbours of the sorted surfaces
+	int		c_occluderTris, c_occlusionTests;	// R_RenderOcclusionBuffer(), R_EntityIsOccluded(), R_LightIsOccluded()
+	int		c_occludedEntities, c_occludedLights;
+	int		c_shadowMapLights, c_shadowMapFaces, c_shadowMapTexels;
+	float	occlusionMsec;		// time spent rasterizing occluders
 	int		frontEndMsec;		// sum of time in all RE_RenderScene's in a frame
 } performanceCounters_t;
 
@@ -639,6 +663,13 @@ typedef struct {
 	int		c_vboIndexes;
 	float	c_overDraw;
 
+	int		c_uniforms;				// glUniform* calls issued
+	int		c_uniformsSkipped;		// redundant glUniform* calls skipped
+	int		c_textureBinds;			// glBindTexture calls issued
+	int		c_textureBindsSkipped;	// redundant glBindTexture calls skipped
+	int		c_activeTextures;		// glActiveTexture calls issued
+	int		c_activeTexturesSkipped;// redundant glActiveTexture calls skipped
+
 	float	maxLightValue;	// for light scale
 	int		msec;			// total msec for backend run
 } backEndCounters_t;
@@ -719,6 +750,9 @@ class idRenderSystemLocal : public idRenderSystem
 		virtual void			DrawStretchPic(float x, float y, float w, float h, float s1, float t1, float s2, float t2, const idMaterial *material);
 
 		virtual void			DrawStretchTri(idVec2 p1, idVec2 p2, idVec2 p3, idVec2 t1, idVec2 t2, idVec2 t3, const idMaterial *material);
+		virtual void			BeginGuiCapture(void);
+		virtual bool			EndGuiCapture(idGuiCapture &capture);
+		virtual void			DrawGuiCapture(const idGuiCapture &capture);
 		virtual void			GlobalToNormalizedDeviceCoordinates(const idVec3 &global, idVec3 &ndc);
 		virtual void			GetGLSettings(int &width, int &height);
 		virtual void			PrintMemInfo(MemInfo_t *mi);
@@ -767,13 +801,12 @@ class idRenderSystemLocal : public idRenderSystem
 		// determines which back end to use
 		backEndName_t			backEndRenderer;
 		float					backEndRendererMaxLight;	// 1.0 for standard, unlimited for floats
+		bool					useShadowMaps;				// interactions were created for shadow maps instead of shadow volumes
 		// determines how much overbrighting needs
 		// to be done post-process
 
 		idVec4					ambientLightVector;	// used for "ambient bump mapping"
 
-		float					sortOffset;				// for determinist sorting of equal sort materials
-
 		idList<idRenderWorldLocal *>worlds;
 
 		idRenderWorldLocal 	*primaryWorld;
@@ -855,6 +888,7 @@ extern idCVar r_useTripleTextureARB;	// 1 = cards with 3+ texture units do a two
 extern idCVar r_useShadowSurfaceScissor;// 1 = scissor shadows by the scissor rect of the interaction surfaces
 extern idCVar r_useConstantMaterials;	// 1 = use pre-calculated material registers if possible
 extern idCVar r_useInteractionTable;	// create a full entityDefs * lightDefs table to make finding interactions faster
+extern idCVar r_useParallelInteractions;// 1 = create the interactions of each visible light in a job
 extern idCVar r_useNodeCommonChildren;	// stop pushing reference bounds early when possible
 extern idCVar r_useSilRemap;			// 1 = consider verts with the same XYZ, but different ST the same for shadows
 extern idCVar r_useCulling;				// 0 = none, 1 = sphere, 2 = sphere + box
@@ -863,6 +897,8 @@ extern idCVar r_useLightScissors;		// 1 = use custom scissor rectangle for each
 extern idCVar r_useClippedLightScissors;// 0 = full screen when near clipped, 1 = exact when near clipped, 2 = exact always
 extern idCVar r_useEntityCulling;		// 0 = none, 1 = box
 extern idCVar r_useEntityScissors;		// 1 = use custom scissor rectangle for each entity
+extern idCVar r_useOcclusionCulling;	// 1 = skip lights and entities hidden by the world in a software depth buffer
+extern idCVar r_occlusionMaxTris;		// maximum number of occluder triangles rasterized per view
 extern idCVar r_useInteractionCulling;	// 1 = cull interactions
 extern idCVar r_useInteractionScissors;	// 1 = use a custom scissor rectangle for each interaction
 extern idCVar r_useFrustumFarDistance;	// if != 0 force the view frustum far distance to this distance
@@ -871,6 +907,12 @@ extern idCVar r_usePreciseTriangleInteractions;	// 1 = do winding clipping to de
 extern idCVar r_useTurboShadow;			// 1 = use the infinite projection with W technique for dynamic shadows
 extern idCVar r_useExternalShadows;		// 1 = skip drawing caps when outside the light volume
 extern idCVar r_useOptimizedShadows;	// 1 = use the dmap generated static shadow volumes
+extern idCVar r_useShadowMaps;			// 1 = use shadow maps instead of stencil shadow volumes on the GLSL back end
+extern idCVar r_shadowMapAtlasSize;		// size of the texture holding the shadow maps of a view
+extern idCVar r_shadowMapSize;			// largest shadow map face, scaled down by the screen coverage of the light
+extern idCVar r_shadowMapBias;			// constant depth bias in world units
+extern idCVar r_shadowMapSlopeBias;		// depth bias in shadow map texels, scaled by the surface slope
+extern idCVar r_showShadowMaps;			// 1 = print the shadow map atlas usage
 extern idCVar r_useShadowProjectedCull;	// 1 = discard triangles outside light volume before shadowing
 extern idCVar r_useDeferredTangents;	// 1 = don't always calc tangents after deform
 extern idCVar r_useCachedDynamicModels;	// 1 = cache snapshots of dynamic models
@@ -878,6 +920,7 @@ extern idCVar r_useInfiniteFarZ;		// 1 = use the no-far-clip-plane trick
 extern idCVar r_useScissor;				// 1 = scissor clip as portals and lights are processed
 extern idCVar r_usePortals;				// 1 = use portals to perform area culling, otherwise draw everything
 extern idCVar r_useStateCaching;		// avoid redundant state changes in GL_*() calls
+extern idCVar r_useStateSort;			// 1 = group opaque surfaces by material and vertex buffer
 extern idCVar r_useCombinerDisplayLists;// if 1, put all nvidia register combiner programming in display lists
 extern idCVar r_useEntityCallbacks;		// if 0, issue the callback immediately at update time, rather than defering
 extern idCVar r_lightAllBackFaces;		// light all the back faces, even when they would be shadowed
@@ -921,6 +964,7 @@ extern idCVar r_showVertexColor;		// draws all triangles with the solid vertex c
 extern idCVar r_showUpdates;			// report entity and light updates and ref counts
 extern idCVar r_showDemo;				// report reads and writes to the demo file
 extern idCVar r_showDynamic;			// report stats on dynamic surface generation
+extern idCVar r_showGuiCache;			// report gui windows drawn from their cached geometry
 extern idCVar r_showLightScale;			// report the scale factor applied to drawing for overbrights
 extern idCVar r_showIntensity;			// draw the screen colors based on intensity, red = 0, green = 128, blue = 255
 extern idCVar r_showDefs;				// report the number of modeDefs and lightDefs in view
@@ -943,6 +987,7 @@ extern idCVar r_showShadows;			// visualize the stencil shadow volumes
 extern idCVar r_showShadowCount;		// colors screen based on shadow volume depth complexity
 extern idCVar r_showLightScissors;		// show light scissor rectangles
 extern idCVar r_showEntityScissors;		// show entity scissor rectangles
+extern idCVar r_showOcclusion;			// report occlusion culling, 2 = show culled bounds, 3 = show occluded screen tiles
 extern idCVar r_showInteractionFrustums;// show a frustum for each interaction
 extern idCVar r_showInteractionScissors;// show screen rectangle which contains the interaction frustum
 extern idCVar r_showMemory;				// print frame memory utilization
@@ -950,6 +995,9 @@ extern idCVar r_showCull;				// report sphere and box culling stats
 extern idCVar r_showInteractions;		// report interaction generation activity
 extern idCVar r_showSurfaces;			// report surface/light/shadow counts
 extern idCVar r_showPrimitives;			// report vertex/index/draw counts
+extern idCVar r_glRecord;				// 0 = direct, 1 = count GL commands, 2 = record the GL command stream
+extern idCVar r_showGLCommands;			// report the GL commands issued each frame
+extern idCVar r_showStateCalls;			// report issued/skipped uniform and texture calls
 extern idCVar r_showPortals;			// draw portal outlines in color based on passed / not passed
 extern idCVar r_showAlloc;				// report alloc/free counts
 extern idCVar r_showSkel;				// draw the skeleton when model animates
@@ -1124,6 +1172,52 @@ void		GLimp_DeactivateContext(void);
 void		GLimp_EnableLogging(bool enable);
 
 
+/*
+====================================================================
+
+QGL COMMAND RECORDER
+
+====================================================================
+*/
+
+typedef struct {
+	int			commands;		// every GL call
+	int			drawCalls;
+	int			drawIndexes;
+	int			stateChanges;	// enables, blend/depth/stencil state, bindings and pointers
+	int			uniforms;
+	int			textureBinds;
+	int			bufferBytes;	// glBufferData / glBufferSubData
+	int			textureBytes;	// texture uploads
+	int			logBytes;		// size of the recorded command stream
+} qglCounters_t;
+
+void		QGL_Init(bool nullDriver);
+// Points the qgl entry points at the driver, or at the null driver which
+// discards every command and answers queries with plausible values, so the
+// renderer can run without a window or a GL context.
+
+void		QGL_Shutdown(void);
+// Closes the stream file and frees the command log.
+
+bool		QGL_NullDriver(void);
+
+void		QGL_SetRecording(int mode);
+// 0 calls the driver directly, 1 counts the commands, 2 also records the
+// command stream into an in-memory log.  The null driver always counts,
+// and an open stream file always records.
+
+void		QGL_EndFrame(void);
+// Called after the buffer swap.  Appends the frame's command log to the
+// stream file, if one is open, and starts counting a new frame.
+
+const qglCounters_t *QGL_FrameCounters(void);
+// The counters of the last completed frame.
+
+void		R_RecordGLStream_f(const idCmdArgs &args);
+void		R_StopGLStream_f(const idCmdArgs &args);
+
+
 /*
 ====================================================================
 
@@ -1377,6 +1471,17 @@ DRAW_GLSL
 */
 
 
+// the uniform values last loaded into a program, indexed by the offset of
+// the location in shaderProgram_t, so GL_Uniform*() can skip reloading them.
+// one slot for every GLint/GLuint before u_fragmentMap, GL_UniformIsCurrent()
+// fails to compile if fields are added to shaderProgram_t without updating it
+const int MAX_UNIFORM_SHADOWS = 43;
+
+typedef struct {
+	int			numFloats;		// 0 = never loaded
+	float		value[16];
+} uniformShadow_t;
+
 typedef struct shaderProgram_s {
 	GLuint		program;
 
@@ -1415,6 +1520,13 @@ typedef struct shaderProgram_s {
 	GLint		diffuseColor;
 	GLint		specularColor;
 
+	GLint		shadowMatrix;
+	GLint		shadowLightOrigin;
+	GLint		shadowTiles[3];
+	GLint		shadowParms;
+	GLint		shadowBias;
+	GLint		shadowDepthPlane;
+
 	/* gl_... */
 	GLint		attr_TexCoord;
 	GLint		attr_Tangent;
@@ -1427,6 +1539,8 @@ typedef struct shaderProgram_s {
 
 	GLint		u_fragmentMap[MAX_FRAGMENT_IMAGES];
 	GLint		u_vertexParm[MAX_VERTEX_PARMS];
+
+	uniformShadow_t	uniformShadows[MAX_UNIFORM_SHADOWS];
 } shaderProgram_t;
 
 
@@ -1440,6 +1554,9 @@ extern shaderProgram_t shadowShader;
 extern shaderProgram_t interactionShader;
 extern shaderProgram_t defaultShader;
 extern shaderProgram_t depthFillShader;
+extern shaderProgram_t interactionShadowMapShader;
+extern shaderProgram_t shadowMapDepthShader;
+void RB_GLSL_RenderShadowMaps(void);
 
 
 /*
@@ -1530,6 +1647,7 @@ void				R_InitTriSurfData(void);
 void				R_ShutdownTriSurfData(void);
 void				R_PurgeTriSurfData(frameData_t *frame);
 void				R_ShowTriSurfMemory_f(const idCmdArgs &args);
+void				R_SetTriSurfAllocatorsShared(bool shared);
 
 srfTriangles_t 	*R_AllocStaticTriSurf(void);
 srfTriangles_t 	*R_CopyStaticTriSurf(const srfTriangles_t *tri);
@@ -1628,8 +1746,8 @@ void *R_FrameAlloc(int bytes);
 void *R_ClearedFrameAlloc(int bytes);
 void R_FrameFree(void *data);
 
-void *R_StaticAlloc(int bytes);		// just malloc with error checking
-void *R_ClearedStaticAlloc(int bytes);	// with memset
+void *R_StaticAlloc(int bytes, memTag_t tag = TAG_GEOMETRY);		// just malloc with error checking
+void *R_ClearedStaticAlloc(int bytes, memTag_t tag = TAG_GEOMETRY);	// with memset
 void R_StaticFree(void *data);
 
 
@@ -1711,6 +1829,31 @@ void R_DeformDrawSurf(drawSurf_t *drawSurf);
 /*
 =============================================================
 
+TR_OCCLUSION
+
+=============================================================
+*/
+
+void R_RenderOcclusionBuffer(void);
+bool R_EntityIsOccluded(const viewEntity_t *vEntity);
+bool R_LightIsOccluded(const viewLight_t *vLight);
+
+/*
+=============================================================
+
+TR_SHADOWMAP
+
+=============================================================
+*/
+
+const int SHADOWMAP_BORDER = 2;		// texels outside the light frustum on each side of a face, for filtering
+
+bool R_ShadowMapsAvailable(void);
+void R_AllocShadowMaps(void);
+
+/*
+=============================================================
+
 TR_TRACE
 
 =============================================================
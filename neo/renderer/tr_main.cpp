@@ -277,10 +277,10 @@ void R_InitFrameData(void)
 
 	R_ShutdownFrameData();
 
-	frameData = (frameData_t *)Mem_ClearedAlloc(sizeof(*frameData));
+	frameData = (frameData_t *)Mem_ClearedAlloc(sizeof(*frameData), TAG_FRAME_TEMP);
 	frame = frameData;
 	size = MEMORY_BLOCK_SIZE;
-	block = (frameMemoryBlock_t *)Mem_Alloc(size + sizeof(*block));
+	block = (frameMemoryBlock_t *)Mem_Alloc(size + sizeof(*block), TAG_FRAME_TEMP);
 
 	if (!block) {
 		common->FatalError("R_InitFrameData: Mem_Alloc() failed");
@@ -330,15 +330,16 @@ int R_CountFrameData(void)
 R_StaticAlloc
 =================
 */
-void *R_StaticAlloc(int bytes)
+void *R_StaticAlloc(int bytes, memTag_t tag)
 {
 	void	*buf;
 
-	tr.pc.c_alloc++;
+	// may be called from the interaction creation jobs
+	__sync_fetch_and_add(&tr.pc.c_alloc, 1);
 
-	tr.staticAllocCount += bytes;
+	__sync_fetch_and_add(&tr.staticAllocCount, bytes);
 
-	buf = Mem_Alloc(bytes);
+	buf = Mem_Alloc(bytes, tag);
 
 	// don't exit on failure on zero length allocations since the old code didn't
 	if (!buf && (bytes != 0)) {
@@ -353,11 +354,11 @@ void *R_StaticAlloc(int bytes)
 R_ClearedStaticAlloc
 =================
 */
-void *R_ClearedStaticAlloc(int bytes)
+void *R_ClearedStaticAlloc(int bytes, memTag_t tag)
 {
 	void	*buf;
 
-	buf = R_StaticAlloc(bytes);
+	buf = R_StaticAlloc(bytes, tag);
 	SIMDProcessor->Memset(buf, 0, bytes);
 	return buf;
 }
@@ -369,7 +370,7 @@ R_StaticFree
 */
 void R_StaticFree(void *data)
 {
-	tr.pc.c_free++;
+	__sync_fetch_and_add(&tr.pc.c_free, 1);
 	Mem_Free(data);
 }
 
@@ -424,7 +425,7 @@ void *R_FrameAlloc(int bytes)
 		int		size;
 
 		size = MEMORY_BLOCK_SIZE;
-		block = (frameMemoryBlock_t *)Mem_Alloc(size + sizeof(*block));
+		block = (frameMemoryBlock_t *)Mem_Alloc(size + sizeof(*block), TAG_FRAME_TEMP);
 
 		if (!block) {
 			common->FatalError("R_FrameAlloc: Mem_Alloc() failed");
@@ -711,12 +712,12 @@ bool R_CornerCullLocalBox(const idBounds &bounds, const float modelMatrix[16], i
 
 		if (j == 8) {
 			// all points were behind one of the planes
-			tr.pc.c_box_cull_out++;
+			__sync_fetch_and_add(&tr.pc.c_box_cull_out, 1);
 			return true;
 		}
 	}
 
-	tr.pc.c_box_cull_in++;
+	__sync_fetch_and_add(&tr.pc.c_box_cull_in, 1);
 
 	return false;		// not culled
 }
@@ -1094,30 +1095,154 @@ DRAWSURF SORTING
 */
 
 
+typedef struct {
+	uint64_t		key;
+	drawSurf_t		*surf;
+} drawSurfSort_t;
+
 /*
 =======================
-R_QsortSurfaces
+R_RadixSortDrawSurfs
 
+Stable LSD radix sort on the 64 bit sort keys, a byte per pass.  The
+keys are copied next to the surface pointers so the passes don't have
+to chase them.  A pass is skipped when all keys share the byte, which
+is the case for most of the low bytes when few surfaces are opaque.
 =======================
 */
-static int R_QsortSurfaces(const void *a, const void *b)
+static void R_RadixSortDrawSurfs(drawSurf_t **drawSurfs, int numDrawSurfs)
 {
-	const drawSurf_t	*ea, *eb;
+	drawSurfSort_t	*src, *dst, *temp;
+	int				counts[8][256];
+	int				i, pass, shift, sum, c;
+
+	if (numDrawSurfs < 2) {
+		return;
+	}
+
+	src = (drawSurfSort_t *)R_FrameAlloc(numDrawSurfs * sizeof(*src));
+	dst = (drawSurfSort_t *)R_FrameAlloc(numDrawSurfs * sizeof(*dst));
 
-	ea = *(drawSurf_t **)a;
-	eb = *(drawSurf_t **)b;
+	// build the histograms of all bytes in one go
+	memset(counts, 0, sizeof(counts));
 
-	if (ea->sort < eb->sort) {
-		return -1;
+	for (i = 0; i < numDrawSurfs; i++) {
+		src[i].key = drawSurfs[i]->sortKey;
+		src[i].surf = drawSurfs[i];
+
+		for (pass = 0; pass < 8; pass++) {
+			counts[pass][(src[i].key >> (pass * 8)) & 255]++;
+		}
 	}
 
-	if (ea->sort > eb->sort) {
-		return 1;
+	for (pass = 0; pass < 8; pass++) {
+		shift = pass * 8;
+
+		if (counts[pass][(src[0].key >> shift) & 255] == numDrawSurfs) {
+			continue;
+		}
+
+		// turn the counts into offsets
+		sum = 0;
+
+		for (i = 0; i < 256; i++) {
+			c = counts[pass][i];
+			counts[pass][i] = sum;
+			sum += c;
+		}
+
+		for (i = 0; i < numDrawSurfs; i++) {
+			dst[counts[pass][(src[i].key >> shift) & 255]++] = src[i];
+		}
+
+		temp = src;
+		src = dst;
+		dst = temp;
 	}
 
-	return 0;
+	for (i = 0; i < numDrawSurfs; i++) {
+		drawSurfs[i] = src[i].surf;
+	}
 }
 
+/*
+=======================
+R_CountStateChanges
+
+For r_showPrimitives 3
+=======================
+*/
+static void R_CountStateChanges(drawSurf_t **drawSurfs, int numDrawSurfs)
+{
+	const idMaterial	*material;
+	GLuint				vbo, lastVbo;
+	int					i;
+
+	material = NULL;
+	lastVbo = 0;
+
+	for (i = 0; i < numDrawSurfs; i++) {
+		if (drawSurfs[i]->material != material) {
+			material = drawSurfs[i]->material;
+			tr.pc.c_materialChanges++;
+		}
+
+		vbo = drawSurfs[i]->geo->ambientCache ? drawSurfs[i]->geo->ambientCache->vbo : 0;
+
+		if (i == 0 || vbo != lastVbo) {
+			lastVbo = vbo;
+			tr.pc.c_bufferChanges++;
+		}
+	}
+
+	tr.pc.c_sortedSurfs += numDrawSurfs;
+}
+
+/*
+=======================
+R_SortLightSurfs
+
+Interactions are additive, so the chains on a light can be put in any
+order.  Sorting them by material and vertex buffer lets the back end
+skip most of the texture and buffer binds.
+=======================
+*/
+static void R_SortLightSurfs(const drawSurf_t **link)
+{
+	const drawSurf_t	*surf;
+	drawSurf_t			**surfs;
+	int					i, count;
+
+	count = 0;
+
+	for (surf = *link; surf; surf = surf->nextOnLight) {
+		count++;
+	}
+
+	if (count < 2) {
+		return;
+	}
+
+	surfs = (drawSurf_t **)R_FrameAlloc(count * sizeof(*surfs));
+
+	for (i = 0, surf = *link; surf; surf = surf->nextOnLight) {
+		surfs[i++] = const_cast<drawSurf_t *>(surf);
+	}
+
+	R_RadixSortDrawSurfs(surfs, count);
+
+	if (r_showPrimitives.GetInteger() > 2) {
+		R_CountStateChanges(surfs, count);
+	}
+
+	// relink the chain in the sorted order
+	for (i = 0; i < count - 1; i++) {
+		surfs[i]->nextOnLight = surfs[i + 1];
+	}
+
+	surfs[count - 1]->nextOnLight = NULL;
+	*link = surfs[0];
+}
 
 /*
 =================
@@ -1126,9 +1251,24 @@ R_SortDrawSurfs
 */
 static void R_SortDrawSurfs(void)
 {
-	// sort the drawsurfs by sort type, then orientation, then shader
-	qsort(tr.viewDef->drawSurfs, tr.viewDef->numDrawSurfs, sizeof(tr.viewDef->drawSurfs[0]),
-	      R_QsortSurfaces);
+	viewLight_t	*vLight;
+
+	// sort the drawsurfs by sort type, then the state they need, keeping
+	// the order they were added in for surfaces that blend
+	R_RadixSortDrawSurfs(tr.viewDef->drawSurfs, tr.viewDef->numDrawSurfs);
+
+	if (r_showPrimitives.GetInteger() > 2) {
+		R_CountStateChanges(tr.viewDef->drawSurfs, tr.viewDef->numDrawSurfs);
+	}
+
+	if (!r_useStateSort.GetBool()) {
+		return;
+	}
+
+	for (vLight = tr.viewDef->viewLights; vLight; vLight = vLight->next) {
+		R_SortLightSurfs(&vLight->localInteractions);
+		R_SortLightSurfs(&vLight->globalInteractions);
+	}
 }
 
 
@@ -1165,8 +1305,6 @@ void R_RenderView(viewDef_t *parms)
 
 	tr.viewDef = parms;
 
-	tr.sortOffset = 0;
-
 	// set the matrix for world space to eye space
 	R_SetViewMatrix(tr.viewDef);
 
@@ -1185,6 +1323,9 @@ void R_RenderView(viewDef_t *parms)
 	// constrain the view frustum to the view lights and entities
 	R_ConstrainViewFrustum();
 
+	// rasterize the world areas that were seen into the occlusion buffer
+	R_RenderOcclusionBuffer();
+
 	// make sure that interactions exist for all light / entity combinations
 	// that are visible
 	// add any pre-generated light shadows, and calculate the light shader values
@@ -1197,6 +1338,9 @@ void R_RenderView(viewDef_t *parms)
 	// any viewLight that didn't have visible surfaces can have it's shadows removed
 	R_RemoveUnecessaryViewLights();
 
+	// place the shadow maps of the remaining lights in the atlas
+	R_AllocShadowMaps();
+
 	// sort all the ambient surfaces for translucency ordering
 	R_SortDrawSurfs();
 
@@ -0,0 +1,506 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+#include "tr_local.h"
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+/*
+=============================================================================================
+
+SOFTWARE OCCLUSION CULLING
+
+The opaque surfaces of the world areas seen through the portals are rasterized into
+a small depth buffer before any lights or entities are added to the view.  Lights and
+entities whose bounds are completely behind the occluders are then skipped.  Entities
+are only skipped for drawing; they still cast shadows into the visible parts of the
+view.
+
+The buffer holds 1/w of the nearest occluder, which is linear in screen space, with
+zero meaning no occluder.  Occluders are sampled at pixel centers, and anything that
+gets close to the near plane is treated as visible.
+
+=============================================================================================
+*/
+
+const int	OCCLUSION_WIDTH = 256;				// multiple of 4
+const int	OCCLUSION_HEIGHT = 128;
+const float	OCCLUSION_NEAR = 1.0f;				// don't trust vertexes closer than this to the eye
+const float	OCCLUSION_MIN_AREA = 1.0f;			// smaller occluder triangles are not worth rasterizing
+const int	OCCLUSION_TILE = 8;					// tile size for r_showOcclusion 3
+
+static float	occlusionBuffer[OCCLUSION_WIDTH * OCCLUSION_HEIGHT];
+static float	occlusionMVP[16];
+static int		occlusionViewCount = -1;		// == tr.viewCount if the buffer is valid for the current view
+
+/*
+===================
+R_ProjectOcclusionPoint
+
+Returns false if the point is too close to the eye to be projected.
+===================
+*/
+static bool R_ProjectOcclusionPoint(const float mvp[16], const idVec3 &point, idVec3 &screen)
+{
+	float	x, y, w;
+
+	w = point[0] * mvp[3] + point[1] * mvp[7] + point[2] * mvp[11] + mvp[15];
+
+	if (w < OCCLUSION_NEAR) {
+		return false;
+	}
+
+	x = point[0] * mvp[0] + point[1] * mvp[4] + point[2] * mvp[8] + mvp[12];
+	y = point[0] * mvp[1] + point[1] * mvp[5] + point[2] * mvp[9] + mvp[13];
+
+	screen[2] = 1.0f / w;
+	screen[0] = (x * screen[2] * 0.5f + 0.5f) * OCCLUSION_WIDTH;
+	screen[1] = (0.5f - y * screen[2] * 0.5f) * OCCLUSION_HEIGHT;
+
+	return true;
+}
+
+/*
+===================
+R_RasterizeOcclusionTriangle
+
+Half space rasterizer, four pixels at a time.
+===================
+*/
+static void R_RasterizeOcclusionTriangle(const idVec3 &v0, const idVec3 &v1In, const idVec3 &v2In)
+{
+	idVec3	v1, v2;
+	float	area, a[3], b[3], c[3];
+	float	dzdx, dzdy, zc;
+	int		minX, maxX, minY, maxY;
+	int		x, y;
+
+	area = (v1In[0] - v0[0]) * (v2In[1] - v0[1]) - (v2In[0] - v0[0]) * (v1In[1] - v0[1]);
+
+	// wind them all the same way, so the inside is where all edges are positive
+	if (area < 0.0f) {
+		v1 = v2In;
+		v2 = v1In;
+		area = -area;
+	} else {
+		v1 = v1In;
+		v2 = v2In;
+	}
+
+	if (area < OCCLUSION_MIN_AREA) {
+		return;
+	}
+
+	minX = idMath::FtoiFast(floor(Min(v0[0], Min(v1[0], v2[0]))));
+	maxX = idMath::FtoiFast(ceil(Max(v0[0], Max(v1[0], v2[0]))));
+	minY = idMath::FtoiFast(floor(Min(v0[1], Min(v1[1], v2[1]))));
+	maxY = idMath::FtoiFast(ceil(Max(v0[1], Max(v1[1], v2[1]))));
+
+	minX = Max(minX, 0) & ~3;
+	maxX = Min(maxX, OCCLUSION_WIDTH - 1);
+	minY = Max(minY, 0);
+	maxY = Min(maxY, OCCLUSION_HEIGHT - 1);
+
+	if (minX > maxX || minY > maxY) {
+		return;
+	}
+
+	// edge functions a * x + b * y + c
+	const idVec3 *verts[3] = { &v0, &v1, &v2 };
+
+	for (int i = 0; i < 3; i++) {
+		const idVec3 &p = *verts[i];
+		const idVec3 &q = *verts[(i + 1) % 3];
+
+		a[i] = p[1] - q[1];
+		b[i] = q[0] - p[0];
+		c[i] = -(a[i] * p[0] + b[i] * p[1]);
+	}
+
+	// 1/w plane
+	dzdx = ((v1[2] - v0[2]) * (v2[1] - v0[1]) - (v2[2] - v0[2]) * (v1[1] - v0[1])) / area;
+	dzdy = ((v2[2] - v0[2]) * (v1[0] - v0[0]) - (v1[2] - v0[2]) * (v2[0] - v0[0])) / area;
+	zc = v0[2] - dzdx * v0[0] - dzdy * v0[1];
+
+	for (y = minY; y <= maxY; y++) {
+		float	py = y + 0.5f;
+		float	px = minX + 0.5f;
+		float	*row = occlusionBuffer + y * OCCLUSION_WIDTH;
+
+#if defined(__SSE__)
+		const __m128 step = _mm_set_ps(3.0f, 2.0f, 1.0f, 0.0f);
+		const __m128 four = _mm_set1_ps(4.0f);
+		const __m128 zero = _mm_setzero_ps();
+		const __m128 a0 = _mm_set1_ps(a[0]), a1 = _mm_set1_ps(a[1]), a2 = _mm_set1_ps(a[2]), az = _mm_set1_ps(dzdx);
+		__m128 xs = _mm_add_ps(_mm_set1_ps(px), step);
+		__m128 e0 = _mm_add_ps(_mm_mul_ps(a0, xs), _mm_set1_ps(b[0] * py + c[0]));
+		__m128 e1 = _mm_add_ps(_mm_mul_ps(a1, xs), _mm_set1_ps(b[1] * py + c[1]));
+		__m128 e2 = _mm_add_ps(_mm_mul_ps(a2, xs), _mm_set1_ps(b[2] * py + c[2]));
+		__m128 z = _mm_add_ps(_mm_mul_ps(az, xs), _mm_set1_ps(dzdy * py + zc));
+		const __m128 de0 = _mm_mul_ps(a0, four), de1 = _mm_mul_ps(a1, four), de2 = _mm_mul_ps(a2, four), dz = _mm_mul_ps(az, four);
+
+		for (x = minX; x <= maxX; x += 4) {
+			__m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(e0, zero), _mm_cmpge_ps(e1, zero)), _mm_cmpge_ps(e2, zero));
+
+			if (_mm_movemask_ps(inside)) {
+				__m128 old = _mm_loadu_ps(row + x);
+				__m128 nearest = _mm_max_ps(old, z);
+				_mm_storeu_ps(row + x, _mm_or_ps(_mm_and_ps(inside, nearest), _mm_andnot_ps(inside, old)));
+			}
+
+			e0 = _mm_add_ps(e0, de0);
+			e1 = _mm_add_ps(e1, de1);
+			e2 = _mm_add_ps(e2, de2);
+			z = _mm_add_ps(z, dz);
+		}
+#else
+		float	e0 = a[0] * px + b[0] * py + c[0];
+		float	e1 = a[1] * px + b[1] * py + c[1];
+		float	e2 = a[2] * px + b[2] * py + c[2];
+		float	z = dzdx * px + dzdy * py + zc;
+
+		for (x = minX; x <= maxX; x++) {
+			if (e0 >= 0.0f && e1 >= 0.0f && e2 >= 0.0f && z > row[x]) {
+				row[x] = z;
+			}
+
+			e0 += a[0];
+			e1 += a[1];
+			e2 += a[2];
+			z += dzdx;
+		}
+#endif
+	}
+
+	tr.pc.c_occluderTris++;
+}
+
+/*
+===================
+R_RasterizeOccluderModel
+
+Returns the number of triangles considered.
+===================
+*/
+static int R_RasterizeOccluderModel(const idRenderEntityLocal *def, int maxTris)
+{
+	const idRenderModel	*model = def->parms.hModel;
+	float				mvp[16];
+	idVec3				localViewOrigin;
+	int					numTris;
+
+	myGlMultMatrix(def->modelMatrix, occlusionMVP, mvp);
+	R_GlobalPointToLocal(def->modelMatrix, tr.viewDef->renderView.vieworg, localViewOrigin);
+
+	numTris = 0;
+
+	for (int s = 0; s < model->NumSurfaces() && numTris < maxTris; s++) {
+		const modelSurface_t	*surf = model->Surface(s);
+		const srfTriangles_t	*tri = surf->geometry;
+		const idMaterial		*shader = surf->shader;
+
+		if (!tri || !shader || !tri->numIndexes) {
+			continue;
+		}
+
+		// only solid surfaces that are always drawn the same way can hide things
+		if (!shader->IsDrawn() || shader->Coverage() != MC_OPAQUE || shader->Deform() != DFRM_NONE) {
+			continue;
+		}
+
+		idVec3	*screen = (idVec3 *)R_FrameAlloc(tri->numVerts * sizeof(screen[0]));
+		bool	*projected = (bool *)R_FrameAlloc(tri->numVerts * sizeof(projected[0]));
+
+		for (int i = 0; i < tri->numVerts; i++) {
+			projected[i] = R_ProjectOcclusionPoint(mvp, tri->verts[i].xyz, screen[i]);
+		}
+
+		for (int i = 0; i < tri->numIndexes && numTris < maxTris; i += 3) {
+			int	i0 = tri->indexes[i + 0];
+			int	i1 = tri->indexes[i + 1];
+			int	i2 = tri->indexes[i + 2];
+
+			// the near plane isn't clipped against, so drop anything crossing it
+			if (!projected[i0] || !projected[i1] || !projected[i2]) {
+				continue;
+			}
+
+			// back faces of one sided surfaces can't be seen, so they can't hide anything
+			if (shader->GetCullType() != CT_TWO_SIDED) {
+				const idVec3 &p0 = tri->verts[i0].xyz;
+				idVec3 normal = (tri->verts[i2].xyz - p0).Cross(tri->verts[i1].xyz - p0);
+				bool facing = (normal * (localViewOrigin - p0) >= 0.0f);
+
+				if (facing != (shader->GetCullType() == CT_FRONT_SIDED)) {
+					continue;
+				}
+			}
+
+			R_RasterizeOcclusionTriangle(screen[i0], screen[i1], screen[i2]);
+			numTris++;
+		}
+	}
+
+	return numTris;
+}
+
+/*
+===================
+R_ShowOcclusionBuffer
+
+Outlines the screen tiles completely covered by occluders.
+===================
+*/
+static void R_ShowOcclusionBuffer(void)
+{
+	int		viewWidth = tr.viewDef->viewport.x2 - tr.viewDef->viewport.x1 + 1;
+	int		viewHeight = tr.viewDef->viewport.y2 - tr.viewDef->viewport.y1 + 1;
+
+	for (int ty = 0; ty < OCCLUSION_HEIGHT; ty += OCCLUSION_TILE) {
+		for (int tx = 0; tx < OCCLUSION_WIDTH; tx += OCCLUSION_TILE) {
+			bool covered = true;
+
+			for (int y = ty; y < ty + OCCLUSION_TILE && covered; y++) {
+				for (int x = tx; x < tx + OCCLUSION_TILE; x++) {
+					if (occlusionBuffer[y * OCCLUSION_WIDTH + x] == 0.0f) {
+						covered = false;
+						break;
+					}
+				}
+			}
+
+			if (!covered) {
+				continue;
+			}
+
+			// screen rects are bottom up
+			idScreenRect rect;
+			rect.x1 = tx * viewWidth / OCCLUSION_WIDTH;
+			rect.x2 = (tx + OCCLUSION_TILE) * viewWidth / OCCLUSION_WIDTH - 1;
+			rect.y1 = (OCCLUSION_HEIGHT - ty - OCCLUSION_TILE) * viewHeight / OCCLUSION_HEIGHT;
+			rect.y2 = (OCCLUSION_HEIGHT - ty) * viewHeight / OCCLUSION_HEIGHT - 1;
+
+			tr.viewDef->renderWorld->DebugScreenRect(colorCyan, rect, tr.viewDef);
+		}
+	}
+}
+
+/*
+===================
+R_RenderOcclusionBuffer
+
+Rasterizes the occluders of the current view, must be called after
+the portal flow has marked the visible areas.
+===================
+*/
+void R_RenderOcclusionBuffer(void)
+{
+	idRenderWorldLocal	*world = tr.viewDef->renderWorld;
+	idTimer				timer;
+	int					numTris, maxTris;
+
+	occlusionViewCount = -1;
+
+	// mirrors flip the face culling, and subviews are rarely worth it
+	if (!r_useOcclusionCulling.GetBool() || !world || tr.viewDef->isSubview) {
+		return;
+	}
+
+	timer.Start();
+
+	memset(occlusionBuffer, 0, sizeof(occlusionBuffer));
+	myGlMultMatrix(tr.viewDef->worldSpace.modelViewMatrix, tr.viewDef->projectionMatrix, occlusionMVP);
+
+	numTris = 0;
+	maxTris = r_occlusionMaxTris.GetInteger();
+
+	for (int i = 0; i < world->numPortalAreas && numTris < maxTris; i++) {
+		portalArea_t *area = &world->portalAreas[i];
+
+		if (area->viewCount != tr.viewCount) {
+			continue;
+		}
+
+		for (areaReference_t *ref = area->entityRefs.areaNext; ref != &area->entityRefs && numTris < maxTris; ref = ref->areaNext) {
+			const idRenderEntityLocal *def = ref->entity;
+
+			if (!def->parms.hModel || !def->parms.hModel->IsStaticWorldModel()) {
+				continue;
+			}
+
+			numTris += R_RasterizeOccluderModel(def, maxTris - numTris);
+		}
+	}
+
+	occlusionViewCount = tr.viewCount;
+
+	timer.Stop();
+	tr.pc.occlusionMsec += timer.Milliseconds();
+
+	if (r_showOcclusion.GetInteger() > 2) {
+		R_ShowOcclusionBuffer();
+	}
+}
+
+/*
+===================
+R_OcclusionTestBounds
+
+Returns true if the bounds are completely hidden by the occluders.
+===================
+*/
+static bool R_OcclusionTestBounds(const float mvp[16], const idBounds &bounds)
+{
+	idVec3	points[8], screen;
+	idBounds	rect;
+	float	nearest;
+	int		minX, maxX, minY, maxY;
+	int		x, y;
+
+	tr.pc.c_occlusionTests++;
+
+	bounds.ToPoints(points);
+	rect.Clear();
+	nearest = 0.0f;
+
+	for (int i = 0; i < 8; i++) {
+		// the eye is in or close to the bounds
+		if (!R_ProjectOcclusionPoint(mvp, points[i], screen)) {
+			return false;
+		}
+
+		rect.AddPoint(screen);
+		nearest = Max(nearest, screen[2]);
+	}
+
+	minX = Max(idMath::FtoiFast(floor(rect[0][0])), 0) & ~3;
+	maxX = Min(idMath::FtoiFast(ceil(rect[1][0])), OCCLUSION_WIDTH - 1);
+	minY = Max(idMath::FtoiFast(floor(rect[0][1])), 0);
+	maxY = Min(idMath::FtoiFast(ceil(rect[1][1])), OCCLUSION_HEIGHT - 1);
+
+	// let the frustum culling deal with anything off screen
+	if (minX > maxX || minY > maxY) {
+		return false;
+	}
+
+	// visible if any occluder under the rect is farther than the nearest point of the bounds
+	for (y = minY; y <= maxY; y++) {
+		const float *row = occlusionBuffer + y * OCCLUSION_WIDTH;
+
+#if defined(__SSE__)
+		const __m128 near4 = _mm_set1_ps(nearest);
+
+		for (x = minX; x <= maxX; x += 4) {
+			if (_mm_movemask_ps(_mm_cmple_ps(_mm_loadu_ps(row + x), near4))) {
+				return false;
+			}
+		}
+#else
+
+		for (x = minX; x <= maxX; x++) {
+			if (row[x] <= nearest) {
+				return false;
+			}
+		}
+
+#endif
+	}
+
+	return true;
+}
+
+/*
+===================
+R_EntityIsOccluded
+===================
+*/
+bool R_EntityIsOccluded(const viewEntity_t *vEntity)
+{
+	const idRenderEntityLocal	*def = vEntity->entityDef;
+	float						mvp[16];
+
+	if (occlusionViewCount != tr.viewCount) {
+		return false;
+	}
+
+	// weapons and other depth hacked models are drawn over everything
+	if (def->parms.weaponDepthHack || def->parms.modelDepthHack != 0.0f) {
+		return false;
+	}
+
+	myGlMultMatrix(def->modelMatrix, occlusionMVP, mvp);
+
+	if (!R_OcclusionTestBounds(mvp, def->referenceBounds)) {
+		return false;
+	}
+
+	tr.pc.c_occludedEntities++;
+
+	if (r_showOcclusion.GetInteger() > 1) {
+		idBounds bounds;
+		bounds.FromTransformedBounds(def->referenceBounds, def->parms.origin, def->parms.axis);
+		tr.viewDef->renderWorld->DebugBounds(colorRed, bounds);
+	}
+
+	return true;
+}
+
+/*
+===================
+R_LightIsOccluded
+
+Everything a light touches is inside its volume, including the shadows
+it casts, so if the volume is hidden the light can be dropped.
+===================
+*/
+bool R_LightIsOccluded(const viewLight_t *vLight)
+{
+	const idRenderLightLocal	*light = vLight->lightDef;
+
+	if (occlusionViewCount != tr.viewCount || !light->frustumTris) {
+		return false;
+	}
+
+	if (!R_OcclusionTestBounds(occlusionMVP, light->frustumTris->bounds)) {
+		return false;
+	}
+
+	tr.pc.c_occludedLights++;
+
+	if (r_showOcclusion.GetInteger() > 1) {
+		tr.viewDef->renderWorld->DebugBounds(colorOrange, light->frustumTris->bounds);
+	}
+
+	return true;
+}
@@ -225,7 +225,7 @@ void RB_ScanStencilBuffer(void)
 
 	memset(counts, 0, sizeof(counts));
 
-	stencilReadback = (byte *)R_StaticAlloc(glConfig.vidWidth * glConfig.vidHeight);
+	stencilReadback = (byte *)R_StaticAlloc(glConfig.vidWidth * glConfig.vidHeight, TAG_MISC);
 	glReadPixels(0, 0, glConfig.vidWidth, glConfig.vidHeight, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, stencilReadback);
 
 	for (i = 0; i < glConfig.vidWidth * glConfig.vidHeight; i++) {
@@ -261,7 +261,7 @@ void RB_CountStencilBuffer(void)
 	byte	*stencilReadback;
 
 
-	stencilReadback = (byte *)R_StaticAlloc(glConfig.vidWidth * glConfig.vidHeight);
+	stencilReadback = (byte *)R_StaticAlloc(glConfig.vidWidth * glConfig.vidHeight, TAG_MISC);
 	glReadPixels(0, 0, glConfig.vidWidth, glConfig.vidHeight, GL_STENCIL_INDEX, GL_UNSIGNED_BYTE, stencilReadback);
 
 	count = 0;
@@ -424,7 +424,7 @@ void RB_ShowIntensity(void)
 		return;
 	}
 
-	colorReadback = (byte *)R_StaticAlloc(glConfig.vidWidth * glConfig.vidHeight * 4);
+	colorReadback = (byte *)R_StaticAlloc(glConfig.vidWidth * glConfig.vidHeight * 4, TAG_MISC);
 	glReadPixels(0, 0, glConfig.vidWidth, glConfig.vidHeight, GL_RGBA, GL_UNSIGNED_BYTE, colorReadback);
 
 	c = glConfig.vidWidth * glConfig.vidHeight * 4;
@@ -510,7 +510,7 @@ void RB_ShowDepthBuffer(void)
 	glColor3f(1, 1, 1);
 	globalImages->BindNull();
 
-	depthReadback = R_StaticAlloc(glConfig.vidWidth * glConfig.vidHeight*4);
+	depthReadback = R_StaticAlloc(glConfig.vidWidth * glConfig.vidHeight*4, TAG_MISC);
 	memset(depthReadback, 0, glConfig.vidWidth * glConfig.vidHeight*4);
 
 	glReadPixels(0, 0, glConfig.vidWidth, glConfig.vidHeight, GL_DEPTH_COMPONENT , GL_FLOAT, depthReadback);
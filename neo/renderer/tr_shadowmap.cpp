@@ -0,0 +1,505 @@
+/*
+===========================================================================
+
+Doom 3 GPL Source Code
+Copyright (C) 1999-2011 id Software LLC, a ZeniMax Media company.
+
+This file is part of the Doom 3 GPL Source Code (?Doom 3 Source Code?).
+
+Doom 3 Source Code is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 3 of the License, or
+(at your option) any later version.
+
+Doom 3 Source Code is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with Doom 3 Source Code.  If not, see <http://www.gnu.org/licenses/>.
+
+In addition, the Doom 3 Source Code is also subject to certain additional terms. You should have received a copy of these additional terms immediately following the terms and conditions of the GNU General Public License which accompanied the Doom 3 Source Code.  If not, please request a copy in writing from id Software at the address below.
+
+If you have questions concerning this license or the applicable additional terms, you may contact in writing id Software LLC, c/o ZeniMax Media Inc., Suite 120, Rockville, Maryland 20850 USA.
+
+===========================================================================
+*/
+
+
+
+#include "../idlib/precompiled.h"
+#pragma hdrstop
+
+#include "tr_local.h"
+
+/*
+=============================================================================================
+
+SHADOW MAP ALLOCATION
+
+With r_useShadowMaps the interactions link the shadow casting surfaces to the view
+lights instead of building shadow volumes.  After the lights of a view are known, each
+light that has casters gets a place in a single shadow map atlas, which the back end
+renders before the interactions.
+
+Point lights get six faces, projected lights one face along the projection, and parallel
+lights one orthographic face along the light direction.  The face size is r_shadowMapSize
+scaled by the screen area of the light, so distant lights don't use up the atlas.  Faces
+are placed in Morton order over cells of the smallest face size, which packs power of
+two squares without overlap as long as they are placed largest first.
+
+The maps store a linear depth in [0,1] instead of the window z, so the interaction
+shader can bias it in world units.
+
+=============================================================================================
+*/
+
+const int	SHADOWMAP_MIN_SIZE = 32;			// also the atlas cell size
+const float	SHADOWMAP_MIN_NEAR = 0.5f;
+const float	SHADOWMAP_NEAR_FRACTION = 0.005f;	// of the far distance, to keep depth buffer precision
+
+typedef struct {
+	viewLight_t		*vLight;
+	int				numFaces;
+	int				size;
+} shadowMapLight_t;
+
+// forward, right and up axis of the six point light faces
+static const idVec3 shadowMapCubeAxis[6][3] = {
+	{ idVec3(1, 0, 0), idVec3(0, 1, 0), idVec3(0, 0, 1) },
+	{ idVec3(-1, 0, 0), idVec3(0, -1, 0), idVec3(0, 0, 1) },
+	{ idVec3(0, 1, 0), idVec3(-1, 0, 0), idVec3(0, 0, 1) },
+	{ idVec3(0, -1, 0), idVec3(1, 0, 0), idVec3(0, 0, 1) },
+	{ idVec3(0, 0, 1), idVec3(1, 0, 0), idVec3(0, 1, 0) },
+	{ idVec3(0, 0, -1), idVec3(1, 0, 0), idVec3(0, -1, 0) }
+};
+
+/*
+====================
+R_ShadowMapsAvailable
+
+Shadow maps are only drawn by the GLSL back end, and the programs
+are not part of the original data.
+====================
+*/
+bool R_ShadowMapsAvailable(void)
+{
+	if (!r_useShadowMaps.GetBool() || tr.backEndRenderer != BE_GLSL) {
+		return false;
+	}
+
+	if (!interactionShadowMapShader.program || !shadowMapDepthShader.program) {
+		return false;
+	}
+
+	return true;
+}
+
+/*
+====================
+R_ShadowMapPlane
+
+Plane that evaluates dir * ( point - origin )
+====================
+*/
+static idVec4 R_ShadowMapPlane(const idVec3 &dir, const idVec3 &origin)
+{
+	return idVec4(dir.x, dir.y, dir.z, -(dir * origin));
+}
+
+/*
+====================
+R_SetShadowMapRow
+
+Rows of the column major face matrices
+====================
+*/
+static void R_SetShadowMapRow(float *matrix, int row, const idVec4 &plane)
+{
+	matrix[row] = plane.x;
+	matrix[4 + row] = plane.y;
+	matrix[8 + row] = plane.z;
+	matrix[12 + row] = plane.w;
+}
+
+/*
+====================
+R_SetShadowMapDepthRow
+
+Maps the w row between near and far to the depth buffer range
+====================
+*/
+static void R_SetShadowMapDepthRow(float *matrix, const idVec4 &w, float zNear, float zFar)
+{
+	float	a, b;
+
+	a = (zFar + zNear) / (zFar - zNear);
+	b = -2.0f * zFar * zNear / (zFar - zNear);
+
+	R_SetShadowMapRow(matrix, 2, w * a + idVec4(0, 0, 0, b));
+	R_SetShadowMapRow(matrix, 3, w);
+}
+
+/*
+====================
+R_SetupPointShadowMap
+
+The faces are widened by the border texels, but only the 90 degree
+frustum is ever looked up.
+====================
+*/
+static bool R_SetupPointShadowMap(viewLight_t *vLight, float border)
+{
+	const srfTriangles_t	*tri;
+	idVec3					origin;
+	float					zNear, zFar;
+	int						i;
+
+	origin = vLight->globalLightOrigin;
+	tri = vLight->frustumTris;
+
+	zFar = 0.0f;
+
+	for (i = 0; i < tri->numVerts; i++) {
+		idVec3 dir = tri->verts[i].xyz - origin;
+		zFar = Max(zFar, Max(idMath::Fabs(dir.x), Max(idMath::Fabs(dir.y), idMath::Fabs(dir.z))));
+	}
+
+	if (zFar <= SHADOWMAP_MIN_NEAR) {
+		return false;
+	}
+
+	zNear = Max(SHADOWMAP_MIN_NEAR, zFar * SHADOWMAP_NEAR_FRACTION);
+
+	for (i = 0; i < 6; i++) {
+		float *matrix = vLight->shadowMapMatrix[i];
+
+		R_SetShadowMapRow(matrix, 0, R_ShadowMapPlane(shadowMapCubeAxis[i][1] / border, origin));
+		R_SetShadowMapRow(matrix, 1, R_ShadowMapPlane(shadowMapCubeAxis[i][2] / border, origin));
+		R_SetShadowMapDepthRow(matrix, R_ShadowMapPlane(shadowMapCubeAxis[i][0], origin), zNear, zFar);
+	}
+
+	vLight->shadowMapDepthScale = 1.0f / zFar;
+	vLight->shadowMapDepthPlane.Set(0, 0, 0, vLight->shadowMapDepthScale);
+
+	// a texel at distance d covers 2 * d * border / size
+	vLight->shadowMapTexelSize.Set(2.0f * border / vLight->shadowMapSize, 0.0f);
+
+	return true;
+}
+
+/*
+====================
+R_SetupProjectedShadowMap
+
+The light projection maps S / Q and T / Q to [0,1] over the light
+frustum, which becomes [-1,1] in clip space.
+====================
+*/
+static bool R_SetupProjectedShadowMap(viewLight_t *vLight, float border)
+{
+	const srfTriangles_t	*tri;
+	idVec4					s, t, q;
+	float					scale, zNear, zFar, width;
+	float					*matrix;
+	int						i;
+
+	scale = vLight->lightProject[2].Normal().Length();
+	width = Min(vLight->lightProject[0].Normal().Length(), vLight->lightProject[1].Normal().Length());
+
+	if (scale < idMath::FLT_EPSILON || width < idMath::FLT_EPSILON) {
+		return false;
+	}
+
+	// scale the projection so w is the distance along the light direction
+	scale = 1.0f / scale;
+	s = vLight->lightProject[0].ToVec4() * scale;
+	t = vLight->lightProject[1].ToVec4() * scale;
+	q = vLight->lightProject[2].ToVec4() * scale;
+
+	tri = vLight->frustumTris;
+
+	zFar = 0.0f;
+
+	for (i = 0; i < tri->numVerts; i++) {
+		zFar = Max(zFar, q.ToVec3() * tri->verts[i].xyz + q.w);
+	}
+
+	if (zFar <= SHADOWMAP_MIN_NEAR) {
+		return false;
+	}
+
+	zNear = Max(SHADOWMAP_MIN_NEAR, zFar * SHADOWMAP_NEAR_FRACTION);
+
+	matrix = vLight->shadowMapMatrix[0];
+
+	R_SetShadowMapRow(matrix, 0, (s * 2.0f - q) / border);
+	R_SetShadowMapRow(matrix, 1, (t * 2.0f - q) / border);
+	R_SetShadowMapDepthRow(matrix, q, zNear, zFar);
+
+	vLight->shadowMapDepthScale = 1.0f / zFar;
+	vLight->shadowMapDepthPlane.Set(0, 0, 0, vLight->shadowMapDepthScale);
+
+	// the frustum is d / ( scale * width ) wide at distance d
+	vLight->shadowMapTexelSize.Set(border / (scale * width * vLight->shadowMapSize), 0.0f);
+
+	return true;
+}
+
+/*
+====================
+R_SetupParallelShadowMap
+
+Orthographic projection along the light direction, fitted to the
+light volume.
+====================
+*/
+static bool R_SetupParallelShadowMap(viewLight_t *vLight, float border)
+{
+	const srfTriangles_t	*tri;
+	idVec3					forward, right, up;
+	idBounds				bounds;
+	idVec3					center, extents;
+	float					*matrix;
+	int						i;
+
+	forward = vLight->lightDef->parms.origin - vLight->globalLightOrigin;
+	forward.Normalize();
+	forward.NormalVectors(right, up);
+
+	tri = vLight->frustumTris;
+
+	bounds.Clear();
+
+	for (i = 0; i < tri->numVerts; i++) {
+		const idVec3 &xyz = tri->verts[i].xyz;
+		bounds.AddPoint(idVec3(right * xyz, up * xyz, forward * xyz));
+	}
+
+	center = bounds.GetCenter();
+	extents = (bounds[1] - bounds[0]) * 0.5f;
+
+	if (extents.x <= 0.0f || extents.y <= 0.0f || extents.z <= 0.0f) {
+		return false;
+	}
+
+	extents.x *= border;
+	extents.y *= border;
+
+	matrix = vLight->shadowMapMatrix[0];
+
+	R_SetShadowMapRow(matrix, 0, idVec4(right.x, right.y, right.z, -center.x) / extents.x);
+	R_SetShadowMapRow(matrix, 1, idVec4(up.x, up.y, up.z, -center.y) / extents.y);
+	R_SetShadowMapRow(matrix, 2, idVec4(forward.x, forward.y, forward.z, -center.z) / extents.z);
+	R_SetShadowMapRow(matrix, 3, idVec4(0, 0, 0, 1));
+
+	vLight->shadowMapDepthScale = 0.5f / extents.z;
+	vLight->shadowMapDepthPlane.Set(0, 0, 0.5f, 0.5f);
+
+	// texels have the same size everywhere
+	vLight->shadowMapTexelSize.Set(0.0f, 2.0f * Max(extents.x, extents.y) / vLight->shadowMapSize * vLight->shadowMapDepthScale);
+
+	return true;
+}
+
+/*
+====================
+R_FloorShadowMapSize
+====================
+*/
+static int R_FloorShadowMapSize(int size)
+{
+	int		pow2;
+
+	pow2 = idMath::CeilPowerOfTwo(Max(size, 1));
+
+	return (pow2 > size) ? pow2 >> 1 : pow2;
+}
+
+/*
+====================
+R_SortShadowMapLights
+
+Largest faces first
+====================
+*/
+static int R_SortShadowMapLights(const void *a, const void *b)
+{
+	return ((const shadowMapLight_t *)b)->size - ((const shadowMapLight_t *)a)->size;
+}
+
+/*
+====================
+R_MortonToCell
+
+Returns the even bits of a Morton code
+====================
+*/
+static int R_MortonToCell(int code)
+{
+	code &= 0x55555555;
+	code = (code | (code >> 1)) & 0x33333333;
+	code = (code | (code >> 2)) & 0x0f0f0f0f;
+	code = (code | (code >> 4)) & 0x00ff00ff;
+	code = (code | (code >> 8)) & 0x0000ffff;
+	return code;
+}
+
+/*
+====================
+R_AllocShadowMaps
+
+Picks the face size of each shadowed light in the view, packs the
+faces into the atlas and builds the face matrices.  Lights that don't
+fit keep numShadowMapFaces at 0 and are drawn unshadowed.
+====================
+*/
+void R_AllocShadowMaps(void)
+{
+	viewLight_t			*vLight;
+	shadowMapLight_t	*lights;
+	int					numLights;
+	int					atlasSize, maxSize, viewArea;
+	int					numCells, usedCells;
+	int					i, j;
+
+	tr.viewDef->shadowMapAtlasSize = 0;
+
+	if (!tr.useShadowMaps) {
+		return;
+	}
+
+	atlasSize = R_FloorShadowMapSize(Min(r_shadowMapAtlasSize.GetInteger(), glConfig.maxTextureSize));
+	maxSize = R_FloorShadowMapSize(r_shadowMapSize.GetInteger());
+
+	if (atlasSize < SHADOWMAP_MIN_SIZE * 4) {
+		return;
+	}
+
+	numLights = 0;
+
+	for (vLight = tr.viewDef->viewLights; vLight; vLight = vLight->next) {
+		numLights++;
+	}
+
+	if (!numLights) {
+		return;
+	}
+
+	lights = (shadowMapLight_t *)R_FrameAlloc(numLights * sizeof(*lights));
+	numLights = 0;
+
+	viewArea = (tr.viewDef->viewport.x2 - tr.viewDef->viewport.x1 + 1) * (tr.viewDef->viewport.y2 - tr.viewDef->viewport.y1 + 1);
+
+	for (vLight = tr.viewDef->viewLights; vLight; vLight = vLight->next) {
+		const idScreenRect &rect = vLight->scissorRect;
+		shadowMapLight_t *light;
+		int size, faceLimit;
+
+		vLight->numShadowMapFaces = 0;
+
+		if (vLight->lightShader->IsFogLight() || vLight->lightShader->IsBlendLight()) {
+			continue;
+		}
+
+		// R_RemoveUnecessaryViewLights drops the casters of lights without visible surfaces
+		if (!vLight->shadowCasters || rect.IsEmpty()) {
+			continue;
+		}
+
+		light = &lights[numLights++];
+		light->vLight = vLight;
+		// parallel lights are flagged as point lights as well
+		light->numFaces = (vLight->lightDef->parms.pointLight && !vLight->lightDef->parms.parallel) ? 6 : 1;
+
+		// a whole point light takes at most a quarter of the atlas
+		faceLimit = (light->numFaces == 6) ? atlasSize / 4 : atlasSize / 2;
+
+		size = idMath::FtoiFast(maxSize * idMath::Sqrt((float)(rect.x2 - rect.x1 + 1) * (rect.y2 - rect.y1 + 1) / viewArea));
+		size = R_FloorShadowMapSize(size);
+
+		light->size = idMath::ClampInt(SHADOWMAP_MIN_SIZE, Min(maxSize, faceLimit), size);
+	}
+
+	if (!numLights) {
+		return;
+	}
+
+	qsort(lights, numLights, sizeof(lights[0]), R_SortShadowMapLights);
+
+	numCells = (atlasSize / SHADOWMAP_MIN_SIZE) * (atlasSize / SHADOWMAP_MIN_SIZE);
+
+	// shrink all the faces until they fit, halving keeps the sort order
+	while (1) {
+		bool	shrunk;
+
+		usedCells = 0;
+
+		for (i = 0; i < numLights; i++) {
+			usedCells += lights[i].numFaces * (lights[i].size / SHADOWMAP_MIN_SIZE) * (lights[i].size / SHADOWMAP_MIN_SIZE);
+		}
+
+		if (usedCells <= numCells) {
+			break;
+		}
+
+		shrunk = false;
+
+		for (i = 0; i < numLights; i++) {
+			if (lights[i].size > SHADOWMAP_MIN_SIZE) {
+				lights[i].size >>= 1;
+				shrunk = true;
+			}
+		}
+
+		if (!shrunk) {
+			break;
+		}
+	}
+
+	// place the faces, the smallest lights are dropped if the atlas is still full
+	usedCells = 0;
+
+	for (i = 0; i < numLights; i++) {
+		int faceCells = (lights[i].size / SHADOWMAP_MIN_SIZE) * (lights[i].size / SHADOWMAP_MIN_SIZE);
+		float border;
+		bool valid;
+
+		if (usedCells + lights[i].numFaces * faceCells > numCells) {
+			break;
+		}
+
+		vLight = lights[i].vLight;
+
+		for (j = 0; j < lights[i].numFaces; j++) {
+			vLight->shadowMapTiles[j][0] = R_MortonToCell(usedCells) * SHADOWMAP_MIN_SIZE;
+			vLight->shadowMapTiles[j][1] = R_MortonToCell(usedCells >> 1) * SHADOWMAP_MIN_SIZE;
+			usedCells += faceCells;
+		}
+
+		vLight->shadowMapSize = lights[i].size;
+
+		border = 1.0f + 2.0f * SHADOWMAP_BORDER / lights[i].size;
+
+		if (vLight->lightDef->parms.parallel) {
+			valid = R_SetupParallelShadowMap(vLight, border);
+		} else if (vLight->lightDef->parms.pointLight) {
+			valid = R_SetupPointShadowMap(vLight, border);
+		} else {
+			valid = R_SetupProjectedShadowMap(vLight, border);
+		}
+
+		if (!valid) {
+			continue;
+		}
+
+		vLight->numShadowMapFaces = lights[i].numFaces;
+
+		tr.pc.c_shadowMapLights++;
+		tr.pc.c_shadowMapFaces += lights[i].numFaces;
+		tr.pc.c_shadowMapTexels += lights[i].numFaces * lights[i].size * lights[i].size;
+	}
+
+	tr.viewDef->shadowMapAtlasSize = atlasSize;
+}
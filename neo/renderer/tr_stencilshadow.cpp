@@ -126,27 +126,30 @@ If a high order bit is clear, the point is outside the plane (definately negativ
 //#define	LIGHT_CLIP_EPSILON	0.001f
 #define	LIGHT_CLIP_EPSILON		0.1f
 
+// the scratch state is per thread so interactions can be created by several job threads at once
+
 #define	MAX_CLIP_SIL_EDGES		2048
-static int	numClipSilEdges;
-static int	clipSilEdges[MAX_CLIP_SIL_EDGES][2];
+static __thread int	numClipSilEdges;
+static __thread int	clipSilEdges[MAX_CLIP_SIL_EDGES][2];
 
 // facing will be 0 if forward facing, 1 if backwards facing
 // grabbed with alloca
-static byte	*globalFacing;
+static __thread byte	*globalFacing;
 
 // faceCastsShadow will be 1 if the face is in the projection
 // and facing the apropriate direction
-static byte	*faceCastsShadow;
+static __thread byte	*faceCastsShadow;
 
-static int	*remap;
+static __thread int	*remap;
 
+// allocated on the first shadow volume a thread creates and kept for the life of the thread
 #define	MAX_SHADOW_INDEXES		0x18000
 #define	MAX_SHADOW_VERTS		0x18000
-static int	numShadowIndexes;
-static glIndex_t	shadowIndexes[MAX_SHADOW_INDEXES];
-static int	numShadowVerts;
-static idVec4	shadowVerts[MAX_SHADOW_VERTS];
-static bool overflowed;
+static __thread int	numShadowIndexes;
+static __thread glIndex_t	*shadowIndexes;
+static __thread int	numShadowVerts;
+static __thread idVec4	*shadowVerts;
+static __thread bool overflowed;
 
 idPlane	pointLightFrustums[6][6] = {
 	{
@@ -203,7 +206,7 @@ idPlane	pointLightFrustums[6][6] = {
 
 int	c_caps, c_sils;
 
-static bool	callOptimizer;			// call the preprocessor optimizer after clipping occluders
+static __thread bool	callOptimizer;			// call the preprocessor optimizer after clipping occluders
 
 typedef struct {
 	int		frontCapStart;
@@ -211,8 +214,8 @@ typedef struct {
 	int		silStart;
 	int		end;
 } indexRef_t;
-static indexRef_t	indexRef[6];
-static int indexFrustumNumber;		// which shadow generating side of a light the indexRef is for
+static __thread indexRef_t	indexRef[6];
+static __thread int indexFrustumNumber;		// which shadow generating side of a light the indexRef is for
 
 /*
 ===============
@@ -1043,7 +1046,7 @@ static void R_CreateShadowVolumeInFrustum(const idRenderEntityLocal *ent,
 
 	numShadowIndexes += numCapIndexes;
 
-	c_caps += numCapIndexes * 2;
+	__sync_fetch_and_add(&c_caps, numCapIndexes * 2);
 
 	int preSilIndexes = numShadowIndexes;
 
@@ -1057,7 +1060,7 @@ static void R_CreateShadowVolumeInFrustum(const idRenderEntityLocal *ent,
 	// non-shadowing triangle will cast a silhouette edge
 	R_AddSilEdges(tri, pointCull, frustum);
 
-	c_sils += numShadowIndexes - preSilIndexes;
+	__sync_fetch_and_add(&c_sils, numShadowIndexes - preSilIndexes);
 
 	// project all of the vertexes to the shadow plane, generating
 	// an equal number of back vertexes
@@ -1299,7 +1302,7 @@ srfTriangles_t *R_CreateShadowVolume(const idRenderEntityLocal *ent,
 		common->Error("R_CreateShadowVolume: tri->numVerts = %i", tri->numVerts);
 	}
 
-	tr.pc.c_createShadowVolumes++;
+	__sync_fetch_and_add(&tr.pc.c_createShadowVolumes, 1);
 
 	// use the fast infinite projection in dynamic situations, which
 	// trades somewhat more overdraw and no cap optimizations for
@@ -1322,6 +1325,11 @@ srfTriangles_t *R_CreateShadowVolume(const idRenderEntityLocal *ent,
 		return NULL;
 	}
 
+	if (shadowVerts == NULL) {
+		shadowIndexes = (glIndex_t *)Mem_Alloc16(MAX_SHADOW_INDEXES * sizeof(shadowIndexes[0]), TAG_GEOMETRY);
+		shadowVerts = (idVec4 *)Mem_Alloc16(MAX_SHADOW_VERTS * sizeof(shadowVerts[0]), TAG_GEOMETRY);
+	}
+
 	// clear the shadow volume
 	numShadowIndexes = 0;
 	numShadowVerts = 0;
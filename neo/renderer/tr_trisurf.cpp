@@ -148,6 +148,48 @@ static idDynamicAlloc<int, 1<<16, 1<<10>				triMirroredVertAllocator;
 static idDynamicAlloc<int, 1<<16, 1<<10>				triDupVertAllocator;
 #endif
 
+// set while front end jobs may allocate triangle surfaces concurrently
+static bool			triAllocatorsShared = false;
+
+
+/*
+===============
+R_SetTriSurfAllocatorsShared
+
+While shared, the allocation and free functions used during interaction
+creation serialize on CRITICAL_SECTION_THREE. Only called from the main
+thread while no jobs are running.
+===============
+*/
+void R_SetTriSurfAllocatorsShared(bool shared)
+{
+	triAllocatorsShared = shared;
+}
+
+/*
+===============
+R_LockTriSurfAllocators
+===============
+*/
+static void R_LockTriSurfAllocators(void)
+{
+	if (triAllocatorsShared) {
+		Sys_EnterCriticalSection(CRITICAL_SECTION_THREE);
+	}
+}
+
+/*
+===============
+R_UnlockTriSurfAllocators
+===============
+*/
+static void R_UnlockTriSurfAllocators(void)
+{
+	if (triAllocatorsShared) {
+		Sys_LeaveCriticalSection(CRITICAL_SECTION_THREE);
+	}
+}
+
 
 /*
 ===============
@@ -179,6 +221,17 @@ void R_InitTriSurfData(void)
 	triDominantTrisAllocator.SetLockMemory(true);
 	triMirroredVertAllocator.SetLockMemory(true);
 	triDupVertAllocator.SetLockMemory(true);
+
+	// account them as renderer geometry
+	triVertexAllocator.SetMemoryTag(TAG_GEOMETRY);
+	triIndexAllocator.SetMemoryTag(TAG_GEOMETRY);
+	triShadowVertexAllocator.SetMemoryTag(TAG_GEOMETRY);
+	triPlaneAllocator.SetMemoryTag(TAG_GEOMETRY);
+	triSilIndexAllocator.SetMemoryTag(TAG_GEOMETRY);
+	triSilEdgeAllocator.SetMemoryTag(TAG_GEOMETRY);
+	triDominantTrisAllocator.SetMemoryTag(TAG_GEOMETRY);
+	triMirroredVertAllocator.SetMemoryTag(TAG_GEOMETRY);
+	triDupVertAllocator.SetMemoryTag(TAG_GEOMETRY);
 }
 
 /*
@@ -389,6 +442,8 @@ void R_ReallyFreeStaticTriSurf(srfTriangles_t *tri)
 
 	R_FreeStaticTriSurfVertexCaches(tri);
 
+	R_LockTriSurfAllocators();
+
 	if (tri->verts != NULL) {
 		// R_CreateLightTris points tri->verts at the verts of the ambient surface
 		if (tri->ambientSurface == NULL || tri->verts != tri->ambientSurface->verts) {
@@ -438,6 +493,8 @@ void R_ReallyFreeStaticTriSurf(srfTriangles_t *tri)
 #endif
 
 	srfTrianglesAllocator.Free(tri);
+
+	R_UnlockTriSurfAllocators();
 }
 
 /*
@@ -544,7 +601,10 @@ R_AllocStaticTriSurf
 */
 srfTriangles_t *R_AllocStaticTriSurf(void)
 {
+	R_LockTriSurfAllocators();
 	srfTriangles_t *tris = srfTrianglesAllocator.Alloc();
+	R_UnlockTriSurfAllocators();
+
 	memset(tris, 0, sizeof(srfTriangles_t));
 	return tris;
 }
@@ -579,7 +639,9 @@ R_AllocStaticTriSurfVerts
 void R_AllocStaticTriSurfVerts(srfTriangles_t *tri, int numVerts)
 {
 	assert(tri->verts == NULL);
+	R_LockTriSurfAllocators();
 	tri->verts = triVertexAllocator.Alloc(numVerts);
+	R_UnlockTriSurfAllocators();
 }
 
 /*
@@ -590,7 +652,9 @@ R_AllocStaticTriSurfIndexes
 void R_AllocStaticTriSurfIndexes(srfTriangles_t *tri, int numIndexes)
 {
 	assert(tri->indexes == NULL);
+	R_LockTriSurfAllocators();
 	tri->indexes = triIndexAllocator.Alloc(numIndexes);
+	R_UnlockTriSurfAllocators();
 }
 
 /*
@@ -601,7 +665,9 @@ R_AllocStaticTriSurfShadowVerts
 void R_AllocStaticTriSurfShadowVerts(srfTriangles_t *tri, int numVerts)
 {
 	assert(tri->shadowVertexes == NULL);
+	R_LockTriSurfAllocators();
 	tri->shadowVertexes = triShadowVertexAllocator.Alloc(numVerts);
+	R_UnlockTriSurfAllocators();
 }
 
 /*
@@ -611,11 +677,15 @@ R_AllocStaticTriSurfPlanes
 */
 void R_AllocStaticTriSurfPlanes(srfTriangles_t *tri, int numIndexes)
 {
+	R_LockTriSurfAllocators();
+
 	if (tri->facePlanes) {
 		triPlaneAllocator.Free(tri->facePlanes);
 	}
 
 	tri->facePlanes = triPlaneAllocator.Alloc(numIndexes / 3);
+
+	R_UnlockTriSurfAllocators();
 }
 
 /*
@@ -626,7 +696,9 @@ R_ResizeStaticTriSurfVerts
 void R_ResizeStaticTriSurfVerts(srfTriangles_t *tri, int numVerts)
 {
 #ifdef USE_TRI_DATA_ALLOCATOR
+	R_LockTriSurfAllocators();
 	tri->verts = triVertexAllocator.Resize(tri->verts, numVerts);
+	R_UnlockTriSurfAllocators();
 #else
 	assert(false);
 #endif
@@ -640,7 +712,9 @@ R_ResizeStaticTriSurfIndexes
 void R_ResizeStaticTriSurfIndexes(srfTriangles_t *tri, int numIndexes)
 {
 #ifdef USE_TRI_DATA_ALLOCATOR
+	R_LockTriSurfAllocators();
 	tri->indexes = triIndexAllocator.Resize(tri->indexes, numIndexes);
+	R_UnlockTriSurfAllocators();
 #else
 	assert(false);
 #endif
@@ -654,7 +728,9 @@ R_ResizeStaticTriSurfShadowVerts
 void R_ResizeStaticTriSurfShadowVerts(srfTriangles_t *tri, int numVerts)
 {
 #ifdef USE_TRI_DATA_ALLOCATOR
+	R_LockTriSurfAllocators();
 	tri->shadowVertexes = triShadowVertexAllocator.Resize(tri->shadowVertexes, numVerts);
+	R_UnlockTriSurfAllocators();
 #else
 	assert(false);
 #endif
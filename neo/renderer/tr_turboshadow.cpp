@@ -277,8 +277,8 @@ static srfTriangles_t *R_CreateTurboShadowVolume(const idRenderEntityLocal *ent,
 
 	newTri->numVerts = SIMDProcessor->CreateShadowCache(&shadowVerts->xyz, vertRemap, localLightOrigin, tri->verts, tri->numVerts);
 
-	c_turboUsedVerts += newTri->numVerts;
-	c_turboUnusedVerts += tri->numVerts * 2 - newTri->numVerts;
+	__sync_fetch_and_add(&c_turboUsedVerts, newTri->numVerts);
+	__sync_fetch_and_add(&c_turboUnusedVerts, tri->numVerts * 2 - newTri->numVerts);
 
 #ifdef USE_TRI_DATA_ALLOCATOR
 	R_ResizeStaticTriSurfShadowVerts(newTri, newTri->numVerts);
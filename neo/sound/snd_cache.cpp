@@ -48,6 +48,7 @@ idSoundCache::idSoundCache()
 {
 	soundCacheAllocator.Init();
 	soundCacheAllocator.SetLockMemory(true);
+	soundCacheAllocator.SetMemoryTag(TAG_SOUND);
 	listCache.AssureSize(1024, NULL);
 	listCache.SetGranularity(256);
 	insideLevelLoad = false;
@@ -99,6 +99,8 @@ void Posix_Exit(int ret)
 		Sys_DestroyThread(asyncThread);
 	}
 
+	Posix_ShutdownJobThreads();
+
 	// process spawning. it's best when it happens after everything has shut down
 	if (exit_spawn[0]) {
 		Sys_DoStartProcess(exit_spawn, false);
@@ -208,6 +210,54 @@ void Sys_Mkdir(const char *path)
 	mkdir(path, 0777);
 }
 
+/*
+================
+Sys_MapFile
+================
+*/
+const void *Sys_MapFile(const char *path, int *length)
+{
+	struct stat	st;
+	void		*data;
+	int			fd;
+
+	*length = 0;
+
+	fd = open(path, O_RDONLY);
+
+	if (fd == -1) {
+		return NULL;
+	}
+
+	if (fstat(fd, &st) == -1 || st.st_size <= 0) {
+		close(fd);
+		return NULL;
+	}
+
+	data = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	// the mapping stays valid after the descriptor is closed
+	close(fd);
+
+	if (data == MAP_FAILED) {
+		return NULL;
+	}
+
+	*length = st.st_size;
+	return data;
+}
+
+/*
+================
+Sys_UnmapFile
+================
+*/
+void Sys_UnmapFile(const void *data, int length)
+{
+	if (data) {
+		munmap(const_cast<void *>(data), length);
+	}
+}
+
 /*
 ================
 Sys_ListFiles
@@ -60,6 +60,29 @@ typedef struct {
 int				num_interfaces = 0;
 net_interface	netint[MAX_INTERFACES];
 
+idCVar net_batchPackets("net_batchPackets", "1", CVAR_SYSTEM | CVAR_BOOL, "receive and send multiple packets per system call where supported");
+
+#define			BATCH_PACKET_SIZE		16384		// maximum size of a packet received in a batch
+#define			BATCH_SEND_BUFFER_SIZE	65536		// space for the packets of a send batch
+
+typedef struct portBatch_s {
+	// received packets not yet returned
+	int				numReceived;
+	int				nextReceived;
+	netadr_t		receivedFrom[MAX_PACKET_BATCH];
+	int				receivedSize[MAX_PACKET_BATCH];
+	byte			receiveBuffer[MAX_PACKET_BATCH][BATCH_PACKET_SIZE];
+
+	// packets queued for sending
+	bool			sending;
+	int				numQueued;
+	int				queuedBytes;
+	netadr_t		queuedTo[MAX_PACKET_BATCH];
+	int				queuedOffset[MAX_PACKET_BATCH];
+	int				queuedSize[MAX_PACKET_BATCH];
+	byte			sendBuffer[BATCH_SEND_BUFFER_SIZE];
+} portBatch_t;
+
 /*
 =============
 NetadrToSockadr
@@ -498,6 +521,13 @@ idPort::idPort()
 {
 	netSocket = 0;
 	memset(&bound_to, 0, sizeof(bound_to));
+	batch = NULL;
+	packetsRead = 0;
+	bytesRead = 0;
+	readCalls = 0;
+	packetsWritten = 0;
+	bytesWritten = 0;
+	writeCalls = 0;
 }
 
 /*
@@ -522,6 +552,11 @@ void idPort::Close()
 		netSocket = 0;
 		memset(&bound_to, 0, sizeof(bound_to));
 	}
+
+	if (batch) {
+		Mem_Free(batch);
+		batch = NULL;
+	}
 }
 
 /*
@@ -539,8 +574,13 @@ bool idPort::GetPacket(netadr_t &net_from, void *data, int &size, int maxSize)
 		return false;
 	}
 
+	if (GetQueuedPacket(net_from, data, size, maxSize)) {
+		return true;
+	}
+
 	fromlen = sizeof(from);
 	ret = recvfrom(netSocket, data, maxSize, 0, (struct sockaddr *) &from, (socklen_t *) &fromlen);
+	readCalls++;
 
 	if (ret == -1) {
 		if (errno == EWOULDBLOCK || errno == ECONNREFUSED) {
@@ -556,6 +596,8 @@ bool idPort::GetPacket(netadr_t &net_from, void *data, int &size, int maxSize)
 
 	SockadrToNetadr(&from, &net_from);
 	size = ret;
+	packetsRead++;
+	bytesRead += ret;
 	return true;
 }
 
@@ -574,6 +616,10 @@ bool idPort::GetPacketBlocking(netadr_t &net_from, void *data, int &size, int ma
 		return false;
 	}
 
+	if (GetQueuedPacket(net_from, data, size, maxSize)) {
+		return true;
+	}
+
 	if (timeout < 0) {
 		return GetPacket(net_from, data, size, maxSize);
 	}
@@ -606,6 +652,7 @@ bool idPort::GetPacketBlocking(netadr_t &net_from, void *data, int &size, int ma
 	fromlen = sizeof(from);
 
 	ret = recvfrom(netSocket, data, maxSize, 0, (struct sockaddr *)&from, (socklen_t *)&fromlen);
+	readCalls++;
 
 	if (ret == -1) {
 		// there should be no blocking errors once select declares things are good
@@ -616,6 +663,8 @@ bool idPort::GetPacketBlocking(netadr_t &net_from, void *data, int &size, int ma
 	assert(ret < maxSize);
 	SockadrToNetadr(&from, &net_from);
 	size = ret;
+	packetsRead++;
+	bytesRead += ret;
 	return true;
 }
 
@@ -638,13 +687,276 @@ void idPort::SendPacket(const netadr_t to, const void *data, int size)
 		return;
 	}
 
+	// queue the packet if a send batch is open
+	if (batch && batch->sending && size <= BATCH_SEND_BUFFER_SIZE) {
+		if (batch->numQueued >= MAX_PACKET_BATCH || batch->queuedBytes + size > BATCH_SEND_BUFFER_SIZE) {
+			FlushSendBatch();
+		}
+
+		batch->queuedTo[batch->numQueued] = to;
+		batch->queuedOffset[batch->numQueued] = batch->queuedBytes;
+		batch->queuedSize[batch->numQueued] = size;
+		memcpy(batch->sendBuffer + batch->queuedBytes, data, size);
+		batch->queuedBytes += size;
+		batch->numQueued++;
+		return;
+	}
+
 	NetadrToSockadr(&to, &addr);
 
 	ret = sendto(netSocket, data, size, 0, (struct sockaddr *) &addr, sizeof(addr));
+	writeCalls++;
 
 	if (ret == -1) {
 		common->Printf("idPort::SendPacket ERROR: to %s: %s\n", Sys_NetAdrToString(to), strerror(errno));
+		return;
+	}
+
+	packetsWritten++;
+	bytesWritten += ret;
+}
+
+/*
+==================
+idPort::ReceivePackets
+==================
+*/
+int idPort::ReceivePackets(int timeout)
+{
+	fd_set				set;
+	struct timeval		tv;
+	struct sockaddr_in	from[MAX_PACKET_BATCH];
+	int					i, ret, fromlen;
+
+	if (!netSocket) {
+		return 0;
+	}
+
+	if (!batch) {
+		batch = (portBatch_t *) Mem_ClearedAlloc(sizeof(portBatch_t));
+	}
+
+	if (batch->nextReceived < batch->numReceived) {
+		return batch->numReceived - batch->nextReceived;
+	}
+
+	batch->numReceived = 0;
+	batch->nextReceived = 0;
+
+	if (timeout >= 0) {
+		FD_ZERO(&set);
+		FD_SET(netSocket, &set);
+
+		tv.tv_sec = timeout / 1000;
+		tv.tv_usec = (timeout % 1000) * 1000;
+		ret = select(netSocket+1, &set, NULL, NULL, &tv);
+
+		if (ret == -1) {
+			if (errno == EINTR) {
+				common->DPrintf("idPort::ReceivePackets: select EINTR\n");
+				return 0;
+			} else {
+				common->Error("idPort::ReceivePackets: select failed: %s\n", strerror(errno));
+			}
+		}
+
+		if (ret == 0) {
+			// timed out
+			return 0;
+		}
+	}
+
+#ifdef __linux__
+	if (net_batchPackets.GetBool()) {
+		struct mmsghdr	msgs[MAX_PACKET_BATCH];
+		struct iovec	iovecs[MAX_PACKET_BATCH];
+
+		memset(msgs, 0, sizeof(msgs));
+
+		for (i = 0; i < MAX_PACKET_BATCH; i++) {
+			iovecs[i].iov_base = batch->receiveBuffer[i];
+			iovecs[i].iov_len = BATCH_PACKET_SIZE;
+			msgs[i].msg_hdr.msg_name = &from[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(from[i]);
+			msgs[i].msg_hdr.msg_iov = &iovecs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		ret = recvmmsg(netSocket, msgs, MAX_PACKET_BATCH, MSG_DONTWAIT, NULL);
+		readCalls++;
+
+		if (ret == -1) {
+			if (errno != EWOULDBLOCK && errno != ECONNREFUSED) {
+				common->DPrintf("idPort::ReceivePackets recvmmsg(): %s\n", strerror(errno));
+			}
+
+			return 0;
+		}
+
+		for (i = 0; i < ret; i++) {
+			SockadrToNetadr(&from[i], &batch->receivedFrom[i]);
+			batch->receivedSize[i] = msgs[i].msg_len;
+			packetsRead++;
+			bytesRead += msgs[i].msg_len;
+		}
+
+		batch->numReceived = ret;
+		return ret;
 	}
+#endif
+
+	for (i = 0; i < MAX_PACKET_BATCH; i++) {
+		fromlen = sizeof(from[i]);
+		ret = recvfrom(netSocket, batch->receiveBuffer[i], BATCH_PACKET_SIZE, 0, (struct sockaddr *) &from[i], (socklen_t *) &fromlen);
+		readCalls++;
+
+		if (ret == -1) {
+			if (errno != EWOULDBLOCK && errno != ECONNREFUSED) {
+				common->DPrintf("idPort::ReceivePackets recvfrom(): %s\n", strerror(errno));
+			}
+
+			break;
+		}
+
+		SockadrToNetadr(&from[i], &batch->receivedFrom[i]);
+		batch->receivedSize[i] = ret;
+		packetsRead++;
+		bytesRead += ret;
+	}
+
+	batch->numReceived = i;
+	return i;
+}
+
+/*
+==================
+idPort::GetQueuedPacket
+==================
+*/
+bool idPort::GetQueuedPacket(netadr_t &net_from, void *data, int &size, int maxSize)
+{
+	int i;
+
+	if (!batch || batch->nextReceived >= batch->numReceived) {
+		return false;
+	}
+
+	i = batch->nextReceived++;
+
+	assert(batch->receivedSize[i] < maxSize);
+
+	net_from = batch->receivedFrom[i];
+	size = Min(batch->receivedSize[i], maxSize);
+	memcpy(data, batch->receiveBuffer[i], size);
+	return true;
+}
+
+/*
+==================
+idPort::BeginSendBatch
+==================
+*/
+void idPort::BeginSendBatch(void)
+{
+	if (!netSocket) {
+		return;
+	}
+
+	if (!batch) {
+		batch = (portBatch_t *) Mem_ClearedAlloc(sizeof(portBatch_t));
+	}
+
+	batch->sending = true;
+}
+
+/*
+==================
+idPort::EndSendBatch
+==================
+*/
+void idPort::EndSendBatch(void)
+{
+	if (!batch) {
+		return;
+	}
+
+	FlushSendBatch();
+	batch->sending = false;
+}
+
+/*
+==================
+idPort::FlushSendBatch
+==================
+*/
+void idPort::FlushSendBatch(void)
+{
+	struct sockaddr_in	addr[MAX_PACKET_BATCH];
+	int					i, ret;
+
+	for (i = 0; i < batch->numQueued; i++) {
+		NetadrToSockadr(&batch->queuedTo[i], &addr[i]);
+	}
+
+#ifdef __linux__
+	if (net_batchPackets.GetBool()) {
+		struct mmsghdr	msgs[MAX_PACKET_BATCH];
+		struct iovec	iovecs[MAX_PACKET_BATCH];
+		int				first;
+
+		memset(msgs, 0, sizeof(msgs));
+
+		for (i = 0; i < batch->numQueued; i++) {
+			iovecs[i].iov_base = batch->sendBuffer + batch->queuedOffset[i];
+			iovecs[i].iov_len = batch->queuedSize[i];
+			msgs[i].msg_hdr.msg_name = &addr[i];
+			msgs[i].msg_hdr.msg_namelen = sizeof(addr[i]);
+			msgs[i].msg_hdr.msg_iov = &iovecs[i];
+			msgs[i].msg_hdr.msg_iovlen = 1;
+		}
+
+		first = 0;
+
+		while (first < batch->numQueued) {
+			ret = sendmmsg(netSocket, msgs + first, batch->numQueued - first, 0);
+			writeCalls++;
+
+			if (ret == -1) {
+				// the first packet failed, skip it and send the rest
+				common->Printf("idPort::SendPacket ERROR: to %s: %s\n", Sys_NetAdrToString(batch->queuedTo[first]), strerror(errno));
+				first++;
+				continue;
+			}
+
+			for (i = first; i < first + ret; i++) {
+				packetsWritten++;
+				bytesWritten += msgs[i].msg_len;
+			}
+
+			first += ret;
+		}
+
+		batch->numQueued = 0;
+		batch->queuedBytes = 0;
+		return;
+	}
+#endif
+
+	for (i = 0; i < batch->numQueued; i++) {
+		ret = sendto(netSocket, batch->sendBuffer + batch->queuedOffset[i], batch->queuedSize[i], 0, (struct sockaddr *) &addr[i], sizeof(addr[i]));
+		writeCalls++;
+
+		if (ret == -1) {
+			common->Printf("idPort::SendPacket ERROR: to %s: %s\n", Sys_NetAdrToString(batch->queuedTo[i]), strerror(errno));
+			continue;
+		}
+
+		packetsWritten++;
+		bytesWritten += ret;
+	}
+
+	batch->numQueued = 0;
+	batch->queuedBytes = 0;
 }
 
 /*
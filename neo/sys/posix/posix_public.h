@@ -50,6 +50,8 @@ void		Posix_SetExitSpawn(const char *exeName);   // set the process to be spawne
 void		Posix_StartAsyncThread(void);
 extern xthreadInfo asyncThread;
 
+void		Posix_ShutdownJobThreads(void);
+
 bool		Posix_AddKeyboardPollEvent(int key, bool state);
 bool		Posix_AddMousePollEvent(int action, int value);
 
@@ -162,7 +162,7 @@ thread create and destroy
 */
 
 // not a hard limit, just what we keep track of for debugging
-#define MAX_THREADS 10
+#define MAX_THREADS 20
 xthreadInfo *g_threads[MAX_THREADS];
 
 int g_thread_count = 0;
@@ -273,6 +273,221 @@ const char *Sys_GetThreadName(int *index)
 	return "main";
 }
 
+/*
+======================================================
+job threads
+the workers are started on the first Sys_RunJobs call and joined by Posix_ShutdownJobThreads on exit
+a single batch of jobs is in flight at any time, it is guarded by its own mutex so jobs can still use the critical sections
+======================================================
+*/
+
+idCVar sys_jobThreads("sys_jobThreads", "0", CVAR_SYSTEM | CVAR_INIT | CVAR_INTEGER, "number of job threads, 0 = one per additional core, -1 = run all jobs on the calling thread", -1, MAX_JOB_THREADS);
+
+static xthreadInfo		jobThreads[ MAX_JOB_THREADS ];
+static int				numJobThreads = -1;		// -1 until the workers have been started
+
+static pthread_mutex_t	job_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t	job_cond = PTHREAD_COND_INITIALIZER;		// signaled when a new batch is available
+static pthread_cond_t	job_done_cond = PTHREAD_COND_INITIALIZER;	// signaled when the last job of a batch completed
+static bool				job_active = false;
+static xjob_t			job_function;
+static byte				*job_parms;
+static int				job_parmSize;
+static int				job_num;
+static int				job_next;
+static int				job_pending;
+
+/*
+==================
+Sys_RunNextJob
+
+called with job_lock held, returns false if there is nothing left to run
+==================
+*/
+static bool Sys_RunNextJob(void)
+{
+	if (!job_active || job_next >= job_num) {
+		return false;
+	}
+
+	int index = job_next++;
+	pthread_mutex_unlock(&job_lock);
+
+	job_function(job_parms + index * job_parmSize);
+
+	pthread_mutex_lock(&job_lock);
+
+	if (--job_pending == 0) {
+		pthread_cond_signal(&job_done_cond);
+	}
+
+	return true;
+}
+
+/*
+==================
+Sys_JobThreadUnlock
+
+cleanup handler, a worker cancelled in pthread_cond_wait holds job_lock again
+==================
+*/
+static void Sys_JobThreadUnlock(void *parms)
+{
+	pthread_mutex_unlock(&job_lock);
+}
+
+/*
+==================
+Sys_JobThread
+==================
+*/
+static void *Sys_JobThread(void *parms)
+{
+	xthreadInfo *info = (xthreadInfo *)parms;
+
+#if !defined(__ANDROID__)
+	// jobs may hit cancelation points, only the idle wait is allowed to cancel
+	pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+#endif
+
+	pthread_mutex_lock(&job_lock);
+	pthread_cleanup_push(Sys_JobThreadUnlock, NULL);
+
+	while (1) {
+		if (Sys_RunNextJob()) {
+			continue;
+		}
+
+#if defined(__ANDROID__)
+		if (info->threadCancel) {
+			break;
+		}
+
+		pthread_cond_wait(&job_cond, &job_lock);
+#else
+		pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+		pthread_cond_wait(&job_cond, &job_lock);
+		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+#endif
+	}
+
+	pthread_cleanup_pop(1);
+	return NULL;
+}
+
+/*
+==================
+Sys_StartJobThreads
+==================
+*/
+static void Sys_StartJobThreads(void)
+{
+	int count = sys_jobThreads.GetInteger();
+
+	if (count == 0) {
+		count = sysconf(_SC_NPROCESSORS_ONLN) - 1;
+	}
+
+	numJobThreads = idMath::ClampInt(0, MAX_JOB_THREADS, count);
+
+	for (int i = 0; i < numJobThreads; i++) {
+		Sys_CreateThread(Sys_JobThread, &jobThreads[i], THREAD_NORMAL, jobThreads[i], "job", g_threads, &g_thread_count);
+	}
+
+	common->Printf("%d job threads started\n", numJobThreads);
+}
+
+/*
+==================
+Sys_NumJobThreads
+==================
+*/
+int Sys_NumJobThreads(void)
+{
+	return Max(numJobThreads, 0);
+}
+
+/*
+==================
+Sys_RunJobs
+==================
+*/
+void Sys_RunJobs(xjob_t function, void *parms, int parmSize, int numJobs)
+{
+	int i;
+
+	if (numJobs <= 0) {
+		return;
+	}
+
+	pthread_mutex_lock(&job_lock);
+
+	if (numJobThreads < 0) {
+		Sys_StartJobThreads();
+	}
+
+	// run serially if there is nobody to help or another batch is in flight
+	if (numJobThreads == 0 || numJobs == 1 || job_active) {
+		pthread_mutex_unlock(&job_lock);
+
+		for (i = 0; i < numJobs; i++) {
+			function((byte *)parms + i * parmSize);
+		}
+
+		return;
+	}
+
+	job_active = true;
+	job_function = function;
+	job_parms = (byte *)parms;
+	job_parmSize = parmSize;
+	job_num = numJobs;
+	job_next = 0;
+	job_pending = numJobs;
+	pthread_cond_broadcast(&job_cond);
+
+	while (Sys_RunNextJob()) {
+	}
+
+	while (job_pending > 0) {
+		pthread_cond_wait(&job_done_cond, &job_lock);
+	}
+
+	job_active = false;
+	pthread_mutex_unlock(&job_lock);
+}
+
+/*
+==================
+Posix_ShutdownJobThreads
+==================
+*/
+void Posix_ShutdownJobThreads(void)
+{
+	int i, count;
+
+	pthread_mutex_lock(&job_lock);
+	assert(!job_active);
+
+	count = Max(numJobThreads, 0);
+	numJobThreads = 0;	// anything running after this point runs serially
+
+#if defined(__ANDROID__)
+	// no pthread_cancel, wake the idle workers so they see the flag
+	for (i = 0; i < count; i++) {
+		jobThreads[i].threadCancel = true;
+	}
+
+	pthread_cond_broadcast(&job_cond);
+#endif
+
+	pthread_mutex_unlock(&job_lock);
+
+	for (i = 0; i < count; i++) {
+		Sys_DestroyThread(jobThreads[i]);
+	}
+}
+
 /*
 =========================================================
 Async Thread
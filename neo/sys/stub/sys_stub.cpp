@@ -119,6 +119,20 @@ bool idPort::GetPacket(netadr_t &net_from, void *data int &size, int maxSize)
 void idPort::SendPacket(const netadr_t to, const void *data, int size)
 {
 }
+int idPort::ReceivePackets(int timeout)
+{
+	return 0;
+}
+bool idPort::GetQueuedPacket(netadr_t &net_from, void *data, int &size, int maxSize)
+{
+	return false;
+}
+void idPort::BeginSendBatch(void)
+{
+}
+void idPort::EndSendBatch(void)
+{
+}
 
 //==========================================================
 
@@ -157,6 +171,16 @@ void	Sys_Mkdir(const char *path)
 {
 }
 
+const void *Sys_MapFile(const char *path, int *length)
+{
+	*length = 0;
+	return NULL;
+}
+
+void	Sys_UnmapFile(const void *data, int length)
+{
+}
+
 const char *Sys_DefaultCDPath(void)
 {
 	return "";
@@ -328,6 +328,9 @@ void			Sys_ShowConsole(int visLevel, bool quitOnClose);
 
 
 void			Sys_Mkdir(const char *path);
+// maps a whole file read-only into memory, returns NULL if the platform or file doesn't allow it
+const void		*Sys_MapFile(const char *path, int *length);
+void			Sys_UnmapFile(const void *data, int length);
 ID_TIME_T			Sys_FileTimeStamp(FILE *fp);
 // NOTE: do we need to guarantee the same output on all platforms?
 const char 	*Sys_TimeStampToStr(ID_TIME_T timeStamp);
@@ -369,6 +372,8 @@ typedef struct {
 
 #define	PORT_ANY			-1
 
+const int MAX_PACKET_BATCH	= 32;		// maximum number of packets received or sent with a single system call
+
 class idPort
 {
 	public:
@@ -389,15 +394,31 @@ class idPort
 		bool		GetPacketBlocking(netadr_t &from, void *data, int &size, int maxSize, int timeout);
 		void		SendPacket(const netadr_t to, const void *data, int size);
 
+		// Receives the pending packets with as few system calls as possible, waiting
+		// up to timeout msec if none are pending. Returns the number of queued packets.
+		// GetPacket and GetPacketBlocking return queued packets before reading new ones.
+		int			ReceivePackets(int timeout);
+		bool		GetQueuedPacket(netadr_t &from, void *data, int &size, int maxSize);
+
+		// SendPacket calls between BeginSendBatch and EndSendBatch are queued and
+		// transmitted together with as few system calls as possible.
+		void		BeginSendBatch(void);
+		void		EndSendBatch(void);
+
 		int			packetsRead;
 		int			bytesRead;
+		int			readCalls;
 
 		int			packetsWritten;
 		int			bytesWritten;
+		int			writeCalls;
 
 	private:
 		netadr_t	bound_to;		// interface and port
 		int			netSocket;		// OS specific socket
+		struct portBatch_s *batch;	// batched packet buffers, allocated on first use
+
+		void		FlushSendBatch(void);
 };
 
 class idTCP
@@ -460,7 +481,7 @@ typedef struct {
 #endif
 } xthreadInfo;
 
-const int MAX_THREADS				= 10;
+const int MAX_THREADS				= 20;
 extern xthreadInfo *g_threads[MAX_THREADS];
 extern int			g_thread_count;
 
@@ -495,6 +516,16 @@ enum {
 void				Sys_WaitForEvent(int index = TRIGGER_EVENT_ZERO);
 void				Sys_TriggerEvent(int index = TRIGGER_EVENT_ZERO);
 
+// a pool of job threads used to spread independent work over all cores
+// the calling thread runs jobs as well and only returns once all of them are done
+// jobs must not call Sys_RunJobs themselves, nested calls run serially on the calling thread
+typedef void (*xjob_t)(void *parms);
+
+const int MAX_JOB_THREADS			= 8;
+
+void				Sys_RunJobs(xjob_t function, void *parms, int parmSize, int numJobs);
+int					Sys_NumJobThreads(void);
+
 /*
 ==============================================================
 
@@ -37,6 +37,9 @@ class idBindWindow : public idWindow
 		virtual ~idBindWindow();
 
 		virtual const char *HandleEvent(const sysEvent_t *event, bool *updateVisuals);
+		virtual bool CanDrawCached() {
+			return false;
+		}
 		virtual void PostParse();
 		virtual void Draw(int time, float x, float y);
 		virtual size_t Allocated() {
@@ -41,6 +41,9 @@ class idChoiceWindow : public idWindow
 		virtual const char	*HandleEvent(const sysEvent_t *event, bool *updateVisuals);
 		virtual void 		PostParse();
 		virtual void 		Draw(int time, float x, float y);
+		virtual bool		CanDrawCached() {
+			return false;
+		}
 		virtual void		Activate(bool activate, idStr &act);
 		virtual size_t		Allocated() {
 			return idWindow::Allocated();
@@ -45,6 +45,15 @@ idVec4 idDeviceContext::colorNone;
 idCVar gui_smallFontLimit("gui_smallFontLimit", "0.30", CVAR_GUI | CVAR_ARCHIVE, "");
 idCVar gui_mediumFontLimit("gui_mediumFontLimit", "0.60", CVAR_GUI | CVAR_ARCHIVE, "");
 
+idCVar gui_textLayoutCache("gui_textLayoutCache", "1", CVAR_GUI | CVAR_BOOL, "reuse the glyph layout of texts that were drawn before");
+
+// laid out texts kept before the cache is flushed
+const int MAX_TEXT_LAYOUTS = 1024;
+// glyphs batched into a single DrawStretchPic
+const int MAX_TEXT_BATCH = 1024;
+
+idCVar idDrawCache::gui_useDrawCache("gui_useDrawCache", "1", CVAR_GUI | CVAR_BOOL, "reuse the geometry of gui windows whose draw state did not change");
+
 
 idList<fontInfoEx_t> idDeviceContext::fonts;
 
@@ -65,6 +74,9 @@ int idDeviceContext::FindFont(const char *name)
 	fontInfoEx_t fontInfo;
 	int index = fonts.Append(fontInfo);
 
+	// the layouts are keyed by font pointers, which may have moved
+	FreeTextLayouts();
+
 	if (renderSystem->RegisterFont(fileName, fonts[index])) {
 		idStr::Copynz(fonts[index].name, name, sizeof(fonts[index].name));
 		return index;
@@ -98,6 +110,11 @@ void idDeviceContext::SetFont(int num)
 	}
 }
 
+int idDeviceContext::GetFont() const
+{
+	return activeFont - fonts.Ptr();
+}
+
 
 void idDeviceContext::Init()
 {
@@ -148,6 +165,9 @@ void idDeviceContext::Shutdown()
 	fontName.Clear();
 	clipRects.Clear();
 	fonts.Clear();
+	FreeTextLayouts();
+	textVerts.Clear();
+	textIndexes.Clear();
 	Clear();
 }
 
@@ -157,6 +177,8 @@ void idDeviceContext::Clear()
 	useFont = NULL;
 	activeFont = NULL;
 	mbcs = false;
+	textMaterial = NULL;
+	recordLayout = NULL;
 }
 
 idDeviceContext::idDeviceContext()
@@ -692,6 +714,201 @@ void idDeviceContext::PaintChar(float x,float y,float width,float height,float s
 }
 
 
+/*
+=============
+idDeviceContext::BatchChar
+
+Like PaintChar, but the glyph is added to the batch of the current material
+=============
+*/
+void idDeviceContext::BatchChar(float x, float y, float w, float h, float s, float t, float s2, float t2, const idMaterial *hShader)
+{
+	idDrawVert	*verts;
+	glIndex_t	*indexes;
+	int			numVerts, numIndexes, i;
+	bool		transform;
+
+	if (ClippedCoords(&x, &y, &w, &h, &s, &t, &s2, &t2)) {
+		return;
+	}
+
+	AdjustCoords(&x, &y, &w, &h);
+
+	if (hShader != textMaterial || textVerts.Num() >= MAX_TEXT_BATCH * 4) {
+		FlushText();
+		textMaterial = hShader;
+	}
+
+	numVerts = textVerts.Num();
+	numIndexes = textIndexes.Num();
+
+	textVerts.SetNum(numVerts + 4, false);
+	textIndexes.SetNum(numIndexes + 6, false);
+
+	verts = &textVerts[numVerts];
+	indexes = &textIndexes[numIndexes];
+
+	indexes[0] = numVerts + 3;
+	indexes[1] = numVerts + 0;
+	indexes[2] = numVerts + 2;
+	indexes[3] = numVerts + 2;
+	indexes[4] = numVerts + 0;
+	indexes[5] = numVerts + 1;
+
+	verts[0].xyz.Set(x, y, 0.0f);
+	verts[0].st.Set(s, t);
+	verts[1].xyz.Set(x + w, y, 0.0f);
+	verts[1].st.Set(s2, t);
+	verts[2].xyz.Set(x + w, y + h, 0.0f);
+	verts[2].st.Set(s2, t2);
+	verts[3].xyz.Set(x, y + h, 0.0f);
+	verts[3].st.Set(s, t2);
+
+	transform = !mat.IsIdentity();
+
+	for (i = 0; i < 4; i++) {
+		verts[i].normal.Set(0.0f, 0.0f, 1.0f);
+		verts[i].tangents[0].Set(1.0f, 0.0f, 0.0f);
+		verts[i].tangents[1].Set(0.0f, 1.0f, 0.0f);
+
+		if (transform) {
+			verts[i].xyz -= origin;
+			verts[i].xyz *= mat;
+			verts[i].xyz += origin;
+		}
+	}
+}
+
+/*
+=============
+idDeviceContext::FlushText
+
+Draws the batched glyphs, before the color or the material changes
+=============
+*/
+void idDeviceContext::FlushText()
+{
+	if (!textIndexes.Num()) {
+		return;
+	}
+
+	renderSystem->DrawStretchPic(textVerts.Ptr(), textIndexes.Ptr(), textVerts.Num(), textIndexes.Num(), textMaterial, !mat.IsIdentity());
+
+	textVerts.SetNum(0, false);
+	textIndexes.SetNum(0, false);
+}
+
+/*
+=============
+idDeviceContext::FindTextLayout
+
+Lays the text out relative to the rectangle if it wasn't before
+=============
+*/
+idTextLayout *idDeviceContext::FindTextLayout(const char *text, float textScale, int textAlign, const idRectangle &rectDraw, bool wrap)
+{
+	idTextLayout	*layout;
+	int				key, i;
+
+	SetFontByScale(textScale);
+
+	key = textLayoutHash.GenerateKey(text, true);
+
+	for (i = textLayoutHash.First(key); i != -1; i = textLayoutHash.Next(i)) {
+		layout = textLayouts[i];
+
+		if (layout->font == useFont && layout->scale == textScale && layout->width == rectDraw.w && layout->height == rectDraw.h &&
+		    layout->align == textAlign && layout->wrap == wrap && layout->text.Cmp(text) == 0) {
+			return layout;
+		}
+	}
+
+	if (textLayouts.Num() >= MAX_TEXT_LAYOUTS) {
+		FreeTextLayouts();
+	}
+
+	layout = new idTextLayout;
+	layout->text = text;
+	layout->font = useFont;
+	layout->scale = textScale;
+	layout->width = rectDraw.w;
+	layout->height = rectDraw.h;
+	layout->align = textAlign;
+	layout->wrap = wrap;
+	layout->endColor = C_COLOR_DEFAULT;
+
+	recordLayout = layout;
+	layout->result = DrawTextRect(text, textScale, textAlign, colorWhite, idRectangle(0.0f, 0.0f, rectDraw.w, rectDraw.h), wrap, -1, false, NULL, 0);
+	recordLayout = NULL;
+
+	layout->glyphs.Condense();
+	textLayoutHash.Add(key, textLayouts.Append(layout));
+
+	return layout;
+}
+
+/*
+=============
+idDeviceContext::DrawTextLayout
+=============
+*/
+void idDeviceContext::DrawTextLayout(const idTextLayout *layout, float x, float y, const idVec4 &color)
+{
+	const textGlyph_t	*g;
+	idVec4				newColor;
+	int					colorIndex, i;
+
+	if (color.w == 0.0f) {
+		return;
+	}
+
+	FlushText();
+	renderSystem->SetColor(color);
+	colorIndex = C_COLOR_DEFAULT;
+
+	for (i = 0; i < layout->glyphs.Num(); i++) {
+		g = &layout->glyphs[i];
+
+		if (g->color != colorIndex) {
+			FlushText();
+			colorIndex = g->color;
+
+			if (colorIndex == C_COLOR_DEFAULT) {
+				renderSystem->SetColor(color);
+			} else {
+				newColor = idStr::ColorForIndex(colorIndex);
+				newColor[3] = color[3];
+				renderSystem->SetColor(newColor);
+			}
+		}
+
+		BatchChar(x + g->x, y + g->y, g->w, g->h, g->s, g->t, g->s2, g->t2, g->material);
+	}
+
+	FlushText();
+
+	if (layout->endColor != colorIndex) {
+		if (layout->endColor == C_COLOR_DEFAULT) {
+			renderSystem->SetColor(color);
+		} else {
+			newColor = idStr::ColorForIndex(layout->endColor);
+			newColor[3] = color[3];
+			renderSystem->SetColor(newColor);
+		}
+	}
+}
+
+/*
+=============
+idDeviceContext::FreeTextLayouts
+=============
+*/
+void idDeviceContext::FreeTextLayouts()
+{
+	textLayouts.DeleteContents(true);
+	textLayoutHash.Free();
+}
+
 void idDeviceContext::SetFontByScale(float scale)
 {
 	if (scale <= gui_smallFontLimit.GetFloat()) {
@@ -715,13 +932,21 @@ int idDeviceContext::DrawText(float x, float y, float scale, idVec4 color, const
 	idVec4		newColor;
 	const glyphInfo_t *glyph;
 	float		useScale;
+	int			colorIndex;
 	SetFontByScale(scale);
 	useScale = scale * useFont->glyphScale;
 	count = 0;
+	colorIndex = C_COLOR_DEFAULT;
 
-	if (text && color.w != 0.0f) {
+	// a layout is recorded whatever the color is
+	if (text && (color.w != 0.0f || recordLayout)) {
 		const unsigned char	*s = (const unsigned char *)text;
-		renderSystem->SetColor(color);
+
+		if (!recordLayout) {
+			FlushText();
+			renderSystem->SetColor(color);
+		}
+
 		memcpy(&newColor[0], &color[0], sizeof(idVec4));
 		len = strlen(text);
 
@@ -751,6 +976,16 @@ int idDeviceContext::DrawText(float x, float y, float scale, idVec4 color, const
 					newColor[3] = color[3];
 				}
 
+				colorIndex = *(s+1);
+
+				if (recordLayout) {
+					s += 2;
+					count += 2;
+					continue;
+				}
+
+				FlushText();
+
 				if (cursor == count || cursor == count+1) {
 					float partialSkip = ((glyph->xSkip * useScale) + adjust) / 5.0f;
 
@@ -769,7 +1004,23 @@ int idDeviceContext::DrawText(float x, float y, float scale, idVec4 color, const
 				continue;
 			} else {
 				float yadj = useScale * glyph->top;
-				PaintChar(x,y - yadj,glyph->imageWidth,glyph->imageHeight,useScale,glyph->s,glyph->t,glyph->s2,glyph->t2,glyph->glyph);
+
+				if (recordLayout) {
+					textGlyph_t *g = &recordLayout->glyphs.Alloc();
+
+					g->x = x;
+					g->y = y - yadj;
+					g->w = glyph->imageWidth * useScale;
+					g->h = glyph->imageHeight * useScale;
+					g->s = glyph->s;
+					g->t = glyph->t;
+					g->s2 = glyph->s2;
+					g->t2 = glyph->t2;
+					g->material = glyph->glyph;
+					g->color = colorIndex;
+				} else {
+					BatchChar(x, y - yadj, glyph->imageWidth * useScale, glyph->imageHeight * useScale, glyph->s, glyph->t, glyph->s2, glyph->t2, glyph->glyph);
+				}
 
 				if (cursor == count) {
 					DrawEditCursor(x, y, scale);
@@ -784,6 +1035,12 @@ int idDeviceContext::DrawText(float x, float y, float scale, idVec4 color, const
 		if (cursor == len) {
 			DrawEditCursor(x, y, scale);
 		}
+
+		if (recordLayout) {
+			recordLayout->endColor = colorIndex;
+		} else {
+			FlushText();
+		}
 	}
 
 	return count;
@@ -989,6 +1246,7 @@ void idDeviceContext::DrawEditCursor(float x, float y, float scale)
 		return;
 	}
 
+	FlushText();
 	SetFontByScale(scale);
 	float useScale = scale * useFont->glyphScale;
 	const glyphInfo_t *glyph2 = &useFont->glyphs[(overStrikeMode) ? '_' : '|'];
@@ -996,7 +1254,35 @@ void idDeviceContext::DrawEditCursor(float x, float y, float scale)
 	PaintChar(x, y - yadj,glyph2->imageWidth,glyph2->imageHeight,useScale,glyph2->s,glyph2->t,glyph2->s2,glyph2->t2,glyph2->glyph);
 }
 
+/*
+=============
+idDeviceContext::DrawText
+
+Texts without a cursor are drawn from a cached layout
+=============
+*/
 int idDeviceContext::DrawText(const char *text, float textScale, int textAlign, idVec4 color, idRectangle rectDraw, bool wrap, int cursor, bool calcOnly, idList<int> *breaks, int limit)
+{
+	idTextLayout *layout;
+
+	if (calcOnly || cursor >= 0 || breaks || limit || !(text && *text) || !gui_textLayoutCache.GetBool()) {
+		return DrawTextRect(text, textScale, textAlign, color, rectDraw, wrap, cursor, calcOnly, breaks, limit);
+	}
+
+	layout = FindTextLayout(text, textScale, textAlign, rectDraw, wrap);
+	DrawTextLayout(layout, rectDraw.x, rectDraw.y, color);
+
+	return layout->result;
+}
+
+/*
+=============
+idDeviceContext::DrawTextRect
+
+Breaks the text into lines that fit the rectangle and draws them
+=============
+*/
+int idDeviceContext::DrawTextRect(const char *text, float textScale, int textAlign, idVec4 color, idRectangle rectDraw, bool wrap, int cursor, bool calcOnly, idList<int> *breaks, int limit)
 {
 	const char	*p, *textPtr, *newLinePtr;
 	char		buff[1024];
@@ -1166,3 +1452,120 @@ char *idRectangle::String(void) const
 
 	return s;
 }
+
+/*
+=============
+idDeviceContext::AddDrawCacheKey
+
+Adds the transform, clipping and font state that the geometry depends on
+=============
+*/
+void idDeviceContext::AddDrawCacheKey(idDrawCache &cache)
+{
+	int num = clipRects.Num();
+
+	cache.AddKey(&origin, sizeof(origin));
+	cache.AddKey(&mat, sizeof(mat));
+	cache.AddKey(&xScale, sizeof(xScale));
+	cache.AddKey(&yScale, sizeof(yScale));
+	cache.AddKey(&enableClipping, sizeof(enableClipping));
+	cache.AddKey(&activeFont, sizeof(activeFont));
+	cache.AddKey(&num, sizeof(num));
+
+	if (num) {
+		cache.AddKey(clipRects.Ptr(), num * sizeof(idRectangle));
+	}
+}
+
+/*
+=============
+idDrawCache::idDrawCache
+=============
+*/
+idDrawCache::idDrawCache()
+{
+	valid = false;
+	capturing = false;
+}
+
+/*
+=============
+idDrawCache::BeginKey
+=============
+*/
+void idDrawCache::BeginKey(idDeviceContext *dc)
+{
+	key.SetNum(0, false);
+	dc->AddDrawCacheKey(*this);
+}
+
+/*
+=============
+idDrawCache::AddKey
+=============
+*/
+void idDrawCache::AddKey(const void *data, int bytes)
+{
+	int num = key.Num();
+
+	key.SetNum(num + bytes, false);
+	memcpy(key.Ptr() + num, data, bytes);
+}
+
+/*
+=============
+idDrawCache::AddKey
+=============
+*/
+void idDrawCache::AddKey(const char *s)
+{
+	AddKey(s, strlen(s) + 1);
+}
+
+/*
+=============
+idDrawCache::Draw
+=============
+*/
+bool idDrawCache::Draw()
+{
+	if (valid && key.Num() == lastKey.Num() && memcmp(key.Ptr(), lastKey.Ptr(), key.Num()) == 0) {
+		renderSystem->DrawGuiCapture(capture);
+		return true;
+	}
+
+	renderSystem->BeginGuiCapture();
+	capturing = true;
+
+	return false;
+}
+
+/*
+=============
+idDrawCache::EndDraw
+=============
+*/
+void idDrawCache::EndDraw()
+{
+	if (!capturing) {
+		return;
+	}
+
+	capturing = false;
+	valid = renderSystem->EndGuiCapture(capture);
+	lastKey.Swap(key);
+}
+
+/*
+=============
+idDrawCache::Invalidate
+=============
+*/
+void idDrawCache::Invalidate()
+{
+	valid = false;
+	capturing = false;
+	capture.surfaces.Clear();
+	capture.verts.Clear();
+	capture.indexes.Clear();
+}
@@ -38,6 +38,33 @@ const int VIRTUAL_WIDTH = 640;
 const int VIRTUAL_HEIGHT = 480;
 const int BLINK_DIVISOR = 200;
 
+class idDrawCache;
+
+// a glyph of a laid out text, relative to the text rectangle and before clipping
+typedef struct {
+	float				x, y, w, h;
+	float				s, t, s2, t2;
+	const idMaterial	*material;
+	int					color;					// color escape the glyph is drawn with, C_COLOR_DEFAULT for the text color
+} textGlyph_t;
+
+// the glyphs a text is broken into for a font, scale and rectangle size
+class idTextLayout
+{
+	public:
+		idStr				text;
+		const fontInfo_t	*font;
+		float				scale;
+		float				width;
+		float				height;
+		int					align;
+		bool				wrap;
+
+		int					result;				// what DrawText returned
+		int					endColor;			// color escape in effect after the text
+		idList<textGlyph_t>	glyphs;
+};
+
 class idDeviceContext
 {
 	public:
@@ -94,6 +121,7 @@ class idDeviceContext
 			enableClipping = b;
 		};
 		void				SetFont(int num);
+		int					GetFont() const;
 
 		void				SetOverStrike(bool b) {
 			overStrikeMode = b;
@@ -105,6 +133,10 @@ class idDeviceContext
 
 		void				DrawEditCursor(float x, float y, float scale);
 
+		void				AddDrawCacheKey(idDrawCache &cache);
+
+		void				FreeTextLayouts();
+
 		enum {
 			CURSOR_ARROW,
 			CURSOR_HAND,
@@ -140,7 +172,12 @@ class idDeviceContext
 
 	private:
 		int					DrawText(float x, float y, float scale, idVec4 color, const char *text, float adjust, int limit, int style, int cursor = -1);
+		int					DrawTextRect(const char *text, float textScale, int textAlign, idVec4 color, idRectangle rectDraw, bool wrap, int cursor, bool calcOnly, idList<int> *breaks, int limit);
 		void				PaintChar(float x,float y,float width,float height,float scale,float	s,float	t,float	s2,float t2,const idMaterial *hShader);
+		void				BatchChar(float x, float y, float w, float h, float s, float t, float s2, float t2, const idMaterial *hShader);
+		void				FlushText();
+		idTextLayout		*FindTextLayout(const char *text, float textScale, int textAlign, const idRectangle &rectDraw, bool wrap);
+		void				DrawTextLayout(const idTextLayout *layout, float x, float y, const idVec4 &color);
 		void				SetFontByScale(float scale);
 		void				Clear(void);
 
@@ -172,6 +209,42 @@ class idDeviceContext
 		bool				initialized;
 
 		bool				mbcs;
+
+		// glyphs are batched into one DrawStretchPic per material and color
+		idList<idDrawVert>	textVerts;
+		idList<glIndex_t>	textIndexes;
+		const idMaterial	*textMaterial;
+
+		idList<idTextLayout *>	textLayouts;
+		idHashIndex			textLayoutHash;
+		idTextLayout		*recordLayout;		// set while DrawText lays out a text into it
+};
+
+// keeps the geometry a window drew last frame, and adds it again while the
+// draw state the window built its key from stays the same
+class idDrawCache
+{
+	public:
+		idDrawCache();
+
+		void				BeginKey(idDeviceContext *dc);
+		void				AddKey(const void *data, int bytes);
+		void				AddKey(const char *s);
+
+		// returns true if the cached geometry was drawn, otherwise starts
+		// capturing and the caller must draw and then call EndDraw
+		bool				Draw();
+		void				EndDraw();
+		void				Invalidate();
+
+		static idCVar		gui_useDrawCache;
+
+	private:
+		idList<byte>		key;
+		idList<byte>		lastKey;
+		idGuiCapture		capture;
+		bool				valid;
+		bool				capturing;
 };
 
 #endif /* !__DEVICECONTEXT_H__ */
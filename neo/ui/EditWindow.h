@@ -44,6 +44,9 @@ class idEditWindow : public idWindow
 		virtual 			~idEditWindow();
 
 		virtual void		Draw(int time, float x, float y);
+		virtual bool		CanDrawCached() {
+			return false;
+		}
 		virtual const char *HandleEvent(const sysEvent_t *event, bool *updateVisuals);
 		virtual void		PostParse();
 		virtual void		GainFocus();
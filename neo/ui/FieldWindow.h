@@ -39,6 +39,9 @@ class idFieldWindow : public idWindow
 		virtual ~idFieldWindow();
 
 		virtual void Draw(int time, float x, float y);
+		virtual bool CanDrawCached() {
+			return false;
+		}
 
 	private:
 		virtual bool ParseInternalVar(const char *name, idParser *src);
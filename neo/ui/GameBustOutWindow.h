@@ -123,6 +123,9 @@ class idGameBustOutWindow : public idWindow
 		virtual const char	*HandleEvent(const sysEvent_t *event, bool *updateVisuals);
 		virtual void		PostParse();
 		virtual void		Draw(int time, float x, float y);
+		virtual bool		CanDrawCached() {
+			return false;
+		}
 		virtual const char	*Activate(bool activate);
 		virtual idWinVar 	*GetWinVarByName(const char *_name, bool winLookup = false, drawWin_t **owner = NULL);
 
@@ -504,6 +504,9 @@ class idGameSSDWindow : public idWindow
 
 
 		virtual void		Draw(int time, float x, float y);
+		virtual bool		CanDrawCached() {
+			return false;
+		}
 
 		void				AddHealth(int health);
 		void				AddScore(SSDEntity *ent, int points);
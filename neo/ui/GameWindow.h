@@ -34,6 +34,9 @@ class idGameWindowProxy : public idWindow
 	public:
 		idGameWindowProxy(idDeviceContext *d, idUserInterfaceLocal *gui);
 		void		Draw(int time, float x, float y);
+		bool		CanDrawCached() {
+			return false;
+		}
 };
 
 #endif
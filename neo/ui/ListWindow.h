@@ -54,6 +54,9 @@ class idListWindow : public idWindow
 		virtual const char	*HandleEvent(const sysEvent_t *event, bool *updateVisuals);
 		virtual void		PostParse();
 		virtual void		Draw(int time, float x, float y);
+		virtual bool		CanDrawCached() {
+			return false;
+		}
 		virtual void		Activate(bool activate, idStr &act);
 		virtual void		HandleBuddyUpdate(idWindow *buddy);
 		virtual void		StateChanged(bool redraw = false);
@@ -48,6 +48,9 @@ class idMarkerWindow : public idWindow
 		virtual idWinVar *GetWinVarByName(const char *_name, bool winLookup = false);
 
 		virtual const char *HandleEvent(const sysEvent_t *event, bool *updateVisuals);
+		virtual bool CanDrawCached() {
+			return false;
+		}
 		virtual void PostParse();
 		virtual void Draw(int time, float x, float y);
 		virtual const char *RouteMouseCoords(float xd, float yd);
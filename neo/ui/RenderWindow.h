@@ -38,6 +38,9 @@ class idRenderWindow : public idWindow
 
 		virtual void PostParse();
 		virtual void Draw(int time, float x, float y);
+		virtual bool CanDrawCached() {
+			return false;
+		}
 		virtual size_t Allocated() {
 			return idWindow::Allocated();
 		};
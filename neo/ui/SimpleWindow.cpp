@@ -34,6 +34,8 @@ If you have questions concerning this license or the applicable additional terms
 #include "UserInterfaceLocal.h"
 #include "SimpleWindow.h"
 
+extern idCVar r_skipGuiShaders;		// 1 = don't render any gui elements on surfaces
+
 
 idSimpleWindow::idSimpleWindow(idWindow *win)
 {
@@ -261,21 +263,25 @@ void idSimpleWindow::Redraw(float x, float y)
 		dc->EnableClipping(false);
 	}
 
-	DrawBackground(drawRect);
-	DrawBorderAndCaption(drawRect);
+	if (!DrawCached()) {
+		DrawBackground(drawRect);
+		DrawBorderAndCaption(drawRect);
+
+		if (textShadow) {
+			idStr shadowText = text;
+			idRectangle shadowRect = textRect;
 
-	if (textShadow) {
-		idStr shadowText = text;
-		idRectangle shadowRect = textRect;
+			shadowText.RemoveColors();
+			shadowRect.x += textShadow;
+			shadowRect.y += textShadow;
 
-		shadowText.RemoveColors();
-		shadowRect.x += textShadow;
-		shadowRect.y += textShadow;
+			dc->DrawText(shadowText, textScale, textAlign, colorBlack, shadowRect, !(flags & WIN_NOWRAP), -1);
+		}
 
-		dc->DrawText(shadowText, textScale, textAlign, colorBlack, shadowRect, !(flags & WIN_NOWRAP), -1);
+		dc->DrawText(text, textScale, textAlign, foreColor, textRect, !(flags & WIN_NOWRAP), -1);
+		drawCache.EndDraw();
 	}
 
-	dc->DrawText(text, textScale, textAlign, foreColor, textRect, !(flags & WIN_NOWRAP), -1);
 	dc->SetTransformInfo(vec3_origin, mat3_identity);
 
 	if (flags & WIN_NOCLIP) {
@@ -288,6 +294,56 @@ void idSimpleWindow::Redraw(float x, float y)
 }
 
 
+/*
+================
+idSimpleWindow::DrawCached
+
+Adds last frame's geometry again if nothing it depends on changed
+================
+*/
+bool idSimpleWindow::DrawCached()
+{
+	idVec4	colors[4];
+	float	scale;
+	int		size[2];
+
+	if (!idDrawCache::gui_useDrawCache.GetBool() || idWindow::gui_edit.GetBool() || idWindow::gui_debug.GetInteger()
+	    || r_skipGuiShaders.GetInteger()) {
+		drawCache.Invalidate();
+		return false;
+	}
+
+	colors[0] = backColor;
+	colors[1] = matColor;
+	colors[2] = foreColor;
+	colors[3] = borderColor;
+	scale = textScale;
+
+	drawCache.BeginKey(dc);
+	drawCache.AddKey(&flags, sizeof(flags));
+	drawCache.AddKey(&drawRect, sizeof(drawRect));
+	drawCache.AddKey(&clientRect, sizeof(clientRect));
+	drawCache.AddKey(&textRect, sizeof(textRect));
+	drawCache.AddKey(colors, sizeof(colors));
+	drawCache.AddKey(&scale, sizeof(scale));
+	drawCache.AddKey(&background, sizeof(background));
+
+	if (background && (flags & WIN_NATURALMAT)) {
+		size[0] = background->GetImageWidth();
+		size[1] = background->GetImageHeight();
+		drawCache.AddKey(size, sizeof(size));
+	}
+
+	drawCache.AddKey(&matScalex, sizeof(matScalex));
+	drawCache.AddKey(&matScaley, sizeof(matScaley));
+	drawCache.AddKey(&borderSize, sizeof(borderSize));
+	drawCache.AddKey(&textAlign, sizeof(textAlign));
+	drawCache.AddKey(&textShadow, sizeof(textShadow));
+	drawCache.AddKey(text.c_str());
+
+	return drawCache.Draw();
+}
+
 intptr_t idSimpleWindow::GetWinVarOffset(idWinVar *wv, drawWin_t *owner)
 {
 	intptr_t ret = -1;
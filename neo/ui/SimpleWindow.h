@@ -65,6 +65,7 @@ class idSimpleWindow
 		void 			SetupTransforms(float x, float y);
 		void 			DrawBackground(const idRectangle &drawRect);
 		void 			DrawBorderAndCaption(const idRectangle &drawRect);
+		bool			DrawCached();
 
 		idUserInterfaceLocal *gui;
 		idDeviceContext *dc;
@@ -99,6 +100,8 @@ class idSimpleWindow
 		idWindow 		*mParent;
 
 		idWinBool	hideCursor;
+
+		idDrawCache		drawCache;
 };
 
 #endif /* !__SIMPLEWIN_H__ */
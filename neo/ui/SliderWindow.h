@@ -60,6 +60,9 @@ class idSliderWindow : public idWindow
 		virtual const char *HandleEvent(const sysEvent_t *event, bool *updateVisuals);
 		virtual void		PostParse();
 		virtual void		Draw(int time, float x, float y);
+		virtual bool		CanDrawCached() {
+			return false;
+		}
 		virtual void		DrawBackground(const idRectangle &drawRect);
 		virtual const char *RouteMouseCoords(float xd, float yd);
 		virtual void		Activate(bool activate, idStr &act);
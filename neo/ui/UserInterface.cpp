@@ -39,6 +39,87 @@ extern idCVar r_skipGuiShaders;		// 1 = don't render any gui elements on surface
 idUserInterfaceManagerLocal	uiManagerLocal;
 idUserInterfaceManager 	*uiManager = &uiManagerLocal;
 
+idCVar idUserInterfaceManagerLocal::gui_compiled("gui_compiled", "1", CVAR_GUI | CVAR_BOOL, "load guis from their compiled token files, compiling them on first load");
+
+#define GUI_LEXER_FLAGS			(LEXFL_NOFATALERRORS | LEXFL_NOSTRINGCONCAT | LEXFL_ALLOWMULTICHARLITERALS | LEXFL_ALLOWBACKSLASHSTRINGCONCAT)
+
+// a compiled gui is the token stream of the gui source after all includes and
+// defines were processed, so loading it skips the lexer and the precompiler
+// stored in native byte order in the save path, or shipped in a pak
+#define GUI_COMPILED_FOLDER		"generated/"
+#define GUI_COMPILED_EXTENSION	".guic"
+#define GUI_COMPILED_IDENT		(('C'<<24)+('I'<<16)+('U'<<8)+'G')
+#define GUI_COMPILED_VERSION	1
+
+// followed by the file records, the token records and the strings
+typedef struct {
+	int						ident;
+	int						version;
+	int						flags;					// lexer flags the tokens were read with
+	int						numFiles;
+	int						numTokens;
+	int						stringsLength;
+} guiCompiledHeader_t;
+
+// the gui and every file it included, the compiled file is out of date
+// when one of them has a different timestamp
+typedef struct {
+	int						name;					// offset in the strings
+	int						timestamp;
+} guiCompiledFile_t;
+
+typedef struct {
+	int						string;					// offset in the strings
+	short					type;
+	short					linesCrossed;
+	int						subtype;
+	int						line;
+	int						flags;
+} guiCompiledToken_t;
+
+/*
+================
+GUI_CompiledName
+================
+*/
+static idStr GUI_CompiledName(const char *qpath)
+{
+	idStr name = GUI_COMPILED_FOLDER;
+
+	name += qpath;
+	name.SetFileExtension(GUI_COMPILED_EXTENSION);
+
+	return name;
+}
+
+/*
+================
+GUI_AddString
+
+Adds a string to the strings of a compiled gui, equal strings are stored once
+================
+*/
+static int GUI_AddString(const char *string, idList<char> &strings, idHashIndex &hash)
+{
+	int key, offset, length;
+
+	key = hash.GenerateKey(string, true);
+
+	for (offset = hash.First(key); offset != -1; offset = hash.Next(offset)) {
+		if (!strcmp(&strings[offset], string)) {
+			return offset;
+		}
+	}
+
+	offset = strings.Num();
+	length = strlen(string) + 1;
+	strings.SetNum(offset + length, false);
+	memcpy(&strings[offset], string, length);
+	hash.Add(key, offset);
+
+	return offset;
+}
+
 /*
 ===============================================================================
 
@@ -177,6 +258,309 @@ void idUserInterfaceManagerLocal::ListGuis() const
 	common->Printf("===========\n  %i total Guis ( %i copies, %i unique ), %.2f total Mbytes", c, copies, unique, total / (1024.0f * 1024.0f));
 }
 
+/*
+================
+idUserInterfaceManagerLocal::ReadCompiledGui
+
+Fails if there is no compiled file, or if it is out of date
+================
+*/
+bool idUserInterfaceManagerLocal::ReadCompiledGui(const char *qpath, idList<idToken> &tokens) const
+{
+	const guiCompiledHeader_t	*header;
+	const guiCompiledFile_t		*files;
+	const guiCompiledToken_t	*compiled;
+	const char					*strings;
+	const void					*buffer;
+	ID_TIME_T					timestamp;
+	idStr						name;
+	int							i, length;
+	bool						valid;
+
+	name = GUI_CompiledName(qpath);
+	length = fileSystem->ReadFileView(name, &buffer, NULL);
+
+	if (length < 0) {
+		return false;
+	}
+
+	header = (const guiCompiledHeader_t *)buffer;
+
+	valid = (length >= (int)sizeof(guiCompiledHeader_t) &&
+	         header->ident == GUI_COMPILED_IDENT && header->version == GUI_COMPILED_VERSION &&
+	         header->flags == GUI_LEXER_FLAGS &&
+	         header->numFiles > 0 && header->numFiles <= length &&
+	         header->numTokens >= 0 && header->numTokens <= length &&
+	         header->stringsLength > 0 && header->stringsLength <= length &&
+	         sizeof(guiCompiledHeader_t) + header->numFiles * sizeof(guiCompiledFile_t) +
+	         header->numTokens * sizeof(guiCompiledToken_t) + header->stringsLength == (size_t)length);
+
+	if (valid) {
+		files = (const guiCompiledFile_t *)(header + 1);
+		compiled = (const guiCompiledToken_t *)(files + header->numFiles);
+		strings = (const char *)(compiled + header->numTokens);
+		valid = (strings[header->stringsLength - 1] == '\0');
+	}
+
+	for (i = 0; valid && i < header->numFiles; i++) {
+		if (files[i].name < 0 || files[i].name >= header->stringsLength) {
+			valid = false;
+			break;
+		}
+
+		fileSystem->ReadFile(strings + files[i].name, NULL, &timestamp);
+
+		if (timestamp == FILE_NOT_FOUND_TIMESTAMP || (int)timestamp != files[i].timestamp) {
+			valid = false;
+		}
+	}
+
+	if (!valid) {
+		common->DPrintf("%s is out of date\n", name.c_str());
+		fileSystem->FreeFileView(buffer);
+		return false;
+	}
+
+	tokens.SetNum(header->numTokens, false);
+
+	for (i = 0; i < header->numTokens; i++) {
+		idToken &token = tokens[i];
+
+		if (compiled[i].string < 0 || compiled[i].string >= header->stringsLength) {
+			break;
+		}
+
+		token = strings + compiled[i].string;
+		token.type = compiled[i].type;
+		token.subtype = compiled[i].subtype;
+		token.line = compiled[i].line;
+		token.linesCrossed = compiled[i].linesCrossed;
+		token.flags = compiled[i].flags;
+		token.ClearTokenWhiteSpace();
+	}
+
+	fileSystem->FreeFileView(buffer);
+
+	if (i < header->numTokens) {
+		tokens.Clear();
+		return false;
+	}
+
+	return true;
+}
+
+/*
+================
+idUserInterfaceManagerLocal::CompileGui
+
+Reads the gui source through the precompiler and writes the tokens
+================
+*/
+bool idUserInterfaceManagerLocal::CompileGui(const char *qpath, idList<idToken> &tokens) const
+{
+	idParser				src(GUI_LEXER_FLAGS);
+	idToken					token;
+	idList<idStr>			includes;
+	idList<char>			strings;
+	idHashIndex				hash;
+	guiCompiledHeader_t		header;
+	guiCompiledFile_t		file;
+	guiCompiledToken_t		compiled;
+	ID_TIME_T				timestamp;
+	idFile					*f;
+	idStr					name;
+	int						i;
+
+	tokens.Clear();
+
+	src.SetIncludeList(&includes);
+
+	if (!src.LoadFile(qpath)) {
+		return false;
+	}
+
+	includes.Insert(qpath, 0);
+
+	while (src.ReadToken(&token)) {
+		token.ClearTokenWhiteSpace();
+		tokens.Append(token);
+	}
+
+	name = GUI_CompiledName(qpath);
+	f = fileSystem->OpenFileWrite(name);
+
+	if (!f) {
+		common->Warning("couldn't write %s", name.c_str());
+		return true;
+	}
+
+	strings.SetGranularity(4096);
+
+	header.ident = GUI_COMPILED_IDENT;
+	header.version = GUI_COMPILED_VERSION;
+	header.flags = GUI_LEXER_FLAGS;
+	header.numFiles = includes.Num();
+	header.numTokens = tokens.Num();
+
+	// the strings are written last, but the offsets are needed first
+	for (i = 0; i < includes.Num(); i++) {
+		GUI_AddString(includes[i], strings, hash);
+	}
+
+	for (i = 0; i < tokens.Num(); i++) {
+		GUI_AddString(tokens[i], strings, hash);
+	}
+
+	header.stringsLength = strings.Num();
+	f->Write(&header, sizeof(header));
+
+	for (i = 0; i < includes.Num(); i++) {
+		fileSystem->ReadFile(includes[i], NULL, &timestamp);
+		file.name = GUI_AddString(includes[i], strings, hash);
+		file.timestamp = (int)timestamp;
+		f->Write(&file, sizeof(file));
+	}
+
+	for (i = 0; i < tokens.Num(); i++) {
+		compiled.string = GUI_AddString(tokens[i], strings, hash);
+		compiled.type = tokens[i].type;
+		compiled.linesCrossed = tokens[i].linesCrossed;
+		compiled.subtype = tokens[i].subtype & ~TT_VALUESVALID;
+		compiled.line = tokens[i].line;
+		compiled.flags = tokens[i].flags;
+		f->Write(&compiled, sizeof(compiled));
+	}
+
+	f->Write(strings.Ptr(), strings.Num());
+	fileSystem->CloseFile(f);
+
+	return true;
+}
+
+/*
+================
+idUserInterfaceManagerLocal::LoadGuiTokens
+================
+*/
+bool idUserInterfaceManagerLocal::LoadGuiTokens(const char *qpath, idList<idToken> &tokens)
+{
+	if (ReadCompiledGui(qpath, tokens)) {
+		return true;
+	}
+
+	if (CompileGui(qpath, tokens)) {
+		common->DPrintf("compiled %s\n", qpath);
+		return true;
+	}
+
+	return false;
+}
+
+/*
+================
+idUserInterfaceManagerLocal::CompileGuis
+================
+*/
+void idUserInterfaceManagerLocal::CompileGuis(const char *qpath)
+{
+	idList<idToken>	tokens;
+	idFileList		*files;
+	int				i, numCompiled;
+
+	if (qpath && *qpath) {
+		if (CompileGui(qpath, tokens)) {
+			common->Printf("compiled %s, %i tokens\n", qpath, tokens.Num());
+		} else {
+			common->Warning("Couldn't load gui: '%s'", qpath);
+		}
+
+		return;
+	}
+
+	files = fileSystem->ListFilesTree("guis", ".gui", true);
+	numCompiled = 0;
+
+	for (i = 0; i < files->GetNumFiles(); i++) {
+		if (CompileGui(files->GetFile(i), tokens)) {
+			numCompiled++;
+		} else {
+			common->Warning("Couldn't load gui: '%s'", files->GetFile(i));
+		}
+	}
+
+	common->Printf("%i of %i guis compiled\n", numCompiled, files->GetNumFiles());
+	fileSystem->FreeFileList(files);
+}
+
+/*
+================
+idUserInterfaceManagerLocal::BenchmarkText
+
+Draws a console sized page of colored text every frame, first laying it
+out every time, then from the text layout cache.  Only the DrawText
+calls are timed.  The shared device context is already virtual sized,
+the font and transform the guis left in it are restored afterwards.
+================
+*/
+void idUserInterfaceManagerLocal::BenchmarkText(int frames)
+{
+	idList<idStr>	lines;
+	idTimer			timer[2];
+	idVec3			oldOrigin;
+	idMat3			oldMat;
+	float			scale, lineHeight;
+	int				numLines, numChars, pass, frame, i, oldFont;
+	bool			oldCache;
+
+	if (frames <= 0) {
+		return;
+	}
+
+	scale = 0.25f;
+	oldFont = dc.GetFont();
+	dc.GetTransformInfo(oldOrigin, oldMat);
+	dc.SetFont(0);
+	dc.SetTransformInfo(vec3_origin, mat3_identity);
+	lineHeight = dc.MaxCharHeight(scale) + 2;
+	numLines = idMath::FtoiFast(VIRTUAL_HEIGHT / lineHeight);
+	numChars = 0;
+
+	for (i = 0; i < numLines; i++) {
+		lines.Append(va("%4i: ^3WARNING: ^7couldn't load image: ^2textures/base_wall/lfwall%i^7, using default ^1%i", i, i * 7, i * 13));
+		numChars += lines[i].LengthWithoutColors();
+	}
+
+	oldCache = cvarSystem->GetCVarBool("gui_textLayoutCache");
+
+	for (pass = 0; pass < 2; pass++) {
+		cvarSystem->SetCVarBool("gui_textLayoutCache", pass != 0);
+		dc.FreeTextLayouts();
+
+		for (frame = 0; frame < frames; frame++) {
+			renderSystem->BeginFrame(renderSystem->GetScreenWidth(), renderSystem->GetScreenHeight());
+
+			timer[pass].Start();
+
+			for (i = 0; i < numLines; i++) {
+				dc.DrawText(lines[i], scale, idDeviceContext::ALIGN_LEFT, dc.colorWhite, idRectangle(0.0f, i * lineHeight, VIRTUAL_WIDTH, lineHeight), false);
+			}
+
+			timer[pass].Stop();
+
+			renderSystem->EndFrame(NULL, NULL);
+		}
+	}
+
+	cvarSystem->SetCVarBool("gui_textLayoutCache", oldCache);
+	dc.FreeTextLayouts();
+	dc.SetFont(oldFont);
+	dc.SetTransformInfo(oldOrigin, oldMat);
+
+	common->Printf("%i frames of %i lines, %i characters\n", frames, numLines, numChars);
+	common->Printf("laid out: %6.3f msec per frame\n", timer[0].Milliseconds() / frames);
+	common->Printf("cached:   %6.3f msec per frame\n", timer[1].Milliseconds() / frames);
+}
+
 bool idUserInterfaceManagerLocal::CheckGui(const char *qpath) const
 {
 	idFile *file = fileSystem->OpenFileRead(qpath);
@@ -332,12 +716,27 @@ bool idUserInterfaceLocal::InitFromFile(const char *qpath, bool rebuild, bool ca
 	source = qpath;
 	state.Set("text", "Test Text!");
 
-	idParser src(LEXFL_NOFATALERRORS | LEXFL_NOSTRINGCONCAT | LEXFL_ALLOWMULTICHARLITERALS | LEXFL_ALLOWBACKSLASHSTRINGCONCAT);
+	idParser src(GUI_LEXER_FLAGS);
+	idList<idToken> tokens;
+	bool compiled = idUserInterfaceManagerLocal::gui_compiled.GetBool();
+
+#ifdef ID_ALLOW_TOOLS
+
+	// the gui editor keeps the source text of what was parsed
+	if (com_editors & EDITOR_GUI) {
+		compiled = false;
+	}
+
+#endif
 
 	//Load the timestamp so reload guis will work correctly
 	fileSystem->ReadFile(qpath, NULL, &timeStamp);
 
-	src.LoadFile(qpath);
+	if (compiled && uiManagerLocal.LoadGuiTokens(qpath, tokens)) {
+		src.LoadTokens(tokens.Ptr(), tokens.Num(), qpath);
+	} else {
+		src.LoadFile(qpath);
+	}
 
 	if (src.IsLoaded()) {
 		idToken token;
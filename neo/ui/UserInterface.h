@@ -137,6 +137,12 @@ class idUserInterfaceManager
 		// lists all guis
 		virtual void				ListGuis() const = 0;
 
+		// Compiles a gui, or all guis when qpath is empty, to the preprocessed form loaded by InitFromFile.
+		virtual void				CompileGuis(const char *qpath) = 0;
+
+		// Times drawing a screen full of text, with and without the text layout cache.
+		virtual void				BenchmarkText(int frames) = 0;
+
 		// Returns true if gui exists.
 		virtual bool				CheckGui(const char *qpath) const = 0;
 
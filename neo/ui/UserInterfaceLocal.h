@@ -164,6 +164,8 @@ class idUserInterfaceManagerLocal : public idUserInterfaceManager
 		virtual void				EndLevelLoad();
 		virtual void				Reload(bool all);
 		virtual void				ListGuis() const;
+		virtual void				CompileGuis(const char *qpath);
+		virtual void				BenchmarkText(int frames);
 		virtual bool				CheckGui(const char *qpath) const;
 		virtual idUserInterface 	*Alloc(void) const;
 		virtual void				DeAlloc(idUserInterface *gui);
@@ -172,7 +174,15 @@ class idUserInterfaceManagerLocal : public idUserInterfaceManager
 		virtual	idListGUI 			*AllocListGUI(void) const;
 		virtual void				FreeListGUI(idListGUI *listgui);
 
+		// reads the preprocessed tokens of a gui from its compiled file, or compiles it
+		bool						LoadGuiTokens(const char *qpath, idList<idToken> &tokens);
+
+		static idCVar				gui_compiled;
+
 	private:
+		bool						ReadCompiledGui(const char *qpath, idList<idToken> &tokens) const;
+		bool						CompileGui(const char *qpath, idList<idToken> &tokens) const;
+
 		idRectangle					screenRect;
 		idDeviceContext				dc;
 
@@ -1257,6 +1257,58 @@ void idWindow::DrawBorderAndCaption(const idRectangle &drawRect)
 	}
 }
 
+/*
+================
+idWindow::DrawCached
+
+Adds last frame's background, border and text again if nothing they
+depend on changed.  Only plain windows are cached, the derived window
+types draw from state of their own and override CanDrawCached.
+================
+*/
+bool idWindow::DrawCached()
+{
+	idVec4	colors[4];
+	float	scale;
+	int		size[2];
+
+	if (!idDrawCache::gui_useDrawCache.GetBool() || gui_edit.GetBool() || gui_debug.GetInteger()
+	    || r_skipGuiShaders.GetInteger() || !CanDrawCached()) {
+		drawCache.Invalidate();
+		return false;
+	}
+
+	colors[0] = backColor;
+	colors[1] = matColor;
+	colors[2] = foreColor;
+	colors[3] = borderColor;
+	scale = textScale;
+
+	drawCache.BeginKey(dc);
+	drawCache.AddKey(&flags, sizeof(flags));
+	drawCache.AddKey(&drawRect, sizeof(drawRect));
+	drawCache.AddKey(&clientRect, sizeof(clientRect));
+	drawCache.AddKey(&textRect, sizeof(textRect));
+	drawCache.AddKey(colors, sizeof(colors));
+	drawCache.AddKey(&scale, sizeof(scale));
+	drawCache.AddKey(&background, sizeof(background));
+
+	if (background && (flags & WIN_NATURALMAT)) {
+		size[0] = background->GetImageWidth();
+		size[1] = background->GetImageHeight();
+		drawCache.AddKey(size, sizeof(size));
+	}
+
+	drawCache.AddKey(&matScalex, sizeof(matScalex));
+	drawCache.AddKey(&matScaley, sizeof(matScaley));
+	drawCache.AddKey(&borderSize, sizeof(borderSize));
+	drawCache.AddKey(&textAlign, sizeof(textAlign));
+	drawCache.AddKey(&textShadow, sizeof(textShadow));
+	drawCache.AddKey(text.c_str());
+
+	return drawCache.Draw();
+}
+
 /*
 ================
 idWindow::SetupTransforms
@@ -1373,15 +1425,24 @@ void idWindow::Redraw(float x, float y)
 	dc->GetTransformInfo(oldOrg, oldTrans);
 
 	SetupTransforms(x, y);
-	DrawBackground(drawRect);
-	DrawBorderAndCaption(drawRect);
+
+	bool cached = DrawCached();
+
+	if (!cached) {
+		DrawBackground(drawRect);
+		DrawBorderAndCaption(drawRect);
+	}
 
 	if (!(flags & WIN_NOCLIP)) {
 		dc->PushClipRect(clientRect);
 	}
 
-	if (r_skipGuiShaders.GetInteger() < 5) {
-		Draw(time, x, y);
+	if (!cached) {
+		if (r_skipGuiShaders.GetInteger() < 5) {
+			Draw(time, x, y);
+		}
+
+		drawCache.EndDraw();
 	}
 
 	if (gui_debug.GetInteger()) {
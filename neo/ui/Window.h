@@ -247,6 +247,7 @@ class idWindow
 		void CommonInit();
 		void CleanUp();
 		void DrawBorderAndCaption(const idRectangle &drawRect);
+		bool DrawCached();
 		void DrawCaption(int time, float x, float y);
 		void SetupTransforms(float x, float y);
 		bool Contains(const idRectangle &sr, float x, float y);
@@ -271,6 +272,10 @@ class idWindow
 		virtual void Sized();
 		virtual void Moved();
 		virtual void Draw(int time, float x, float y);
+		// only plain windows draw nothing but what the draw cache keys on
+		virtual bool CanDrawCached() {
+			return true;
+		}
 		virtual void MouseExit();
 		virtual void MouseEnter();
 		virtual void DrawBackground(const idRectangle &drawRect);
@@ -462,6 +467,8 @@ class idWindow
 		idRegisterList regList;
 
 		idWinBool	hideCursor;
+
+		idDrawCache	drawCache;				// background, border and text from the last redraw
 };
 
 ID_INLINE void idWindow::AddDefinedVar(idWinVar *var)